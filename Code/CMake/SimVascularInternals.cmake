@@ -15,6 +15,7 @@ set(SV_LIBS
   THIRDPARTY_TINYXML
   THIRDPARTY_ZLIB
   LINEAR_SOLVER
+  PROFILER
 )
 
 foreach(lib ${SV_LIBS})
@@ -0,0 +1,1100 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Smoothed aggregation algebraic multigrid (SA-AMG) preconditioner.
+//
+// The hierarchy is built from the fsils matrix Val(dof*dof,nnz), stored 
+// with the lhs rowPtr/colPtr structure. The matrix of a process holds only
+// the contributions of its own elements, the global matrix being the sum
+// over all processes. Each process aggregates the nodes it owns (lhs nodes
+// [0,mynNo)) so the prolongator P has a single row for each global fine
+// node, known on every process sharing the node. The coarse matrix 
+//
+//   Ac = P^T A P = sum_p P^T A_p P 
+//
+// is then again an fsils matrix for a coarse lhs created with 
+// fsils_lhs_create(), and the coarse levels use the same communication,
+// product and norm functions as the fine system.
+//
+// The near null space is the constant for each dof. The tentative 
+// prolongator is smoothed with one damped Jacobi step
+//
+//   P = (I - omega D^-1 A) P_tent,  omega = 4 / (3 lambda_max),
+//
+// with lambda_max estimated for D^-1 A by power iterations. The 
+// preconditioner is a V-cycle with Jacobi or Chebyshev smoothing. The 
+// coarsest level is solved with a dense LU factorization replicated on 
+// all processes.
+
+#include "amg.h"
+#include "DebugMsg.h"
+#include "Profiler.h"
+
+#include "fsils_api.hpp"
+#include "lhs.h"
+#include "norm.h"
+#include "spar_mul.h"
+
+#include <math.h>
+#include <unordered_map>
+
+namespace amg {
+
+namespace {
+
+/// @brief Number of power iterations used to estimate lambda_max.
+const int num_power_iterations = 15;
+
+/// @brief Number of smoother sweeps on a coarsest level that is not
+/// solved directly.
+const int num_coarse_sweeps = 10;
+
+/// @brief MPI tags used to exchange prolongator rows.
+const int count_tag = 21;
+const int value_tag = 22;
+
+/// @brief Block sparse matrix in compressed row form used while the 
+/// hierarchy is built, the block of entry e is val[e*dof*dof].
+//
+class BlockCsr 
+{
+  public:
+    std::vector<int> ptr;
+    std::vector<int> col;
+    std::vector<double> val;
+};
+
+/// @brief Set the inverse of the assembled point diagonal. 
+//
+void set_diagonal(AmgLevel& lev, const int dof)
+{
+  auto& lhs = *lev.lhs;
+  const auto& A = *lev.A;
+  int nNo = lhs.nNo;
+  Array<double> D(dof,nNo);
+
+  for (int a = 0; a < nNo; a++) {
+    int d = lhs.diagPtr(a);
+    for (int k = 0; k < dof; k++) {
+      D(k,a) = A(k*dof+k,d);
+    }
+  }
+
+  fsils_commuv(lhs, dof, D);
+
+  lev.Dinv.resize(dof,nNo);
+
+  for (int i = 0; i < D.size(); i++) {
+    lev.Dinv(i) = (D(i) != 0.0) ? 1.0 / D(i) : 0.0;
+  }
+
+  lev.b.resize(dof,nNo);
+  lev.x.resize(dof,nNo);
+  lev.r.resize(dof,nNo);
+  lev.d.resize(dof,nNo);
+  lev.t.resize(dof,nNo);
+}
+
+/// @brief Estimate the largest eigenvalue of Dinv*A using power iterations.
+//
+void estimate_lambda_max(AmgLevel& lev, const int dof)
+{
+  auto& lhs = *lev.lhs;
+  const auto& A = *lev.A;
+  int mynNo = lhs.mynNo;
+  auto& x = lev.r;
+  auto& y = lev.t;
+
+  // The start vector is set on owned nodes and communicated so it is 
+  // the same on all processes sharing a node.
+  x = 0.0;
+  for (int a = 0; a < mynNo; a++) {
+    for (int k = 0; k < dof; k++) {
+      if (lev.Dinv(k,a) != 0.0) {
+        x(k,a) = 1.0 + 0.5*sin(1.0 + dof*a + k);
+      }
+    }
+  }
+
+  fsils_commuv(lhs, dof, x);
+
+  double nx = norm::fsi_ls_normv(dof, mynNo, lhs.commu, x);
+  double lambda = 0.0;
+
+  for (int iter = 0; iter < num_power_iterations; iter++) {
+    if (nx == 0.0) {
+      break;
+    }
+
+    for (int i = 0; i < x.size(); i++) {
+      x(i) = x(i) / nx;
+    }
+
+    spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, A, x, y);
+
+    for (int i = 0; i < y.size(); i++) {
+      x(i) = lev.Dinv(i) * y(i);
+    }
+
+    nx = norm::fsi_ls_normv(dof, mynNo, lhs.commu, x);
+    lambda = nx;
+  }
+
+  lev.lambda_max = (lambda > 0.0) ? lambda : 1.0;
+}
+
+/// @brief Frobenius norm of the block of nonzero j.
+//
+double block_norm(const Array<double>& A, const int dof, const int j)
+{
+  double s = 0.0;
+  for (int i = 0; i < dof*dof; i++) {
+    s += A(i,j)*A(i,j);
+  }
+  return sqrt(s);
+}
+
+/// @brief Aggregate the owned nodes [0,mynNo) of a level.
+///
+/// Node j is strongly connected to node a if |A_aj| > theta sqrt(|A_aa| |A_jj|),
+/// using block norms. Unknowns removed by Dirichlet conditions have a zero 
+/// diagonal and no strong connections, their nodes are added to a 
+/// neighboring aggregate.
+///
+/// Returns the number of aggregates, agg(a) is the aggregate of node a.
+//
+int aggregate(const AmgLevel& lev, const int dof, const double theta, std::vector<int>& agg)
+{
+  const auto& lhs = *lev.lhs;
+  const auto& A = *lev.A;
+  int mynNo = lhs.mynNo;
+
+  std::vector<double> dn(mynNo);
+
+  for (int a = 0; a < mynNo; a++) {
+    double s = 0.0;
+    for (int k = 0; k < dof; k++) {
+      if (lev.Dinv(k,a) != 0.0) {
+        s += 1.0 / (lev.Dinv(k,a)*lev.Dinv(k,a));
+      }
+    }
+    dn[a] = sqrt(s);
+  }
+
+  auto strength = [&](const int a, const int j) -> double 
+  {
+    int b = lhs.colPtr(j);
+    if ((b == a) || (b >= mynNo) || (dn[a] == 0.0) || (dn[b] == 0.0)) {
+      return 0.0;
+    }
+    double s = block_norm(A, dof, j);
+    return (s > theta*sqrt(dn[a]*dn[b])) ? s : 0.0;
+  };
+
+  agg.assign(mynNo, -1);
+  int nAgg = 0;
+
+  // Aggregates made of a node and all of its strong neighbors.
+  //
+  for (int a = 0; a < mynNo; a++) {
+    if ((agg[a] != -1) || (dn[a] == 0.0)) {
+      continue;
+    }
+
+    bool free = true;
+    int num_strong = 0;
+
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      if (strength(a,j) > 0.0) {
+        num_strong += 1;
+        if (agg[lhs.colPtr(j)] != -1) {
+          free = false;
+          break;
+        }
+      }
+    }
+
+    if (!free || (num_strong == 0)) {
+      continue;
+    }
+
+    agg[a] = nAgg;
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      if (strength(a,j) > 0.0) {
+        agg[lhs.colPtr(j)] = nAgg;
+      }
+    }
+    nAgg += 1;
+  }
+
+  // Add the remaining nodes to the aggregate of their strongest neighbor.
+  //
+  std::vector<int> agg1 = agg;
+
+  for (int a = 0; a < mynNo; a++) {
+    if (agg[a] != -1) {
+      continue;
+    }
+
+    double smax = 0.0;
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      double s = strength(a,j);
+      if ((s > smax) && (agg1[lhs.colPtr(j)] != -1)) {
+        smax = s;
+        agg[a] = agg1[lhs.colPtr(j)];
+      }
+    }
+  }
+
+  // Aggregate what is left with its free strong neighbors.
+  //
+  for (int a = 0; a < mynNo; a++) {
+    if ((agg[a] != -1) || (dn[a] == 0.0)) {
+      continue;
+    }
+
+    agg[a] = nAgg;
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      int b = lhs.colPtr(j);
+      if ((strength(a,j) > 0.0) && (agg[b] == -1)) {
+        agg[b] = nAgg;
+      }
+    }
+    nAgg += 1;
+  }
+
+  // Nodes without unknowns join any neighboring aggregate.
+  //
+  for (int a = 0; a < mynNo; a++) {
+    if (agg[a] != -1) {
+      continue;
+    }
+
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      int b = lhs.colPtr(j);
+      if ((b < mynNo) && (agg[b] != -1)) {
+        agg[a] = agg[b];
+        break;
+      }
+    }
+
+    if (agg[a] == -1) {
+      agg[a] = nAgg;
+      nAgg += 1;
+    }
+  }
+
+  return nAgg;
+}
+
+/// @brief Add the rows of Q computed by other processes to the rows of 
+/// the shared nodes.
+///
+/// Q(nNo, nc) holds the contributions of the elements of this process,
+/// with columns given by the global IDs cgid. The rows received from 
+/// the other processes are returned as lists of (row, global ID, block).
+//
+void exchange_shared_rows(const FSILS_lhsType& lhs, const int dof, const std::vector<int>& cgid, 
+    const BlockCsr& Q, std::vector<int>& ext_row, std::vector<int>& ext_gid, std::vector<double>& ext_val)
+{
+  int nReq = lhs.nReq;
+  int dd = dof*dof;
+
+  if ((lhs.commu.nTasks == 1) || (nReq == 0)) {
+    return;
+  }
+
+  auto comm = lhs.commu.comm;
+  std::vector<std::vector<int>> sCount(nReq), rCount(nReq);
+  std::vector<std::vector<double>> sBuf(nReq), rBuf(nReq);
+  std::vector<MPI_Request> req(2*nReq);
+
+  for (int i = 0; i < nReq; i++) {
+    auto& cS = lhs.cS[i];
+    sCount[i].resize(cS.n);
+    rCount[i].resize(cS.n);
+
+    for (int m = 0; m < cS.n; m++) {
+      int a = cS.ptr(m);
+      sCount[i][m] = Q.ptr[a+1] - Q.ptr[a];
+
+      for (int e = Q.ptr[a]; e < Q.ptr[a+1]; e++) {
+        sBuf[i].push_back(cgid[Q.col[e]]);
+        sBuf[i].insert(sBuf[i].end(), Q.val.begin() + e*dd, Q.val.begin() + (e+1)*dd);
+      }
+    }
+
+    MPI_Irecv(rCount[i].data(), cS.n, cm_mod::mpint, cS.iP, count_tag, comm, &req[i]);
+    MPI_Isend(sCount[i].data(), cS.n, cm_mod::mpint, cS.iP, count_tag, comm, &req[nReq+i]);
+  }
+
+  MPI_Waitall(2*nReq, req.data(), MPI_STATUSES_IGNORE);
+
+  for (int i = 0; i < nReq; i++) {
+    auto& cS = lhs.cS[i];
+    int n = 0;
+    for (int m = 0; m < cS.n; m++) {
+      n += rCount[i][m];
+    }
+    rBuf[i].resize(n*(dd+1));
+
+    MPI_Irecv(rBuf[i].data(), rBuf[i].size(), cm_mod::mpreal, cS.iP, value_tag, comm, &req[i]);
+    MPI_Isend(sBuf[i].data(), sBuf[i].size(), cm_mod::mpreal, cS.iP, value_tag, comm, &req[nReq+i]);
+  }
+
+  MPI_Waitall(2*nReq, req.data(), MPI_STATUSES_IGNORE);
+
+  for (int i = 0; i < nReq; i++) {
+    auto& cS = lhs.cS[i];
+    const double* buf = rBuf[i].data();
+
+    for (int m = 0; m < cS.n; m++) {
+      for (int e = 0; e < rCount[i][m]; e++) {
+        ext_row.push_back(cS.ptr(m));
+        ext_gid.push_back(lround(buf[0]));
+        ext_val.insert(ext_val.end(), buf + 1, buf + 1 + dd);
+        buf += dd + 1;
+      }
+    }
+  }
+}
+
+/// @brief Create the next coarser level.
+///
+/// Sets the prolongator of the fine level and the lhs and matrix of 
+/// the coarse level. Returns the global number of coarse nodes.
+//
+int coarsen(AmgLevel& lev, AmgLevel& crs, const int dof, const FSILS_amgOptType& opt)
+{
+  auto& lhs = *lev.lhs;
+  const auto& A = *lev.A;
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+  int dd = dof*dof;
+
+  // Aggregate the owned nodes and number the aggregates globally.
+  //
+  std::vector<int> agg;
+  int nAgg = aggregate(lev, dof, opt.theta, agg);
+  int offset = 0;
+  int gnAgg = nAgg;
+
+  if (lhs.commu.nTasks > 1) {
+    MPI_Exscan(&nAgg, &offset, 1, cm_mod::mpint, MPI_SUM, lhs.commu.comm);
+    MPI_Allreduce(&nAgg, &gnAgg, 1, cm_mod::mpint, MPI_SUM, lhs.commu.comm);
+    if (lhs.commu.task == 0) {
+      offset = 0;
+    }
+  }
+
+  // Get the aggregate of nodes owned by other processes.
+  Vector<double> gAgg(nNo);
+  for (int a = 0; a < mynNo; a++) {
+    gAgg(a) = offset + agg[a] + 1;
+  }
+  fsils_commus(lhs, gAgg);
+
+  // Local numbering of the coarse nodes.
+  //
+  std::unordered_map<int,int> gtl;
+  std::vector<int> cgid;
+
+  auto local_id = [&](const int g) -> int 
+  {
+    auto it = gtl.find(g);
+    if (it != gtl.end()) {
+      return it->second;
+    }
+    int n = cgid.size();
+    gtl[g] = n;
+    cgid.push_back(g);
+    return n;
+  };
+
+  std::vector<int> lagg(nNo);
+  for (int a = 0; a < nNo; a++) {
+    lagg[a] = local_id(lround(gAgg(a)) - 1);
+  }
+
+  // Q = A * P_tent for the elements of this process. The tentative 
+  // prolongator is the identity block restricted to unknowns not removed
+  // by Dirichlet conditions.
+  //
+  BlockCsr Q;
+  Q.ptr.resize(nNo+1);
+  std::vector<int> marker(cgid.size(), -1);
+
+  for (int a = 0; a < nNo; a++) {
+    int start = Q.col.size();
+    Q.ptr[a] = start;
+
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      int b = lhs.colPtr(j);
+      int J = lagg[b];
+
+      if (marker[J] < start) {
+        marker[J] = Q.col.size();
+        Q.col.push_back(J);
+        Q.val.resize(Q.val.size() + dd, 0.0);
+      }
+
+      double* q = &Q.val[marker[J]*dd];
+      for (int l = 0; l < dof; l++) {
+        for (int k = 0; k < dof; k++) {
+          if (lev.Dinv(k,b) != 0.0) {
+            q[l*dof+k] += A(l*dof+k,j);
+          }
+        }
+      }
+    }
+  }
+  Q.ptr[nNo] = Q.col.size();
+
+  std::vector<int> ext_row, ext_gid;
+  std::vector<double> ext_val;
+  exchange_shared_rows(lhs, dof, cgid, Q, ext_row, ext_gid, ext_val);
+
+  std::vector<int> ext_ptr(nNo+1, 0);
+  for (int row : ext_row) {
+    ext_ptr[row+1] += 1;
+  }
+  for (int a = 0; a < nNo; a++) {
+    ext_ptr[a+1] += ext_ptr[a];
+  }
+  std::vector<int> ext_idx(ext_row.size()), fill(ext_ptr.begin(), ext_ptr.end()-1);
+  for (int e = 0; e < static_cast<int>(ext_row.size()); e++) {
+    ext_idx[fill[ext_row[e]]++] = e;
+  }
+
+  std::vector<int> ext_col(ext_gid.size());
+  for (size_t e = 0; e < ext_gid.size(); e++) {
+    ext_col[e] = local_id(ext_gid[e]);
+  }
+
+  // Smoothed prolongator P = P_tent - omega Dinv Q.
+  //
+  int nc = cgid.size();
+  double omega = 4.0 / (3.0 * lev.lambda_max);
+  BlockCsr P;
+  P.ptr.resize(nNo+1);
+  marker.assign(nc, -1);
+
+  for (int a = 0; a < nNo; a++) {
+    int start = P.col.size();
+    P.ptr[a] = start;
+
+    auto entry = [&](const int J) -> double* 
+    {
+      if (marker[J] < start) {
+        marker[J] = P.col.size();
+        P.col.push_back(J);
+        P.val.resize(P.val.size() + dd, 0.0);
+      }
+      return &P.val[marker[J]*dd];
+    };
+
+    auto add_q = [&](const int J, const double* q) 
+    {
+      double* p = entry(J);
+      for (int l = 0; l < dof; l++) {
+        for (int k = 0; k < dof; k++) {
+          p[l*dof+k] -= omega * lev.Dinv(l,a) * q[l*dof+k];
+        }
+      }
+    };
+
+    double* p = entry(lagg[a]);
+    for (int k = 0; k < dof; k++) {
+      if (lev.Dinv(k,a) != 0.0) {
+        p[k*dof+k] += 1.0;
+      }
+    }
+
+    for (int e = Q.ptr[a]; e < Q.ptr[a+1]; e++) {
+      add_q(Q.col[e], &Q.val[e*dd]);
+    }
+
+    for (int i = ext_ptr[a]; i < ext_ptr[a+1]; i++) {
+      int e = ext_idx[i];
+      add_q(ext_col[e], &ext_val[e*dd]);
+    }
+  }
+  P.ptr[nNo] = P.col.size();
+
+  // Remove zero blocks and the coarse nodes that are not used.
+  //
+  std::vector<int> new_id(nc, -1);
+  int nnzP = 0;
+  int ncl = 0;
+
+  for (int a = 0; a < nNo; a++) {
+    int start = nnzP;
+    for (int e = P.ptr[a]; e < P.ptr[a+1]; e++) {
+      bool zero = true;
+      for (int i = 0; i < dd; i++) {
+        if (P.val[e*dd+i] != 0.0) {
+          zero = false;
+          break;
+        }
+      }
+      if (zero) {
+        continue;
+      }
+      int J = P.col[e];
+      if (new_id[J] == -1) {
+        new_id[J] = ncl++;
+      }
+      P.col[nnzP] = new_id[J];
+      std::copy(P.val.begin() + e*dd, P.val.begin() + (e+1)*dd, P.val.begin() + nnzP*dd);
+      nnzP += 1;
+    }
+    P.ptr[a] = start;
+  }
+  P.ptr[nNo] = nnzP;
+  P.col.resize(nnzP);
+  P.val.resize(nnzP*dd);
+
+  std::vector<int> cgid_used(ncl);
+  for (int J = 0; J < nc; J++) {
+    if (new_id[J] != -1) {
+      cgid_used[new_id[J]] = cgid[J];
+    }
+  }
+  nc = ncl;
+
+  // AP = A * P
+  //
+  BlockCsr AP;
+  AP.ptr.resize(nNo+1);
+  marker.assign(nc, -1);
+
+  for (int a = 0; a < nNo; a++) {
+    int start = AP.col.size();
+    AP.ptr[a] = start;
+
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      int b = lhs.colPtr(j);
+
+      for (int e = P.ptr[b]; e < P.ptr[b+1]; e++) {
+        int J = P.col[e];
+        if (marker[J] < start) {
+          marker[J] = AP.col.size();
+          AP.col.push_back(J);
+          AP.val.resize(AP.val.size() + dd, 0.0);
+        }
+
+        double* c = &AP.val[marker[J]*dd];
+        const double* p = &P.val[e*dd];
+
+        for (int l = 0; l < dof; l++) {
+          for (int m = 0; m < dof; m++) {
+            double alm = A(l*dof+m,j);
+            for (int k = 0; k < dof; k++) {
+              c[l*dof+k] += alm * p[m*dof+k];
+            }
+          }
+        }
+      }
+    }
+  }
+  AP.ptr[nNo] = AP.col.size();
+
+  // Ac = P^T * AP, using the transpose of P. The diagonal entry 
+  // is added first to each row.
+  //
+  std::vector<int> pt_ptr(nc+1, 0), pt_row(nnzP), pt_idx(nnzP);
+  for (int e = 0; e < nnzP; e++) {
+    pt_ptr[P.col[e]+1] += 1;
+  }
+  for (int J = 0; J < nc; J++) {
+    pt_ptr[J+1] += pt_ptr[J];
+  }
+  fill.assign(pt_ptr.begin(), pt_ptr.end()-1);
+  for (int a = 0; a < nNo; a++) {
+    for (int e = P.ptr[a]; e < P.ptr[a+1]; e++) {
+      int i = fill[P.col[e]]++;
+      pt_row[i] = a;
+      pt_idx[i] = e;
+    }
+  }
+
+  BlockCsr Ac;
+  Ac.ptr.resize(nc+1);
+  marker.assign(nc, -1);
+
+  for (int I = 0; I < nc; I++) {
+    int start = Ac.col.size();
+    Ac.ptr[I] = start;
+    marker[I] = start;
+    Ac.col.push_back(I);
+    Ac.val.resize(Ac.val.size() + dd, 0.0);
+
+    for (int i = pt_ptr[I]; i < pt_ptr[I+1]; i++) {
+      int a = pt_row[i];
+      const double* p = &P.val[pt_idx[i]*dd];
+
+      for (int f = AP.ptr[a]; f < AP.ptr[a+1]; f++) {
+        int J = AP.col[f];
+        if (marker[J] < start) {
+          marker[J] = Ac.col.size();
+          Ac.col.push_back(J);
+          Ac.val.resize(Ac.val.size() + dd, 0.0);
+        }
+
+        double* c = &Ac.val[marker[J]*dd];
+        const double* q = &AP.val[f*dd];
+
+        for (int l = 0; l < dof; l++) {
+          for (int m = 0; m < dof; m++) {
+            double pml = p[m*dof+l];
+            for (int k = 0; k < dof; k++) {
+              c[l*dof+k] += pml * q[m*dof+k];
+            }
+          }
+        }
+      }
+    }
+  }
+  Ac.ptr[nc] = Ac.col.size();
+
+  // Create the coarse lhs and copy the coarse matrix and prolongator.
+  //
+  int nnzc = Ac.col.size();
+  Vector<int> gNodes(nc), rowPtr(nc+1), colPtr(nnzc);
+
+  for (int I = 0; I < nc; I++) {
+    gNodes(I) = cgid_used[I];
+    rowPtr(I) = Ac.ptr[I];
+  }
+  rowPtr(nc) = nnzc;
+
+  for (int e = 0; e < nnzc; e++) {
+    colPtr(e) = Ac.col[e];
+  }
+
+  fsils_lhs_create(crs.coarse_lhs, lhs.commu, gnAgg, nc, nnzc, gNodes, rowPtr, colPtr, 0);
+  crs.lhs = &crs.coarse_lhs;
+
+  crs.coarse_A.resize(dd, nnzc);
+  for (int e = 0; e < nnzc; e++) {
+    for (int i = 0; i < dd; i++) {
+      crs.coarse_A(i,e) = Ac.val[e*dd+i];
+    }
+  }
+  crs.A = &crs.coarse_A;
+
+  crs.gNodes.resize(nc);
+  for (int I = 0; I < nc; I++) {
+    crs.gNodes(crs.coarse_lhs.map(I)) = cgid_used[I];
+  }
+
+  lev.pPtr.resize(nNo+1);
+  lev.pCol.resize(nnzP);
+  lev.pVal.resize(dd, nnzP);
+
+  for (int a = 0; a <= nNo; a++) {
+    lev.pPtr(a) = P.ptr[a];
+  }
+
+  for (int e = 0; e < nnzP; e++) {
+    lev.pCol(e) = crs.coarse_lhs.map(P.col[e]);
+    for (int i = 0; i < dd; i++) {
+      lev.pVal(i,e) = P.val[e*dd+i];
+    }
+  }
+
+  return gnAgg;
+}
+
+/// @brief Assemble the coarsest level matrix on all processes and 
+/// compute its LU factorization with partial pivoting.
+//
+void factor_coarsest(AmgHierarchy& amg)
+{
+  auto& lev = *amg.levels.back();
+  auto& lhs = *lev.lhs;
+  const auto& A = *lev.A;
+  int dof = amg.dof;
+  int n = lhs.gnNo * dof;
+
+  amg.n_direct = n;
+  amg.lu.resize(n,n);
+  amg.piv.resize(n);
+  auto& M = amg.lu;
+
+  for (int a = 0; a < lhs.nNo; a++) {
+    int g = lev.gNodes(a);
+    for (int j = lhs.rowPtr(0,a); j <= lhs.rowPtr(1,a); j++) {
+      int gc = lev.gNodes(lhs.colPtr(j));
+      for (int l = 0; l < dof; l++) {
+        for (int k = 0; k < dof; k++) {
+          M(g*dof+l, gc*dof+k) += A(l*dof+k,j);
+        }
+      }
+    }
+  }
+
+  if (lhs.commu.nTasks > 1) {
+    MPI_Allreduce(MPI_IN_PLACE, M.data(), n*n, cm_mod::mpreal, MPI_SUM, lhs.commu.comm);
+  }
+
+  // Unknowns without coupling, e.g. removed by Dirichlet conditions, 
+  // are given an identity row.
+  //
+  for (int i = 0; i < n; i++) {
+    bool zero = true;
+    for (int j = 0; j < n; j++) {
+      if (M(i,j) != 0.0) {
+        zero = false;
+        break;
+      }
+    }
+    if (zero) {
+      M(i,i) = 1.0;
+    }
+  }
+
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    for (int i = k+1; i < n; i++) {
+      if (fabs(M(i,k)) > fabs(M(p,k))) {
+        p = i;
+      }
+    }
+
+    amg.piv(k) = p;
+    if (p != k) {
+      for (int j = 0; j < n; j++) {
+        std::swap(M(k,j), M(p,j));
+      }
+    }
+
+    if (M(k,k) == 0.0) {
+      M(k,k) = 1.0;
+    }
+
+    for (int i = k+1; i < n; i++) {
+      M(i,k) = M(i,k) / M(k,k);
+    }
+
+    for (int j = k+1; j < n; j++) {
+      double mkj = M(k,j);
+      if (mkj == 0.0) {
+        continue;
+      }
+      for (int i = k+1; i < n; i++) {
+        M(i,j) -= M(i,k) * mkj;
+      }
+    }
+  }
+}
+
+/// @brief Solve the coarsest level system with the LU factors.
+//
+void solve_coarsest(AmgHierarchy& amg, const Array<double>& b, Array<double>& x)
+{
+  auto& lev = *amg.levels.back();
+  auto& lhs = *lev.lhs;
+  const auto& M = amg.lu;
+  int dof = amg.dof;
+  int n = amg.n_direct;
+  Vector<double> y(n);
+
+  for (int a = 0; a < lhs.mynNo; a++) {
+    int g = lev.gNodes(a);
+    for (int k = 0; k < dof; k++) {
+      y(g*dof+k) = b(k,a);
+    }
+  }
+
+  if (lhs.commu.nTasks > 1) {
+    MPI_Allreduce(MPI_IN_PLACE, y.data(), n, cm_mod::mpreal, MPI_SUM, lhs.commu.comm);
+  }
+
+  for (int k = 0; k < n; k++) {
+    std::swap(y(k), y(amg.piv(k)));
+  }
+
+  for (int j = 0; j < n; j++) {
+    for (int i = j+1; i < n; i++) {
+      y(i) -= M(i,j) * y(j);
+    }
+  }
+
+  for (int j = n-1; j >= 0; j--) {
+    y(j) = y(j) / M(j,j);
+    for (int i = 0; i < j; i++) {
+      y(i) -= M(i,j) * y(j);
+    }
+  }
+
+  for (int a = 0; a < lhs.nNo; a++) {
+    int g = lev.gNodes(a);
+    for (int k = 0; k < dof; k++) {
+      x(k,a) = y(g*dof+k);
+    }
+  }
+}
+
+/// @brief Apply sweeps of the smoother to A x = b.
+///
+/// If zero_guess is true x is assumed to be zero on entry.
+//
+void smooth(AmgHierarchy& amg, AmgLevel& lev, const Array<double>& b, Array<double>& x, 
+    const int sweeps, const bool zero_guess)
+{
+  auto& lhs = *lev.lhs;
+  const auto& A = *lev.A;
+  int dof = amg.dof;
+  auto& r = lev.r;
+  auto& d = lev.d;
+  auto& t = lev.t;
+
+  auto residual = [&]() -> void 
+  {
+    spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, A, x, r);
+    for (int i = 0; i < r.size(); i++) {
+      r(i) = b(i) - r(i);
+    }
+  };
+
+  if (amg.opt.smoother == AmgSmootherType::AMG_SMOOTHER_JACOBI) {
+    double omega = 4.0 / (3.0 * lev.lambda_max);
+
+    for (int s = 0; s < sweeps; s++) {
+      if (zero_guess && (s == 0)) {
+        r = b;
+      } else {
+        residual();
+      }
+      for (int i = 0; i < x.size(); i++) {
+        x(i) += omega * lev.Dinv(i) * r(i);
+      }
+    }
+    return;
+  }
+
+  // Chebyshev polynomial of Dinv*A on [upper/30, upper].
+  //
+  double upper = 1.1 * lev.lambda_max;
+  double lower = upper / 30.0;
+  double theta = 0.5 * (upper + lower);
+  double delta = 0.5 * (upper - lower);
+  double sigma = theta / delta;
+  double rho = 1.0 / sigma;
+
+  if (zero_guess) {
+    r = b;
+  } else {
+    residual();
+  }
+
+  for (int i = 0; i < d.size(); i++) {
+    d(i) = lev.Dinv(i) * r(i) / theta;
+  }
+
+  for (int s = 0; s < sweeps; s++) {
+    for (int i = 0; i < x.size(); i++) {
+      x(i) += d(i);
+    }
+
+    if (s == sweeps-1) {
+      break;
+    }
+
+    spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, A, d, t);
+
+    double rho_new = 1.0 / (2.0*sigma - rho);
+    double c1 = rho_new * rho;
+    double c2 = 2.0 * rho_new / delta;
+
+    for (int i = 0; i < r.size(); i++) {
+      r(i) -= t(i);
+      d(i) = c1*d(i) + c2*lev.Dinv(i)*r(i);
+    }
+    rho = rho_new;
+  }
+}
+
+/// @brief V-cycle on level l for A x = b, with a zero initial guess. 
+//
+void vcycle(AmgHierarchy& amg, const int l, const Array<double>& b, Array<double>& x)
+{
+  auto& lev = *amg.levels[l];
+  int dof = amg.dof;
+
+  if (l == static_cast<int>(amg.levels.size())-1) {
+    if (amg.n_direct != 0) {
+      solve_coarsest(amg, b, x);
+    } else {
+      x = 0.0;
+      smooth(amg, lev, b, x, num_coarse_sweeps, true);
+    }
+    return;
+  }
+
+  auto& lhs = *lev.lhs;
+  auto& crs = *amg.levels[l+1];
+  auto& r = lev.r;
+
+  x = 0.0;
+  smooth(amg, lev, b, x, amg.opt.sweeps, true);
+
+  spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, *lev.A, x, r);
+  for (int i = 0; i < r.size(); i++) {
+    r(i) = b(i) - r(i);
+  }
+
+  // Restrict the residual, b_c = P^T r, summing over owned rows.
+  //
+  crs.b = 0.0;
+  for (int a = 0; a < lhs.mynNo; a++) {
+    for (int e = lev.pPtr(a); e < lev.pPtr(a+1); e++) {
+      int c = lev.pCol(e);
+      for (int m = 0; m < dof; m++) {
+        double rm = r(m,a);
+        for (int k = 0; k < dof; k++) {
+          crs.b(k,c) += lev.pVal(m*dof+k,e) * rm;
+        }
+      }
+    }
+  }
+  fsils_commuv(*crs.lhs, dof, crs.b);
+
+  vcycle(amg, l+1, crs.b, crs.x);
+
+  // Prolongate the correction, x = x + P x_c.
+  //
+  for (int a = 0; a < lhs.nNo; a++) {
+    for (int e = lev.pPtr(a); e < lev.pPtr(a+1); e++) {
+      int c = lev.pCol(e);
+      for (int m = 0; m < dof; m++) {
+        for (int k = 0; k < dof; k++) {
+          x(m,a) += lev.pVal(m*dof+k,e) * crs.x(k,c);
+        }
+      }
+    }
+  }
+
+  smooth(amg, lev, b, x, amg.opt.sweeps, false);
+}
+
+};
+
+AmgHierarchy::~AmgHierarchy()
+{
+  amg_free(*this);
+}
+
+/// @brief Build the multigrid hierarchy for the matrix Val(dof*dof,nnz).
+///
+/// Val is referenced by the finest level and must not be changed 
+/// while the hierarchy is used.
+//
+void amg_setup(FSILS_lhsType& lhs, const FSILS_amgOptType& opt, const int dof, const Array<double>& Val, 
+    AmgHierarchy& amg)
+{
+  SV_PROFILE_REGION("amg_setup");
+
+  #define n_debug_amg_setup
+  #ifdef debug_amg_setup
+  DebugMsg dmsg(__func__,  lhs.commu.task);
+  dmsg.banner();
+  #endif
+
+  amg_free(amg);
+  amg.dof = dof;
+  amg.opt = opt;
+
+  auto fine = std::make_unique<AmgLevel>();
+  fine->lhs = &lhs;
+  fine->A = &Val;
+  amg.levels.push_back(std::move(fine));
+
+  while (true) {
+    auto& lev = *amg.levels.back();
+    set_diagonal(lev, dof);
+    estimate_lambda_max(lev, dof);
+
+    int gnNo = lev.lhs->gnNo;
+    #ifdef debug_amg_setup
+    dmsg << "level: " << amg.levels.size()-1;
+    dmsg << "gnNo: " << gnNo;
+    dmsg << "lambda_max: " << lev.lambda_max;
+    #endif
+
+    if ((gnNo*dof <= opt.coarse_size) || (static_cast<int>(amg.levels.size()) >= opt.max_levels)) {
+      break;
+    }
+
+    auto crs = std::make_unique<AmgLevel>();
+    int gnc = coarsen(lev, *crs, dof, opt);
+
+    // Stop if the aggregation does not reduce the number of nodes.
+    if (gnc >= gnNo) {
+      fsils_lhs_free(crs->coarse_lhs);
+      lev.pPtr.clear();
+      lev.pCol.clear();
+      lev.pVal.clear();
+      break;
+    }
+
+    amg.levels.push_back(std::move(crs));
+  }
+
+  auto& coarsest = *amg.levels.back();
+
+  if ((amg.levels.size() > 1) && (coarsest.lhs->gnNo*dof <= opt.coarse_size)) {
+    factor_coarsest(amg);
+  }
+}
+
+/// @brief Apply one V-cycle, X = M^-1 R.
+//
+void amg_apply(AmgHierarchy& amg, const Array<double>& R, Array<double>& X)
+{
+  SV_PROFILE_REGION("amg_apply");
+
+  vcycle(amg, 0, R, X);
+}
+
+/// @brief Free the coarse levels.
+//
+void amg_free(AmgHierarchy& amg)
+{
+  for (size_t l = 1; l < amg.levels.size(); l++) {
+    fsils_lhs_free(amg.levels[l]->coarse_lhs);
+  }
+
+  amg.levels.clear();
+  amg.n_direct = 0;
+}
+
+};
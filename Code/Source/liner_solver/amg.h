@@ -0,0 +1,122 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FSI_LINEAR_SOLVER_AMG_H 
+#define FSI_LINEAR_SOLVER_AMG_H 
+
+#include "fils_struct.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace amg {
+
+using namespace fsi_linear_solver;
+
+/// @brief One level of the smoothed aggregation multigrid hierarchy.
+///
+/// The finest level uses the lhs and matrix of the system being solved.
+/// A coarse level owns an lhs created with fsils_lhs_create() for its
+/// coarse nodes, so vectors on every level are distributed and
+/// communicated like the vectors of the fine system.
+//
+class AmgLevel
+{
+  public:
+    /// The lhs of this level                              (USE)
+    FSILS_lhsType* lhs = nullptr;
+
+    /// The matrix of this level (dof*dof,nnz)             (USE)
+    const Array<double>* A = nullptr;
+
+    /// Storage for the lhs and matrix of a coarse level   (USE)
+    FSILS_lhsType coarse_lhs;
+    Array<double> coarse_A;
+
+    /// Global node IDs of a coarse level in lhs ordering  (USE)
+    Vector<int> gNodes;
+
+    /// Inverse of the point diagonal, zero for unknowns
+    /// removed by Dirichlet conditions (dof,nNo)          (USE)
+    Array<double> Dinv;
+
+    /// Estimate of the largest eigenvalue of Dinv*A       (USE)
+    double lambda_max = 0.0;
+
+    /// Prolongator from the next coarser level, a block 
+    /// CSR matrix with pPtr(nNo+1), pCol(nnzP) and 
+    /// pVal(dof*dof,nnzP)                                 (USE)
+    Vector<int> pPtr;
+    Vector<int> pCol;
+    Array<double> pVal;
+
+    /// Right hand side and solution of the coarse 
+    /// correction on this level (dof,nNo)                 (TMP)
+    Array<double> b, x;
+
+    /// Work vectors of the smoother (dof,nNo)             (TMP)
+    Array<double> r, d, t;
+};
+
+/// @brief Smoothed aggregation multigrid hierarchy used as a 
+/// preconditioner by pcgrad_v(), pschur() and fgmres_v().
+//
+class AmgHierarchy
+{
+  public:
+    AmgHierarchy() = default;
+    AmgHierarchy(const AmgHierarchy&) = delete;
+    AmgHierarchy& operator=(const AmgHierarchy&) = delete;
+    ~AmgHierarchy();
+
+    /// Degrees of freedom per node
+    int dof = 0;
+
+    FSILS_amgOptType opt;
+
+    std::vector<std::unique_ptr<AmgLevel>> levels;
+
+    /// LU factors of the coarsest level matrix, gathered on 
+    /// all processes, if it is solved directly
+    int n_direct = 0;
+    Array<double> lu;
+    Vector<int> piv;
+};
+
+void amg_setup(FSILS_lhsType& lhs, const FSILS_amgOptType& opt, const int dof, const Array<double>& Val, 
+    AmgHierarchy& amg);
+
+void amg_apply(AmgHierarchy& amg, const Array<double>& R, Array<double>& X);
+
+void amg_free(AmgHierarchy& amg);
+
+};
+
+#endif
@@ -57,6 +57,26 @@ void fsils_bcast_v(const int n, Vector<double>& u, FSILS_commuType& commu)
   } 
 }
 
+/// @brief Start a nonblocking sum of u(0:n-1) over all processors.
+///
+/// u must not be accessed until fsils_bcast_v_end() is called. 
+//
+void fsils_bcast_v_begin(const int n, Vector<double>& u, FSILS_commuType& commu, MPI_Request& req)
+{
+  req = MPI_REQUEST_NULL;
+
+  if (commu.nTasks > 1) { 
+    MPI_Iallreduce(MPI_IN_PLACE, u.data(), n, cm_mod::mpreal, MPI_SUM, commu.comm, &req);
+  } 
+}
+
+/// @brief Complete a sum started by fsils_bcast_v_begin().
+//
+void fsils_bcast_v_end(MPI_Request& req)
+{
+  MPI_Wait(&req, MPI_STATUS_IGNORE);
+}
+
 };
 
 
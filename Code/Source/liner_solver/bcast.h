@@ -38,4 +38,8 @@ void fsils_bcast(double& u, FSILS_commuType& commu);
 
 void fsils_bcast_v(const int n, Vector<double>& u, FSILS_commuType& commu);
 
+void fsils_bcast_v_begin(const int n, Vector<double>& u, FSILS_commuType& commu, MPI_Request& req);
+
+void fsils_bcast_v_end(MPI_Request& req);
+
 };
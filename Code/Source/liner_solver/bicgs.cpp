@@ -40,6 +40,7 @@
 #include "spar_mul.h"
 
 #include "Array3.h"
+#include "Profiler.h"
 
 #include <math.h>
 
@@ -49,6 +50,8 @@ namespace bicgs {
 void bicgsv (fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof, 
     const Array<double>& K, Array<double>& R)
 {
+  SV_PROFILE_REGION("bicgsv");
+
   #define n_debug_bicgsv
   #ifdef debug_bicgsv
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -101,19 +104,23 @@ void bicgsv (fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
 
     spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, K, P, V);
     double alpha = rho / dot::fsils_dot_v(dof, mynNo, lhs.commu, Rh, V);
-    S = R - alpha*V;
+    S = R;
+    omp_la::omp_sum_v(dof, nNo, -alpha, S, V);
 
     spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, K, S, T);
-    double omega = norm::fsi_ls_normv(dof, mynNo, lhs.commu, T);
-    omega = dot::fsils_dot_v(dof, mynNo, lhs.commu, T, S) / (omega * omega);
+    double tt, ts;
+    dot::fsils_dot2_v(dof, mynNo, lhs.commu, T, T, T, S, tt, ts);
+    double omega = ts / tt;
 
-    X = X + alpha*P + omega*S;
-    R = S - omega*T;
+    omp_la::omp_sum_v(dof, nNo, alpha, X, P);
+    omp_la::omp_sum_v(dof, nNo, omega, X, S);
+    R = S;
+    omp_la::omp_sum_v(dof, nNo, -omega, R, T);
 
     errO = err;
-    err =  norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
     double rhoO  = rho;
-    rho = dot::fsils_dot_v(dof, mynNo, lhs.commu, R, Rh);
+    dot::fsils_dot2_v(dof, mynNo, lhs.commu, R, R, R, Rh, err, rho);
+    err = sqrt(err);
     beta = rho*alpha / (rhoO*omega);
 
     #ifdef debug_bicgsv
@@ -123,7 +130,8 @@ void bicgsv (fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
     dmsg << "beta: " << beta;
     #endif
 
-    P = R + beta * (P - omega*V);
+    omp_la::omp_sum_v(dof, nNo, -omega, P, V);
+    omp_la::omp_axpby_v(dof, nNo, beta, P, 1.0, R);
     i_itr += 1;
   } 
 
@@ -149,6 +157,8 @@ void bicgsv (fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
 //
 void bicgss(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const Vector<double>& K, Vector<double>& R)
 {
+  SV_PROFILE_REGION("bicgss");
+
   #define n_debug_bicgss
   #ifdef debug_bicgss
   DebugMsg dmsg(__func__,  lhs.commu.task);
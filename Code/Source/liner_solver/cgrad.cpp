@@ -30,9 +30,12 @@
 
 #include "cgrad.h"
 #include "DebugMsg.h"
+#include "Profiler.h"
 
 #include "fsils_api.hpp"
 #include "add_bc_mul.h"
+#include "amg.h"
+#include "bcast.h"
 #include "dot.h"
 #include "omp_la.h"
 #include "norm.h"
@@ -50,6 +53,8 @@ namespace cgrad {
 void schur(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& D, 
     const Array<double>& G, const Vector<double>& L, Vector<double>& R)
 {
+  SV_PROFILE_REGION("schur");
+
   #define n_debug_schur
   #ifdef debug_schur
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -165,6 +170,8 @@ void schur(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<d
 //
 void cgrad_v(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& K, Array<double>& R)
 {
+  SV_PROFILE_REGION("cgrad_v");
+
   #define n_debug_cgrad_v 
   #ifdef debug_cgrad_v
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -218,13 +225,12 @@ void cgrad_v(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array
 
     double alpha = errO / dot::fsils_dot_v(dof, mynNo, lhs.commu, P, KP);
     omp_la::omp_sum_v(dof, nNo, alpha, X, P);
-    omp_la::omp_sum_v(dof, nNo, -alpha, R, KP);
 
-    err = norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
-    err = err * err;
+    // R = R - alpha*KP and err = |R|^2 in one pass.
+    err = omp_la::omp_sum_nrm_v(dof, nNo, mynNo, -alpha, R, KP);
+    bcast::fsils_bcast(err, lhs.commu);
 
-    omp_la::omp_sum_v(dof, nNo, errO/err, P, R);
-    omp_la::omp_mul_v(dof, nNo, err/errO, P);
+    omp_la::omp_axpby_v(dof, nNo, err/errO, P, 1.0, R);
   }
 
   R = X;
@@ -251,6 +257,8 @@ void cgrad_v(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array
 //
 void cgrad_s(FSILS_lhsType& lhs, FSILS_subLsType& ls, const Vector<double>& K, Vector<double>& R)
 {
+  SV_PROFILE_REGION("cgrad_s");
+
   #define n_debug_cgrad_s 
   #ifdef debug_cgrad_s
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -330,6 +338,182 @@ void cgrad_s(FSILS_lhsType& lhs, FSILS_subLsType& ls, const Vector<double>& K, V
   #endif
 }
 
+//----------
+// pcgrad_v
+//----------
+// Conjugate-gradient algorithm preconditioned with the AMG hierarchy M.
+// A scalar problem is solved as a vector problem with dof = 1.
+//
+void pcgrad_v(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& K, 
+    amg::AmgHierarchy& M, Array<double>& R)
+{
+  SV_PROFILE_REGION("pcgrad_v");
+
+  #define n_debug_pcgrad_v 
+  #ifdef debug_pcgrad_v
+  DebugMsg dmsg(__func__,  lhs.commu.task);
+  dmsg.banner();
+  #endif
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+
+  Array<double> P(dof,nNo), KP(dof,nNo), X(dof,nNo), Z(dof,nNo);
+
+  ls.callD = fsi_linear_solver::fsils_cpu_t();
+  ls.suc = false;
+  ls.iNorm = norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
+  double eps = std::max(ls.absTol, ls.relTol*ls.iNorm);
+  double errO = ls.iNorm;
+  double err = errO;
+  X = 0.0;
+
+  amg::amg_apply(M, R, Z);
+  P = Z;
+  double rz = dot::fsils_dot_v(dof, mynNo, lhs.commu, R, Z);
+  int last_i = 0;
+
+  for (int i = 0; i < ls.mItr; i++) {
+    #ifdef debug_pcgrad_v
+    dmsg << "----- i " << i+1 << " -----";
+    dmsg << "err: " << err;
+    #endif
+    last_i = i;
+
+    if (err < eps) {
+      ls.suc = true;
+      break;
+    }
+
+    errO = err;
+
+    spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, K, P, KP);
+
+    double alpha = rz / dot::fsils_dot_v(dof, mynNo, lhs.commu, P, KP);
+    omp_la::omp_sum_v(dof, nNo, alpha, X, P);
+    omp_la::omp_sum_v(dof, nNo, -alpha, R, KP);
+
+    err = norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
+
+    amg::amg_apply(M, R, Z);
+    double rz_new = dot::fsils_dot_v(dof, mynNo, lhs.commu, R, Z);
+
+    // P = Z + (rz_new/rz) * P
+    omp_la::omp_mul_v(dof, nNo, rz_new/rz, P);
+    omp_la::omp_sum_v(dof, nNo, 1.0, P, Z);
+    rz = rz_new;
+  }
+
+  R = X;
+  ls.itr = last_i;
+  ls.fNorm = err;
+  ls.callD = fsi_linear_solver::fsils_cpu_t() - ls.callD;
+
+  if (errO < std::numeric_limits<double>::epsilon()) {
+    ls.dB = 0.0;
+  } else {
+    ls.dB = 10.0 * log(err/errO);
+  }
+}
+
+//--------
+// pschur
+//--------
+// Conjugate-gradient algorithm for the Schur complement S = L - D*G of
+// schur(), preconditioned with an AMG hierarchy M built for an 
+// approximation of S.
+//
+void pschur(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& D, 
+    const Array<double>& G, const Vector<double>& L, amg::AmgHierarchy& M, Vector<double>& R)
+{
+  SV_PROFILE_REGION("pschur");
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+
+  Vector<double> X(nNo), P(nNo), SP(nNo), DGP(nNo);
+  Array<double> GP(dof,nNo), Ra(1,nNo), Za(1,nNo);
+
+  double time = fsi_linear_solver::fsils_cpu_t();
+  ls.suc = false;
+  ls.iNorm = norm::fsi_ls_norms(mynNo, lhs.commu, R);
+  double eps = std::max(ls.absTol, ls.relTol*ls.iNorm);
+  double errO = ls.iNorm;
+  double err = errO;
+
+  // Z = M^-1 R for the scalar vectors.
+  //
+  auto precond = [&](const Vector<double>& U, Vector<double>& Z) -> void 
+  {
+    for (int a = 0; a < nNo; a++) {
+      Ra(0,a) = U(a);
+    }
+    amg::amg_apply(M, Ra, Za);
+    for (int a = 0; a < nNo; a++) {
+      Z(a) = Za(0,a);
+    }
+  };
+
+  Vector<double> Z(nNo);
+  X = 0.0;
+  precond(R, Z);
+  P = Z;
+  double rz = dot::fsils_dot_s(mynNo, lhs.commu, R, Z);
+  int last_i = 0;
+
+  for (int i = 0; i < ls.mItr; i++) {
+    last_i = i;
+
+    if (err < eps) {
+      ls.suc = true;
+      break;
+    }
+
+    errO = err;
+
+    // SP = L*P - D*G*P
+    //
+    spar_mul::fsils_spar_mul_sv(lhs, lhs.rowPtr, lhs.colPtr, dof, G, P, GP);
+
+    for (auto& face : lhs.face) {
+      if (face.coupledFlag) {
+        auto unCondU = GP;
+        add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_PRE, dof, unCondU, GP);
+        break;
+      }
+    }
+
+    spar_mul::fsils_spar_mul_vs(lhs, lhs.rowPtr, lhs.colPtr, dof, D, GP, DGP);
+    spar_mul::fsils_spar_mul_ss(lhs, lhs.rowPtr, lhs.colPtr, L, P, SP);
+    omp_la::omp_sum_s(nNo, -1.0, SP, DGP);
+
+    double alpha = rz / dot::fsils_dot_s(mynNo, lhs.commu, P, SP);
+    omp_la::omp_sum_s(nNo, alpha, X, P);
+    omp_la::omp_sum_s(nNo, -alpha, R, SP);
+
+    err = norm::fsi_ls_norms(mynNo, lhs.commu, R);
+
+    precond(R, Z);
+    double rz_new = dot::fsils_dot_s(mynNo, lhs.commu, R, Z);
+
+    // P = Z + (rz_new/rz) * P
+    omp_la::omp_mul_s(nNo, rz_new/rz, P);
+    omp_la::omp_sum_s(nNo, 1.0, P, Z);
+    rz = rz_new;
+  }
+
+  R = X;
+  ls.fNorm = err;
+  ls.callD = fsi_linear_solver::fsils_cpu_t() - time + ls.callD;
+  ls.itr = ls.itr + last_i;
+
+  if (errO < std::numeric_limits<double>::epsilon()) {
+    ls.dB = 0.0;
+  } else {
+    ls.dB = 10.0 * log(err/errO);
+  }
+}
+
 };
 
 
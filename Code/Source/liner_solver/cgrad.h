@@ -29,6 +29,7 @@
  */
 
 #include "fils_struct.hpp"
+#include "amg.h"
 
 namespace cgrad {
 
@@ -41,4 +42,10 @@ void cgrad_s(FSILS_lhsType& lhs, FSILS_subLsType& ls, const Vector<double>& K, V
 void schur(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& D,
     const Array<double>& G, const Vector<double>& L, Vector<double>& R);
 
+void pcgrad_v(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& K, 
+    amg::AmgHierarchy& M, Array<double>& R);
+
+void pschur(FSILS_lhsType& lhs, FSILS_subLsType& ls, const int dof, const Array<double>& D, 
+    const Array<double>& G, const Vector<double>& L, amg::AmgHierarchy& M, Vector<double>& R);
+
 };
@@ -40,18 +40,56 @@
 #include "dot.h"
 
 #include "fils_struct.hpp"
+#include "omp_la.h"
+#include "Profiler.h"
+
+#include <algorithm>
 
 namespace dot {
 
+/// @brief Local dot product of the first dof rows of the nNo columns 
+/// of U and V.
+//
+static double nc_dot(const int dof, const int nNo, const Array<double>& U, const Array<double>& V)
+{
+  const double* u = U.data();
+  const double* v = V.data();
+  const int ldu = U.nrows();
+  const int ldv = V.nrows();
+  double result = 0.0;
+
+  if ((ldu == dof) && (ldv == dof)) {
+    omp_la::omp_reduce(dof*nNo, 1, &result, [&](const int begin, const int end, double* s) {
+      double sum = 0.0;
+      #pragma omp simd reduction(+:sum)
+      for (int i = begin; i < end; i++) {
+        sum += u[i]*v[i];
+      }
+      s[0] += sum;
+    });
+
+  } else {
+    omp_la::omp_reduce(nNo, 1, &result, [&](const int begin, const int end, double* s) {
+      double sum = 0.0;
+      for (int i = begin; i < end; i++) {
+        for (int j = 0; j < dof; j++) {
+          sum += u[i*ldu+j]*v[i*ldv+j];
+        }
+      }
+      s[0] += sum;
+    });
+  }
+
+  return result;
+}
+
 /// @brief Reproduces 'FUNCTION FSILS_DOTS(nNo, commu, U, V)'. 
 //
 double fsils_dot_s(const int nNo, FSILS_commuType& commu, const Vector<double>& U, const Vector<double>& V)
 {
-  double result = 0.0; 
+  SV_PROFILE_REGION("fsils_dot_s");
 
-  for (int i = 0; i < nNo; i++) {
-    result = result + U(i)*V(i);
-  }
+  double result = fsils_nc_dot_s(nNo, U, V);
 
   if (commu.nTasks == 1) {
     return result;
@@ -68,42 +106,9 @@ double fsils_dot_s(const int nNo, FSILS_commuType& commu, const Vector<double>&
 //
 double fsils_dot_v(const int dof, const int nNo, FSILS_commuType& commu, const Array<double>& U, const Array<double>& V)
 {
-  double result = 0.0; 
-
-  switch (dof) {
-    case 1:
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*V(0,i);
-      }
-    break;
+  SV_PROFILE_REGION("fsils_dot_v");
 
-    case 2:
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*V(0,i) + U(1,i)*V(1,i);
-      }
-    break;
-
-    case 3:
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*V(0,i) + U(1,i)*V(1,i) +  U(2,i)*V(2,i);
-      }
-    break;
-
-    case 4:
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*V(0,i) + U(1,i)*V(1,i) + U(2,i)*V(2,i) + U(3,i)*V(3,i);
-      }
-    break;
-
-    defualt: 
-      for (int i = 0; i < nNo; i++) {
-        double sum{0.0};
-        for (int j = 0; j < U.nrows(); j++) {
-          sum += U(j,i) * V(j,i);
-        }
-        result = result + sum; 
-      }
-  }
+  double result = nc_dot(dof, nNo, U, V);
 
   if (commu.nTasks == 1) {
     return result;
@@ -116,15 +121,43 @@ double fsils_dot_v(const int dof, const int nNo, FSILS_commuType& commu, const A
   return tmp;
 }
 
+/// @brief The two dot products <U1,V1> and <U2,V2> computed with a 
+/// single global reduction.
+//
+void fsils_dot2_v(const int dof, const int nNo, FSILS_commuType& commu, const Array<double>& U1, 
+    const Array<double>& V1, const Array<double>& U2, const Array<double>& V2, double& r1, double& r2)
+{
+  SV_PROFILE_REGION("fsils_dot2_v");
+
+  double result[2] = {nc_dot(dof, nNo, U1, V1), nc_dot(dof, nNo, U2, V2)};
+
+  if (commu.nTasks != 1) {
+    double tmp[2];
+    MPI_Allreduce(result, tmp, 2, cm_mod::mpreal, MPI_SUM, commu.comm);
+    result[0] = tmp[0];
+    result[1] = tmp[1];
+  }
+
+  r1 = result[0];
+  r2 = result[1];
+}
+
 /// @brief Reproduces Fortran 'FSILS_NCDOTS(nNo, , U, V)'.
 //
 double fsils_nc_dot_s(const int nNo, const Vector<double>& U, const Vector<double>& V)
 {
+  const double* u = U.data();
+  const double* v = V.data();
   double result{0.0};
 
-  for (int i = 0; i < nNo; i++) { 
-    result = result + U(i)*V(i);
-  } 
+  omp_la::omp_reduce(nNo, 1, &result, [&](const int begin, const int end, double* s) {
+    double sum = 0.0;
+    #pragma omp simd reduction(+:sum)
+    for (int i = begin; i < end; i++) {
+      sum += u[i]*v[i];
+    }
+    s[0] += sum;
+  });
 
   return result;
 }
@@ -133,43 +166,59 @@ double fsils_nc_dot_s(const int nNo, const Vector<double>& U, const Vector<doubl
 //
 double fsils_nc_dot_v(const int dof, const int nNo, const Array<double>& U, const Array<double>& V)
 {
-  double result = 0.0;
-
-  switch (dof) {
-    case 1: {
-      for (int i = 0; i < nNo; i++) { 
-        result = result + U(0,i)*V(0,i);
-      }
-    } break;
+  return nc_dot(dof, nNo, U, V);
+}
 
-    case 2: {
-      for (int i = 0; i < nNo; i++) { 
-        result = result + U(0,i)*V(0,i) + U(1,i)*V(1,i);
-      }
-    } break;
+/// @brief The local dot products result(j) = <U(:,:,j),V>, j = 0,...,n-1, 
+/// computed in a single pass over V.
+//
+void fsils_nc_mdot_v(const int dof, const int nNo, const int n, const Array3<double>& U, const Array<double>& V, 
+    Vector<double>& result)
+{
+  if ((U.nrows() != dof) || (V.nrows() != dof)) {
+    for (int j = 0; j < n; j++) {
+      result(j) = nc_dot(dof, nNo, U.rslice(j), V);
+    }
+    return;
+  }
 
-    case 3: {
-      for (int i = 0; i < nNo; i++) { 
-        result = result + U(0,i)*V(0,i) + U(1,i)*V(1,i) + U(2,i)*V(2,i);
+  const double* u = U.data();
+  const double* v = V.data();
+  const long long ls = (long long)U.nrows() * U.ncols();
+
+  // Blocks of V stay in cache while the n products are computed.
+  //
+  const int nb = 1024;
+
+  omp_la::omp_reduce(dof*nNo, n, result.data(), [&](const int begin, const int end, double* s) {
+    for (int b = begin; b < end; b += nb) {
+      const int e = std::min(b + nb, end);
+      for (int j = 0; j < n; j++) {
+        const double* uj = u + j*ls;
+        double sum = 0.0;
+        #pragma omp simd reduction(+:sum)
+        for (int i = b; i < e; i++) {
+          sum += uj[i]*v[i];
+        }
+        s[j] += sum;
       }
-    } break;
+    }
+  });
+}
 
-    case 4: {
-      for (int i = 0; i < nNo; i++) { 
-        result = result + U(0,i)*V(0,i) + U(1,i)*V(1,i) +  U(2,i)*V(2,i) + U(3,i)*V(3,i);
-      }
-    } break;
+/// @brief The dot products result(j) = <U(:,:,j),V>, j = 0,...,n-1, 
+/// computed with a single global reduction.
+//
+void fsils_mdot_v(const int dof, const int nNo, FSILS_commuType& commu, const int n, const Array3<double>& U, 
+    const Array<double>& V, Vector<double>& result)
+{
+  SV_PROFILE_REGION("fsils_mdot_v");
 
-    default: {
-      for (int i = 0; i < nNo; i++) { 
-        result = result + U.col(i) * V.col(i);
-      }
-    } break;
-  } 
+  fsils_nc_mdot_v(dof, nNo, n, U, V, result);
 
-  return result;
+  if (commu.nTasks != 1) {
+    MPI_Allreduce(MPI_IN_PLACE, result.data(), n, cm_mod::mpreal, MPI_SUM, commu.comm);
+  }
 }
 
 };
-
-
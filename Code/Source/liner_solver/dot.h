@@ -30,6 +30,8 @@
 
 #include "fils_struct.hpp"
 
+#include "Array3.h"
+
 namespace dot {
 
 using namespace fsi_linear_solver;
@@ -42,4 +44,13 @@ double fsils_nc_dot_s(const int nNo, const Vector<double>& U, const Vector<doubl
 
 double fsils_nc_dot_v(const int dof, const int nNo, const Array<double>& U, const Array<double>& V);
 
+void fsils_dot2_v(const int dof, const int nNo, FSILS_commuType& commu, const Array<double>& U1, 
+    const Array<double>& V1, const Array<double>& U2, const Array<double>& V2, double& r1, double& r2);
+
+void fsils_nc_mdot_v(const int dof, const int nNo, const int n, const Array3<double>& U, const Array<double>& V, 
+    Vector<double>& result);
+
+void fsils_mdot_v(const int dof, const int nNo, FSILS_commuType& commu, const int n, const Array3<double>& U, 
+    const Array<double>& V, Vector<double>& result);
+
 };
@@ -35,7 +35,17 @@
 
 #include "mpi.h"
 
+#include <functional>
 #include <map>
+#include <memory>
+
+namespace ilu {
+  class IluFactor;
+};
+
+namespace recycle {
+  class RecycleSpace;
+};
 
 /// SELECTED_REAL_KIND(P,R) returns the kind value of a real data type with 
 ///
@@ -72,7 +82,21 @@ enum LinearSolverType
   LS_TYPE_CG = 798,
   LS_TYPE_GMRES = 797, 
   LS_TYPE_NS = 796, 
-  LS_TYPE_BICGS = 795
+  LS_TYPE_BICGS = 795,
+  LS_TYPE_PGMRES = 794
+};
+
+enum class AmgSmootherType
+{
+  AMG_SMOOTHER_JACOBI = 0,
+  AMG_SMOOTHER_CHEBYSHEV = 1
+};
+
+enum class ForcingTermType
+{
+  FORCING_NONE = 0,
+  FORCING_EW1 = 1,
+  FORCING_EW2 = 2
 };
 
 class FSILS_commuType 
@@ -113,6 +137,33 @@ class FSILS_cSType
     Vector<int> ptr;
 };
 
+/// @brief Persistent communication plan for the exchange of shared 
+/// node values with dof values per node.
+///
+/// The send and receive requests are created once with MPI_Send_init
+/// and MPI_Recv_init on the sB and rB buffers and are restarted for each
+/// exchange by fsils_commu_begin() and completed by fsils_commu_end().
+//
+class FSILS_haloType
+{
+  public:
+    /// Number of values per node
+    int dof = 0;
+
+    /// Number of communication requests
+    int nReq = 0;
+
+    /// An exchange has been started and not completed
+    bool active = false;
+
+    /// Send and receive buffers (dof*nmax,nReq)
+    Array<double> sB;
+    Array<double> rB;
+
+    std::vector<MPI_Request> rReq;
+    std::vector<MPI_Request> sReq;
+};
+
 class FSILS_faceType
 {
   public:
@@ -214,7 +265,20 @@ class FSILS_lhsType
 
     std::vector<FSILS_cSType> cS;
 
+    /// Persistent communication plans indexed by the number 
+    /// of values per node, created on first use and freed by
+    /// fsils_lhs_free()                     (USE)
+    mutable std::map<int,FSILS_haloType> halo;
+
     std::vector<FSILS_faceType> face;
+
+    /// Matrix-free operator KU = K*U, with U and KU in the
+    /// unmapped node ordering. If set it is used instead
+    /// of the assembled matrix                (IN)
+    std::function<void(const Array<double>&, Array<double>&)> mat_vec;
+
+    /// Diagonal scaling applied to mat_vec    (USE)
+    Array<double> mat_vec_W;
 };
 
 class FSILS_subLsType 
@@ -263,6 +327,64 @@ class FSILS_subLsType
 
     /// Calling duration            (OUT)
     double callD;  
+
+    /// Use pipelined GMRES         (IN)
+    bool pipelined = false;
+};
+
+/// @brief Settings for the smoothed aggregation algebraic multigrid 
+/// preconditioner (amg.cpp).
+//
+class FSILS_amgOptType
+{
+  public:
+    /// Smoother used on each level         (IN)
+    AmgSmootherType smoother = AmgSmootherType::AMG_SMOOTHER_CHEBYSHEV;
+
+    /// Smoother sweeps (Chebyshev degree)  (IN)
+    int sweeps = 2;
+
+    /// Maximum number of levels            (IN)
+    int max_levels = 10;
+
+    /// Number of unknowns solved directly  
+    /// on the coarsest level                (IN)
+    int coarse_size = 500;
+
+    /// Strength of connection threshold    (IN)
+    double theta = 0.0;
+};
+
+/// @brief Settings and state of the Eisenstat-Walker forcing term that
+/// sets the relative tolerance of the solves of inexact Newton iterations
+/// (forcing.cpp).
+//
+class FSILS_forcingType
+{
+  public:
+    /// Choice 1 or 2 of Eisenstat and Walker   (IN)
+    ForcingTermType type = ForcingTermType::FORCING_NONE;
+
+    /// Forcing term of the first iteration     (IN)
+    double eta0 = 0.1;
+
+    /// Maximum forcing term                    (IN)
+    double eta_max = 0.9;
+
+    /// Newton iteration of the solve, from 1   (IN)
+    int itr = 0;
+
+    /// Residual norm at which the Newton 
+    /// iterations are converged               (IN)
+    double nl_tol = 0.0;
+
+    /// Forcing term of the last solve          (OUT)
+    double eta = 0.0;
+
+    /// Initial and final residual norms of 
+    /// the last solve                          (USE)
+    double iNorm = 0.0;
+    double fNorm = 0.0;
 };
 
 class FSILS_lsType 
@@ -283,6 +405,31 @@ class FSILS_lsType
     FSILS_subLsType GM;
     FSILS_subLsType CG;
     FSILS_subLsType RI;
+
+    /// AMG preconditioner settings (IN)
+    FSILS_amgOptType amg;
+
+    /// Level of fill of the ILU(k) preconditioner  (IN)
+    int ilu_fill = 0;
+
+    /// ILU factors, the symbolic factorization is 
+    /// reused while the lhs pattern is unchanged    (USE)
+    std::shared_ptr<ilu::IluFactor> ilu;
+
+    /// Number of previous solutions used to project 
+    /// the initial guess                            (IN)
+    int proj_size = 0;
+
+    /// Number of vectors recycled between solves by 
+    /// the GCRO-DR solver                           (IN)
+    int recycle_size = 0;
+
+    /// Previous solutions and recycled subspace     (USE)
+    std::shared_ptr<recycle::RecycleSpace> recycle;
+
+    /// Adaptive relative tolerance of inexact Newton 
+    /// solves                                       (IN)
+    FSILS_forcingType forcing;
 };
 
 
@@ -0,0 +1,104 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// The functions here set the relative tolerance of the linear solves
+// of inexact Newton iterations using the forcing terms of 
+//
+//   S.C. Eisenstat and H.F. Walker, Choosing the forcing terms in an 
+//   inexact Newton method, SIAM J. Sci. Comput. 17 (1996) 16-32.
+//
+// The early Newton iterations, whose residual is far from converged, 
+// are solved loosely and the tolerance tightens as the Newton iterations
+// converge. The norms are those of the diagonally scaled residual, which 
+// is also the norm used to check the convergence of the Newton iterations.
+
+#include "forcing.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace forcing {
+
+/// @brief Return the relative tolerance for the solve of Newton iteration
+/// 'forcing.itr' with initial residual norm 'iNorm'.
+///
+/// The safeguards of Eisenstat and Walker keep the forcing term from 
+/// decreasing too fast, the forcing term is not allowed to be smaller than 
+/// needed to reach the Newton tolerance 'forcing.nl_tol', larger than 
+/// 'forcing.eta_max' or smaller than the linear solver tolerance 'relTol'.
+//
+double forcing_term(FSILS_forcingType& forcing, const double relTol, const double iNorm)
+{
+  const double gamma = 0.9;
+  const double alpha = 0.5 * (1.0 + sqrt(5.0));
+  double eta = forcing.eta0;
+
+  if ((forcing.itr > 1) && (forcing.iNorm > 0.0)) {
+    if (forcing.type == ForcingTermType::FORCING_EW1) {
+      // |  ||F_k|| - ||F_k-1 + J_k-1 s_k-1||  | / ||F_k-1||
+      eta = fabs(iNorm - forcing.fNorm) / forcing.iNorm;
+      double eta_s = pow(forcing.eta, alpha);
+
+      if (eta_s > 0.1) {
+        eta = std::max(eta, eta_s);
+      }
+
+    } else if (forcing.type == ForcingTermType::FORCING_EW2) {
+      // gamma * (||F_k|| / ||F_k-1||)^2
+      eta = gamma * pow(iNorm / forcing.iNorm, 2.0);
+      double eta_s = gamma * pow(forcing.eta, 2.0);
+
+      if (eta_s > 0.1) {
+        eta = std::max(eta, eta_s);
+      }
+    }
+  }
+
+  if ((forcing.nl_tol > 0.0) && (iNorm > 0.0)) {
+    eta = std::max(eta, 0.5 * forcing.nl_tol / iNorm);
+  }
+
+  eta = std::min(eta, forcing.eta_max);
+  eta = std::max(eta, relTol);
+  forcing.eta = eta;
+
+  return eta;
+}
+
+/// @brief Store the initial and final residual norms of a solve which
+/// are used to set the forcing term of the next Newton iteration.
+//
+void forcing_update(FSILS_forcingType& forcing, const double iNorm, const double fNorm)
+{
+  forcing.iNorm = iNorm;
+  forcing.fNorm = fNorm;
+}
+
+};
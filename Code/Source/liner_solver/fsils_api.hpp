@@ -51,6 +51,16 @@ void fsils_commus(const FSILS_lhsType& lhs, Vector<double>& R);
 
 void fsils_commuv(const FSILS_lhsType& lhs, const int dof, Array<double>& R);
 
+void fsils_commu_begin(const FSILS_lhsType& lhs, const Vector<double>& R);
+
+void fsils_commu_begin(const FSILS_lhsType& lhs, const int dof, const Array<double>& R);
+
+void fsils_commu_end(const FSILS_lhsType& lhs, Vector<double>& R);
+
+void fsils_commu_end(const FSILS_lhsType& lhs, const int dof, Array<double>& R);
+
+void fsils_commu_plans_free(const FSILS_lhsType& lhs);
+
 double fsils_cpu_t();
 
 void fsils_ls_create(FSILS_lsType& ls, LinearSolverType LS_type, double relTol = consts::double_inf, 
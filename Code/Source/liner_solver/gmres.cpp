@@ -42,9 +42,11 @@
 #include "dot.h"
 #include "norm.h"
 #include "omp_la.h"
+#include "recycle.h"
 #include "spar_mul.h"
 
 #include "Array3.h"
+#include "Profiler.h"
 
 #include <math.h>
 
@@ -91,6 +93,8 @@ void bc_pre(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subL
 void gmres(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof, 
     const Array<double>& Val, const Array<double>& R, Array<double>& X)
 {
+  SV_PROFILE_REGION("gmres");
+
   #define n_debug_gmres
   #ifdef debug_gmres
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -198,20 +202,17 @@ void gmres(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLs
         }
       }
 
-      for (int j = 0; j <= i+1; j++) {
-        h(j,i) = dot::fsils_nc_dot_v(dof, mynNo, u.rslice(j), u.rslice(i+1));
-      }
-
-      // h_col is modofied here so don't use 'rcol() method'.
-      auto h_col = h.col(i);
+      Vector<double> h_col(i+2);
+      dot::fsils_nc_mdot_v(dof, mynNo, i+2, u, u_slice_1, h_col);
       bcast::fsils_bcast_v(i+2, h_col, lhs.commu);
       h.set_col(i, h_col);
 
+      Vector<double> r(i+1);
       for (int j = 0; j <= i; j++) {
-        auto u_slice_1 = u.rslice(i+1);
-        omp_la::omp_sum_v(dof, nNo, -h(j,i), u_slice_1, u.rslice(j));
+        r(j) = -h(j,i);
         h(i+1,i) = h(i+1,i) - h(j,i)*h(j,i);
       }
+      omp_la::omp_msum_v(dof, nNo, i+1, r, u_slice_1, u);
 
       h(i+1,i) = sqrt(fabs(h(i+1,i)));
 
@@ -287,6 +288,8 @@ void gmres(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLs
 void gmres_s(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof,
     const Vector<double>& Val, Vector<double>& R)
 {
+  SV_PROFILE_REGION("gmres_s");
+
   #define n_debug_gmres_s
   #ifdef debug_gmres_s
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -450,6 +453,8 @@ void gmres_s(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
 void gmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof,
     const Array<double>& Val, Array<double>& R)
 {
+  SV_PROFILE_REGION("gmres_v");
+
   using namespace fsi_linear_solver;
 
   #define n_debug_gmres_v
@@ -505,7 +510,7 @@ void gmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
     ls.dB = ls.fNorm;
     ls.itr = ls.itr + 1;
     auto u_slice = u.rslice(0);
-    spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof,  Val, X, u_slice);
+    spar_mul::fsils_mat_vec_v(lhs, dof, Val, X, u_slice);
 
     add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, X, u_slice);
 
@@ -534,7 +539,7 @@ void gmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
       last_i = i;
       auto u_slice = u.rslice(i);
       auto u_slice_1 = u.rslice(i+1);
-      spar_mul::fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof,  Val, u_slice, u_slice_1);
+      spar_mul::fsils_mat_vec_v(lhs, dof, Val, u_slice, u_slice_1);
 
       add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, u_slice, u_slice_1);
 
@@ -547,22 +552,22 @@ void gmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
         }
       }
 
+      Vector<double> h_col(i+2);
+      dot::fsils_nc_mdot_v(dof, mynNo, i+2, u, u_slice_1, h_col);
+      bcast::fsils_bcast_v(i+2, h_col, lhs.commu);
+      h.set_col(i, h_col);
+      #ifdef debug_gmres_v
       for (int j = 0; j <= i+1; j++) {
-        h(j,i) = dot::fsils_nc_dot_v(dof, mynNo, u.rslice(j), u.rslice(i+1));
-        #ifdef debug_gmres_v
         dmsg << "h(j,i): " << h(j,i);
-        #endif
       }
+      #endif
 
-      auto h_col = h.col(i);
-      bcast::fsils_bcast_v(i+2, h_col, lhs.commu);
-      h.set_col(i, h_col);
-
+      Vector<double> r(i+1);
       for (int j = 0; j <= i; j++) {
-        auto u_slice_1 = u.rslice(i+1);
-        omp_la::omp_sum_v(dof, nNo, -h(j,i), u_slice_1, u.rslice(j));
+        r(j) = -h(j,i);
         h(i+1,i) = h(i+1,i) - h(j,i)*h(j,i);
       }
+      omp_la::omp_msum_v(dof, nNo, i+1, r, u_slice_1, u);
       h(i+1,i) = sqrt(fabs(h(i+1,i)));
 
       u_slice_1 = u.rslice(i+1);
@@ -628,6 +633,741 @@ void gmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_sub
   #endif
 }
 
-};
+//-------------
+// pgmres_cycle
+//-------------
+// Pipelined restarted GMRES iterations for vector problems, X = Val^-1 * R.
+//
+// This is the p(1)-GMRES of Ghysels et al. (2013). In addition to the 
+// orthonormal basis v_i a second basis z_i = A v_(i-1) is updated by
+// the same recurrence. The dot products for Hessenberg column i-1 
+// 
+//   <z_i,v_j>, j < i,  <z_i,z_i>
+//
+// only need z_i, so their global reduction is started with a nonblocking
+// MPI_Iallreduce and overlapped with the product A z_i used for z_(i+1). 
+// There is one global reduction per iteration, which is hidden behind the 
+// sparse matrix-vector product, at the cost of storing the z basis.
+//
+// Returns false if the initial residual is below the absolute tolerance.
+//
+bool pgmres_cycle(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof,
+    const Array<double>& Val, const Array<double>& R, Array<double>& X, const bool bc_pre_mul)
+{
+  using namespace fsi_linear_solver;
+
+  #define n_debug_pgmres_cycle
+  #ifdef debug_pgmres_cycle
+  DebugMsg dmsg(__func__,  lhs.commu.task);
+  dmsg.banner();
+  #endif
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+  int sD = ls.sD;
+
+  Array<double> h(sD+1,sD);
+  Array3<double> v(dof,nNo,sD+1), z(dof,nNo,sD+1);
+  Vector<double> y(sD), c(sD), s(sD), err(sD+1), g(sD+1);
+
+  bool pre = false;
+  if (bc_pre_mul) {
+    for (auto& face : lhs.face) {
+      if (face.coupledFlag) {
+        pre = true;
+        break;
+      }
+    }
+  }
+
+  // Apply the operator, KU = K*U, optionally followed by the coupled
+  // boundary preconditioner.
+  //
+  auto mat_vec = [&](const Array<double>& U, Array<double>& KU, const bool with_pre) -> void 
+  {
+    spar_mul::fsils_mat_vec_v(lhs, dof, Val, U, KU);
+    add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, U, KU);
+    if (with_pre) {
+      add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_PRE, dof, KU, KU);
+    }
+    ls.itr = ls.itr + 1;
+  };
+
+  double eps = 0.0;
+  int last_i = 0;
+  X = 0.0;
+
+  for (int l = 0; l < ls.mItr; l++) {
+    auto v_0 = v.rslice(0);
+
+    if (l == 0) {
+      v_0 = R;
+    } else {
+      mat_vec(X, v_0, false);
+      v_0 = R - v_0;
+    }
+
+    if (pre) {
+      add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_PRE, dof, v_0, v_0);
+    }
+
+    err(0) = norm::fsi_ls_normv(dof, mynNo, lhs.commu, v_0);
+    #ifdef debug_pgmres_cycle
+    dmsg << "err(0): " << err(0);
+    #endif
+
+    if (l == 0) {
+      eps = err(0);
+
+      if (eps <= ls.absTol) {
+        ls.callD = std::numeric_limits<double>::epsilon();
+        ls.dB = 0.0;
+        return false; 
+      }
+
+      ls.iNorm = eps;
+      ls.fNorm = eps;
+      eps = std::max(ls.absTol, ls.relTol*eps);
+    }
+
+    ls.dB = ls.fNorm;
+    omp_la::omp_mul_v(dof, nNo, 1.0/err(0), v_0);
+
+    auto z_1 = z.rslice(1);
+    mat_vec(v_0, z_1, pre);
+
+    // Compute column k = i-1 of the Hessenberg matrix and the basis 
+    // vector v_i from z_i.
+    //
+    bool breakdown = false;
+
+    for (int i = 1; i <= sD; i++) {
+      int k = i - 1;
+      last_i = k;
+      auto z_i = z.rslice(i);
+
+      for (int j = 0; j < i; j++) {
+        g(j) = dot::fsils_nc_dot_v(dof, mynNo, v.rslice(j), z_i);
+      }
+      g(i) = dot::fsils_nc_dot_v(dof, mynNo, z_i, z_i);
+
+      MPI_Request req;
+      bcast::fsils_bcast_v_begin(i+1, g, lhs.commu, req);
+
+      // Compute w = A z_i while the dot products are reduced.
+      if (i < sD) {
+        auto z_i1 = z.rslice(i+1);
+        mat_vec(z_i, z_i1, pre);
+      }
+
+      bcast::fsils_bcast_v_end(req);
+
+      double hh = g(i);
+      for (int j = 0; j < i; j++) {
+        h(j,k) = g(j);
+        hh = hh - g(j)*g(j);
+      }
+
+      // hh is the squared norm of the part of z_i orthogonal to the basis. 
+      //
+      // If it is zero to rounding the Krylov space is invariant (lucky 
+      // breakdown), column k is completed with h(i,k) = 0, the cycle ends 
+      // and convergence is checked with the true residual. 
+      //
+      // If it is negative the basis has lost its orthogonality through 
+      // rounding, the cycle ends with the columns already computed and
+      // is restarted.
+      //
+      const double eps_mach = std::numeric_limits<double>::epsilon();
+
+      if (hh < -sqrt(eps_mach) * g(i)) {
+        last_i = k - 1;
+        break;
+      }
+
+      breakdown = (hh <= eps_mach * g(i));
+
+      if (breakdown) {
+        h(i,k) = 0.0;
+
+      } else {
+        h(i,k) = sqrt(hh);
+
+        // v_i = (z_i - sum_j h(j,k) v_j) / h(i,k)
+        auto v_i = v.rslice(i);
+        v_i = z_i;
+        for (int j = 0; j < i; j++) {
+          omp_la::omp_sum_v(dof, nNo, -h(j,k), v_i, v.rslice(j));
+        }
+        omp_la::omp_mul_v(dof, nNo, 1.0/h(i,k), v_i);
+
+        // z_(i+1) = (A z_i - sum_j h(j,k) z_(j+1)) / h(i,k)
+        if (i < sD) {
+          auto z_i1 = z.rslice(i+1);
+          for (int j = 0; j < i; j++) {
+            omp_la::omp_sum_v(dof, nNo, -h(j,k), z_i1, z.rslice(j+1));
+          }
+          omp_la::omp_mul_v(dof, nNo, 1.0/h(i,k), z_i1);
+        }
+      }
+
+      for (int j = 0; j <= k-1; j++) {
+        double tmp = c(j)*h(j,k) + s(j)*h(j+1,k);
+        h(j+1,k) = -s(j)*h(j,k) + c(j)*h(j+1,k);
+        h(j,k) = tmp;
+      }
+
+      double tmp = sqrt(h(k,k)*h(k,k) + h(k+1,k)*h(k+1,k));
+
+      // A zero column can not be used to update X.
+      if (tmp == 0.0) {
+        last_i = k - 1;
+        break;
+      }
+
+      c(k) = h(k,k) / tmp;
+      s(k) = h(k+1,k) / tmp;
+      h(k,k) = tmp;
+      h(k+1,k) = 0.0;
+      err(k+1) = -s(k)*err(k);
+      err(k) = c(k)*err(k);
+      #ifdef debug_pgmres_cycle
+      dmsg << "err(k+1): " << err(k+1);
+      #endif
+
+      if (breakdown) {
+        break;
+      }
+
+      if (fabs(err(k+1)) < eps) {
+        ls.suc = true;
+        break;
+      }
+    }
+
+    // No column was computed before a breakdown, restarting would
+    // repeat it.
+    //
+    if (last_i < 0) {
+      break;
+    }
+
+    for (int i = 0; i <= last_i; i++) {
+      y(i) = err(i);
+    }
+
+    for (int j = last_i; j >= 0; j--) { 
+      for (int k = j+1; k <= last_i; k++) {
+        y(j) = y(j) - h(j,k)*y(k);
+      }
+      y(j) = y(j) / h(j,j);
+    }
+
+    for (int j = 0; j <= last_i; j++) {
+      omp_la::omp_sum_v(dof, nNo, y(j), X, v.rslice(j));
+    }
+
+    ls.fNorm = fabs(err(last_i+1));
+
+    // After a lucky breakdown the residual estimate is zero, the cycle 
+    // has converged if the true residual is below the tolerance and is 
+    // restarted otherwise.
+    //
+    if (breakdown) {
+      auto r = v.rslice(0);
+      mat_vec(X, r, false);
+      r = R - r;
+      if (pre) {
+        add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_PRE, dof, r, r);
+      }
+      ls.fNorm = norm::fsi_ls_normv(dof, mynNo, lhs.commu, r);
+      ls.suc = (ls.fNorm < eps);
+    }
+
+    if (ls.suc) {
+      break;
+    }
+  }
+
+  return true;
+}
+
+//--------
+// pgmres
+//--------
+// Pipelined version of gmres(), solves Val * X = R.
+//
+void pgmres(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof, 
+    const Array<double>& Val, const Array<double>& R, Array<double>& X)
+{
+  SV_PROFILE_REGION("pgmres");
+
+  double time = fsi_linear_solver::fsils_cpu_t(); 
+  ls.suc = false;
+
+  if (!pgmres_cycle(lhs, ls, dof, Val, R, X, true)) {
+    return;
+  }
+
+  ls.callD = fsi_linear_solver::fsils_cpu_t() - time + ls.callD;
+  ls.dB  = 10.0 * log(ls.fNorm / ls.dB);
+}
+
+//----------
+// pgmres_v
+//----------
+// Pipelined version of gmres_v(), solves Val * X = R and returns X in R.
+//
+void pgmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof,
+    const Array<double>& Val, Array<double>& R)
+{
+  SV_PROFILE_REGION("pgmres_v");
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+  Array<double> X(dof,nNo);
+
+  ls.callD = fsi_linear_solver::fsils_cpu_t();
+  ls.suc = false;
+  ls.itr = 0;
+
+  if (dof > 1) {
+    bc_pre(lhs, ls, dof, mynNo, nNo);
+  }
+
+  if (!pgmres_cycle(lhs, ls, dof, Val, R, X, false)) {
+    return;
+  }
+
+  R = X;
+  ls.callD = fsi_linear_solver::fsils_cpu_t() - ls.callD;
+  ls.dB  = 10.0 * log(ls.fNorm / ls.dB);
+}
+
+//----------
+// fgmres_v
+//----------
+// Flexible GMRES for vector problems, right preconditioned with the 
+// preconditioner prec(u, z) setting z = M^-1 u (AMG or ILU). The 
+// preconditioned basis z_i = M^-1 u_i is stored and the solution is 
+// updated with it, X = X + sum_i y_i z_i. A scalar problem is solved as
+// a vector problem with dof = 1. 
+//
+void fgmres_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof,
+    const Array<double>& Val, const std::function<void(const Array<double>&, Array<double>&)>& prec, 
+    Array<double>& R)
+{
+  SV_PROFILE_REGION("fgmres_v");
+
+  using namespace fsi_linear_solver;
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+
+  Array<double> h(ls.sD+1,ls.sD), X(dof,nNo);
+  Array3<double> u(dof,nNo,ls.sD+1), z(dof,nNo,ls.sD);
+  Vector<double> y(ls.sD), c(ls.sD), s(ls.sD), err(ls.sD+1);
+
+  ls.callD = fsi_linear_solver::fsils_cpu_t();
+  ls.suc = false;
+  double eps = norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
+  ls.iNorm = eps;
+  ls.fNorm = eps;
+  eps = std::max(ls.absTol, ls.relTol*eps);
+  ls.itr = 0;
+  int last_i = 0;
+
+  bc_pre(lhs, ls, dof, mynNo, nNo);
+
+  if (ls.iNorm <= ls.absTol) {
+    ls.callD = std::numeric_limits<double>::epsilon();
+    ls.dB = 0.0;
+    return; 
+  }
+
+  for (int l = 0; l < ls.mItr; l++) {
+    ls.dB = ls.fNorm;
+    ls.itr = ls.itr + 1;
+    auto u_0 = u.rslice(0);
+    spar_mul::fsils_mat_vec_v(lhs, dof, Val, X, u_0);
+    add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, X, u_0);
+    u_0 = R - u_0;
+
+    err(0) = norm::fsi_ls_normv(dof, mynNo, lhs.commu, u_0);
+    omp_la::omp_mul_v(dof, nNo, 1.0/err(0), u_0);
+
+    for (int i = 0; i < ls.sD; i++) {
+      ls.itr = ls.itr + 1;
+      last_i = i;
+      auto u_i = u.rslice(i);
+      auto u_i1 = u.rslice(i+1);
+      auto z_i = z.rslice(i);
+
+      prec(u_i, z_i);
+      spar_mul::fsils_mat_vec_v(lhs, dof, Val, z_i, u_i1);
+      add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, z_i, u_i1);
 
+      Vector<double> h_col(i+2);
+      dot::fsils_nc_mdot_v(dof, mynNo, i+2, u, u_i1, h_col);
+      bcast::fsils_bcast_v(i+2, h_col, lhs.commu);
+      h.set_col(i, h_col);
+
+      Vector<double> r(i+1);
+      for (int j = 0; j <= i; j++) {
+        r(j) = -h(j,i);
+        h(i+1,i) = h(i+1,i) - h(j,i)*h(j,i);
+      }
+      omp_la::omp_msum_v(dof, nNo, i+1, r, u_i1, u);
+      h(i+1,i) = sqrt(fabs(h(i+1,i)));
+      omp_la::omp_mul_v(dof, nNo, 1.0/h(i+1,i), u_i1);
+
+      for (int j = 0; j <= i-1; j++) {
+        double tmp = c(j)*h(j,i) + s(j)*h(j+1,i);
+        h(j+1,i) = -s(j)*h(j,i) + c(j)*h(j+1,i);
+        h(j,i) = tmp;
+      }
+
+      double tmp = sqrt(h(i,i)*h(i,i) + h(i+1,i)*h(i+1,i));
+      c(i) = h(i,i) / tmp;
+      s(i) = h(i+1,i) / tmp;
+      h(i,i) = tmp;
+      h(i+1,i) = 0.0;
+      err(i+1) = -s(i)*err(i);
+      err(i) = c(i)*err(i);
+
+      if (fabs(err(i+1)) < eps) {
+        ls.suc = true;
+        break;
+      }
+    }
+
+    for (int i = 0; i <= last_i; i++) {
+      y(i) = err(i);
+    }
+
+    for (int j = last_i; j >= 0; j--) { 
+      for (int k = j+1; k <= last_i; k++) {
+        y(j) = y(j) - h(j,k)*y(k);
+      }
+      y(j) = y(j) / h(j,j);
+    }
+
+    for (int j = 0; j <= last_i; j++) {
+      omp_la::omp_sum_v(dof, nNo, y(j), X, z.rslice(j));
+    }
+
+    ls.fNorm = fabs(err(last_i+1));
+    if (ls.suc) {
+      break;
+    }
+  }
+
+  R = X;
+  ls.callD = fsi_linear_solver::fsils_cpu_t() - ls.callD;
+  ls.dB  = 10.0 * log(ls.fNorm / ls.dB);
+}
+
+//----------
+// gcrodr_v
+//----------
+// GMRES with deflated restarts and subspace recycling (GCRO-DR) for 
+// vector problems. A scalar problem is solved as a vector problem with
+// dof = 1.
+//
+// The recycled subspace U of the previous solve is mapped with the 
+// current matrix, C = A U, and orthonormalized so that A U = C with 
+// C^T C = I. The component of the residual in span{C} is removed, 
+// X = X + U C^T r, and the GMRES cycles are run with the deflated 
+// operator (I - C C^T) A, for which 
+//
+//   A [U V_m] = [C V_m+1] G,  G = | I  B |,  B = C^T A V_m
+//                                 | 0  H |
+//
+// The minimal residual correction is X = X + V_m y - U B y. At the end 
+// of the solve U is replaced by the harmonic Ritz vectors of A in 
+// span{U, V_m} of the last cycle (recycle::harmonic_ritz_vectors). 
+//
+// The dot products with C and V of each iteration are summed in a 
+// single global reduction.
+//
+void gcrodr_v(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_subLsType& ls, const int dof,
+    const Array<double>& Val, recycle::RecycleSpace& space, Array<double>& R)
+{
+  SV_PROFILE_REGION("gcrodr_v");
+
+  using namespace fsi_linear_solver;
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+  int kMax = space.U.nslices();
+
+  Array<double> h(ls.sD+1,ls.sD), hc(ls.sD+1,ls.sD), B(kMax,ls.sD), X(dof,nNo);
+  Array3<double> u(dof,nNo,ls.sD+1), C(dof,nNo,kMax);
+  Vector<double> y(ls.sD), c(ls.sD), s(ls.sD), err(ls.sD+1);
+
+  ls.callD = fsi_linear_solver::fsils_cpu_t();
+  ls.suc = false;
+  double eps = norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
+  ls.iNorm = eps;
+  ls.fNorm = eps;
+  eps = std::max(ls.absTol, ls.relTol*eps);
+  ls.itr = 0;
+  int last_i = 0;
+
+  bc_pre(lhs, ls, dof, mynNo, nNo);
+
+  if (ls.iNorm <= ls.absTol) {
+    ls.callD = std::numeric_limits<double>::epsilon();
+    ls.dB = 0.0;
+    return; 
+  }
+
+  // Compute C = A U with modified Gram-Schmidt, dropping recycled 
+  // vectors that are (nearly) linearly dependent.
+  //
+  int k = 0;
+
+  for (int j = 0; j < space.nU; j++) {
+    auto U_k = space.U.rslice(k);
+    auto C_k = C.rslice(k);
+
+    if (j != k) {
+      U_k = space.U.rslice(j);
+    }
+
+    spar_mul::fsils_mat_vec_v(lhs, dof, Val, U_k, C_k);
+    add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, U_k, C_k);
+    double nrm0 = norm::fsi_ls_normv(dof, mynNo, lhs.commu, C_k);
+
+    for (int i = 0; i < k; i++) {
+      double r = dot::fsils_dot_v(dof, mynNo, lhs.commu, C.rslice(i), C_k);
+      omp_la::omp_sum_v(dof, nNo, -r, C_k, C.rslice(i));
+      omp_la::omp_sum_v(dof, nNo, -r, U_k, space.U.rslice(i));
+    }
+
+    double nrm = norm::fsi_ls_normv(dof, mynNo, lhs.commu, C_k);
+
+    if (!(nrm > 1.0e-8 * nrm0)) {
+      continue;
+    }
+
+    omp_la::omp_mul_v(dof, nNo, 1.0/nrm, C_k);
+    omp_la::omp_mul_v(dof, nNo, 1.0/nrm, U_k);
+    k += 1;
+  }
+
+  space.nU = k;
+  int m = 0;
+
+  for (int l = 0; l < ls.mItr; l++) {
+    ls.dB = ls.fNorm;
+    ls.itr = ls.itr + 1;
+    m = 0;
+    auto u_0 = u.rslice(0);
+    spar_mul::fsils_mat_vec_v(lhs, dof, Val, X, u_0);
+    add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, X, u_0);
+    u_0 = R - u_0;
+
+    // Remove the residual in span{C}, X = X + U C^T r.
+    //
+    if (k > 0) {
+      Vector<double> d(k);
+
+      for (int j = 0; j < k; j++) {
+        d(j) = dot::fsils_nc_dot_v(dof, mynNo, C.rslice(j), u_0);
+      }
+      bcast::fsils_bcast_v(k, d, lhs.commu);
+
+      for (int j = 0; j < k; j++) {
+        omp_la::omp_sum_v(dof, nNo, -d(j), u_0, C.rslice(j));
+        omp_la::omp_sum_v(dof, nNo, d(j), X, space.U.rslice(j));
+      }
+    }
 
+    err(0) = norm::fsi_ls_normv(dof, mynNo, lhs.commu, u_0);
+
+    if (err(0) < eps) {
+      ls.fNorm = err(0);
+      ls.suc = true;
+      break;
+    }
+
+    omp_la::omp_mul_v(dof, nNo, 1.0/err(0), u_0);
+
+    for (int i = 0; i < ls.sD; i++) {
+      ls.itr = ls.itr + 1;
+      last_i = i;
+      auto u_i = u.rslice(i);
+      auto u_i1 = u.rslice(i+1);
+      spar_mul::fsils_mat_vec_v(lhs, dof, Val, u_i, u_i1);
+      add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, u_i, u_i1);
+      Vector<double> d(k+i+2), dc(k), du(i+2);
+
+      dot::fsils_nc_mdot_v(dof, mynNo, k, C, u_i1, dc);
+      dot::fsils_nc_mdot_v(dof, mynNo, i+2, u, u_i1, du);
+
+      for (int j = 0; j < k; j++) {
+        d(j) = dc(j);
+      }
+
+      for (int j = 0; j <= i+1; j++) {
+        d(k+j) = du(j);
+      }
+
+      bcast::fsils_bcast_v(k+i+2, d, lhs.commu);
+      h(i+1,i) = d(k+i+1);
+
+      for (int j = 0; j < k; j++) {
+        B(j,i) = d(j);
+        dc(j) = -B(j,i);
+        h(i+1,i) = h(i+1,i) - B(j,i)*B(j,i);
+      }
+
+      for (int j = 0; j <= i; j++) {
+        h(j,i) = d(k+j);
+        du(j) = -h(j,i);
+        h(i+1,i) = h(i+1,i) - h(j,i)*h(j,i);
+      }
+
+      omp_la::omp_msum_v(dof, nNo, k, dc, u_i1, C);
+      omp_la::omp_msum_v(dof, nNo, i+1, du, u_i1, u);
+      h(i+1,i) = sqrt(fabs(h(i+1,i)));
+      omp_la::omp_mul_v(dof, nNo, 1.0/h(i+1,i), u_i1);
+
+      // Keep the Hessenberg matrix for the recycled subspace update.
+      for (int j = 0; j <= i+1; j++) {
+        hc(j,i) = h(j,i);
+      }
+
+      for (int j = 0; j <= i-1; j++) {
+        double tmp = c(j)*h(j,i) + s(j)*h(j+1,i);
+        h(j+1,i) = -s(j)*h(j,i) + c(j)*h(j+1,i);
+        h(j,i) = tmp;
+      }
+
+      double tmp = sqrt(h(i,i)*h(i,i) + h(i+1,i)*h(i+1,i));
+      c(i) = h(i,i) / tmp;
+      s(i) = h(i+1,i) / tmp;
+      h(i,i) = tmp;
+      h(i+1,i) = 0.0;
+      err(i+1) = -s(i)*err(i);
+      err(i) = c(i)*err(i);
+
+      if (fabs(err(i+1)) < eps) {
+        ls.suc = true;
+        break;
+      }
+    }
+
+    for (int i = 0; i <= last_i; i++) {
+      y(i) = err(i);
+    }
+
+    for (int j = last_i; j >= 0; j--) { 
+      for (int i = j+1; i <= last_i; i++) {
+        y(j) = y(j) - h(j,i)*y(i);
+      }
+      y(j) = y(j) / h(j,j);
+    }
+
+    for (int j = 0; j <= last_i; j++) {
+      omp_la::omp_sum_v(dof, nNo, y(j), X, u.rslice(j));
+    }
+
+    for (int j = 0; j < k; j++) {
+      double by = 0.0;
+      for (int i = 0; i <= last_i; i++) {
+        by += B(j,i) * y(i);
+      }
+      omp_la::omp_sum_v(dof, nNo, -by, X, space.U.rslice(j));
+    }
+
+    m = last_i + 1;
+    ls.fNorm = fabs(err(last_i+1));
+    if (ls.suc) {
+      break;
+    }
+  }
+
+  // Update the recycled subspace with the harmonic Ritz vectors of the 
+  // last cycle, the generalized eigenvalue problem 
+  //
+  //   G^T G p = theta G^T [C V_m+1]^T [U V_m] p
+  //
+  // has size k+m with C^T V_m = 0 and V_m+1^T V_m = [I 0]^T.
+  //
+  if ((m > 0) && (kMax > 0)) {
+    int n = k + m;
+    Array<double> G(n+1,n), F(n+1,n);
+
+    for (int i = 0; i < k; i++) {
+      G(i,i) = 1.0;
+      for (int j = 0; j < m; j++) {
+        G(i,k+j) = B(i,j);
+      }
+    }
+
+    for (int i = 0; i <= m; i++) {
+      for (int j = 0; j < m; j++) {
+        G(k+i,k+j) = (i <= j+1) ? hc(i,j) : 0.0;
+      }
+    }
+
+    for (int j = 0; j < m; j++) {
+      F(k+j,k+j) = 1.0;
+    }
+
+    if (k > 0) {
+      Vector<double> f((k+m+1)*k);
+
+      for (int j = 0; j < k; j++) {
+        for (int i = 0; i < k; i++) {
+          f(j*(k+m+1)+i) = dot::fsils_nc_dot_v(dof, mynNo, C.rslice(i), space.U.rslice(j));
+        }
+        for (int i = 0; i <= m; i++) {
+          f(j*(k+m+1)+k+i) = dot::fsils_nc_dot_v(dof, mynNo, u.rslice(i), space.U.rslice(j));
+        }
+      }
+
+      bcast::fsils_bcast_v(f.size(), f, lhs.commu);
+
+      for (int j = 0; j < k; j++) {
+        for (int i = 0; i < k+m+1; i++) {
+          F(i,j) = f(j*(k+m+1)+i);
+        }
+      }
+    }
+
+    auto P = recycle::harmonic_ritz_vectors(G, F, kMax);
+    int nP = P.ncols();
+
+    if (nP > 0) {
+      Array3<double> U(dof,nNo,nP);
+
+      for (int p = 0; p < nP; p++) {
+        auto U_p = U.rslice(p);
+        for (int j = 0; j < k; j++) {
+          omp_la::omp_sum_v(dof, nNo, P(j,p), U_p, space.U.rslice(j));
+        }
+        for (int j = 0; j < m; j++) {
+          omp_la::omp_sum_v(dof, nNo, P(k+j,p), U_p, u.rslice(j));
+        }
+      }
+
+      for (int p = 0; p < nP; p++) {
+        auto U_p = space.U.rslice(p);
+        U_p = U.rslice(p);
+        double nrm = norm::fsi_ls_normv(dof, mynNo, lhs.commu, U_p);
+        omp_la::omp_mul_v(dof, nNo, 1.0/nrm, U_p);
+      }
+    }
+
+    space.nU = nP;
+  }
+
+  R = X;
+  ls.callD = fsi_linear_solver::fsils_cpu_t() - ls.callD;
+  ls.dB  = 10.0 * log(ls.fNorm / ls.dB);
+}
+
+};
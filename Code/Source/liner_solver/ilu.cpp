@@ -0,0 +1,625 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Node block incomplete LU preconditioner ILU(k).
+//
+// The fsils matrix Val(dof*dof,nnz) of a process holds only the 
+// contributions of its own elements. The rows of the nodes shared with 
+// other processes are completed with the entries of the other processes 
+// whose column is also a node of this process, giving the matrix of the
+// overlapping subdomain of the process. This matrix is factored with 
+// dof x dof blocks and the factors are applied as a restricted additive
+// Schwarz (block Jacobi) preconditioner: each process solves with its 
+// own factors and keeps the values of the nodes it owns (lhs nodes 
+// [0,mynNo)), which are then communicated to the other processes.
+//
+// The lhs pattern is fixed for a simulation, so the symbolic 
+// factorization, the level schedules of the triangular solves and the 
+// communication plan are computed once and reused by the numeric 
+// factorization of each solve. The rows of a level of the triangular 
+// solves are independent and are distributed over OpenMP threads.
+
+#include "ilu.h"
+
+#include "fsils_api.hpp"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <math.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace ilu {
+
+namespace {
+
+/// @brief MPI tags used to exchange shared rows.
+const int count_tag = 23;
+const int index_tag = 24;
+const int value_tag = 25;
+
+/// @brief Return true if the symbolic factorization stored in ilu was
+/// computed for the pattern of lhs on all processes.
+//
+bool same_pattern(const FSILS_lhsType& lhs, const int dof, const int fill, const IluFactor& ilu)
+{
+  int same = (ilu.dof == dof) && (ilu.fill == fill) && (ilu.nNo == lhs.nNo) && (ilu.nnz == lhs.nnz);
+
+  for (int a = 0; same && (a < lhs.nNo); a++) {
+    same = (ilu.a_ptr[2*a] == lhs.rowPtr(0,a)) && (ilu.a_ptr[2*a+1] == lhs.rowPtr(1,a));
+  }
+
+  for (int i = 0; same && (i < lhs.nnz); i++) {
+    same = (ilu.a_col[i] == lhs.colPtr(i));
+  }
+
+  if (lhs.commu.nTasks > 1) {
+    MPI_Allreduce(MPI_IN_PLACE, &same, 1, cm_mod::mpint, MPI_MIN, lhs.commu.comm);
+  }
+
+  return same;
+}
+
+/// @brief Return the factor entry of row a and column b, or -1 if it 
+/// is not in the pattern.
+//
+int find_entry(const IluFactor& ilu, const int a, const int b)
+{
+  auto first = ilu.col.begin() + ilu.ptr[a];
+  auto last = ilu.col.begin() + ilu.ptr[a+1];
+  auto it = std::lower_bound(first, last, b);
+
+  if ((it == last) || (*it != b)) {
+    return -1;
+  }
+
+  return it - ilu.col.begin();
+}
+
+/// @brief Group rows by level into ptr(nLevels+1) and rows.
+//
+void make_schedule(const std::vector<int>& level, const int nLevels, std::vector<int>& ptr, std::vector<int>& rows)
+{
+  ptr.assign(nLevels+1, 0);
+  rows.resize(level.size());
+
+  for (int l : level) {
+    ptr[l+1] += 1;
+  }
+
+  for (int l = 0; l < nLevels; l++) {
+    ptr[l+1] += ptr[l];
+  }
+
+  std::vector<int> fill(ptr.begin(), ptr.end()-1);
+
+  for (int a = 0; a < static_cast<int>(level.size()); a++) {
+    rows[fill[level[a]]++] = a;
+  }
+}
+
+/// @brief Compute the pattern of the ILU(k) factors using levels of fill
+/// and the level schedules of the triangular solves.
+//
+void symbolic(const FSILS_lhsType& lhs, const int dof, const int fill, IluFactor& ilu)
+{
+  int nNo = lhs.nNo;
+  int nnz = lhs.nnz;
+
+  ilu.dof = dof;
+  ilu.fill = fill;
+  ilu.nNo = nNo;
+  ilu.nnz = nnz;
+  ilu.a_ptr.resize(2*nNo);
+  ilu.a_col.resize(nnz);
+
+  for (int a = 0; a < nNo; a++) {
+    ilu.a_ptr[2*a] = lhs.rowPtr(0,a);
+    ilu.a_ptr[2*a+1] = lhs.rowPtr(1,a);
+  }
+
+  for (int i = 0; i < nnz; i++) {
+    ilu.a_col[i] = lhs.colPtr(i);
+  }
+
+  // Level of fill of the entries of the current row (-1 if not in the
+  // row) and of the entries of the factors.
+  std::vector<int> lev(nNo, -1);
+  std::vector<int> flev;
+  std::vector<int> row;
+  std::set<int> lower;
+
+  ilu.ptr.assign(nNo+1, 0);
+  ilu.col.clear();
+  ilu.diag.assign(nNo, -1);
+
+  for (int a = 0; a < nNo; a++) {
+    row.clear();
+    lower.clear();
+
+    for (int e = lhs.rowPtr(0,a); e <= lhs.rowPtr(1,a); e++) {
+      int b = lhs.colPtr(e);
+      lev[b] = 0;
+      row.push_back(b);
+      if (b < a) {
+        lower.insert(b);
+      }
+    }
+
+    // Eliminate the lower entries in increasing column order, fill 
+    // entries are added to 'lower' ahead of the current column.
+    //
+    for (int k : lower) {
+      for (int f = ilu.diag[k]+1; f < ilu.ptr[k+1]; f++) {
+        int j = ilu.col[f];
+        int l = lev[k] + flev[f] + 1;
+
+        if (l > fill) {
+          continue;
+        }
+
+        if (lev[j] < 0) {
+          lev[j] = l;
+          row.push_back(j);
+          if (j < a) {
+            lower.insert(j);
+          }
+        } else if (l < lev[j]) {
+          lev[j] = l;
+        }
+      }
+    }
+
+    std::sort(row.begin(), row.end());
+
+    for (int b : row) {
+      if (b == a) {
+        ilu.diag[a] = ilu.col.size();
+      }
+      ilu.col.push_back(b);
+      flev.push_back(lev[b]);
+      lev[b] = -1;
+    }
+
+    ilu.ptr[a+1] = ilu.col.size();
+
+    if (ilu.diag[a] < 0) {
+      throw std::runtime_error("[ilu_setup] The matrix row of node " + std::to_string(a) + " has no diagonal entry.");
+    }
+  }
+
+  ilu.a_to_f.resize(nnz);
+
+  for (int a = 0; a < nNo; a++) {
+    for (int e = lhs.rowPtr(0,a); e <= lhs.rowPtr(1,a); e++) {
+      ilu.a_to_f[e] = find_entry(ilu, a, lhs.colPtr(e));
+    }
+  }
+
+  // Level schedules, a row is in the level following the levels of 
+  // the rows it depends on.
+  //
+  std::vector<int> level(nNo, 0);
+  int nLevels = 0;
+
+  for (int a = 0; a < nNo; a++) {
+    for (int f = ilu.ptr[a]; f < ilu.diag[a]; f++) {
+      level[a] = std::max(level[a], level[ilu.col[f]] + 1);
+    }
+    nLevels = std::max(nLevels, level[a] + 1);
+  }
+
+  make_schedule(level, nLevels, ilu.fwd_ptr, ilu.fwd_rows);
+
+  level.assign(nNo, 0);
+  nLevels = 0;
+
+  for (int a = nNo-1; a >= 0; a--) {
+    for (int f = ilu.diag[a]+1; f < ilu.ptr[a+1]; f++) {
+      level[a] = std::max(level[a], level[ilu.col[f]] + 1);
+    }
+    nLevels = std::max(nLevels, level[a] + 1);
+  }
+
+  make_schedule(level, nLevels, ilu.bwd_ptr, ilu.bwd_rows);
+}
+
+/// @brief Set the plan used to complete the rows of shared nodes.
+///
+/// A process sends the entries of the rows of the nodes it shares with
+/// another process whose column is also shared with it. The row and 
+/// column are identified by their position in the shared node list 
+/// lhs.cS, which is ordered the same way on both processes.
+//
+void exchange_plan(const FSILS_lhsType& lhs, IluFactor& ilu)
+{
+  int nReq = lhs.nReq;
+  int dd = ilu.dof * ilu.dof;
+
+  ilu.send_idx.assign(nReq, {});
+  ilu.recv_idx.assign(nReq, {});
+  ilu.send_buf.assign(nReq, {});
+  ilu.recv_buf.assign(nReq, {});
+
+  if ((lhs.commu.nTasks == 1) || (nReq == 0)) {
+    return;
+  }
+
+  auto comm = lhs.commu.comm;
+  std::vector<int> pos(lhs.nNo, -1);
+  std::vector<int> sCount(nReq), rCount(nReq);
+  std::vector<std::vector<int>> sPair(nReq), rPair(nReq);
+  std::vector<MPI_Request> req(2*nReq);
+
+  for (int i = 0; i < nReq; i++) {
+    auto& cS = lhs.cS[i];
+
+    for (int m = 0; m < cS.n; m++) {
+      pos[cS.ptr(m)] = m;
+    }
+
+    for (int m = 0; m < cS.n; m++) {
+      int a = cS.ptr(m);
+      for (int e = lhs.rowPtr(0,a); e <= lhs.rowPtr(1,a); e++) {
+        int p = pos[lhs.colPtr(e)];
+        if (p >= 0) {
+          ilu.send_idx[i].push_back(e);
+          sPair[i].push_back(m);
+          sPair[i].push_back(p);
+        }
+      }
+    }
+
+    for (int m = 0; m < cS.n; m++) {
+      pos[cS.ptr(m)] = -1;
+    }
+
+    sCount[i] = ilu.send_idx[i].size();
+    MPI_Irecv(&rCount[i], 1, cm_mod::mpint, cS.iP, count_tag, comm, &req[i]);
+    MPI_Isend(&sCount[i], 1, cm_mod::mpint, cS.iP, count_tag, comm, &req[nReq+i]);
+  }
+
+  MPI_Waitall(2*nReq, req.data(), MPI_STATUSES_IGNORE);
+
+  for (int i = 0; i < nReq; i++) {
+    auto& cS = lhs.cS[i];
+    rPair[i].resize(2*rCount[i]);
+    MPI_Irecv(rPair[i].data(), rPair[i].size(), cm_mod::mpint, cS.iP, index_tag, comm, &req[i]);
+    MPI_Isend(sPair[i].data(), sPair[i].size(), cm_mod::mpint, cS.iP, index_tag, comm, &req[nReq+i]);
+  }
+
+  MPI_Waitall(2*nReq, req.data(), MPI_STATUSES_IGNORE);
+
+  for (int i = 0; i < nReq; i++) {
+    auto& cS = lhs.cS[i];
+    ilu.recv_idx[i].resize(rCount[i]);
+
+    for (int n = 0; n < rCount[i]; n++) {
+      int a = cS.ptr(rPair[i][2*n]);
+      int b = cS.ptr(rPair[i][2*n+1]);
+      ilu.recv_idx[i][n] = find_entry(ilu, a, b);
+    }
+
+    ilu.send_buf[i].resize(sCount[i]*dd);
+    ilu.recv_buf[i].resize(rCount[i]*dd);
+  }
+}
+
+/// @brief C = A B for dof x dof row-major blocks.
+//
+inline void block_mul(const int dof, const double* A, const double* B, double* C)
+{
+  for (int r = 0; r < dof; r++) {
+    for (int c = 0; c < dof; c++) {
+      double s = 0.0;
+      for (int m = 0; m < dof; m++) {
+        s += A[r*dof+m] * B[m*dof+c];
+      }
+      C[r*dof+c] = s;
+    }
+  }
+}
+
+/// @brief C = C - A B for dof x dof row-major blocks.
+//
+inline void block_mul_sub(const int dof, const double* A, const double* B, double* C)
+{
+  for (int r = 0; r < dof; r++) {
+    for (int m = 0; m < dof; m++) {
+      double a = A[r*dof+m];
+      if (a == 0.0) {
+        continue;
+      }
+      for (int c = 0; c < dof; c++) {
+        C[r*dof+c] -= a * B[m*dof+c];
+      }
+    }
+  }
+}
+
+/// @brief Replace the diagonal block of node 'node' by its inverse.
+///
+/// An unknown removed by a Dirichlet condition has a zero row and column
+/// in the diagonally scaled matrix, its diagonal entry is set to one.
+//
+void invert_block(const int dof, const int node, double* D)
+{
+  for (int k = 0; k < dof; k++) {
+    bool zero = true;
+    for (int m = 0; m < dof; m++) {
+      zero = zero && (D[k*dof+m] == 0.0) && (D[m*dof+k] == 0.0);
+    }
+    if (zero) {
+      D[k*dof+k] = 1.0;
+    }
+  }
+
+  // Gauss-Jordan elimination with partial pivoting.
+  //
+  const int n = dof;
+  std::vector<double> A(D, D + n*n), B(n*n, 0.0);
+
+  for (int k = 0; k < n; k++) {
+    B[k*n+k] = 1.0;
+  }
+
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    for (int r = k+1; r < n; r++) {
+      if (fabs(A[r*n+k]) > fabs(A[p*n+k])) {
+        p = r;
+      }
+    }
+
+    if (A[p*n+k] == 0.0) {
+      throw std::runtime_error("[ilu_setup] The diagonal block of node " + std::to_string(node) + " is singular.");
+    }
+
+    if (p != k) {
+      for (int c = 0; c < n; c++) {
+        std::swap(A[k*n+c], A[p*n+c]);
+        std::swap(B[k*n+c], B[p*n+c]);
+      }
+    }
+
+    double s = 1.0 / A[k*n+k];
+    for (int c = 0; c < n; c++) {
+      A[k*n+c] *= s;
+      B[k*n+c] *= s;
+    }
+
+    for (int r = 0; r < n; r++) {
+      double f = A[r*n+k];
+      if ((r == k) || (f == 0.0)) {
+        continue;
+      }
+      for (int c = 0; c < n; c++) {
+        A[r*n+c] -= f * A[k*n+c];
+        B[r*n+c] -= f * B[k*n+c];
+      }
+    }
+  }
+
+  std::copy(B.begin(), B.end(), D);
+}
+
+/// @brief Compute the numeric ILU(k) factors of the subdomain matrix.
+//
+void factor(const FSILS_lhsType& lhs, const Array<double>& Val, IluFactor& ilu)
+{
+  int nNo = ilu.nNo;
+  int dof = ilu.dof;
+  int dd = dof*dof;
+  int nReq = ilu.send_idx.size();
+
+  ilu.val.assign(ilu.col.size()*dd, 0.0);
+
+  for (int e = 0; e < ilu.nnz; e++) {
+    double* v = &ilu.val[ilu.a_to_f[e]*dd];
+    for (int i = 0; i < dd; i++) {
+      v[i] += Val(i,e);
+    }
+  }
+
+  // Add the entries of the shared rows from the other processes.
+  //
+  if (nReq > 0) {
+    auto comm = lhs.commu.comm;
+    std::vector<MPI_Request> req(2*nReq);
+
+    for (int i = 0; i < nReq; i++) {
+      auto& cS = lhs.cS[i];
+      auto& buf = ilu.send_buf[i];
+
+      for (size_t n = 0; n < ilu.send_idx[i].size(); n++) {
+        int e = ilu.send_idx[i][n];
+        for (int k = 0; k < dd; k++) {
+          buf[n*dd+k] = Val(k,e);
+        }
+      }
+
+      MPI_Irecv(ilu.recv_buf[i].data(), ilu.recv_buf[i].size(), cm_mod::mpreal, cS.iP, value_tag, comm, &req[i]);
+      MPI_Isend(buf.data(), buf.size(), cm_mod::mpreal, cS.iP, value_tag, comm, &req[nReq+i]);
+    }
+
+    MPI_Waitall(2*nReq, req.data(), MPI_STATUSES_IGNORE);
+
+    for (int i = 0; i < nReq; i++) {
+      for (size_t n = 0; n < ilu.recv_idx[i].size(); n++) {
+        int f = ilu.recv_idx[i][n];
+        if (f < 0) {
+          continue;
+        }
+        for (int k = 0; k < dd; k++) {
+          ilu.val[f*dd+k] += ilu.recv_buf[i][n*dd+k];
+        }
+      }
+    }
+  }
+
+  // Row by row (IKJ) block elimination restricted to the pattern.
+  //
+  std::vector<int> pos(nNo, -1);
+  std::vector<double> L(dd);
+
+  for (int a = 0; a < nNo; a++) {
+    for (int f = ilu.ptr[a]; f < ilu.ptr[a+1]; f++) {
+      pos[ilu.col[f]] = f;
+    }
+
+    for (int f = ilu.ptr[a]; f < ilu.diag[a]; f++) {
+      int k = ilu.col[f];
+      block_mul(dof, &ilu.val[f*dd], &ilu.val[ilu.diag[k]*dd], L.data());
+      std::copy(L.begin(), L.end(), ilu.val.begin() + f*dd);
+
+      for (int g = ilu.diag[k]+1; g < ilu.ptr[k+1]; g++) {
+        int h = pos[ilu.col[g]];
+        if (h >= 0) {
+          block_mul_sub(dof, L.data(), &ilu.val[g*dd], &ilu.val[h*dd]);
+        }
+      }
+    }
+
+    invert_block(dof, a, &ilu.val[ilu.diag[a]*dd]);
+
+    for (int f = ilu.ptr[a]; f < ilu.ptr[a+1]; f++) {
+      pos[ilu.col[f]] = -1;
+    }
+  }
+}
+
+};
+
+/// @brief Compute the ILU(k) factors of the matrix Val, the symbolic 
+/// factorization is recomputed only if the lhs pattern, dof or level 
+/// of fill changed.
+//
+void ilu_setup(FSILS_lhsType& lhs, const int dof, const int fill, const Array<double>& Val, IluFactor& ilu)
+{
+  SV_PROFILE_REGION("ilu_setup");
+
+  if (!same_pattern(lhs, dof, fill, ilu)) {
+    symbolic(lhs, dof, fill, ilu);
+    exchange_plan(lhs, ilu);
+  }
+
+  factor(lhs, Val, ilu);
+}
+
+/// @brief Apply the preconditioner, X = M^-1 R.
+///
+/// X is consistent across processes.
+//
+void ilu_apply(const FSILS_lhsType& lhs, IluFactor& ilu, const Array<double>& R, Array<double>& X)
+{
+  SV_PROFILE_REGION("ilu_apply");
+
+  int nNo = ilu.nNo;
+  int dof = ilu.dof;
+  int dd = dof*dof;
+  int nFwd = ilu.fwd_ptr.size() - 1;
+  int nBwd = ilu.bwd_ptr.size() - 1;
+
+  for (int i = 0; i < R.size(); i++) {
+    X(i) = R(i);
+  }
+
+  double* x = X.data();
+  const double* v = ilu.val.data();
+
+  #pragma omp parallel
+  {
+    std::vector<double> t(dof);
+
+    // Forward substitution with the unit lower factor.
+    //
+    for (int l = 0; l < nFwd; l++) {
+      #pragma omp for schedule(static)
+      for (int n = ilu.fwd_ptr[l]; n < ilu.fwd_ptr[l+1]; n++) {
+        int a = ilu.fwd_rows[n];
+        double* xa = x + a*dof;
+
+        for (int f = ilu.ptr[a]; f < ilu.diag[a]; f++) {
+          const double* L = v + f*dd;
+          const double* xb = x + ilu.col[f]*dof;
+          for (int r = 0; r < dof; r++) {
+            for (int c = 0; c < dof; c++) {
+              xa[r] -= L[r*dof+c] * xb[c];
+            }
+          }
+        }
+      }
+    }
+
+    // Backward substitution with the upper factor.
+    //
+    for (int l = 0; l < nBwd; l++) {
+      #pragma omp for schedule(static)
+      for (int n = ilu.bwd_ptr[l]; n < ilu.bwd_ptr[l+1]; n++) {
+        int a = ilu.bwd_rows[n];
+        double* xa = x + a*dof;
+
+        for (int f = ilu.diag[a]+1; f < ilu.ptr[a+1]; f++) {
+          const double* U = v + f*dd;
+          const double* xb = x + ilu.col[f]*dof;
+          for (int r = 0; r < dof; r++) {
+            for (int c = 0; c < dof; c++) {
+              xa[r] -= U[r*dof+c] * xb[c];
+            }
+          }
+        }
+
+        const double* Dinv = v + ilu.diag[a]*dd;
+        for (int r = 0; r < dof; r++) {
+          t[r] = 0.0;
+          for (int c = 0; c < dof; c++) {
+            t[r] += Dinv[r*dof+c] * xa[c];
+          }
+        }
+        std::copy(t.begin(), t.end(), xa);
+      }
+    }
+  }
+
+  // Keep the values of the owned nodes and communicate them.
+  //
+  if (lhs.commu.nTasks > 1) {
+    for (int a = lhs.mynNo; a < nNo; a++) {
+      for (int i = 0; i < dof; i++) {
+        X(i,a) = 0.0;
+      }
+    }
+
+    fsils_commuv(lhs, dof, X);
+  }
+}
+
+};
@@ -0,0 +1,96 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FSI_LINEAR_SOLVER_ILU_H 
+#define FSI_LINEAR_SOLVER_ILU_H 
+
+#include "fils_struct.hpp"
+
+#include <vector>
+
+namespace ilu {
+
+using namespace fsi_linear_solver;
+
+/// @brief Node block incomplete LU factorization ILU(k) of the local 
+/// matrix of a process, used as a block Jacobi (restricted additive 
+/// Schwarz) preconditioner across processes.
+///
+/// The symbolic factorization, the level schedules of the triangular
+/// solves and the shared row exchange plan depend only on the lhs 
+/// sparsity pattern and are reused until the pattern changes.
+//
+class IluFactor
+{
+  public:
+    /// Degrees of freedom per node
+    int dof = 0;
+
+    /// Level of fill
+    int fill = -1;
+
+    /// The lhs pattern the symbolic factorization was computed for
+    int nNo = 0;
+    int nnz = 0;
+    std::vector<int> a_ptr;
+    std::vector<int> a_col;
+
+    /// Block CSR pattern of the factors with sorted columns, the 
+    /// strictly lower blocks store L (unit diagonal), the others 
+    /// store U with the inverse of the diagonal block at diag(a)
+    std::vector<int> ptr;
+    std::vector<int> col;
+    std::vector<int> diag;
+    std::vector<double> val;
+
+    /// Factor entry of each lhs matrix entry
+    std::vector<int> a_to_f;
+
+    /// Rows of the forward and backward substitutions grouped in 
+    /// levels of independent rows
+    std::vector<int> fwd_ptr, fwd_rows;
+    std::vector<int> bwd_ptr, bwd_rows;
+
+    /// Matrix entries sent to and factor entries receiving the values 
+    /// of each process sharing nodes with this one, -1 for an entry 
+    /// not in the pattern of the factors
+    std::vector<std::vector<int>> send_idx;
+    std::vector<std::vector<int>> recv_idx;
+    std::vector<std::vector<double>> send_buf;
+    std::vector<std::vector<double>> recv_buf;
+};
+
+void ilu_setup(FSILS_lhsType& lhs, const int dof, const int fill, const Array<double>& Val, IluFactor& ilu);
+
+void ilu_apply(const FSILS_lhsType& lhs, IluFactor& ilu, const Array<double>& R, Array<double>& X);
+
+};
+
+#endif
@@ -40,65 +40,127 @@
 
 #include "fsils.hpp"
 #include "CmMod.h"
+#include "Profiler.h"
 #include "Array3.h"
 
 #include "fsils_std.h"
 
 namespace fsi_linear_solver {
 
-void fsils_commus(const FSILS_lhsType& lhs, Vector<double>& R)
+namespace {
+
+/// @brief Returns true if there are no shared nodes to exchange.
+//
+bool no_commu(const FSILS_lhsType& lhs)
 {
-  if (lhs.commu.nTasks == 1) {
-    return;
+  return (lhs.commu.nTasks == 1) || (lhs.cS.size() == 0);
+}
+
+/// @brief Get the persistent communication plan for dof values per node,
+/// creating its buffers and requests the first time it is used.
+//
+FSILS_haloType& get_plan(const FSILS_lhsType& lhs, const int dof)
+{
+  auto& plan = lhs.halo[dof];
+
+  if (plan.dof == dof) {
+    return plan;
   }
 
   int nReq = lhs.nReq;
-  if (lhs.cS.size() == 0) {
+  int nmax = std::max_element(lhs.cS.begin(), lhs.cS.end(), 
+      [](const FSILS_cSType& a, const FSILS_cSType& b){return a.n < b.n;})->n; 
+
+  plan.dof = dof;
+  plan.nReq = nReq;
+  plan.sB.resize(dof*nmax, nReq);
+  plan.rB.resize(dof*nmax, nReq);
+  plan.rReq.resize(nReq);
+  plan.sReq.resize(nReq);
+
+  int mpi_tag = 1;
+
+  for (int i = 0; i < nReq; i++) {
+    MPI_Recv_init(plan.rB.col_data(i), lhs.cS[i].n*dof, mpreal, lhs.cS[i].iP, mpi_tag, lhs.commu.comm, &plan.rReq[i]);
+    MPI_Send_init(plan.sB.col_data(i), lhs.cS[i].n*dof, mpreal, lhs.cS[i].iP, mpi_tag, lhs.commu.comm, &plan.sReq[i]);
+  }
+
+  return plan;
+}
+
+/// @brief Pack the shared node values of R(dof,nNo) and start the 
+/// persistent sends and receives.
+//
+void commu_begin(const FSILS_lhsType& lhs, const int dof, const double* R)
+{
+  if (no_commu(lhs)) {
     return;
   }
 
-  int nmax = std::max_element(lhs.cS.begin(), lhs.cS.end(), 
-    [](const FSILS_cSType& a, const FSILS_cSType& b){return a.n < b.n;})->n; 
+  auto& plan = get_plan(lhs, dof);
 
-  Array<double> sB(nmax,nReq); 
-  Array<double> rB(nmax,nReq); 
-  std::vector<MPI_Request> rReq(nReq); 
-  std::vector<MPI_Request> sReq(nReq);
+  if (plan.active) {
+    throw std::runtime_error("[fsils_commu_begin] An exchange for dof " + std::to_string(dof) + " has already been started.");
+  }
 
-  for (int i = 0; i < nReq; i++) {
+  for (int i = 0; i < plan.nReq; i++) {
+    double* sB = plan.sB.col_data(i);
     for (int j = 0; j < lhs.cS[i].n; j++) { 
       int k = lhs.cS[i].ptr(j);
-      sB(j,i) = R(k);
+      for (int l = 0; l < dof; l++) { 
+        sB[j*dof+l] = R[k*dof+l];
+      }
     }
   }
 
-  int mpi_tag = 1;
+  MPI_Startall(plan.nReq, plan.rReq.data());
+  MPI_Startall(plan.nReq, plan.sReq.data());
+  plan.active = true;
+}
 
-  for (int i = 0; i < nReq; i++) {
-    auto rec_err = MPI_Irecv(rB.col_data(i), lhs.cS[i].n, mpreal, lhs.cS[i].iP, mpi_tag, lhs.commu.comm, &rReq[i]);
-    auto send_err = MPI_Isend(sB.col_data(i), lhs.cS[i].n, mpreal, lhs.cS[i].iP, mpi_tag, lhs.commu.comm, &sReq[i]);
+/// @brief Wait for the receives, add the received values to the 
+/// shared node values of R(dof,nNo) and wait for the sends.
+//
+void commu_end(const FSILS_lhsType& lhs, const int dof, double* R)
+{
+  if (no_commu(lhs)) {
+    return;
+  }
+
+  auto& plan = get_plan(lhs, dof);
+
+  if (!plan.active) {
+    throw std::runtime_error("[fsils_commu_end] No exchange for dof " + std::to_string(dof) + " has been started.");
   }
 
   // Wait for the MPI receive to complete.
   //
-  for (int i = 0; i < nReq; i++) {
-    MPI_Status stat;
-    auto err = MPI_Wait(&rReq[i], &stat);
-  }
+  MPI_Waitall(plan.nReq, plan.rReq.data(), MPI_STATUSES_IGNORE);
 
-  for (int i = 0; i < nReq; i++) {
+  for (int i = 0; i < plan.nReq; i++) {
+    const double* rB = plan.rB.col_data(i);
     for (int j = 0; j < lhs.cS[i].n; j++) { 
       int k = lhs.cS[i].ptr(j);
-      R(k) = R(k) + rB(j,i);
+      for (int l = 0; l < dof; l++) { 
+        R[k*dof+l] += rB[j*dof+l];
+      }
     }
   }
 
   // Wait for the MPI send to complete.
   //
-  for (int i = 0; i < nReq; i++) {
-    MPI_Status stat;
-    auto err = MPI_Wait(&sReq[i], &stat);
-  }
+  MPI_Waitall(plan.nReq, plan.sReq.data(), MPI_STATUSES_IGNORE);
+  plan.active = false;
+}
+
+};
+
+void fsils_commus(const FSILS_lhsType& lhs, Vector<double>& R)
+{
+  SV_PROFILE_REGION("fsils_commus");
+
+  commu_begin(lhs, 1, R.data());
+  commu_end(lhs, 1, R.data());
 }
 
 /// @brief This a both way communication with three main part:
@@ -110,65 +172,56 @@ void fsils_commus(const FSILS_lhsType& lhs, Vector<double>& R)
 //
 void fsils_commuv(const FSILS_lhsType& lhs, int dof, Array<double>& R)
 {
-  if (lhs.commu.nTasks == 1) {
-    return;
-  }
-
-  if (lhs.cS.size() == 0) {
-    return;
-  }
+  SV_PROFILE_REGION("fsils_commuv");
 
-  int nReq = lhs.nReq;
-  int nmax = std::max_element(lhs.cS.begin(), lhs.cS.end(), 
-      [](const FSILS_cSType& a, const FSILS_cSType& b){return a.n < b.n;})->n; 
-
-  Array3<double> sB(dof,nmax,nReq); 
-  Array3<double> rB(dof,nmax,nReq); 
-  std::vector<MPI_Request> rReq(nReq); 
-  std::vector<MPI_Request> sReq(nReq);
-
-  int n = 1;
+  commu_begin(lhs, dof, R.data());
+  commu_end(lhs, dof, R.data());
+}
 
-  for (int i = 0; i < nReq; i++) {
-    for (int j = 0; j < lhs.cS[i].n; j++) { 
-      int k = lhs.cS[i].ptr(j);
-      for (int l = 0; l < dof; l++) { 
-        sB(l,j,i) = R(l,k);
-      }
-    }
-  }
+/// @brief Start the nonblocking exchange of the shared node values of R(nNo).
+///
+/// R must not be modified at the shared nodes until fsils_commu_end() is called.
+//
+void fsils_commu_begin(const FSILS_lhsType& lhs, const Vector<double>& R)
+{
+  commu_begin(lhs, 1, R.data());
+}
 
-  int mpi_tag = 1;
+/// @brief Start the nonblocking exchange of the shared node values of R(dof,nNo).
+//
+void fsils_commu_begin(const FSILS_lhsType& lhs, const int dof, const Array<double>& R)
+{
+  commu_begin(lhs, dof, R.data());
+}
 
-  for (int i = 0; i < nReq; i++) {
-    auto rec_err = MPI_Irecv(rB.slice_data(i), lhs.cS[i].n*dof, mpreal, lhs.cS[i].iP, mpi_tag, lhs.commu.comm, &rReq[i]);
-    auto send_err = MPI_Isend(sB.slice_data(i), lhs.cS[i].n*dof, mpreal, lhs.cS[i].iP, mpi_tag, lhs.commu.comm, &sReq[i]);
-  }
+/// @brief Complete an exchange started by fsils_commu_begin(), summing the 
+/// values of R(nNo) at the shared nodes.
+//
+void fsils_commu_end(const FSILS_lhsType& lhs, Vector<double>& R)
+{
+  commu_end(lhs, 1, R.data());
+}
 
-  // Wait for the MPI receive to complete.
-  //
-  for (int i = 0; i < nReq; i++) {
-    MPI_Status stat;
-    auto err = MPI_Wait(&rReq[i], &stat);
-  }
+/// @brief Complete an exchange started by fsils_commu_begin(), summing the 
+/// values of R(dof,nNo) at the shared nodes.
+//
+void fsils_commu_end(const FSILS_lhsType& lhs, const int dof, Array<double>& R)
+{
+  commu_end(lhs, dof, R.data());
+}
 
-  for (int i = 0; i < nReq; i++) {
-    for (int j = 0; j < lhs.cS[i].n; j++) { 
-      int k = lhs.cS[i].ptr(j);
-      for (int l = 0; l < dof; l++) { 
-        R(l,k) = R(l,k) + rB(l,j,i);
-      }
+/// @brief Free the persistent communication plans of lhs.
+//
+void fsils_commu_plans_free(const FSILS_lhsType& lhs)
+{
+  for (auto& [dof, plan] : lhs.halo) {
+    for (int i = 0; i < plan.nReq; i++) {
+      MPI_Request_free(&plan.rReq[i]);
+      MPI_Request_free(&plan.sReq[i]);
     }
   }
 
-  // Wait for the MPI send to complete.
-  //
-  for (int i = 0; i < nReq; i++) {
-    MPI_Status stat;
-    auto err = MPI_Wait(&sReq[i], &stat);
-  }
+  lhs.halo.clear();
 }
 
 };
-
-
@@ -279,6 +279,10 @@ void fsils_lhs_create(FSILS_lhsType& lhs, FSILS_commuType& commu, int gnNo, int
   disp = 0;
   lhs.nReq = 0;
 
+  // The persistent communication plans are created on first use 
+  // for the new communication structure.
+  fsils_commu_plans_free(lhs);
+
   for (int i = 0; i < nTasks; i++) {
     if (i == tF) {
       continue; 
@@ -390,6 +394,8 @@ void fsils_lhs_free(FSILS_lhsType& lhs)
     //IF (ALLOCATED(lhs.cS(i).ptr)) DEALLOCATE(lhs.cS(i).ptr)
   }
 
+  fsils_commu_plans_free(lhs);
+
   lhs.foC = false;
   lhs.gnNo   = 0;
   lhs.nNo    = 0;
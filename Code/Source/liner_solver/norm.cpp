@@ -40,6 +40,8 @@
 #include "norm.h"
 
 #include "CmMod.h"
+#include "Profiler.h"
+#include "dot.h"
 
 #include "mpi.h"
 
@@ -49,11 +51,9 @@ namespace norm {
 
 double fsi_ls_norms(const int nNo, FSILS_commuType& commu, const Vector<double>& U)
 {
-  double result = 0.0;
+  SV_PROFILE_REGION("fsi_ls_norms");
 
-  for (int i = 0; i < nNo; i++) {
-    result = result + U(i)*U(i);
-  } 
+  double result = dot::fsils_nc_dot_s(nNo, U, U);
 
   if (commu.nTasks != 1) {
     double tmp;
@@ -66,41 +66,9 @@ double fsi_ls_norms(const int nNo, FSILS_commuType& commu, const Vector<double>&
 
 double fsi_ls_normv(const int dof, const int nNo, FSILS_commuType& commu, const Array<double>& U)
 {
-  double result = 0.0;
+  SV_PROFILE_REGION("fsi_ls_normv");
 
-  switch (dof) {
-    case 1: {
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*U(0,i);
-      }
-    } break; 
-
-    case 2: {
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*U(0,i) + U(1,i)*U(1,i);
-      }
-    } break; 
-
-    case 3: {
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*U(0,i) + U(1,i)*U(1,i) + U(2,i)*U(2,i);
-      }
-    } break; 
-
-    case 4: {
-      for (int i = 0; i < nNo; i++) {
-        result = result + U(0,i)*U(0,i) + U(1,i)*U(1,i) + U(2,i)*U(2,i) + U(3,i)*U(3,i);
-      }
-    } break; 
-
-    default: { 
-      for (int i = 0; i < nNo; i++) {
-        for (int j = 0; j < U.nrows(); j++) {
-          result = result + U(j,i)*U(j,i);
-        }
-      }
-    } break; 
-  } 
+  double result = dot::fsils_nc_dot_v(dof, nNo, U, U);
 
   if (commu.nTasks != 1) {
     double tmp;
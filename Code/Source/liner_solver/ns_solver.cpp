@@ -38,6 +38,7 @@
 #include "fils_struct.hpp"
 
 #include "add_bc_mul.h"
+#include "amg.h"
 #include "cgrad.h"
 #include "dot.h"
 #include "ge.h"
@@ -46,6 +47,7 @@
 #include "spar_mul.h"
 
 #include "Array3.h"
+#include "Profiler.h"
 
 #include <math.h>
 
@@ -158,14 +160,69 @@ void depart(fsi_linear_solver::FSILS_lhsType& lhs, const int nsd, const int dof,
   }
 }
 
+/// @brief Approximate the Schur complement S = L - Gt*G solved by 
+/// cgrad::schur() with a matrix on the node graph, used to build its 
+/// AMG preconditioner.
+///
+/// Products outside of the sparsity pattern are added to the diagonal.
+/// Each process only uses its own contributions to Gt and G, so the 
+/// products through nodes shared with other processes are approximate.
+///
+/// Modifies: S(1,nnz)
+//
+void schur_matrix(fsi_linear_solver::FSILS_lhsType& lhs, const int nsd, const Array<double>& Gt, const Array<double>& mG,
+    const Vector<double>& mL, Array<double>& S)
+{
+  const int nNo = lhs.nNo;
+  Vector<int> pos(nNo);
+  pos = -1;
+
+  for (int i = 0; i < nNo; i++) {
+    for (int j = lhs.rowPtr(0,i); j <= lhs.rowPtr(1,i); j++) {
+      pos(lhs.colPtr(j)) = j;
+      S(0,j) = mL(j);
+    }
+
+    int d = lhs.diagPtr(i);
+
+    for (int j = lhs.rowPtr(0,i); j <= lhs.rowPtr(1,i); j++) {
+      int k = lhs.colPtr(j);
+
+      for (int l = lhs.rowPtr(0,k); l <= lhs.rowPtr(1,k); l++) {
+        double v = 0.0;
+        for (int m = 0; m < nsd; m++) {
+          v += Gt(m,j) * mG(m,l);
+        }
+
+        int c = pos(lhs.colPtr(l));
+        if (c != -1) {
+          S(0,c) -= v;
+        } else {
+          S(0,d) += fabs(v);
+        }
+      }
+    }
+
+    for (int j = lhs.rowPtr(0,i); j <= lhs.rowPtr(1,i); j++) {
+      pos(lhs.colPtr(j)) = -1;
+    }
+  }
+}
+
 /// @brief This routine is mainley intended for solving incompressible NS or
 /// FSI equations with a form of AU=R, in which A = [K D;-G L] and
 /// G = -D^t
 ///
+/// If prec is PREC_FSILS_AMG the Schur complement solve is preconditioned 
+/// with AMG.
+///
 /// Ri (dof, lhs.nNo )
 //
-void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_lsType& ls, const int dof, const Array<double>& Val, Array<double>& Ri)
+void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_lsType& ls, const int dof, const Array<double>& Val, 
+    Array<double>& Ri, const consts::PreconditionerType prec)
 {
+  SV_PROFILE_REGION("ns_solver");
+
   using namespace consts;
   using namespace fsi_linear_solver;
 
@@ -249,6 +306,18 @@ void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_l
   //
   bc_pre(lhs, nsd, dof, nNo, mynNo);
 
+  // Build the AMG preconditioner for the Schur complement.
+  //
+  bool use_amg = (prec == PreconditionerType::PREC_FSILS_AMG);
+  amg::AmgHierarchy schur_amg;
+  Array<double> mS;
+
+  if (use_amg) {
+    mS.resize(1,nnz);
+    schur_matrix(lhs, nsd, Gt, mG, mL, mS);
+    amg::amg_setup(lhs, ls.amg, 1, mS, schur_amg);
+  }
+
   for (int faIn = 0; faIn < lhs.nFaces; faIn++) {
     auto& face = lhs.face[faIn];
     #ifdef debug_ns_solver
@@ -284,7 +353,11 @@ void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_l
     // Solve for U = inv(mK) * Rm
     //
     auto U_slice = U.slice(i);
-    gmres::gmres(lhs, ls.GM, nsd, mK, Rm, U_slice);
+    if (ls.GM.pipelined) {
+      gmres::pgmres(lhs, ls.GM, nsd, mK, Rm, U_slice);
+    } else {
+      gmres::gmres(lhs, ls.GM, nsd, mK, Rm, U_slice);
+    }
     U.set_slice(i, U_slice);
 
     // P = D*U
@@ -300,7 +373,11 @@ void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_l
     // P = [L + G^t*G]^-1*P
     //
     P_col = P.rcol(i);
-    cgrad::schur(lhs, ls.CG, nsd, Gt, mG, mL, P_col);
+    if (use_amg) {
+      cgrad::pschur(lhs, ls.CG, nsd, Gt, mG, mL, schur_amg, P_col);
+    } else {
+      cgrad::schur(lhs, ls.CG, nsd, Gt, mG, mL, P_col);
+    }
     //P.set_col(i, P_col);
 
     // MU1 = G*P
@@ -322,7 +399,11 @@ void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_l
     //
     lhs.debug_active = true;
     auto U_i = U.rslice(i);
-    gmres::gmres(lhs, ls.GM, nsd, mK, MU.slice(iBB), U_i);
+    if (ls.GM.pipelined) {
+      gmres::pgmres(lhs, ls.GM, nsd, mK, MU.slice(iBB), U_i);
+    } else {
+      gmres::gmres(lhs, ls.GM, nsd, mK, MU.slice(iBB), U_i);
+    }
     //U.set_slice(i, U_i);
 
     // MU2 = K*U
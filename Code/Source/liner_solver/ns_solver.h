@@ -29,6 +29,7 @@
  */
 
 #include "fils_struct.hpp"
+#include "consts.h"
 
 namespace ns_solver {
 
@@ -37,7 +38,11 @@ void bc_pre(fsi_linear_solver::FSILS_lhsType& lhs, const int nsd, const int dof,
 void depart(fsi_linear_solver::FSILS_lhsType& lhs, const int nsd, const int dof, const int nNo, const int nnz, 
     const Array<double>& Val, Array<double>& Gt, Array<double>& mK, Array<double>& mG, Array<double>& mD, Vector<double>& mL);
 
-void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_lsType& ls, const int dof, const Array<double>& Val, Array<double>& Ri);
+void ns_solver(fsi_linear_solver::FSILS_lhsType& lhs, fsi_linear_solver::FSILS_lsType& ls, const int dof, const Array<double>& Val, 
+    Array<double>& Ri, const consts::PreconditionerType prec);
+
+void schur_matrix(fsi_linear_solver::FSILS_lhsType& lhs, const int nsd, const Array<double>& Gt, const Array<double>& mG,
+    const Vector<double>& mL, Array<double>& S);
 
 
 };
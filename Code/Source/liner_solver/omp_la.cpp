@@ -29,17 +29,26 @@
  */
 
 // A bunch of operation that benefits from OMP hyperthreading
+//
+// The vector problem kernels operate on all dof*nNo entries at once when
+// the arrays have dof rows, otherwise only on the first dof rows of 
+// each column.
 
 #include "omp_la.h"
 
+#include <algorithm>
+
 namespace omp_la {
 
 /// @brief Reproduces 'SUBROUTINE OMPMULS (nNo, r, U)'.
 //
 void omp_mul_s(const int nNo, const double r, Vector<double>& U)
 {
+  double* u = U.data();
+
+  #pragma omp parallel for simd schedule(static) if(parallel: nNo > omp_min_size)
   for (int i = 0; i < nNo; i++) {
-    U(i) = r * U(i);
+    u[i] = r * u[i];
   }
 }
 
@@ -47,44 +56,24 @@ void omp_mul_s(const int nNo, const double r, Vector<double>& U)
 //
 void omp_mul_v(const int dof, const int nNo, const double r, Array<double>& U)
 {
-  switch (dof) {
-    case 1:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = r * U(0,i);
-      }
-    break;
-
-    case 2:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = r*U(0,i);
-        U(1,i) = r*U(1,i);
-      }
-    break;
-
-    case 3:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = r*U(0,i);
-        U(1,i) = r*U(1,i);
-        U(2,i) = r*U(2,i);
-      }
-    break;
-
-    case 4:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = r*U(0,i);
-        U(1,i) = r*U(1,i);
-        U(2,i) = r*U(2,i);
-        U(3,i) = r*U(3,i);
-      }
-    break;
-
-    default: 
-      for (int i = 0; i < nNo; i++) {
-        for (int j = 0; j < U.nrows(); j++) {
-          U(j,i) = r*U(j,i);
-        }
-        //U(:,i) = r*U(:,i)
+  double* u = U.data();
+  const int ld = U.nrows();
+
+  if (ld == dof) {
+    const int n = dof*nNo;
+
+    #pragma omp parallel for simd schedule(static) if(parallel: n > omp_min_size)
+    for (int i = 0; i < n; i++) {
+      u[i] = r * u[i];
+    }
+
+  } else {
+    #pragma omp parallel for schedule(static) if(parallel: dof*nNo > omp_min_size)
+    for (int i = 0; i < nNo; i++) {
+      for (int j = 0; j < dof; j++) {
+        u[i*ld+j] = r * u[i*ld+j];
       }
+    }
   }
 }
 
@@ -92,8 +81,12 @@ void omp_mul_v(const int dof, const int nNo, const double r, Array<double>& U)
 //
 void omp_sum_s(const int nNo, const double r, Vector<double>& U, const Vector<double>& V)
 {
+  double* u = U.data();
+  const double* v = V.data();
+
+  #pragma omp parallel for simd schedule(static) if(parallel: nNo > omp_min_size)
   for (int i = 0; i < nNo; i++) {
-    U(i) = U(i) + r*V(i);
+    u[i] = u[i] + r*v[i];
   }
 }
 
@@ -101,49 +94,105 @@ void omp_sum_s(const int nNo, const double r, Vector<double>& U, const Vector<do
 //
 void omp_sum_v(const int dof, const int nNo, const double r, Array<double>& U, const Array<double>& V)
 {
-  switch (dof) {
+  omp_axpby_v(dof, nNo, 1.0, U, r, V);
+}
 
-    case 1:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = U(0,i) + r*V(0,i);
+/// @brief U = a*U + b*V.
+//
+void omp_axpby_v(const int dof, const int nNo, const double a, Array<double>& U, const double b, const Array<double>& V)
+{
+  double* u = U.data();
+  const double* v = V.data();
+  const int ldu = U.nrows();
+  const int ldv = V.nrows();
+
+  if ((ldu == dof) && (ldv == dof)) {
+    const int n = dof*nNo;
+
+    #pragma omp parallel for simd schedule(static) if(parallel: n > omp_min_size)
+    for (int i = 0; i < n; i++) {
+      u[i] = a*u[i] + b*v[i];
+    }
+
+  } else {
+    #pragma omp parallel for schedule(static) if(parallel: dof*nNo > omp_min_size)
+    for (int i = 0; i < nNo; i++) {
+      for (int j = 0; j < dof; j++) {
+        u[i*ldu+j] = a*u[i*ldu+j] + b*v[i*ldv+j];
       }
-    break;
+    }
+  }
+}
 
-    case 2:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = U(0,i) + r*V(0,i);
-        U(1,i) = U(1,i) + r*V(1,i);
-      }
-    break;
+/// @brief U = U + sum_j r(j)*V(:,:,j), j = 0,...,n-1, in a single pass 
+/// over U.
+//
+void omp_msum_v(const int dof, const int nNo, const int n, const Vector<double>& r, Array<double>& U, 
+    const Array3<double>& V)
+{
+  if ((U.nrows() != dof) || (V.nrows() != dof)) {
+    for (int j = 0; j < n; j++) {
+      omp_sum_v(dof, nNo, r(j), U, V.rslice(j));
+    }
+    return;
+  }
 
-    case 3:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = U(0,i) + r*V(0,i);
-        U(1,i) = U(1,i) + r*V(1,i);
-        U(2,i) = U(2,i) + r*V(2,i);
-      }
-    break;
-
-    case 4:
-      for (int i = 0; i < nNo; i++) {
-        U(0,i) = U(0,i) + r*V(0,i);
-        U(1,i) = U(1,i) + r*V(1,i);
-        U(2,i) = U(2,i) + r*V(2,i);
-        U(3,i) = U(3,i) + r*V(3,i);
+  double* u = U.data();
+  const double* v = V.data();
+  const long long ls = (long long)V.nrows() * V.ncols();
+  const int ne = dof*nNo;
+
+  // Blocks of entries stay in cache while the n vectors are added.
+  //
+  const int nb = 1024;
+
+  #pragma omp parallel for schedule(static) if(parallel: ne > omp_min_size)
+  for (int b = 0; b < ne; b += nb) {
+    const int e = std::min(b + nb, ne);
+    for (int j = 0; j < n; j++) {
+      const double rj = r(j);
+      const double* vj = v + j*ls;
+      #pragma omp simd
+      for (int i = b; i < e; i++) {
+        u[i] += rj * vj[i];
       }
-    break;
-
-    default:
-      for (int j = 0; j < U.nrows(); j++) {
-        for (int i = 0; i < nNo; i++) {
-          U(j,i) = U(j,i) + r*V(j,i);
-        }
-        //U(:,i) = U(:,i) + r*V(:,i)
-      } 
+    }
   }
 }
 
+/// @brief U = U + r*V, returning the sum of the squares of U over the 
+/// owned nodes [0,mynNo) (not summed over the processes).
+//
+double omp_sum_nrm_v(const int dof, const int nNo, const int mynNo, const double r, Array<double>& U, 
+    const Array<double>& V)
+{
+  if ((U.nrows() != dof) || (V.nrows() != dof)) {
+    omp_sum_v(dof, nNo, r, U, V);
+    double result = 0.0;
+    for (int i = 0; i < mynNo; i++) {
+      for (int j = 0; j < dof; j++) {
+        result += U(j,i) * U(j,i);
+      }
+    }
+    return result;
+  }
 
-};
-
+  double* u = U.data();
+  const double* v = V.data();
+  const int nm = dof*mynNo;
+  double result = 0.0;
+
+  omp_reduce(dof*nNo, 1, &result, [&](const int begin, const int end, double* s) {
+    double sum = 0.0;
+    #pragma omp simd reduction(+:sum)
+    for (int i = begin; i < end; i++) {
+      u[i] = u[i] + r*v[i];
+      sum += (i < nm) ? u[i]*u[i] : 0.0;
+    }
+    s[0] += sum;
+  });
+
+  return result;
+}
 
+};
@@ -28,12 +28,78 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef FSI_LINEAR_SOLVER_OMP_LA_H 
+#define FSI_LINEAR_SOLVER_OMP_LA_H 
+
 #include "fils_struct.hpp"
 
+#include "Array3.h"
+
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Vector kernels of the linear solvers.
+//
+// The kernels work on the raw data of the arrays so the loops are 
+// vectorized (omp simd). When built with OpenMP (SV_USE_OPENMP) the 
+// loops are also split among the threads if the vectors have more than
+// omp_min_size entries, the number of threads is set at run time with 
+// OMP_NUM_THREADS. 
+//
+// Reductions are summed over a fixed partition of the entries and the 
+// partial sums are added in partition order, so results are reproducible 
+// for a given number of threads.
+
 namespace omp_la {
 
 using namespace fsi_linear_solver;
 
+/// @brief Vectors with fewer entries are processed by one thread.
+//
+constexpr int omp_min_size = 16384;
+
+/// @brief Compute the m sums s(0:m-1) of f(begin, end, s) over the 
+/// entries [0,n), f adds the sums of the entries [begin,end) to s.
+//
+template <typename F>
+void omp_reduce(const int n, const int m, double* s, const F& f)
+{
+  for (int j = 0; j < m; j++) {
+    s[j] = 0.0;
+  }
+
+  #ifdef _OPENMP
+  int nt = omp_get_max_threads();
+
+  if ((n > omp_min_size) && (nt > 1)) {
+    std::vector<double> part(nt*m, 0.0);
+
+    // The entries are split into nt fixed chunks shared among the threads 
+    // of the team, which may have fewer than nt threads (OMP_DYNAMIC, 
+    // thread limits or nested parallel regions).
+    //
+    #pragma omp parallel for schedule(static) num_threads(nt)
+    for (int t = 0; t < nt; t++) {
+      int begin = (long long)n * t / nt;
+      int end = (long long)n * (t+1) / nt;
+      f(begin, end, part.data() + t*m);
+    }
+
+    for (int t = 0; t < nt; t++) {
+      for (int j = 0; j < m; j++) {
+        s[j] += part[t*m+j];
+      }
+    }
+    return;
+  }
+  #endif
+
+  f(0, n, s);
+}
+
 void omp_mul_s(const int nNo, const double r, Vector<double>& U);
 
 void omp_mul_v(const int dof, const int nNo, const double r, Array<double>& U);
@@ -42,4 +108,14 @@ void omp_sum_s(const int nNo, const double r, Vector<double>& U, const Vector<do
 
 void omp_sum_v(const int dof, const int nNo, const double r, Array<double>& U, const Array<double>& V);
 
+void omp_axpby_v(const int dof, const int nNo, const double a, Array<double>& U, const double b, const Array<double>& V);
+
+void omp_msum_v(const int dof, const int nNo, const int n, const Vector<double>& r, Array<double>& U, 
+    const Array3<double>& V);
+
+double omp_sum_nrm_v(const int dof, const int nNo, const int mynNo, const double r, Array<double>& U, 
+    const Array<double>& V);
+
 };
+
+#endif
@@ -34,6 +34,7 @@
 #include "precond.h"
 
 #include "fsils_api.hpp"
+#include "Profiler.h"
 
 #include <math.h>
 
@@ -110,6 +111,79 @@ void pos_mul(const Array<int>& rowPtr, const Vector<int>& colPtr, const int nNo,
   }
 }
 
+//--------------
+// diag_scaling 
+//--------------
+// Set the symmetric Jacobi scaling W = diag(K)^{-1/2} from the diagonal 
+// entries of K stored in W, accounting for Dirichlet BCs, and scale R.
+//
+// Modifies: R, W, lhs.face.valM
+//
+void diag_scaling(fsi_linear_solver::FSILS_lhsType& lhs, const int dof, Array<double>& R, Array<double>& W)
+{
+  int nNo = lhs.nNo;
+
+  fsils_commuv(lhs, dof, W);
+
+  // Accounting for Dirichlet BC and inversing W = W^{-1/2}
+  //
+  for (int Ac = 0; Ac < nNo; Ac++) {
+    for (int i = 0; i < dof; i++) {
+      if (W(i,Ac) == 0.0) {
+        W(i,Ac) = 1.0;
+      }
+    }
+  }
+
+  for (int i = 0; i < W.size(); i++) {
+    W(i) = 1.0 / sqrt(fabs(W(i)));
+  }
+
+  for (int faIn = 0; faIn < lhs.nFaces; faIn++) {
+    auto& face = lhs.face[faIn];
+
+    if (!face.incFlag) {
+      continue;
+    }
+
+    int n = std::min(face.dof,dof);
+
+    if (face.bGrp == fsi_linear_solver::BcType::BC_TYPE_Dir) {
+      for (int a = 0; a < face.nNo; a++) {
+        int Ac = face.glob(a);
+        for (int i = 0; i < n; i++) {
+          W(i,Ac) = W(i,Ac) * face.val(i,a);
+        }
+      }
+    }
+  }
+
+  // Multipling R with W: R = W*R
+  //
+  // W ( dof, lhs.nNo )
+  //
+  // R ( dof, lhs.nNo )
+  //
+  // ELement-wise multiplication.
+  //
+  for (int i = 0; i < W.size(); i++) {
+    R(i) = W(i) * R(i);
+  }
+
+  for (int faIn = 0; faIn < lhs.nFaces; faIn++) {
+    auto& face = lhs.face[faIn];
+
+    if (face.coupledFlag) {
+      for (int a = 0; a < face.nNo; a++) {
+        int Ac = face.glob(a);
+        for (int i = 0; i < std::min(face.dof,dof); i++) {
+          face.valM(i,a) = face.val(i,a) * W(i,Ac);
+        }
+      }
+    }
+  }
+}
+
 //--------------
 // precond_diag 
 //--------------
@@ -122,6 +196,8 @@ void pos_mul(const Array<int>& rowPtr, const Vector<int>& colPtr, const int nNo,
 void precond_diag(fsi_linear_solver::FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr, 
     const Vector<int>& diagPtr, const int dof, Array<double>& Val, Array<double>& R, Array<double>& W)
 {
+  SV_PROFILE_REGION("precond_diag");
+
   #define n_debug_precond_diag
   #ifdef debug_precond_diag
   DebugMsg dmsg(__func__,  lhs.commu.task);
@@ -185,75 +261,40 @@ void precond_diag(fsi_linear_solver::FSILS_lhsType& lhs, const Array<int>& rowPt
     } break;
   }
 
-  fsils_commuv(lhs, dof, W);
-
-  // Accounting for Dirichlet BC and inversing W = W^{-1/2}
+  // Compute W = diag(K)^{-1/2} and R = W*R.
   //
-  for (int Ac = 0; Ac < nNo; Ac++) {
-    for (int i = 0; i < dof; i++) {
-      if (W(i,Ac) == 0.0) {
-        W(i,Ac) = 1.0;
-      }
-    }
-  }
-
-  for (int i = 0; i < W.size(); i++) {
-    W(i) = 1.0 / sqrt(fabs(W(i)));
-  }
-
-  for (int faIn = 0; faIn < lhs.nFaces; faIn++) {
-    auto& face = lhs.face[faIn];
-    #ifdef debug_precond_diag
-    dmsg << ">>> faIn: " << faIn;
-    dmsg << "face.incFlag: " << face.incFlag;
-    #endif
-
-    if (!face.incFlag) {
-      continue;
-    }
-
-    int n = std::min(face.dof,dof);
-
-    if (face.bGrp == fsi_linear_solver::BcType::BC_TYPE_Dir) {
-      for (int a = 0; a < face.nNo; a++) {
-        int Ac = face.glob(a);
-        for (int i = 0; i < n; i++) {
-          W(i,Ac) = W(i,Ac) * face.val(i,a);
-        }
-      }
-    }
-  }
+  diag_scaling(lhs, dof, R, W);
 
   // Pre-multipling K with W: K = W*K
   pre_mul(rowPtr, lhs.nNo, lhs.nnz, dof, Val, W);
 
-  // Multipling R with W: R = W*R
-  //
-  // W ( dof, lhs.nNo )
-  //
-  // R ( dof, lhs.nNo )
-  //
-  // ELement-wise multiplication.
-  //
-  for (int i = 0; i < W.size(); i++) {
-    R(i) = W(i) * R(i);
-  }
-
   // Now post-multipling K by W: K = K*W
   pos_mul(rowPtr, colPtr, lhs.nNo, lhs.nnz, dof, Val, W);
+}
 
-  for (int faIn = 0; faIn < lhs.nFaces; faIn++) {
-    auto& face = lhs.face[faIn];
+//-----------------
+// precond_diag_mf
+//-----------------
+// Jacobi symmetic preconditioner for a matrix-free operator. The
+// diagonal is taken from the assembled block diagonal D(dof*dof,nNo) 
+// and W is stored in lhs.mat_vec_W to scale the operator.
+//
+// Modifies: R, W, lhs.mat_vec_W
+//
+void precond_diag_mf(fsi_linear_solver::FSILS_lhsType& lhs, const int dof, const Array<double>& D, 
+    Array<double>& R, Array<double>& W)
+{
+  int nNo = lhs.nNo;
 
-    if (face.coupledFlag) {
-      for (int a = 0; a < face.nNo; a++) {
-        int Ac = face.glob(a);
-        for (int i = 0; i < std::min(face.dof,dof); i++) {
-          face.valM(i,a) = face.val(i,a) * W(i,Ac);
-        }
-      }
+  for (int Ac = 0; Ac < nNo; Ac++) {
+    for (int i = 0; i < dof; i++) {
+      W(i,Ac) = D(i*dof+i,Ac);
     }
   }
+
+  diag_scaling(lhs, dof, R, W);
+
+  lhs.mat_vec_W = W;
 }
 
 //-------------
@@ -266,6 +307,8 @@ void precond_diag(fsi_linear_solver::FSILS_lhsType& lhs, const Array<int>& rowPt
 void precond_rcs(fsi_linear_solver::FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr,
     const Vector<int>& diagPtr, const int dof, Array<double>& Val, Array<double>& R, Array<double>& W1, Array<double>& W2)
 {
+  SV_PROFILE_REGION("precond_rcs");
+
   const int nNo = lhs.nNo;
   int maxiter = 10;
   double tol = 2.0;
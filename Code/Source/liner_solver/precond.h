@@ -34,9 +34,14 @@ namespace precond {
 
 void pos_mul(const Array<int>& rowPtr, const Vector<int>& colPtr, const int nNo, const int nnz, const int dof, Array<double>& Val, const Array<double>& W);
 
+void diag_scaling(fsi_linear_solver::FSILS_lhsType& lhs, const int dof, Array<double>& R, Array<double>& W);
+
 void precond_diag(fsi_linear_solver::FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr, const Vector<int>& diagPtr, 
     const int dof, Array<double>& Val, Array<double>& R, Array<double>& W);
 
+void precond_diag_mf(fsi_linear_solver::FSILS_lhsType& lhs, const int dof, const Array<double>& D, 
+    Array<double>& R, Array<double>& W);
+
 void precond_rcs(fsi_linear_solver::FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr,
     const Vector<int>& diagPtr, const int dof, Array<double>& Val, Array<double>& R, Array<double>& W1, Array<double>& W2);
 
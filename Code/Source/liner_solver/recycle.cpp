@@ -0,0 +1,274 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Data reused between the linear solves of an equation.
+//
+// The solution of a linear solve is strongly correlated with the 
+// solutions of the previous Newton iterations and time steps. Two ways
+// to use this are implemented here
+//
+//   1) The initial guess of a solve is the combination of the last 
+//      solutions X_k that minimizes the residual |R - A X0|. The images 
+//      A X_k are orthonormalized so that X0 is the projection of the 
+//      solution onto span{X_k} in the A^T A inner product.
+//
+//   2) The GCRO-DR solver (gmres::gcrodr_v) deflates a subspace U of 
+//      approximate eigenvectors of the smallest eigenvalues of A. U is 
+//      updated at the end of each solve from the harmonic Ritz vectors 
+//      of the last GMRES cycle and is used with the matrix of the next 
+//      solve (Parks et al. 2006, Recycling Krylov subspaces for 
+//      sequences of linear systems).
+//
+// The system is solved with the diagonally scaled matrix, whose scaling
+// changes from one solve to the next. The solutions X_k are therefore 
+// stored unscaled, while the recycled subspace is only used to span the
+// deflation space and is stored as it is.
+
+#include "recycle.h"
+
+#include "add_bc_mul.h"
+#include "dot.h"
+#include "norm.h"
+#include "omp_la.h"
+#include "spar_mul.h"
+
+#include "eigen3/Eigen/Dense"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace recycle {
+
+/// @brief Set the number of solutions nX and recycled vectors nU kept
+/// for vectors of size (dof,nNo). The stored data is discarded if the 
+/// sizes change, e.g. after remeshing.
+//
+void recycle_init(RecycleSpace& space, const int dof, const int nNo, const int nX, const int nU)
+{
+  if ((space.dof == dof) && (space.nNo == nNo) && (space.X.nslices() == nX) && (space.U.nslices() == nU)) {
+    return;
+  }
+
+  space.dof = dof;
+  space.nNo = nNo;
+  space.nX = 0;
+  space.iX = 0;
+  space.nU = 0;
+
+  space.X.clear();
+  space.U.clear();
+
+  if (nX > 0) {
+    space.X.resize(dof, nNo, nX);
+  }
+
+  if (nU > 0) {
+    space.U.resize(dof, nNo, nU);
+  }
+}
+
+/// @brief Store the (unscaled) solution X of a solve, replacing the 
+/// oldest one when all slots are used.
+//
+void add_solution(RecycleSpace& space, const Array<double>& X)
+{
+  int n = space.X.nslices();
+
+  if (n == 0) {
+    return;
+  }
+
+  auto x = space.X.rslice(space.iX);
+  x = X;
+
+  space.iX = (space.iX + 1) % n;
+  space.nX = std::min(space.nX + 1, n);
+}
+
+/// @brief Compute the initial guess X0 from the stored solutions.
+///
+/// Val is the diagonally scaled matrix, W the column scaling so that 
+/// the unscaled solution is W*X. On return X0 minimizes |R - Val*X0| 
+/// over the span of the stored solutions, R is replaced by the residual 
+/// R - Val*X0 and its norm is returned.
+//
+double project_initial_guess(FSILS_lhsType& lhs, const RecycleSpace& space, const int dof, 
+    const Array<double>& Val, const Array<double>& W, Array<double>& R, Array<double>& X0)
+{
+  using namespace fsi_linear_solver;
+
+  int nNo = lhs.nNo;
+  int mynNo = lhs.mynNo;
+  int n = space.nX;
+
+  X0.resize(dof, nNo);
+  X0 = 0.0;
+
+  if (n == 0) {
+    return norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
+  }
+
+  // Orthonormalize the images Q = A*Z of the scaled solutions Z with 
+  // modified Gram-Schmidt, applying the same operations to Z. Solutions
+  // (nearly) linearly dependent on the previous ones are dropped.
+  //
+  Array3<double> Z(dof, nNo, n), Q(dof, nNo, n);
+  int m = 0;
+
+  for (int k = 0; k < n; k++) {
+    auto x = space.X.rslice(k);
+    auto z = Z.rslice(m);
+    auto q = Q.rslice(m);
+
+    for (int i = 0; i < z.size(); i++) {
+      z(i) = (W(i) != 0.0) ? x(i) / W(i) : 0.0;
+    }
+
+    spar_mul::fsils_mat_vec_v(lhs, dof, Val, z, q);
+    add_bc_mul::add_bc_mul(lhs, BcopType::BCOP_TYPE_ADD, dof, z, q);
+
+    double nrm0 = norm::fsi_ls_normv(dof, mynNo, lhs.commu, q);
+
+    for (int j = 0; j < m; j++) {
+      double h = dot::fsils_dot_v(dof, mynNo, lhs.commu, Q.rslice(j), q);
+      omp_la::omp_sum_v(dof, nNo, -h, q, Q.rslice(j));
+      omp_la::omp_sum_v(dof, nNo, -h, z, Z.rslice(j));
+    }
+
+    double nrm = norm::fsi_ls_normv(dof, mynNo, lhs.commu, q);
+
+    if (!(nrm > 1.0e-8 * nrm0)) {
+      continue;
+    }
+
+    omp_la::omp_mul_v(dof, nNo, 1.0/nrm, q);
+    omp_la::omp_mul_v(dof, nNo, 1.0/nrm, z);
+    m += 1;
+  }
+
+  for (int j = 0; j < m; j++) {
+    double a = dot::fsils_dot_v(dof, mynNo, lhs.commu, Q.rslice(j), R);
+    omp_la::omp_sum_v(dof, nNo, -a, R, Q.rslice(j));
+    omp_la::omp_sum_v(dof, nNo, a, X0, Z.rslice(j));
+  }
+
+  return norm::fsi_ls_normv(dof, mynNo, lhs.commu, R);
+}
+
+/// @brief Compute the k harmonic Ritz vectors P(n,k) for the harmonic 
+/// Ritz values of smallest magnitude of the generalized eigenvalue problem
+///
+///   G^T G p = theta G^T F p
+///
+/// with G and F of size (n+1,n). The real and imaginary parts of a 
+/// complex pair of vectors are returned as two real vectors. Returns an
+/// empty array if the eigenvalue problem can not be solved.
+//
+Array<double> harmonic_ritz_vectors(const Array<double>& G, const Array<double>& F, const int k)
+{
+  int nr = G.nrows();
+  int n = G.ncols();
+
+  Eigen::MatrixXd Ge(nr, n), Fe(nr, n);
+
+  for (int i = 0; i < nr; i++) {
+    for (int j = 0; j < n; j++) {
+      Ge(i,j) = G(i,j);
+      Fe(i,j) = F(i,j);
+    }
+  }
+
+  Eigen::MatrixXd GtF = Ge.transpose() * Fe;
+  Eigen::FullPivLU<Eigen::MatrixXd> lu(GtF);
+
+  if (!lu.isInvertible()) {
+    return Array<double>();
+  }
+
+  Eigen::MatrixXd M = lu.solve(Ge.transpose() * Ge);
+  Eigen::EigenSolver<Eigen::MatrixXd> es(M);
+
+  if (es.info() != Eigen::Success) {
+    return Array<double>();
+  }
+
+  auto theta = es.eigenvalues();
+  auto vec = es.eigenvectors();
+
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return std::abs(theta(a)) < std::abs(theta(b)); });
+
+  int nk = std::min(k, n);
+  Array<double> P(n, nk);
+  std::vector<bool> used(n, false);
+  int np = 0;
+
+  for (int l = 0; (l < n) && (np < nk); l++) {
+    int e = order[l];
+
+    if (used[e]) {
+      continue;
+    }
+    used[e] = true;
+
+    for (int i = 0; i < n; i++) {
+      P(i,np) = vec(i,e).real();
+    }
+    np += 1;
+
+    if (theta(e).imag() == 0.0) {
+      continue;
+    }
+
+    // Skip the conjugate eigenvalue, its vector spans the same 
+    // real subspace.
+    //
+    for (int l2 = l+1; l2 < n; l2++) {
+      int e2 = order[l2];
+      if (!used[e2] && (theta(e2) == std::conj(theta(e)))) {
+        used[e2] = true;
+        break;
+      }
+    }
+
+    if (np < nk) {
+      for (int i = 0; i < n; i++) {
+        P(i,np) = vec(i,e).imag();
+      }
+      np += 1;
+    }
+  }
+
+  return P;
+}
+
+};
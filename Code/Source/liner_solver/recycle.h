@@ -0,0 +1,79 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FSI_LINEAR_SOLVER_RECYCLE_H 
+#define FSI_LINEAR_SOLVER_RECYCLE_H 
+
+#include "fils_struct.hpp"
+
+#include "Array3.h"
+
+namespace recycle {
+
+using namespace fsi_linear_solver;
+
+/// @brief Data kept between the linear solves of an equation to speed 
+/// up the next solve.
+///
+/// The solutions of the last solves are used to project the initial 
+/// guess of the next solve. The recycled subspace U holds approximate 
+/// eigenvectors of the system matrix for the smallest eigenvalues, which 
+/// the GCRO-DR solver (gmres::gcrodr_v) deflates in the next solve.
+//
+class RecycleSpace
+{
+  public:
+    /// Size of the vectors, the data is discarded when these change
+    int dof = 0;
+    int nNo = 0;
+
+    /// Solutions of the last solves (dof,nNo,nX) stored cyclically 
+    /// in the unscaled space, iX is the slot of the next solution 
+    Array3<double> X;
+    int nX = 0;
+    int iX = 0;
+
+    /// Recycled subspace (dof,nNo,nU) in the scaled space
+    Array3<double> U;
+    int nU = 0;
+};
+
+void recycle_init(RecycleSpace& space, const int dof, const int nNo, const int nX, const int nU);
+
+void add_solution(RecycleSpace& space, const Array<double>& X);
+
+double project_initial_guess(FSILS_lhsType& lhs, const RecycleSpace& space, const int dof, 
+    const Array<double>& Val, const Array<double>& W, Array<double>& R, Array<double>& X0);
+
+Array<double> harmonic_ritz_vectors(const Array<double>& G, const Array<double>& F, const int k);
+
+};
+
+#endif
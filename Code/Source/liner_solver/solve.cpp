@@ -30,11 +30,17 @@
 
 #include "lhs.h"
 #include "CmMod.h"
+#include "Profiler.h"
+#include "amg.h"
 #include "bicgs.h"
 #include "cgrad.h"
+#include "forcing.h"
 #include "gmres.h"
+#include "ilu.h"
+#include "norm.h"
 #include "ns_solver.h"
 #include "precond.h"
+#include "recycle.h"
 
 namespace fsi_linear_solver {
 
@@ -50,6 +56,8 @@ namespace fsi_linear_solver {
 void fsils_solve(FSILS_lhsType& lhs, FSILS_lsType& ls, const int dof, Array<double>& Ri, Array<double>& Val, 
     const consts::PreconditionerType prec, const Vector<int>& incL, const Vector<double>& res)
 {
+  SV_PROFILE_REGION("fsils_solve");
+
   using namespace consts;
 
   #define n_debug_fsils_solve
@@ -123,8 +131,32 @@ void fsils_solve(FSILS_lhsType& lhs, FSILS_lsType& ls, const int dof, Array<doub
   //
   // Modifies Val and R.
   //
+  // A matrix-free operator is scaled using the block diagonal passed 
+  // in Val(dof*dof,nNo).
+  //
+  if (lhs.mat_vec) {
+    if (prec != PreconditionerType::PREC_FSILS) {
+      throw std::runtime_error("[fsils_solve] A matrix-free operator can only be used with the fsils preconditioner.");
+    }
+
+    bool gmres = (ls.LS_type == LinearSolverType::LS_TYPE_GMRES) || (ls.LS_type == LinearSolverType::LS_TYPE_PGMRES);
+
+    if (!gmres || (dof == 1)) {
+      throw std::runtime_error("[fsils_solve] A matrix-free operator can only be used with the GMRES solvers and dof > 1.");
+    }
+
+    Array<double> D(dof*dof,nNo);
 
-  if (prec == PreconditionerType::PREC_FSILS) {
+    for (int a = 0; a < nNo; a++) {
+      for (int i = 0; i < dof*dof; i++) {
+        D(i,lhs.map(a)) = Val(i,a);
+      }
+    }
+
+    precond::precond_diag_mf(lhs, dof, D, R, Wc);
+
+  } else if ((prec == PreconditionerType::PREC_FSILS) || (prec == PreconditionerType::PREC_FSILS_AMG) ||
+             (prec == PreconditionerType::PREC_FSILS_ILU)) {
     precond::precond_diag(lhs, lhs.rowPtr, lhs.colPtr, lhs.diagPtr, dof, Val, R, Wc);
   } else if (prec == PreconditionerType::PREC_RCS) {
     precond::precond_rcs(lhs, lhs.rowPtr, lhs.colPtr, lhs.diagPtr, dof, Val, R, Wr, Wc);
@@ -132,15 +164,101 @@ void fsils_solve(FSILS_lhsType& lhs, FSILS_lsType& ls, const int dof, Array<doub
     //PRINT *, "This linear solver and preconditioner combination is not supported."
   }
 
+  // The AMG preconditioner is built for the diagonally scaled matrix 
+  // and used with the CG and GMRES solvers, and for the Schur complement
+  // solve in the NS solver.
+  //
+  bool use_amg = (prec == PreconditionerType::PREC_FSILS_AMG);
+  amg::AmgHierarchy amg;
+
+  if (use_amg && (ls.LS_type != LinearSolverType::LS_TYPE_NS) && (ls.LS_type != LinearSolverType::LS_TYPE_CG) && 
+      (ls.LS_type != LinearSolverType::LS_TYPE_GMRES)) {
+    throw std::runtime_error("[fsils_solve] The fsils AMG preconditioner can only be used with the CG, GMRES and NS solvers.");
+  }
+
+  // The ILU preconditioner is built for the diagonally scaled matrix and 
+  // used with the GMRES solver. The factors are kept in 'ls' to reuse 
+  // their symbolic factorization in the following solves.
+  //
+  bool use_ilu = (prec == PreconditionerType::PREC_FSILS_ILU);
+
+  if (use_ilu) {
+    if (ls.LS_type != LinearSolverType::LS_TYPE_GMRES) {
+      throw std::runtime_error("[fsils_solve] The fsils ILU preconditioner can only be used with the GMRES solver.");
+    }
+
+    if (!ls.ilu) {
+      ls.ilu = std::make_shared<ilu::IluFactor>();
+    }
+  }
+
+  // Krylov subspace recycling is implemented by the GCRO-DR solver 
+  // which only uses the diagonal scaling of the matrix.
+  //
+  if (ls.recycle_size > 0) {
+    if ((ls.LS_type != LinearSolverType::LS_TYPE_GMRES) || use_amg || use_ilu) {
+      throw std::runtime_error("[fsils_solve] Krylov subspace recycling can only be used with the GMRES solver "
+          "and the fsils or rcs preconditioners.");
+    }
+  }
+
+  if ((ls.proj_size > 0) || (ls.recycle_size > 0)) {
+    if (!ls.recycle) {
+      ls.recycle = std::make_shared<recycle::RecycleSpace>();
+    }
+
+    recycle::recycle_init(*ls.recycle, dof, nNo, ls.proj_size, ls.recycle_size);
+  }
+
+  bool use_proj = (ls.proj_size > 0) && (ls.recycle->nX > 0);
+  bool use_forcing = (ls.forcing.type != ForcingTermType::FORCING_NONE);
+  double relTol = ls.RI.relTol;
+  double iNorm = 0.0;
+  Array<double> X0;
+
+  if (use_proj || use_forcing) {
+    iNorm = norm::fsi_ls_normv(dof, lhs.mynNo, lhs.commu, R);
+  }
+
+  // Set the relative tolerance of an inexact Newton iteration from the 
+  // residual norms of the previous iterations.
+  //
+  if (use_forcing) {
+    ls.RI.relTol = forcing::forcing_term(ls.forcing, relTol, iNorm);
+  }
+
+  // Project the initial guess X0 onto the previous solutions and solve 
+  // for the correction with the residual R - A*X0. The relative tolerance
+  // is scaled to still be relative to the norm of R.
+  //
+  if (use_proj) {
+    double rNorm = recycle::project_initial_guess(lhs, *ls.recycle, dof, Val, Wc, R, X0);
+
+    if (rNorm > 0.0) {
+      ls.RI.relTol = ls.RI.relTol * iNorm / rNorm;
+    }
+  }
+
   // Solve for 'R'.
   //
   switch (ls.LS_type) {
     case LinearSolverType::LS_TYPE_NS:
-      ns_solver::ns_solver(lhs, ls, dof, Val, R);
+      ns_solver::ns_solver(lhs, ls, dof, Val, R, prec);
     break;
 
     case LinearSolverType::LS_TYPE_GMRES:
-      if (dof == 1) {
+      if (use_amg) {
+        amg::amg_setup(lhs, ls.amg, dof, Val, amg);
+        gmres::fgmres_v(lhs, ls.RI, dof, Val, [&](const Array<double>& U, Array<double>& Z) {
+            amg::amg_apply(amg, U, Z); }, R);
+      } else if (use_ilu) {
+        auto& M = *ls.ilu;
+        ilu::ilu_setup(lhs, dof, ls.ilu_fill, Val, M);
+        gmres::fgmres_v(lhs, ls.RI, dof, Val, [&](const Array<double>& U, Array<double>& Z) {
+            ilu::ilu_apply(lhs, M, U, Z); }, R);
+      } else if (ls.recycle_size > 0) {
+        gmres::gcrodr_v(lhs, ls.RI, dof, Val, *ls.recycle, R);
+      } else if (dof == 1) {
         auto Valv = Val.row(0);
         auto Rv = R.row(0);
         gmres::gmres_s(lhs, ls.RI, dof, Valv, Rv);
@@ -151,8 +269,16 @@ void fsils_solve(FSILS_lhsType& lhs, FSILS_lsType& ls, const int dof, Array<doub
       }
     break;
 
+    // The pipelined solver treats a scalar problem as a vector problem with dof = 1.
+    case LinearSolverType::LS_TYPE_PGMRES:
+      gmres::pgmres_v(lhs, ls.RI, dof, Val, R);
+    break;
+
     case LinearSolverType::LS_TYPE_CG:
-      if (dof == 1) {
+      if (use_amg) {
+        amg::amg_setup(lhs, ls.amg, dof, Val, amg);
+        cgrad::pcgrad_v(lhs, ls.RI, dof, Val, amg, R);
+      } else if (dof == 1) {
         auto Valv = Val.row(0);
         auto Rv = R.row(0);
         cgrad::cgrad_s(lhs, ls.RI, Valv, Rv);
@@ -179,12 +305,27 @@ void fsils_solve(FSILS_lhsType& lhs, FSILS_lsType& ls, const int dof, Array<doub
       throw std::runtime_error("FSILS: LS_type not defined");
   }
 
+  if (use_proj) {
+    R = R + X0;
+    ls.RI.iNorm = iNorm;
+  }
+
+  if (use_forcing) {
+    forcing::forcing_update(ls.forcing, ls.RI.iNorm, ls.RI.fNorm);
+  }
+
+  ls.RI.relTol = relTol;
+
   // Element-wise multiplication.
   //
   for (int i = 0; i < Wc.size(); i++) {
     R(i) = Wc(i) * R(i);
   }
 
+  if (ls.proj_size > 0) {
+    recycle::add_solution(*ls.recycle, R);
+  }
+
   for (int a = 0; a < nNo; a++) {
     for (int i = 0; i < R.nrows(); i++) {
       Ri(i,a) = R(i,lhs.map(a));
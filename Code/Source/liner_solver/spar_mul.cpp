@@ -36,26 +36,84 @@
 // Reproduces code in SPARMUL.f.
 
 #include "spar_mul.h"
+#include "spar_mul_block.h"
 
 #include "fsils_api.hpp"
+#include "Profiler.h"
 
 namespace spar_mul {
 
+namespace {
+
+void commu_begin(const FSILS_lhsType& lhs, const int dof, const Vector<double>& KU)
+{
+  fsils_commu_begin(lhs, KU);
+}
+
+void commu_begin(const FSILS_lhsType& lhs, const int dof, const Array<double>& KU)
+{
+  fsils_commu_begin(lhs, dof, KU);
+}
+
+void commu_end(const FSILS_lhsType& lhs, const int dof, Vector<double>& KU)
+{
+  fsils_commu_end(lhs, KU);
+}
+
+void commu_end(const FSILS_lhsType& lhs, const int dof, Array<double>& KU)
+{
+  fsils_commu_end(lhs, dof, KU);
+}
+
+/// @brief Compute the rows of KU = K*U using mul_rows(begin,end) and sum 
+/// KU at the nodes shared with other processes.
+///
+/// The nodes shared with other processes are numbered [0,shnNo) and 
+/// [mynNo,nNo). These rows are computed first and their exchange started,
+/// the interior rows [shnNo,mynNo) are then computed while the messages 
+/// are in flight.
+//
+template <typename T, typename RowFunc>
+void mul_rows_commu(FSILS_lhsType& lhs, const int dof, T& KU, RowFunc mul_rows)
+{
+  int nNo = lhs.nNo;
+
+  if ((lhs.commu.nTasks == 1) || (lhs.cS.size() == 0)) {
+    mul_rows(0, nNo);
+    return;
+  }
+
+  mul_rows(0, lhs.shnNo);
+  mul_rows(lhs.mynNo, nNo);
+
+  commu_begin(lhs, dof, KU);
+
+  mul_rows(lhs.shnNo, lhs.mynNo);
+
+  commu_end(lhs, dof, KU);
+}
+
+};
+
 /// @brief Reproduces 'SUBROUTINE FSILS_SPARMULSS(lhs, rowPtr, colPtr, K, U, KU)'
 //
 void fsils_spar_mul_ss(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr, 
     const Vector<double>& K, const Vector<double>& U, Vector<double>& KU)
 {
-  int nNo = lhs.nNo;
+  SV_PROFILE_REGION("fsils_spar_mul_ss");
+
   KU = 0.0;
 
-  for (int i = 0; i < nNo; i++) {
-    for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-      KU(i) = KU(i) + K(j) * U(colPtr(j));
-    } 
-  }
+  auto mul_rows = [&](const int begin, const int end)
+  {
+    for (int i = begin; i < end; i++) {
+      for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+        KU(i) = KU(i) + K(j) * U(colPtr(j));
+      } 
+    }
+  };
 
-  fsils_commus(lhs, KU);
+  mul_rows_commu(lhs, 1, KU, mul_rows);
 }
 
 /// @brief Reproduces 'SUBROUTINE FSILS_SPARMULSV(lhs, rowPtr, colPtr, dof, K, U, KU)'. 
@@ -63,65 +121,69 @@ void fsils_spar_mul_ss(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vecto
 void fsils_spar_mul_sv(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr, 
     const int dof, const Array<double>& K, const Vector<double>& U, Array<double>& KU)
 {
-  int nNo = lhs.nNo;
+  SV_PROFILE_REGION("fsils_spar_mul_sv");
+
   KU = 0.0;
 
-  switch (dof) {
+  auto mul_rows = [&](const int begin, const int end)
+  {
+    switch (dof) {
 
-    case 1:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          KU(0,i) = KU(0,i) + K(0,j)*U(colPtr(j));
+      case 1:
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            KU(0,i) = KU(0,i) + K(0,j)*U(colPtr(j));
+          }
         }
-      }
-    break; 
-
-    case 2: {
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(0,i) = KU(0,i) + K(0,j)*U(col);
-          KU(1,i) = KU(1,i) + K(1,j)*U(col);
+      break; 
+
+      case 2: {
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            KU(0,i) = KU(0,i) + K(0,j)*U(col);
+            KU(1,i) = KU(1,i) + K(1,j)*U(col);
+          }
         }
-      }
 
-    } break; 
+      } break; 
 
-    case 3: {
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(0,i) += K(0,j) * U(col);
-          KU(1,i) += K(1,j) * U(col);
-          KU(2,i) += K(2,j) * U(col);
+      case 3: {
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            KU(0,i) += K(0,j) * U(col);
+            KU(1,i) += K(1,j) * U(col);
+            KU(2,i) += K(2,j) * U(col);
+          }
         }
-      }
-    } break; 
-
-    case 4:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(0,i) = KU(0,i) + K(0,j)*U(col);
-          KU(1,i) = KU(1,i) + K(1,j)*U(col);
-          KU(2,i) = KU(2,i) + K(2,j)*U(col);
-          KU(3,i) = KU(3,i) + K(3,j)*U(col);
+      } break; 
+
+      case 4:
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            KU(0,i) = KU(0,i) + K(0,j)*U(col);
+            KU(1,i) = KU(1,i) + K(1,j)*U(col);
+            KU(2,i) = KU(2,i) + K(2,j)*U(col);
+            KU(3,i) = KU(3,i) + K(3,j)*U(col);
+          }
         }
-      }
-    break; 
-
-    default: 
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          for (int m = 0; m < KU.nrows(); m++) {
-            KU(m,i) = KU(m,i) + K(m,j) * U(col);
+      break; 
+
+      default: 
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            for (int m = 0; m < KU.nrows(); m++) {
+              KU(m,i) = KU(m,i) + K(m,j) * U(col);
+            }
           }
         }
-      }
-  } 
+    }
+  };
 
-  fsils_commuv(lhs, dof, KU);
+  mul_rows_commu(lhs, dof, KU, mul_rows);
 }
 
 /// @brief Reproduces 'SUBROUTINE FSILS_SPARMULVS(lhs, rowPtr, colPtr, dof, K, U, KU)'.
@@ -129,134 +191,130 @@ void fsils_spar_mul_sv(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vecto
 void fsils_spar_mul_vs(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr, 
     const int dof, const Array<double>& K, const Array<double>& U, Vector<double>& KU)
 {
-  int nNo = lhs.nNo;
+  SV_PROFILE_REGION("fsils_spar_mul_vs");
+
   KU = 0.0;
 
-  switch (dof) {
+  auto mul_rows = [&](const int begin, const int end)
+  {
+    switch (dof) {
 
-    case 1:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          KU(i) = KU(i) + K(0,j) * U(0,colPtr(j));
-        }
-      }
-    break; 
-
-    case 2:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(i) = KU(i) + K(0,j)*U(0,col) + K(1,j)*U(1,col);
+      case 1:
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            KU(i) = KU(i) + K(0,j) * U(0,colPtr(j));
+          }
         }
-      }
-    break; 
-
-    case 3:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(i) = KU(i) + K(0,j)*U(0,col) + K(1,j)*U(1,col) + K(2,j)*U(2,col);
+      break; 
+
+      case 2:
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            KU(i) = KU(i) + K(0,j)*U(0,col) + K(1,j)*U(1,col);
+          }
         }
-      }
-    break; 
-
-    case 4:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(i) = KU(i) + K(0,j)*U(0,col) + K(1,j)*U(1,col) + K(2,j)*U(2,col) + K(3,j)*U(3,col);
+      break; 
+
+      case 3:
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            KU(i) = KU(i) + K(0,j)*U(0,col) + K(1,j)*U(1,col) + K(2,j)*U(2,col);
+          }
         }
-      }
-    break; 
-
-    default: 
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          double sum = 0.0;
-          for (int m = 0; m < K.nrows(); m++) {
-            sum += K(m,j) * U(m,col);
+      break; 
+
+      case 4:
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            KU(i) = KU(i) + K(0,j)*U(0,col) + K(1,j)*U(1,col) + K(2,j)*U(2,col) + K(3,j)*U(3,col);
           }
-          KU(i) = KU(i) + sum; 
-          //KU(i) = KU(i) + SUM(K(:,j)*U(:,colPtr(j)))
         }
-     }
-  } 
+      break; 
 
-  fsils_commus(lhs, KU);
+      default: 
+        for (int i = begin; i < end; i++) {
+          for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+            int col = colPtr(j);
+            double sum = 0.0;
+            for (int m = 0; m < K.nrows(); m++) {
+              sum += K(m,j) * U(m,col);
+            }
+            KU(i) = KU(i) + sum; 
+            //KU(i) = KU(i) + SUM(K(:,j)*U(:,colPtr(j)))
+          }
+       }
+    }
+  };
+
+  mul_rows_commu(lhs, 1, KU, mul_rows);
 }
 
 /// @brief Reproduces 'SUBROUTINE FSILS_SPARMULVV(lhs, rowPtr, colPtr, dof, K, U, KU)'. 
+///
+/// Fixed block size kernels are used for the common dof values when they
+/// are compiled with SIMD instructions (SV_USE_NATIVE_ARCH).
 //
 void fsils_spar_mul_vv(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr, 
     const int dof, const Array<double>& K, const Array<double>& U, Array<double>& KU)
 {
+  SV_PROFILE_REGION("fsils_spar_mul_vv");
+
+  bool use_block = block_size_vectorized(dof);
+
+  auto mul_rows = [&](const int begin, const int end)
+  {
+    if (use_block) {
+      spar_mul_vv_block(begin, end, rowPtr, colPtr, dof, K, U, KU);
+    } else {
+      spar_mul_vv_csr(begin, end, rowPtr, colPtr, dof, K, U, KU);
+    }
+  };
+
+  mul_rows_commu(lhs, dof, KU, mul_rows);
+}
+
+/// @brief Product of the preconditioned system matrix and a vector, KU = K*U.
+///
+/// If the lhs has a matrix-free operator (lhs.mat_vec) it is applied to the
+/// diagonally scaled vector, KU = W*K*W*U, instead of multiplying by the
+/// assembled matrix K.
+//
+void fsils_mat_vec_v(FSILS_lhsType& lhs, const int dof, const Array<double>& K, const Array<double>& U, 
+    Array<double>& KU)
+{
+  if (!lhs.mat_vec) {
+    fsils_spar_mul_vv(lhs, lhs.rowPtr, lhs.colPtr, dof, K, U, KU);
+    return;
+  }
+
   int nNo = lhs.nNo;
-  KU = 0.0;
+  const auto& W = lhs.mat_vec_W;
+  Array<double> Ul(dof,nNo), KUl(dof,nNo);
+
+  for (int a = 0; a < nNo; a++) {
+    int Ac = lhs.map(a);
+    for (int i = 0; i < dof; i++) {
+      Ul(i,a) = W(i,Ac) * U(i,Ac);
+    }
+  }
 
-  switch (dof) {
+  lhs.mat_vec(Ul, KUl);
 
-    case 1:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          KU(0,i) = KU(0,i) + K(0,j)*U(0,colPtr(j));
-        }
-      }
-    break;
-
-    case 2:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(0,i) = KU(0,i) + K(0,j)*U(0,col) + K(1,j)*U(1,col);
-          KU(1,i) = KU(1,i) + K(2,j)*U(0,col) + K(3,j)*U(1,col);
-        }
-      }
-    break;
-
-    case 3:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(0,i) = KU(0,i) + K(0,j)*U(0,col) + K(1,j)*U(1,col) + K(2,j)*U(2,col);
-          KU(1,i) = KU(1,i) + K(3,j)*U(0,col) + K(4,j)*U(1,col) + K(5,j)*U(2,col);
-          KU(2,i) = KU(2,i) + K(6,j)*U(0,col) + K(7,j)*U(1,col) + K(8,j)*U(2,col);
-        }
-      }
-    break;
-
-    case 4:
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          KU(0,i) = KU(0,i) + K(0 ,j)*U(0,col) + K(1 ,j)*U(1,col) + K(2 ,j)*U(2,col) + K(3 ,j)*U(3,col);
-          KU(1,i) = KU(1,i) + K(4 ,j)*U(0,col) + K(5 ,j)*U(1,col) + K(6 ,j)*U(2,col) + K(7 ,j)*U(3,col);
-          KU(2,i) = KU(2,i) + K(8 ,j)*U(0,col) + K(9,j)*U(1,col) + K(10,j)*U(2,col) + K(11,j)*U(3,col);
-          KU(3,i) = KU(3,i) + K(12,j)*U(0,col) + K(13,j)*U(1,col) + K(14,j)*U(2,col) + K(15,j)*U(3,col);
-        }
-      }
-    break;
-
-    default: 
-      for (int i = 0; i < nNo; i++) {
-        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
-          int col = colPtr(j);
-          for (int l = 0; l < dof; l++) {
-            int e = l*dof;
-            int s = e - dof + 1;;
-            double sum = 0.0;
-            for (int k = 0; k < dof; k++) {
-              sum += K(k+s,j) * U(k,col);
-            }
-            KU(l,i) = KU(l,i) + sum;
-          }
-        }
-     }
-  } 
+  for (int a = 0; a < nNo; a++) {
+    int Ac = lhs.map(a);
+    for (int i = 0; i < dof; i++) {
+      KU(i,Ac) = KUl(i,a);
+    }
+  }
 
   fsils_commuv(lhs, dof, KU);
+
+  for (int i = 0; i < KU.size(); i++) {
+    KU(i) = W(i) * KU(i);
+  }
 }
 
 };
-
-
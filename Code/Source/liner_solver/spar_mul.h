@@ -46,4 +46,7 @@ void fsils_spar_mul_vs(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vecto
 void fsils_spar_mul_vv(FSILS_lhsType& lhs, const Array<int>& rowPtr, const Vector<int>& colPtr,
     const int dof, const Array<double>& K, const Array<double>& U, Array<double>& KU);
 
+void fsils_mat_vec_v(FSILS_lhsType& lhs, const int dof, const Array<double>& K, const Array<double>& U, 
+    Array<double>& KU);
+
 };
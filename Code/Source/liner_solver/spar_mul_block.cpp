@@ -0,0 +1,360 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Block sparse matrix-vector products KU = K*U. 
+//
+// The fsils matrix K(dof*dof,nnz) stores a dense dof x dof block for each 
+// nonzero of the node graph, row-major within the block. The kernels here 
+// use a fixed block size and raw pointers into K, U and KU so the block 
+// products can be unrolled and vectorized. Explicit AVX2 (dof = 2, 3, 4) 
+// and AVX-512 (dof = 7) versions are used when the code is compiled for 
+// those instruction sets, otherwise a scalar version is used.
+//
+// The product is not communicated across processes.
+
+#include "spar_mul_block.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace spar_mul {
+
+namespace {
+
+/// @brief Scalar block product for a fixed block size N.
+//
+template <int N>
+void block_mul_scalar(const int begin, const int end, const int* rowPtr, const int* colPtr, const double* K, 
+    const double* U, double* KU)
+{
+  for (int i = begin; i < end; i++) {
+    double sum[N] = {};
+
+    for (int j = rowPtr[2*i]; j <= rowPtr[2*i+1]; j++) {
+      const double* Kj = K + N*N*j;
+      const double* Uc = U + N*colPtr[j];
+
+      for (int l = 0; l < N; l++) {
+        for (int k = 0; k < N; k++) {
+          sum[l] += Kj[l*N+k] * Uc[k];
+        }
+      }
+    }
+
+    for (int l = 0; l < N; l++) {
+      KU[N*i+l] = sum[l];
+    }
+  }
+}
+
+/// @brief Block product for a fixed block size N.
+//
+template <int N>
+void block_mul(const int begin, const int end, const int* rowPtr, const int* colPtr, const double* K, 
+    const double* U, double* KU)
+{
+  block_mul_scalar<N>(begin, end, rowPtr, colPtr, K, U, KU);
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+/// @brief Sum the lanes of four vectors, returns {sum(a), sum(b), sum(c), sum(d)}.
+//
+inline __m256d hsum4(__m256d a, __m256d b, __m256d c, __m256d d)
+{
+  __m256d ab = _mm256_hadd_pd(a, b);
+  __m256d cd = _mm256_hadd_pd(c, d);
+  __m256d lo = _mm256_permute2f128_pd(ab, cd, 0x20);
+  __m256d hi = _mm256_permute2f128_pd(ab, cd, 0x31);
+  return _mm256_add_pd(lo, hi);
+}
+
+/// @brief AVX2 2x2 block product. 
+///
+/// A block [k00 k01 k10 k11] is multiplied by [u0 u1 u0 u1] and 
+/// the pairs of lanes summed.
+//
+template <>
+void block_mul<2>(const int begin, const int end, const int* rowPtr, const int* colPtr, const double* K, 
+    const double* U, double* KU)
+{
+  for (int i = begin; i < end; i++) {
+    __m256d sum = _mm256_setzero_pd();
+
+    for (int j = rowPtr[2*i]; j <= rowPtr[2*i+1]; j++) {
+      __m256d u = _mm256_broadcast_pd(reinterpret_cast<const __m128d*>(U + 2*colPtr[j]));
+      sum = _mm256_fmadd_pd(_mm256_loadu_pd(K + 4*j), u, sum);
+    }
+
+    __m256d s = _mm256_hadd_pd(sum, sum);
+    __m128d r = _mm_unpacklo_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    _mm_storeu_pd(KU + 2*i, r);
+  }
+}
+
+/// @brief AVX2 3x3 block product. 
+///
+/// Block rows and U are loaded into the first three lanes of a vector 
+/// with a mask so nothing is read past the end of K or U.
+//
+template <>
+void block_mul<3>(const int begin, const int end, const int* rowPtr, const int* colPtr, const double* K, 
+    const double* U, double* KU)
+{
+  const __m256i mask = _mm256_set_epi64x(0, -1, -1, -1);
+  const __m256d zero = _mm256_setzero_pd();
+
+  for (int i = begin; i < end; i++) {
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd();
+
+    for (int j = rowPtr[2*i]; j <= rowPtr[2*i+1]; j++) {
+      const double* Kj = K + 9*j;
+      __m256d u = _mm256_maskload_pd(U + 3*colPtr[j], mask);
+      sum0 = _mm256_fmadd_pd(_mm256_maskload_pd(Kj, mask), u, sum0);
+      sum1 = _mm256_fmadd_pd(_mm256_maskload_pd(Kj+3, mask), u, sum1);
+      sum2 = _mm256_fmadd_pd(_mm256_maskload_pd(Kj+6, mask), u, sum2);
+    }
+
+    _mm256_maskstore_pd(KU + 3*i, mask, hsum4(sum0, sum1, sum2, zero));
+  }
+}
+
+/// @brief AVX2 4x4 block product. 
+///
+/// Each block row is a full vector. The four row sums are accumulated 
+/// over the nonzeros of a row and only reduced once per row.
+//
+template <>
+void block_mul<4>(const int begin, const int end, const int* rowPtr, const int* colPtr, const double* K, 
+    const double* U, double* KU)
+{
+  for (int i = begin; i < end; i++) {
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd();
+    __m256d sum3 = _mm256_setzero_pd();
+
+    for (int j = rowPtr[2*i]; j <= rowPtr[2*i+1]; j++) {
+      const double* Kj = K + 16*j;
+      __m256d u = _mm256_loadu_pd(U + 4*colPtr[j]);
+      sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(Kj), u, sum0);
+      sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(Kj+4), u, sum1);
+      sum2 = _mm256_fmadd_pd(_mm256_loadu_pd(Kj+8), u, sum2);
+      sum3 = _mm256_fmadd_pd(_mm256_loadu_pd(Kj+12), u, sum3);
+    }
+
+    _mm256_storeu_pd(KU + 4*i, hsum4(sum0, sum1, sum2, sum3));
+  }
+}
+
+#endif
+
+#if defined(__AVX512F__)
+
+/// @brief AVX-512 7x7 block product. 
+///
+/// Block rows and U are loaded into the first seven lanes of a vector 
+/// with a mask.
+//
+template <>
+void block_mul<7>(const int begin, const int end, const int* rowPtr, const int* colPtr, const double* K, 
+    const double* U, double* KU)
+{
+  const __mmask8 mask = 0x7f;
+
+  for (int i = begin; i < end; i++) {
+    __m512d sum[7];
+    for (int l = 0; l < 7; l++) {
+      sum[l] = _mm512_setzero_pd();
+    }
+
+    for (int j = rowPtr[2*i]; j <= rowPtr[2*i+1]; j++) {
+      const double* Kj = K + 49*j;
+      __m512d u = _mm512_maskz_loadu_pd(mask, U + 7*colPtr[j]);
+      for (int l = 0; l < 7; l++) {
+        sum[l] = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, Kj + 7*l), u, sum[l]);
+      }
+    }
+
+    for (int l = 0; l < 7; l++) {
+      KU[7*i+l] = _mm512_reduce_add_pd(sum[l]);
+    }
+  }
+}
+
+#endif
+
+};
+
+/// @brief Returns true if there is a fixed block size kernel for dof.
+//
+bool block_size_supported(const int dof)
+{
+  return (dof == 2) || (dof == 3) || (dof == 4) || (dof == 7);
+}
+
+/// @brief Returns true if the fixed block size kernel for dof uses SIMD 
+/// instructions. 
+///
+/// The scalar block kernels are slower than the CSR kernel, so only the 
+/// AVX2 and AVX-512 kernels should be used in place of it.
+//
+bool block_size_vectorized(const int dof)
+{
+  #if defined(__AVX2__) && defined(__FMA__)
+  if ((dof == 2) || (dof == 3) || (dof == 4)) {
+    return true;
+  }
+  #endif
+
+  #if defined(__AVX512F__)
+  if (dof == 7) {
+    return true;
+  }
+  #endif
+
+  return false;
+}
+
+/// @brief Block sparse matrix-vector product KU = K*U for the block sizes 
+/// given by block_size_supported().
+///
+/// The rows [begin,end) of KU(dof,nNo) are overwritten.
+//
+void spar_mul_vv_block(const int begin, const int end, const Array<int>& rowPtr, const Vector<int>& colPtr,
+    const int dof, const Array<double>& K, const Array<double>& U, Array<double>& KU)
+{
+  const int* rp = rowPtr.data();
+  const int* cp = colPtr.data();
+  const double* k = K.data();
+  const double* u = U.data();
+  double* ku = KU.data();
+
+  switch (dof) {
+    case 2:
+      block_mul<2>(begin, end, rp, cp, k, u, ku);
+    break;
+
+    case 3:
+      block_mul<3>(begin, end, rp, cp, k, u, ku);
+    break;
+
+    case 4:
+      block_mul<4>(begin, end, rp, cp, k, u, ku);
+    break;
+
+    case 7:
+      block_mul<7>(begin, end, rp, cp, k, u, ku);
+    break;
+
+    default:
+      throw std::runtime_error("[spar_mul_vv_block] No block kernel for dof " + std::to_string(dof) + ".");
+  }
+}
+
+/// @brief Sparse matrix-vector product KU = K*U using the Array index operators.
+///
+/// This is used for block sizes without a fixed size kernel.
+///
+/// The rows [begin,end) of KU(dof,nNo) are overwritten.
+//
+void spar_mul_vv_csr(const int begin, const int end, const Array<int>& rowPtr, const Vector<int>& colPtr,
+    const int dof, const Array<double>& K, const Array<double>& U, Array<double>& KU)
+{
+  for (int i = begin; i < end; i++) {
+    for (int l = 0; l < dof; l++) {
+      KU(l,i) = 0.0;
+    }
+  }
+
+  switch (dof) {
+
+    case 1:
+      for (int i = begin; i < end; i++) {
+        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+          KU(0,i) = KU(0,i) + K(0,j)*U(0,colPtr(j));
+        }
+      }
+    break;
+
+    case 2:
+      for (int i = begin; i < end; i++) {
+        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+          int col = colPtr(j);
+          KU(0,i) = KU(0,i) + K(0,j)*U(0,col) + K(1,j)*U(1,col);
+          KU(1,i) = KU(1,i) + K(2,j)*U(0,col) + K(3,j)*U(1,col);
+        }
+      }
+    break;
+
+    case 3:
+      for (int i = begin; i < end; i++) {
+        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+          int col = colPtr(j);
+          KU(0,i) = KU(0,i) + K(0,j)*U(0,col) + K(1,j)*U(1,col) + K(2,j)*U(2,col);
+          KU(1,i) = KU(1,i) + K(3,j)*U(0,col) + K(4,j)*U(1,col) + K(5,j)*U(2,col);
+          KU(2,i) = KU(2,i) + K(6,j)*U(0,col) + K(7,j)*U(1,col) + K(8,j)*U(2,col);
+        }
+      }
+    break;
+
+    case 4:
+      for (int i = begin; i < end; i++) {
+        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+          int col = colPtr(j);
+          KU(0,i) = KU(0,i) + K(0 ,j)*U(0,col) + K(1 ,j)*U(1,col) + K(2 ,j)*U(2,col) + K(3 ,j)*U(3,col);
+          KU(1,i) = KU(1,i) + K(4 ,j)*U(0,col) + K(5 ,j)*U(1,col) + K(6 ,j)*U(2,col) + K(7 ,j)*U(3,col);
+          KU(2,i) = KU(2,i) + K(8 ,j)*U(0,col) + K(9,j)*U(1,col) + K(10,j)*U(2,col) + K(11,j)*U(3,col);
+          KU(3,i) = KU(3,i) + K(12,j)*U(0,col) + K(13,j)*U(1,col) + K(14,j)*U(2,col) + K(15,j)*U(3,col);
+        }
+      }
+    break;
+
+    default: 
+      for (int i = begin; i < end; i++) {
+        for (int j = rowPtr(0,i); j <= rowPtr(1,i); j++) {
+          int col = colPtr(j);
+          for (int l = 0; l < dof; l++) {
+            int s = l*dof;
+            double sum = 0.0;
+            for (int k = 0; k < dof; k++) {
+              sum += K(k+s,j) * U(k,col);
+            }
+            KU(l,i) = KU(l,i) + sum;
+          }
+        }
+     }
+  } 
+}
+
+};
@@ -0,0 +1,357 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+bool Profiler::enabled = false;
+MPI_Comm Profiler::comm_ = MPI_COMM_WORLD;
+int Profiler::current_ = 0;
+std::vector<Profiler::Region> Profiler::regions_;
+std::string Profiler::step_file_name_;
+std::ofstream Profiler::step_file_;
+
+/// @brief Enable profiling for the processes of 'comm'. 
+///
+/// If 'step_file_name' is not empty then the region times of each time step
+/// are written to it by write_time_step(), as JSON lines if the file name 
+/// ends with '.json' and as CSV otherwise. 
+//
+void Profiler::enable(MPI_Comm comm, const std::string& step_file_name)
+{
+  enabled = true;
+  comm_ = comm;
+  step_file_name_ = step_file_name;
+
+  // The root region is never timed.
+  if (regions_.size() == 0) {
+    regions_.emplace_back();
+    current_ = 0;
+  }
+}
+
+/// @brief Enter the region 'name' nested in the current region.
+//
+void Profiler::begin(const char* name)
+{
+  int child = -1;
+
+  for (int i : regions_[current_].children) {
+    if (regions_[i].name == name) {
+      child = i;
+      break;
+    }
+  }
+
+  if (child == -1) {
+    child = regions_.size();
+    Region region;
+    region.name = name;
+    region.parent = current_;
+    regions_.push_back(region);
+    regions_[current_].children.push_back(child);
+  }
+
+  current_ = child;
+}
+
+/// @brief Leave the current region entered at time 'start'.
+//
+void Profiler::end(const Clock::time_point& start)
+{
+  double time = std::chrono::duration<double>(Clock::now() - start).count();
+  auto& region = regions_[current_];
+
+  region.calls += 1;
+  region.time += time;
+  region.step_calls += 1;
+  region.step_time += time;
+
+  current_ = region.parent;
+}
+
+/// @brief Gather the region times of all processes on the master process. 
+///
+/// The region paths are returned in depth-first order, with the number of calls 
+/// (max over processes) and the time of each process. The step times are 
+/// gathered if 'step' is true.
+///
+/// This is a collective operation, the output is only set on the master process.
+//
+void Profiler::gather(const bool step, std::vector<std::string>& paths, std::vector<long>& calls,
+    std::vector<std::vector<double>>& times)
+{
+  int rank, nProcs;
+  MPI_Comm_rank(comm_, &rank);
+  MPI_Comm_size(comm_, &nProcs);
+
+  // Serialize the region tree as lines of 'path calls time' in depth-first order.
+  //
+  std::string local;
+  std::vector<std::pair<int,std::string>> stack;
+
+  for (auto it = regions_[0].children.rbegin(); it != regions_[0].children.rend(); it++) {
+    stack.push_back({*it, regions_[*it].name});
+  }
+
+  while (stack.size() != 0) {
+    auto [i, path] = stack.back();
+    stack.pop_back();
+    auto& region = regions_[i];
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "\t%ld\t%.9e\n", step ? region.step_calls : region.calls, 
+        step ? region.step_time : region.time);
+    local += path + buffer;
+
+    for (auto it = region.children.rbegin(); it != region.children.rend(); it++) {
+      stack.push_back({*it, path + "/" + regions_[*it].name});
+    }
+  }
+
+  int size = local.size();
+  std::vector<int> sizes(nProcs);
+  MPI_Gather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, comm_);
+
+  std::vector<int> disps(nProcs, 0);
+  std::string all;
+
+  if (rank == 0) {
+    std::partial_sum(sizes.begin(), sizes.end()-1, disps.begin()+1);
+    all.resize(disps.back() + sizes.back());
+  }
+
+  MPI_Gatherv(local.data(), size, MPI_CHAR, all.data(), sizes.data(), disps.data(), MPI_CHAR, 0, comm_);
+
+  if (rank != 0) {
+    return;
+  }
+
+  // Merge the region trees of all processes. A child path is always seen
+  // after its parent path.
+  //
+  std::map<std::string,int> index;
+  std::vector<std::string> merged_paths;
+  std::vector<long> merged_calls;
+  std::vector<std::vector<double>> merged_times;
+  std::vector<std::vector<int>> children(1);
+
+  for (int p = 0; p < nProcs; p++) {
+    std::istringstream lines(all.substr(disps[p], sizes[p]));
+    std::string path;
+
+    while (std::getline(lines, path, '\t')) {
+      long ncalls;
+      double time;
+      lines >> ncalls >> time;
+      lines.ignore();
+
+      auto it = index.find(path);
+      int i;
+
+      if (it == index.end()) {
+        i = merged_paths.size();
+        index[path] = i;
+        merged_paths.push_back(path);
+        merged_calls.push_back(0);
+        merged_times.push_back(std::vector<double>(nProcs, 0.0));
+        children.emplace_back();
+
+        auto pos = path.rfind('/');
+        int parent = (pos == std::string::npos) ? 0 : index[path.substr(0,pos)] + 1;
+        children[parent].push_back(i);
+      } else {
+        i = it->second;
+      }
+
+      merged_calls[i] = std::max(merged_calls[i], ncalls);
+      merged_times[i][p] = time;
+    }
+  }
+
+  // Order the merged regions depth first. 
+  //
+  paths.clear();
+  calls.clear();
+  times.clear();
+  std::vector<int> node_stack(children[0].rbegin(), children[0].rend());
+
+  while (node_stack.size() != 0) {
+    int i = node_stack.back();
+    node_stack.pop_back();
+    paths.push_back(merged_paths[i]);
+    calls.push_back(merged_calls[i]);
+    times.push_back(merged_times[i]);
+    node_stack.insert(node_stack.end(), children[i+1].rbegin(), children[i+1].rend());
+  }
+}
+
+/// @brief Return a table of the min/avg/max region times over all processes. 
+///
+/// This is a collective operation, an empty string is returned on processes
+/// other than the master or if profiling is not enabled. 
+//
+std::string Profiler::report()
+{
+  if (!enabled) {
+    return "";
+  }
+
+  std::vector<std::string> paths;
+  std::vector<long> calls;
+  std::vector<std::vector<double>> times;
+  gather(false, paths, calls, times);
+
+  int rank;
+  MPI_Comm_rank(comm_, &rank);
+  if (rank != 0) {
+    return "";
+  }
+
+  int nProcs = times.size() == 0 ? 1 : times[0].size();
+  std::vector<double> tMin(paths.size()), tAvg(paths.size()), tMax(paths.size());
+  double total = 0.0;
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    tMin[i] = *std::min_element(times[i].begin(), times[i].end());
+    tMax[i] = *std::max_element(times[i].begin(), times[i].end());
+    tAvg[i] = std::accumulate(times[i].begin(), times[i].end(), 0.0) / nProcs;
+    if (paths[i].find('/') == std::string::npos) {
+      total += tAvg[i];
+    }
+  }
+
+  std::ostringstream out;
+  std::string sepLine(104, '-');
+
+  out << std::endl;
+  out << " Profile of " << nProcs << " processes, wall clock time in seconds" << std::endl;
+  out << " " << sepLine << std::endl;
+  out << " " << std::left << std::setw(44) << "Region" << std::right << std::setw(10) << "Calls" 
+      << std::setw(12) << "Min" << std::setw(12) << "Avg" << std::setw(12) << "Max" 
+      << std::setw(8) << "Max/Avg" << std::setw(6) << "%" << std::endl;
+  out << " " << sepLine << std::endl;
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    int depth = std::count(paths[i].begin(), paths[i].end(), '/');
+    auto name = std::string(2*depth, ' ') + paths[i].substr(paths[i].rfind('/') + 1);
+    double ratio = (tAvg[i] > 0.0) ? tMax[i] / tAvg[i] : 1.0;
+    double percent = (total > 0.0) ? 100.0 * tAvg[i] / total : 0.0;
+
+    out << " " << std::left << std::setw(44) << name << std::right << std::setw(10) << calls[i] 
+        << std::scientific << std::setprecision(4) << std::setw(12) << tMin[i] << std::setw(12) << tAvg[i] 
+        << std::setw(12) << tMax[i] << std::fixed << std::setprecision(2) << std::setw(8) << ratio 
+        << std::setprecision(1) << std::setw(6) << percent << std::endl;
+  }
+
+  out << " " << sepLine << std::endl;
+
+  return out.str();
+}
+
+/// @brief Write the min/avg/max region times over all processes for the 
+/// regions entered since the last call to the time step file.
+///
+/// This is a collective operation. 
+//
+void Profiler::write_time_step(const int time_step)
+{
+  if (!enabled || step_file_name_ == "") {
+    return;
+  }
+
+  std::vector<std::string> paths;
+  std::vector<long> calls;
+  std::vector<std::vector<double>> times;
+  gather(true, paths, calls, times);
+
+  for (auto& region : regions_) {
+    region.step_calls = 0;
+    region.step_time = 0.0;
+  }
+
+  int rank;
+  MPI_Comm_rank(comm_, &rank);
+  if (rank != 0) {
+    return;
+  }
+
+  bool json = (step_file_name_.size() > 5) && (step_file_name_.substr(step_file_name_.size()-5) == ".json");
+
+  if (!step_file_.is_open()) {
+    step_file_.open(step_file_name_);
+    if (step_file_.fail()) {
+      throw std::runtime_error("[Profiler] Unable to open the file '" + step_file_name_ + "' for writing.");
+    }
+    if (!json) {
+      step_file_ << "time_step,region,calls,min,avg,max" << std::endl;
+    }
+  }
+
+  step_file_ << std::scientific << std::setprecision(6);
+
+  if (json) {
+    step_file_ << "{\"time_step\": " << time_step << ", \"regions\": [";
+  }
+
+  bool first = true;
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    if (calls[i] == 0) {
+      continue;
+    }
+
+    double tMin = *std::min_element(times[i].begin(), times[i].end());
+    double tMax = *std::max_element(times[i].begin(), times[i].end());
+    double tAvg = std::accumulate(times[i].begin(), times[i].end(), 0.0) / times[i].size();
+
+    if (json) {
+      step_file_ << (first ? "" : ", ") << "{\"region\": \"" << paths[i] << "\", \"calls\": " << calls[i] 
+          << ", \"min\": " << tMin << ", \"avg\": " << tAvg << ", \"max\": " << tMax << "}";
+    } else {
+      step_file_ << time_step << "," << paths[i] << "," << calls[i] << "," << tMin << "," << tAvg 
+          << "," << tMax << std::endl;
+    }
+
+    first = false;
+  }
+
+  if (json) {
+    step_file_ << "]}" << std::endl;
+  }
+}
+
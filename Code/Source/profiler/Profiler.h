@@ -0,0 +1,136 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROFILER_H 
+#define PROFILER_H 
+
+#include "mpi.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// @brief The Profiler class accumulates the wall clock time spent in nested 
+/// code regions of an MPI process.
+///
+/// A region is timed by a ProfileRegion object created at the top of a function 
+/// or scope using the SV_PROFILE_REGION macro
+///
+///   SV_PROFILE_REGION("global_eq_assem");
+///
+/// Regions are identified by their name and the names of the enclosing regions 
+/// so the same function called from two places is reported as two regions.
+///
+/// The report() and write_time_step() methods are collective, region times are 
+/// gathered on the master process and the min/avg/max over all processes is 
+/// reported. A process that never entered a region contributes zero time to it.
+///
+/// Profiling is disabled by default, a disabled region only tests a static flag. 
+/// Regions must only be created by the thread that calls MPI.
+//
+class Profiler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief A node of the region tree.
+    struct Region {
+      std::string name;
+      int parent = -1;
+      std::vector<int> children;
+      long calls = 0;
+      double time = 0.0;
+      long step_calls = 0;
+      double step_time = 0.0;
+    };
+
+    static bool enabled;
+
+    static void enable(MPI_Comm comm, const std::string& step_file_name);
+    static void begin(const char* name);
+    static void end(const Clock::time_point& start);
+    static std::string report();
+    static void write_time_step(const int time_step);
+
+  private:
+    static void gather(const bool step, std::vector<std::string>& paths, std::vector<long>& calls,
+        std::vector<std::vector<double>>& times);
+
+    static MPI_Comm comm_;
+    static int current_;
+    static std::vector<Region> regions_;
+    static std::string step_file_name_;
+    static std::ofstream step_file_;
+};
+
+/// @brief The ProfileRegion class times a code region from its construction 
+/// to its destruction or a call to stop().
+//
+class ProfileRegion
+{
+  public:
+    explicit ProfileRegion(const char* name) : active_(Profiler::enabled) 
+    {
+      if (active_) {
+        Profiler::begin(name);
+        start_ = Profiler::Clock::now();
+      }
+    }
+
+    ~ProfileRegion() 
+    {
+      stop();
+    }
+
+    void stop()
+    {
+      if (active_) {
+        Profiler::end(start_);
+        active_ = false;
+      }
+    }
+
+    ProfileRegion(const ProfileRegion&) = delete;
+    ProfileRegion& operator=(const ProfileRegion&) = delete;
+
+  private:
+    bool active_;
+    Profiler::Clock::time_point start_;
+};
+
+#define SV_PROFILE_CONCAT_(a, b) a ## b
+#define SV_PROFILE_CONCAT(a, b) SV_PROFILE_CONCAT_(a, b)
+
+/// @brief Time the enclosing scope as the region 'name'.
+#define SV_PROFILE_REGION(name) ProfileRegion SV_PROFILE_CONCAT(sv_profile_region_, __LINE__)(name)
+
+#endif
+
@@ -35,6 +35,7 @@
 #define ARRAY_H 
 
 #include <algorithm>
+#include <atomic>
 #include <array>
 #include <cstring>
 #include <float.h>
@@ -54,13 +55,14 @@ template<typename T>
 class Array 
 {
   public:
-    // Some variables used to monitor Array object allocation.
-    static int id;
-    static int num_allocated;
-    static int active;
+    // Some variables used to monitor Array object allocation, atomic because
+    // objects are created and destroyed in threaded element loops.
+    static std::atomic<int> id;
+    static std::atomic<int> num_allocated;
+    static std::atomic<int> active;
     static bool show_index_check_message;
-    static double memory_in_use;
-    static double memory_returned;
+    static std::atomic<long long> memory_in_use;
+    static std::atomic<long long> memory_returned;
     static void memory(const std::string& prefix="");
     static void stats(const std::string& prefix="");
     static bool write_enabled;
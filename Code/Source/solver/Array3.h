@@ -33,6 +33,7 @@
 #ifndef ARRAY3_H 
 #define ARRAY3_H 
 
+#include <atomic>
 #include <float.h>
 #include <iostream>
 #include <string>
@@ -52,11 +53,11 @@ class Array3
 {
   public:
 
-    static int num_allocated;
-    static int active;
+    static std::atomic<int> num_allocated;
+    static std::atomic<int> active;
     static bool show_index_check_message;
-    static double memory_in_use;
-    static double memory_returned;
+    static std::atomic<long long> memory_in_use;
+    static std::atomic<long long> memory_returned;
     static bool write_enabled;
     static void memory(const std::string& prefix="");
     static void stats(const std::string& prefix="");
@@ -0,0 +1,152 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "AsyncWriter.h"
+#include "Profiler.h"
+
+#include <stdexcept>
+
+AsyncWriter::~AsyncWriter()
+{
+  if (!started()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+
+  task_added_.notify_one();
+  thread_.join();
+}
+
+/// @brief Start the background thread, at most 'max_tasks' tasks are queued.
+//
+void AsyncWriter::start(const int max_tasks)
+{
+  if (max_tasks < 1) {
+    throw std::runtime_error("[AsyncWriter] The maximum number of queued output tasks must be > 0.");
+  }
+
+  max_tasks_ = max_tasks;
+
+  if (!started()) {
+    thread_ = std::thread(&AsyncWriter::run, this);
+  }
+}
+
+/// @brief Queue 'task' for execution on the background thread.
+//
+void AsyncWriter::submit(std::function<void()> task)
+{
+  if (!started()) {
+    task();
+    return;
+  }
+
+  {
+    SV_PROFILE_REGION("async_output_wait");
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_done_.wait(lock, [this] { return static_cast<int>(tasks_.size()) < max_tasks_ || error_; });
+    check_error();
+    tasks_.push_back(std::move(task));
+  }
+
+  task_added_.notify_one();
+}
+
+/// @brief Wait until all queued tasks are finished.
+//
+void AsyncWriter::flush()
+{
+  if (!started()) {
+    return;
+  }
+
+  SV_PROFILE_REGION("async_output_wait");
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_done_.wait(lock, [this] { return (tasks_.size() == 0 && !busy_) || error_; });
+  check_error();
+}
+
+/// @brief Rethrow on the calling thread an exception thrown by a task.
+///
+/// The mutex must be locked.
+//
+void AsyncWriter::check_error()
+{
+  if (error_) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+/// @brief Execute the queued tasks in order until the writer is destroyed.
+//
+void AsyncWriter::run()
+{
+  while (true) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_added_.wait(lock, [this] { return tasks_.size() != 0 || stop_; });
+
+      if (tasks_.size() == 0) {
+        return;
+      }
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      busy_ = true;
+    }
+
+    std::exception_ptr error;
+
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_ = false;
+      if (error) {
+        error_ = error;
+      }
+    }
+
+    task_done_.notify_all();
+  }
+}
+
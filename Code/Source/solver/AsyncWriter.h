@@ -0,0 +1,84 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ASYNC_WRITER_H 
+#define ASYNC_WRITER_H 
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// @brief The AsyncWriter class executes output tasks (formatting, compressing 
+/// and writing files) on a background thread so time stepping can continue 
+/// while the data is written.
+///
+/// A task must own a snapshot of the data it writes, it must not reference 
+/// solver arrays that are modified by the next time steps and it must not call 
+/// MPI. The number of queued tasks is bounded, submit() blocks until a task 
+/// finishes if the queue is full.
+///
+/// Tasks are executed immediately by submit() if the writer has not been started.
+//
+class AsyncWriter
+{
+  public:
+    AsyncWriter() {}
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    bool started() const { return thread_.joinable(); }
+
+    void flush();
+    void start(const int max_tasks);
+    void submit(std::function<void()> task);
+
+  private:
+    void check_error();
+    void run();
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable task_added_;
+    std::condition_variable task_done_;
+    std::deque<std::function<void()>> tasks_;
+    std::exception_ptr error_;
+
+    int max_tasks_ = 2;
+    bool busy_ = false;
+    bool stop_ = false;
+};
+
+#endif
+
@@ -0,0 +1,341 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Checkpoint.h"
+#include "Simulation.h"
+
+#include <zlib.h>
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const int version = 1;
+
+// Number of bytes of a record compressed as one block.
+const int64_t block_size = 1 << 20;
+
+};
+
+/// @brief Returns the CRC-32 checksum of a restart record.
+//
+uint32_t Checkpoint::checksum(const std::string& record)
+{
+  return crc32_z(0L, reinterpret_cast<const Bytef*>(record.data()), record.size());
+}
+
+/// @brief Byte shuffle and compress 'data'.
+///
+/// Compressed data
+///
+///   uint32 checksum, int64 size, int64 number of blocks
+///   (int64 block size, int64 compressed block size, compressed block)[number of blocks]
+//
+std::string Checkpoint::compress(const std::string& data, const uint32_t checksum)
+{
+  int64_t size = data.size();
+  int64_t num_blocks = (size + block_size - 1) / block_size;
+
+  std::string result;
+  result.append((char*)&checksum, sizeof(checksum));
+  result.append((char*)&size, sizeof(size));
+  result.append((char*)&num_blocks, sizeof(num_blocks));
+
+  std::string shuffled;
+  std::string compressed;
+
+  for (int64_t start = 0; start < size; start += block_size) {
+    int64_t length = std::min(block_size, size - start);
+    int64_t n = length / sizeof(double);
+    const char* block = data.data() + start;
+
+    shuffled.resize(length);
+    for (int64_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < sizeof(double); j++) {
+        shuffled[j*n + i] = block[i*sizeof(double) + j];
+      }
+    }
+    std::copy(block + n*sizeof(double), block + length, shuffled.begin() + n*sizeof(double));
+
+    uLongf compressed_length = compressBound(length);
+    compressed.resize(compressed_length);
+
+    if (compress2((Bytef*)compressed.data(), &compressed_length, (const Bytef*)shuffled.data(), length, Z_BEST_SPEED) != Z_OK) {
+      throw std::runtime_error("[Checkpoint] Compressing a restart record failed.");
+    }
+
+    int64_t stored_length = compressed_length;
+    result.append((char*)&length, sizeof(length));
+    result.append((char*)&stored_length, sizeof(stored_length));
+    result.append(compressed.data(), compressed_length);
+  }
+
+  return result;
+}
+
+/// @brief Decompress data created by compress().
+//
+std::string Checkpoint::decompress(const std::string& data, uint32_t& checksum)
+{
+  int64_t size, num_blocks;
+  size_t pos = 0;
+
+  auto read_value = [&data, &pos](void* value, size_t length) {
+    if (pos + length > data.size()) {
+      throw std::runtime_error("[Checkpoint] A compressed restart record is truncated.");
+    }
+    data.copy((char*)value, length, pos);
+    pos += length;
+  };
+
+  read_value(&checksum, sizeof(checksum));
+  read_value(&size, sizeof(size));
+  read_value(&num_blocks, sizeof(num_blocks));
+
+  std::string result(size, '\0');
+  std::string shuffled;
+  int64_t start = 0;
+
+  for (int64_t iBlk = 0; iBlk < num_blocks; iBlk++) {
+    int64_t length, stored_length;
+    read_value(&length, sizeof(length));
+    read_value(&stored_length, sizeof(stored_length));
+
+    if (start + length > size || pos + stored_length > data.size()) {
+      throw std::runtime_error("[Checkpoint] A compressed restart record is truncated.");
+    }
+
+    shuffled.resize(length);
+    uLongf uncompressed_length = length;
+
+    if (uncompress((Bytef*)shuffled.data(), &uncompressed_length, (const Bytef*)data.data() + pos, stored_length) != Z_OK || 
+        uncompressed_length != static_cast<uLongf>(length)) {
+      throw std::runtime_error("[Checkpoint] Decompressing a restart record failed.");
+    }
+    pos += stored_length;
+
+    int64_t n = length / sizeof(double);
+    char* block = result.data() + start;
+
+    for (int64_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < sizeof(double); j++) {
+        block[i*sizeof(double) + j] = shuffled[j*n + i];
+      }
+    }
+    std::copy(shuffled.begin() + n*sizeof(double), shuffled.end(), block + n*sizeof(double));
+
+    start += length;
+  }
+
+  if (start != size) {
+    throw std::runtime_error("[Checkpoint] A compressed restart record is truncated.");
+  }
+
+  return result;
+}
+
+/// @brief Read the restart record of this processor from the compressed 
+/// restart file 'fName'.
+///
+/// Returns false if 'fName' is not a compressed restart file. 
+//
+bool Checkpoint::read(Simulation* simulation, const std::string& fName, std::string& record)
+{
+  auto& cm = simulation->com_mod.cm;
+
+  std::ifstream file(fName, std::ios::binary | std::ios::in);
+  std::array<int,5> header{};
+  file.read((char*)header.data(), sizeof(header));
+
+  if (!file || header[0] != magic) {
+    return false;
+  }
+
+  if (header[1] != version) {
+    throw std::runtime_error("[Checkpoint] The version " + std::to_string(header[1]) + " of the restart file '" + 
+        fName + "' is not supported.");
+  }
+
+  int np = header[2];
+  bool is_delta = header[3];
+
+  if (np != cm.np()) {
+    throw std::runtime_error("[Checkpoint] The number of processors " + std::to_string(np) + " read from '" + 
+        fName + "' don't match.");
+  }
+
+  std::string base_name(header[4], '\0');
+  std::vector<int64_t> offsets(np);
+  std::vector<int64_t> sizes(np);
+  file.read(base_name.data(), base_name.size());
+  file.read((char*)offsets.data(), np*sizeof(int64_t));
+  file.read((char*)sizes.data(), np*sizeof(int64_t));
+
+  int rank = cm.idcm();
+  std::string data(sizes[rank], '\0');
+  file.seekg(offsets[rank]);
+  file.read(data.data(), data.size());
+
+  if (!file) {
+    throw std::runtime_error("[Checkpoint] Unable to read the restart record of processor " + std::to_string(rank) + 
+        " from '" + fName + "'.");
+  }
+
+  uint32_t checksum;
+  record = decompress(data, checksum);
+
+  // A delta record is applied to the record of the full checkpoint which 
+  // is stored in the same directory.
+  //
+  if (is_delta) {
+    auto base_path = (std::filesystem::path(fName).parent_path() / base_name).string();
+    std::string base_record;
+
+    if (!read(simulation, base_path, base_record) || base_record.size() != record.size()) {
+      throw std::runtime_error("[Checkpoint] The full restart file '" + base_path + "' needed by '" + 
+          fName + "' is missing or does not match.");
+    }
+
+    xor_record(record, base_record);
+  }
+
+  if (Checkpoint::checksum(record) != checksum) {
+    throw std::runtime_error("[Checkpoint] The checksum of the restart record of processor " + std::to_string(rank) + 
+        " read from '" + fName + "' does not match.");
+  }
+
+  return true;
+}
+
+/// @brief Write the restart 'record' of this processor to 'fName' as a full 
+/// or delta checkpoint. 
+///
+/// The records are compressed by each processor, the file header is written 
+/// by the master and the records are written by the output writer. 
+/// If the file written is not 'link_name' the master creates 'link_name' as 
+/// a hard link to it.
+//
+void Checkpoint::write(Simulation* simulation, const std::string& fName, const std::string& link_name, std::string record)
+{
+  auto& com_mod = simulation->com_mod;
+  auto& cm_mod = simulation->cm_mod;
+  auto& cm = com_mod.cm;
+  const int cTS = com_mod.cTS;
+  const int np = cm.np();
+  const int fullIncr = com_mod.stFileFullIncr;
+
+  int full = (fullIncr <= 0) || (base_record_.size() != record.size()) || (cTS - base_time_step_ >= fullIncr);
+  MPI_Allreduce(MPI_IN_PLACE, &full, 1, cm_mod::mpint, MPI_MAX, cm.com());
+
+  // A full checkpoint must not overwrite the restart file delta 
+  // checkpoints are written to.
+  //
+  std::string file_name = fName;
+  if (full && fullIncr > 0 && com_mod.stFileRepl) {
+    file_name = com_mod.stFileName + "_full.bin";
+  }
+
+  uint32_t checksum = Checkpoint::checksum(record);
+  std::string data;
+  std::string base_name;
+
+  if (full) {
+    data = compress(record, checksum);
+  } else {
+    std::string delta = record;
+    xor_record(delta, base_record_);
+    data = compress(delta, checksum);
+    base_name = std::filesystem::path(base_file_name_).filename().string();
+  }
+
+  // Compute the record offsets.
+  //
+  int64_t size = data.size();
+  std::vector<int64_t> sizes(np);
+  std::vector<int64_t> offsets(np);
+  MPI_Allgather(&size, 1, MPI_INT64_T, sizes.data(), 1, MPI_INT64_T, cm.com());
+
+  offsets[0] = 5*sizeof(int) + base_name.size() + 2*np*sizeof(int64_t);
+  for (int i = 1; i < np; i++) {
+    offsets[i] = offsets[i-1] + sizes[i-1];
+  }
+
+  // Create the file. It is removed first because it may be a hard link to 
+  // a full checkpoint.
+  //
+  if (cm.mas(cm_mod)) {
+    std::array<int,5> header{magic, version, np, !full, static_cast<int>(base_name.size())};
+    std::remove(file_name.c_str());
+    std::ofstream file(file_name, std::ios::out | std::ios::binary);
+    file.write((char*)header.data(), sizeof(header));
+    file.write(base_name.data(), base_name.size());
+    file.write((char*)offsets.data(), np*sizeof(int64_t));
+    file.write((char*)sizes.data(), np*sizeof(int64_t));
+    file.close();
+  }
+
+  MPI_Barrier(cm.com());
+
+  std::streampos write_pos = offsets[cm.idcm()];
+  bool link = cm.mas(cm_mod) && (file_name != link_name);
+
+  simulation->output_writer.submit([file_name, link_name, write_pos, link, data = std::move(data)]() {
+    std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::in);
+    file.seekp(write_pos);
+    file.write(data.data(), data.size());
+    file.close();
+
+    if (link) {
+      std::filesystem::remove(link_name);
+      std::filesystem::create_hard_link(file_name, link_name);
+    }
+  });
+
+  if (full) {
+    base_record_ = std::move(record);
+    base_file_name_ = file_name;
+    base_time_step_ = cTS;
+  }
+}
+
+/// @brief XOR the bytes of 'record' with the bytes of 'base'.
+//
+void Checkpoint::xor_record(std::string& record, const std::string& base)
+{
+  for (size_t i = 0; i < record.size(); i++) {
+    record[i] ^= base[i];
+  }
+}
+
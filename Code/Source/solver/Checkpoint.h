@@ -0,0 +1,82 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHECKPOINT_H 
+#define CHECKPOINT_H 
+
+#include <cstdint>
+#include <string>
+
+class Simulation;
+
+/// @brief The Checkpoint class writes and reads compressed restart files.
+///
+/// The restart record of each processor is compressed in blocks. Each block
+/// is byte shuffled, the bytes of all doubles with the same significance are 
+/// stored together, and compressed with zlib. 
+///
+/// If incremental checkpoints are enabled only every 'stFileFullIncr' time 
+/// steps a full checkpoint is written. Other checkpoints store the XOR of 
+/// the record with the record of the last full checkpoint, which is mostly 
+/// zero bytes for slowly changing solutions. 
+///
+/// File layout
+///
+///   int magic, int version, int number of processors, int is delta
+///   int base file name length, char base file name[]
+///   int64 record offset[number of processors], int64 record size[number of processors]
+///   compressed records 
+///
+/// A compressed record stores the CRC-32 checksum of the uncompressed restart 
+/// record used to verify the record when it is read.
+//
+class Checkpoint
+{
+  public:
+    static const int magic = 0x73764643;
+
+    static bool read(Simulation* simulation, const std::string& fName, std::string& record);
+    void write(Simulation* simulation, const std::string& fName, const std::string& link_name, std::string record);
+
+    static uint32_t checksum(const std::string& record);
+    static std::string compress(const std::string& data, const uint32_t checksum);
+    static std::string decompress(const std::string& data, uint32_t& checksum);
+
+  private:
+    static void xor_record(std::string& record, const std::string& base);
+
+    // Record and file name of the last full checkpoint.
+    std::string base_record_;
+    std::string base_file_name_;
+    int base_time_step_ = 0;
+};
+
+#endif
+
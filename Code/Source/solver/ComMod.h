@@ -825,6 +825,36 @@ class cplBCType
     std::vector<cplFaceType> fa;
 };
 
+/// @brief Element geometry (shape function gradients, Jacobians and inverse
+/// mapping gradients) evaluated at the integration points of a function
+/// space. 
+///
+/// The values for element e and integration point g are stored at index 
+/// e*nG+g. Function spaces with constant gradients (lShpF) store a single 
+/// integration point per element.
+//
+class elemGeoType
+{
+  public:
+    /// @brief Number of stored integration points per element, 0 if the
+    /// cache is not used
+    int nG = 0;
+
+    /// @brief Shape function gradients, Nx(nsd,eNoN,nEl*nG)
+    Array3<double> Nx;
+
+    /// @brief Shape function second derivatives, Nxx(nsymd,eNoN,nEl*nG)
+    Array3<double> Nxx;
+
+    /// @brief Inverse of the mapping gradient, ksix(nsd,nsd,nEl*nG)
+    Array3<double> ksix;
+
+    /// @brief Jacobian, Jac(nEl*nG)
+    Vector<double> Jac;
+
+    bool valid() const { return nG > 0; }
+};
+
 /// @brief This is the container for a mesh or NURBS patch, those specific
 /// to NURBS are noted
 //
@@ -982,6 +1012,10 @@ class mshType
     /// davep double Nxx(:,:,:)
     Array3<double> Nxx;
 
+    /// @brief Element scatter map: location in colPtr/Val of the (a,b) entry 
+    /// of element e, eValPtr(a,b,e). Set by lhsa().
+    Array3<int> eValPtr;
+
     /// @brief Solution field (displacement, velocity, pressure, etc.) for a known, potentially
     /// time-varying, quantity of interest across a mesh
     Array3<double> Ys;
@@ -995,6 +1029,30 @@ class mshType
     /// @brief Mesh element adjacency
     adjType eAdj;
 
+    /// @brief Whether to cache the element geometry (Cache_element_geometry)
+    bool cacheGeo = false;
+
+    /// @brief Maximum size in MB of the element geometry cache of this mesh 
+    /// on a process (Element_geometry_cache_size). Each mesh has its own limit.
+    double cacheGeoSize = 1024.0;
+
+    /// @brief Cached element geometry of the mesh function space (Nx)
+    elemGeoType geo;
+
+    /// @brief Cached element geometry of the Taylor-Hood function spaces, 
+    /// thGeo[iOpt-1][i] for fs[i] as set by get_thood_fs(iOpt)
+    std::array<std::array<elemGeoType,2>,2> thGeo;
+
+    /// @brief Number of element colors used for threaded assembly
+    int nColor = 0;
+
+    /// @brief Element color pointer, elements of color c are
+    /// eColList(eColPtr(c):eColPtr(c+1)-1)
+    Vector<int> eColPtr;
+
+    /// @brief Elements sorted by color
+    Vector<int> eColList;
+
     /// @brief Function spaces (basis)
     std::vector<fsType> fs;
 
@@ -1016,6 +1074,49 @@ class mshType
 
 };
 
+/// @brief Settings and state of the reuse of the tangent matrix between
+/// Newton iterations (modified Newton).
+///
+/// The tangent matrix is assembled every 'iterations' Newton iterations, 
+/// at the first Newton iteration of every 'time_steps' time steps and when
+/// the residual norm of the last Newton iteration was reduced by less than
+/// 'residual_ratio'. The other iterations only assemble the residual and
+/// solve with the kept tangent matrix.
+//
+class tangentType
+{
+  public:
+    /// @brief Return true if the tangent matrix may be reused
+    bool enabled() const { return (iterations != 1) || (time_steps != 1); }
+
+    /// @brief Newton iterations between assemblies, 0 only assembles 
+    /// at the first iteration of a time step
+    int iterations = 1;
+
+    /// @brief Time steps between assemblies at the first iteration
+    int time_steps = 1;
+
+    /// @brief Assemble when the ratio of the residual norms of the last 
+    /// two Newton iterations is larger than this, 0 to disable
+    double residual_ratio = 0.0;
+
+    /// @brief The kept tangent matrix is used for the current iteration
+    bool reuse = false;
+
+    /// @brief Number of solves with the kept tangent matrix 
+    int age = 0;
+
+    /// @brief Time step the kept tangent matrix was assembled
+    int cTS = -1;
+
+    /// @brief Residual norms of the last two Newton iterations
+    double rNorm = 0.0;
+    double rNormO = 0.0;
+
+    /// @brief The kept tangent matrix (dof*dof,nnz)
+    Array<double> Val;
+};
+
 /// @brief Equation type
 //
 class eqType
@@ -1037,6 +1138,10 @@ class eqType
     /// @brief Use C++ Trilinos framework for assembly and for linear solvers
     bool assmTLS = false;
 
+    /// @brief Apply the tangent matrix matrix-free by reassembling the 
+    /// equation, only its block diagonal is stored (Matrix_free)
+    bool matrixFree = false;
+
     /// @brief Degrees of freedom
     int dof = 0;
 
@@ -1106,6 +1211,10 @@ class eqType
     /// @brief \f$\rho_{infinity}\f$
     double roInf = 0.0;
 
+    /// @brief Relative assembly cost used to weight elements when 
+    /// partitioning meshes (Partition_cost)
+    double partitionCost = 1.0;
+
     /// @brief Accepted relative tolerance
     double tol = 0.0;
 
@@ -1125,12 +1234,22 @@ class eqType
     /// @brief The type of preconditioner used by the interface to a numerical linear algebra library.
     consts::PreconditionerType linear_algebra_preconditioner = consts::PreconditionerType::PREC_FSILS;
 
+    /// @brief Reuse of the preconditioner between linear solves, the maximum number of solves 
+    /// using the same preconditioner and the maximum ratio of the number of iterations of a
+    /// solve to the number of iterations of the first solve using the preconditioner. 
+    consts::PreconditionerReuseType linear_algebra_preconditioner_reuse = consts::PreconditionerReuseType::PREC_REUSE_NONE;
+    int linear_algebra_preconditioner_reuse_max_solves = 10;
+    double linear_algebra_preconditioner_reuse_max_ratio = 2.0;
+
     /// @brief Interface to a numerical linear algebra library.
     LinearAlgebra* linear_algebra = nullptr;
 
     /// @brief FSILS type of linear solver
     fsi_linear_solver::FSILS_lsType FSILS;
 
+    /// @brief Reuse of the tangent matrix between Newton iterations
+    tangentType tangent;
+
     /// @brief BCs associated with this equation;
     std::vector<bcType> bc;
 
@@ -1365,12 +1484,29 @@ class ComMod {
     /// @brief Whether mesh is moving
     bool mvMsh = false;
 
+    /// @brief Whether to time code regions and print a profile report
+    bool profile = false;
+
+    /// @brief Whether to weight elements by their assembly cost when 
+    /// partitioning meshes
+    bool partCost = false;
+
+    /// @brief Whether to also balance the number of elements when 
+    /// partitioning meshes with element weights
+    bool partBalanceSolver = false;
+
+    /// @brief Whether to write restart and VTK files on a background thread
+    bool asyncOutput = false;
+
     /// @brief Whether to averaged results
     bool saveAve = false;
 
     /// @brief Whether to save to VTK files
     bool saveVTK = false;
 
+    /// @brief Whether to save VTK files partitioned by processor (.pvtu)
+    bool savePVTU = false;
+
     /// @brief Whether any file being saved
     bool savedOnce = false;
 
@@ -1383,6 +1519,13 @@ class ComMod {
     /// @brief Whether to overwrite restart file or not
     bool stFileRepl = false;
 
+    /// @brief Whether to write restart files in global node order so they 
+    /// can be read back with any number of processors
+    bool stFileGlobal = false;
+
+    /// @brief Whether to compress restart files
+    bool stFileCompress = false;
+
     /// @brief Restart simulation after remeshing
     bool resetSim = false;
 
@@ -1469,12 +1612,19 @@ class ComMod {
     /// @brief Increment in saving solutions
     int saveIncr = 0;
 
+    /// @brief Maximum number of queued background output tasks
+    int asyncOutputQueueSize = 2;
+
     /// @brief Stamp ID to make sure simulation is compatible with stFiles
     std::array<int,7> stamp;
 
     /// @brief Increment in saving restart file
     int stFileIncr = 0;
 
+    /// @brief Increment in saving full compressed restart files, the restart
+    /// files saved in between store the changes since the last full one
+    int stFileFullIncr = 0;
+
     /// @brief Total number of degrees of freedom per node
     int tDof = 0;
 
@@ -1506,6 +1656,18 @@ class ComMod {
     /// @brief Initialization file path
     std::string iniFilePath;
 
+    /// @brief Folder storing the element partition (processor of each element)
+    /// computed by ParMETIS, reused by later runs with the same mesh and number
+    /// of processors. The mesh is still read and distributed on every run.
+    std::string partCacheDir;
+
+    /// @brief File storing the measured assembly time per unit of model cost
+    /// of each physics, used to calibrate the partition cost model
+    std::string partCostFile;
+
+    /// @brief Profile file name for the region times of each time step
+    std::string profileFileName;
+
     /// @brief Saved output file name
     std::string saveName;
 
@@ -1585,6 +1747,11 @@ class ComMod {
     /// @brief Time derivative of displacement
     Array<double>  Ad;
 
+    /// @brief Assembly time and number of timed assemblies for each 
+    /// equation and mesh, used to calibrate the partition cost model
+    Array<double> asmTime;
+    Array<double> asmCount;
+
     /// @brief Residual of the displacement equation
     Array<double>  Rd;
 
@@ -31,6 +31,7 @@
 #include "FsilsLinearAlgebra.h"
 #include "fsils_api.hpp"
 #include "lhsa.h"
+#include "utils.h"
 #include <iostream>
 
 /////////////////////////////////////////////////////////////////
@@ -57,9 +58,33 @@ void FsilsLinearAlgebra::alloc(ComMod& com_mod, eqType& lEq)
   #ifdef debug_alloc
   std::cout << "[FsilsLinearAlgebra::alloc] ---------- alloc ---------- " << std::endl;
   #endif
+  using namespace consts;
+
   int dof = com_mod.dof;
+  matrix_free = lEq.matrixFree;
+
+  if (!matrix_free) {
+    com_mod.Val.resize(dof*dof, com_mod.lhs.nnz);
+    return;
+  }
+
+  // Val entries are set directly by index for Taylor-Hood function spaces
+  // and undeforming Neumann BCs so these can't be used matrix-free. 
+  //
+  for (auto& msh : com_mod.msh) {
+    if (msh.nFs == 2) {
+      throw std::runtime_error("[FsilsLinearAlgebra::alloc] The matrix-free linear solver can't be used with Taylor-Hood function spaces.");
+    }
+  }
 
-  com_mod.Val.resize(dof*dof, com_mod.lhs.nnz);
+  for (auto& bc : lEq.bc) {
+    if (utils::btest(bc.bType, iBC_undefNeu)) {
+      throw std::runtime_error("[FsilsLinearAlgebra::alloc] The matrix-free linear solver can't be used with undeforming Neumann BCs.");
+    }
+  }
+
+  // Only the block diagonal of the tangent matrix is stored.
+  com_mod.Val.resize(dof*dof, com_mod.tnNo);
 }
 
 /// @brief Assemble local element arrays.
@@ -75,9 +100,109 @@ void FsilsLinearAlgebra::assemble(ComMod& com_mod, const int num_elem_nodes, con
   std::cout << "[FsilsLinearAlgebra::assemble] lR.size(): " << lR.size() << std::endl;
   #endif
 
+  if (matrix_free) {
+    assemble_matrix_free(com_mod, num_elem_nodes, eqN, lK, lR);
+    return;
+  }
+
+  if (com_mod.eq[com_mod.cEq].tangent.reuse) {
+    lhsa_ns::do_assem_residual(com_mod, num_elem_nodes, eqN, lR);
+    return;
+  }
+
   lhsa_ns::do_assem(com_mod, num_elem_nodes, eqN, lK, lR);
 }
 
+/// @brief Assemble the local arrays of element 'e' of mesh 'lM' using the 
+/// mesh element scatter map.
+//
+void FsilsLinearAlgebra::assemble(ComMod& com_mod, const mshType& lM, const int e, const Vector<int>& eqN,
+        const Array3<double>& lK, const Array<double>& lR)
+{
+  if (matrix_free) {
+    assemble_matrix_free(com_mod, lM.eNoN, eqN, lK, lR);
+    return;
+  }
+
+  if (com_mod.eq[com_mod.cEq].tangent.reuse) {
+    lhsa_ns::do_assem_residual(com_mod, lM.eNoN, eqN, lR);
+    return;
+  }
+
+  if (lM.eValPtr.nslices() != lM.nEl) {
+    lhsa_ns::do_assem(com_mod, lM.eNoN, eqN, lK, lR);
+    return;
+  }
+
+  lhsa_ns::do_assem(com_mod, lM.eNoN, eqN, lM.eValPtr.rslice(e), lK, lR);
+}
+
+/// @brief Assemble local element arrays for the matrix-free solver.
+///
+/// When the equation is reassembled by mat_vec() the element tangent 
+/// matrix is applied to mat_vec_U and added to mat_vec_KU. Otherwise 
+/// the residual and the block diagonal of the tangent matrix are assembled
+/// into com_mod.R and com_mod.Val(dof*dof,tnNo).
+//
+void FsilsLinearAlgebra::assemble_matrix_free(ComMod& com_mod, const int num_elem_nodes, const Vector<int>& eqN,
+        const Array3<double>& lK, const Array<double>& lR)
+{
+  const int dof = com_mod.dof;
+
+  if (mat_vec_KU != nullptr) {
+    const auto& U = *mat_vec_U;
+    auto& KU = *mat_vec_KU;
+
+    for (int a = 0; a < num_elem_nodes; a++) {
+      int rowN = eqN(a);
+      if (rowN == -1) {
+        continue;
+      }
+
+      for (int b = 0; b < num_elem_nodes; b++) {
+        int colN = eqN(b);
+        if (colN == -1) {
+          continue;
+        }
+
+        for (int i = 0; i < dof; i++) {
+          double sum = 0.0;
+          for (int j = 0; j < dof; j++) {
+            sum += lK(i*dof+j,a,b) * U(j,colN);
+          }
+          KU(i,rowN) += sum;
+        }
+      }
+    }
+
+    return;
+  }
+
+  auto& R = com_mod.R;
+  auto& Val = com_mod.Val;
+
+  for (int a = 0; a < num_elem_nodes; a++) {
+    int rowN = eqN(a);
+    if (rowN == -1) {
+      continue;
+    }
+
+    for (int i = 0; i < R.nrows(); i++) {
+      R(i,rowN) = R(i,rowN) + lR(i,a);
+    }
+
+    for (int b = 0; b < num_elem_nodes; b++) {
+      if (eqN(b) != rowN) {
+        continue;
+      }
+
+      for (int i = 0; i < Val.nrows(); i++) {
+        Val(i,rowN) = Val(i,rowN) + lK(i,a,b);
+      }
+    }
+  }
+}
+
 /// @brief Check the validity of the preconditioner and assembly types options. 
 void FsilsLinearAlgebra::check_options(const consts::PreconditionerType prec_cond_type, 
   const consts::LinearAlgebraType assembly_type)
@@ -144,6 +269,33 @@ void FsilsLinearAlgebra::solve(ComMod& com_mod, eqType& lEq, const Vector<int>&
   auto& Val = com_mod.Val;
   auto preconditioner = lEq.linear_algebra_preconditioner;
 
+  if (matrix_free) {
+    if (!assembly_function) {
+      throw std::runtime_error("[FsilsLinearAlgebra::solve] No assembly function has been set for the matrix-free linear solver.");
+    }
+    lhs.mat_vec = [this](const Array<double>& U, Array<double>& KU) { mat_vec(U, KU); };
+  }
+
   fsi_linear_solver::fsils_solve(lhs, lEq.FSILS, dof, R, Val, preconditioner, incL, res);
+
+  lhs.mat_vec = nullptr;
+  assembly_function = nullptr;
+}
+
+/// @brief Apply the tangent matrix, KU = K*U, by reassembling the equation.
+///
+/// U and KU are in the local node ordering. KU only contains the contributions 
+/// of the elements and faces of this process.
+//
+void FsilsLinearAlgebra::mat_vec(const Array<double>& U, Array<double>& KU)
+{
+  KU = 0.0;
+  mat_vec_U = &U;
+  mat_vec_KU = &KU;
+
+  assembly_function();
+
+  mat_vec_U = nullptr;
+  mat_vec_KU = nullptr;
 }
 
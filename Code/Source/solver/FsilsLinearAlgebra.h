@@ -45,15 +45,36 @@ class FsilsLinearAlgebra : public virtual LinearAlgebra {
     virtual void alloc(ComMod& com_mod, eqType& lEq);
     virtual void assemble(ComMod& com_mod, const int num_elem_nodes, const Vector<int>& eqN,
         const Array3<double>& lK, const Array<double>& lR);
+    virtual void assemble(ComMod& com_mod, const mshType& lM, const int e, const Vector<int>& eqN,
+        const Array3<double>& lK, const Array<double>& lR);
     virtual void check_options(const consts::PreconditionerType prec_cond_type, const consts::LinearAlgebraType assembly_type);
     virtual void initialize(ComMod& com_mod, eqType& lEq);
     virtual void solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res);
     virtual void set_assembly(consts::LinearAlgebraType atype);
     virtual void set_preconditioner(consts::PreconditionerType prec_type);
+    virtual bool thread_safe_assembly() { return true; }
+    virtual void set_assembly_function(std::function<void()> function) { assembly_function = function; }
 
   private:
     /// @brief A list of linear algebra interfaces that can be used for assembly.
     static std::set<consts::LinearAlgebraType> valid_assemblers; 
+
+    void assemble_matrix_free(ComMod& com_mod, const int num_elem_nodes, const Vector<int>& eqN,
+        const Array3<double>& lK, const Array<double>& lR);
+    void mat_vec(const Array<double>& U, Array<double>& KU);
+
+    /// @brief If true only the block diagonal of the tangent matrix is 
+    /// assembled, in com_mod.Val(dof*dof,tnNo), and the matrix is applied 
+    /// by reassembling the equation.
+    bool matrix_free = false;
+
+    /// @brief Function reassembling the current equation.
+    std::function<void()> assembly_function;
+
+    /// @brief The vector the tangent matrix is applied to, and the product,
+    /// while the equation is reassembled by mat_vec().
+    const Array<double>* mat_vec_U = nullptr;
+    Array<double>* mat_vec_KU = nullptr;
 };
 
 #endif
@@ -34,6 +34,8 @@
 #include "ComMod.h"
 #include "consts.h"
 
+#include <functional>
+
 /// @brief The LinearAlgebra class provides an abstract interface to linear algebra 
 /// frameworks: FSILS, Trilinos, PETSc, etc.
 //
@@ -49,14 +51,31 @@ class LinearAlgebra {
     virtual void alloc(ComMod& com_mod, eqType& lEq) = 0;
     virtual void assemble(ComMod& com_mod, const int num_elem_nodes, const Vector<int>& eqN, 
         const Array3<double>& lK, const Array<double>& lR) = 0;
+    virtual void assemble(ComMod& com_mod, const mshType& lM, const int e, const Vector<int>& eqN, 
+        const Array3<double>& lK, const Array<double>& lR);
     virtual void check_options(const consts::PreconditionerType prec_cond_type, const consts::LinearAlgebraType assembly_type) = 0;
     virtual void initialize(ComMod& com_mod, eqType& lEq) = 0;
     virtual void set_assembly(consts::LinearAlgebraType assembly_type) = 0;
     virtual void set_preconditioner(consts::PreconditionerType prec_type) = 0;
+
+    /// @brief Set the reuse of the preconditioner between solves. A preconditioner 
+    /// is used for at most 'max_solves' solves and is rebuilt when the number of 
+    /// iterations exceeds 'max_ratio' times the iterations of its first solve.
+    virtual void set_preconditioner_reuse(const consts::PreconditionerReuseType reuse, const int max_solves, 
+        const double max_ratio) { }
     virtual void solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res) = 0;
 
     virtual consts::LinearAlgebraType get_interface_type() { return interface_type; }
 
+    /// @brief Return true if assemble() can be called concurrently for 
+    /// elements that do not share global rows.
+    virtual bool thread_safe_assembly() { return false; }
+
+    /// @brief Set the function that reassembles the current equation. It is
+    /// used by matrix-free solvers to apply the tangent matrix and is only
+    /// valid during the next call to solve().
+    virtual void set_assembly_function(std::function<void()> function) { }
+
     consts::LinearAlgebraType interface_type = consts::LinearAlgebraType::none;
     consts::LinearAlgebraType assembly_type = consts::LinearAlgebraType::none;
     consts::PreconditionerType preconditioner_type = consts::PreconditionerType::PREC_NONE;
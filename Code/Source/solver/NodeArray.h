@@ -0,0 +1,96 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NODE_ARRAY_H 
+#define NODE_ARRAY_H 
+
+#include <array>
+#include <vector>
+
+/// @brief The NodeArray template class stores the temporaries of element 
+/// kernels indexed by element node last, x[a], x[i][a] or x[i][j][a] for 
+/// the dimensions D1 = D2 = 0, D2 = 0 or both > 0.
+///
+/// For element types with a compile-time number of nodes N > 0 the values 
+/// are stored in a fixed-size array on the stack. For N = 0 they are 
+/// allocated for the number of nodes given to the constructor, so any 
+/// element type is supported. The values are initialized to zero.
+//
+template <int N, int D1 = 0, int D2 = 0>
+class NodeArray 
+{
+  static constexpr int size1 = (D1 > 0) ? D1 : 1;
+  static constexpr int size2 = (D2 > 0) ? D2 : 1;
+
+  public:
+    /// @brief A D2 x number of nodes slice of a three index array.
+    class Slice 
+    {
+      public:
+        Slice(double* data, const int stride) : data_(data), stride_(stride) {}
+        double* operator[](const int j) const { return data_ + j*stride_; }
+
+      private:
+        double* data_;
+        int stride_;
+    };
+
+    explicit NodeArray(const int num_nodes) 
+    {
+      if (N == 0) {
+        dynamic_.assign(size1*size2*num_nodes, 0.0);
+        num_nodes_ = num_nodes;
+      }
+    }
+
+    NodeArray(const NodeArray&) = delete;
+    NodeArray& operator=(const NodeArray&) = delete;
+
+    decltype(auto) operator[](const int i) 
+    {
+      if constexpr (D1 == 0) {
+        return (data()[i]);
+      } else if constexpr (D2 == 0) {
+        return data() + i*stride();
+      } else {
+        return Slice(data() + i*D2*stride(), stride());
+      }
+    }
+
+  private:
+    double* data() { return (N > 0) ? fixed_.data() : dynamic_.data(); }
+    int stride() const { return (N > 0) ? N : num_nodes_; }
+
+    std::array<double, size1*size2*N> fixed_{};
+    std::vector<double> dynamic_;
+    int num_nodes_ = 0;
+};
+
+#endif
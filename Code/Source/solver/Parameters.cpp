@@ -1832,8 +1832,12 @@ EquationParameters::EquationParameters()
   set_parameter("Max_iterations", 1, !required, max_iterations);
   set_parameter("Min_iterations", 1, !required, min_iterations);
 
+  set_parameter("Partition_cost", 1.0, !required, partition_cost);
   set_parameter("Prestress", false, !required, prestress);
 
+  set_parameter("Tangent_update_iterations", 1, !required, tangent_update_iterations);
+  set_parameter("Tangent_update_residual_ratio", 0.0, !required, tangent_update_residual_ratio);
+  set_parameter("Tangent_update_time_steps", 1, !required, tangent_update_time_steps);
   set_parameter("Tolerance", 0.5, !required, tolerance);
   set_parameter("Use_taylor_hood_type_basis", false, !required, use_taylor_hood_type_basis);
 }
@@ -2002,12 +2006,17 @@ GeneralSimulationParameters::GeneralSimulationParameters()
   // A parameter that must be defined.
   bool required = true;
 
+  set_parameter("Asynchronous_output", false, !required, asynchronous_output);
+  set_parameter("Asynchronous_output_queue_size", 2, !required, asynchronous_output_queue_size);
+
   set_parameter("Check_IEN_order", true, !required, check_ien_order);
+  set_parameter("Compress_restart_file", false, !required, compress_restart_file);
   set_parameter("Continue_previous_simulation", false, required, continue_previous_simulation);
   set_parameter("Convert_BIN_to_VTK_format", false, !required, convert_bin_to_vtk_format);
 
   set_parameter("Debug", false, !required, debug);
 
+  set_parameter("Increment_in_saving_full_restart_files", 0, !required, increment_in_saving_full_restart_files);
   set_parameter("Increment_in_saving_restart_files", 0, !required, increment_in_saving_restart_files);
   set_parameter("Increment_in_saving_VTK_files", 0, !required, increment_in_saving_vtk_files);
 
@@ -2018,11 +2027,21 @@ GeneralSimulationParameters::GeneralSimulationParameters()
 
   set_parameter("Overwrite_restart_file", false, !required, overwrite_restart_file);
 
+  set_parameter("Partition_balance_solver", false, !required, partition_balance_solver);
+  set_parameter("Partition_cache_folder", "", !required, partition_cache_folder);
+  set_parameter("Partition_cost_file", "", !required, partition_cost_file);
+  set_parameter("Partition_with_cost_model", false, !required, partition_with_cost_model);
+
+  set_parameter("Profile", false, !required, profile);
+  set_parameter("Profile_file_name", "", !required, profile_file_name);
+
   set_parameter("Restart_file_name", "stFile", !required, restart_file_name);
 
   set_parameter("Save_averaged_results", false, !required, save_averaged_results);
   set_parameter("Save_results_in_folder", "", !required, save_results_in_folder);
   set_parameter("Save_results_to_VTK_format", false, required, save_results_to_vtk_format);
+  set_parameter("Save_results_to_partitioned_VTK_format", false, !required, save_results_to_partitioned_vtk_format);
+  set_parameter("Save_restart_file_in_global_node_order", false, !required, save_restart_file_in_global_node_order);
   set_parameter("Searched_file_name_to_trigger_stop", "", !required, searched_file_name_to_trigger_stop);
   set_parameter("Simulation_initialization_file_path", "", !required, simulation_initialization_file_path);
   set_parameter("Simulation_requires_remeshing", false, !required, simulation_requires_remeshing);
@@ -2246,6 +2265,9 @@ MeshParameters::MeshParameters()
   set_parameter("Domain", 0,  !required, domain_id);
   set_parameter("Domain_file_path", "", !required, domain_file_path);
 
+  set_parameter("Cache_element_geometry", false, !required, cache_element_geometry);
+  set_parameter("Element_geometry_cache_size", 1024.0, !required, element_geometry_cache_size);
+
   //set_parameter("Fiber_direction", {}, !required, fiber_direction);
   set_parameter("Fiber_direction_file_path", {}, !required, fiber_direction_file_paths);
 
@@ -2425,6 +2447,10 @@ LinearAlgebraParameters::LinearAlgebraParameters()
   auto prec_type = consts::preconditioner_type_to_name.at(consts::PreconditionerType::PREC_NONE);
   set_parameter("Preconditioner", prec_type, !required, preconditioner);
 
+  set_parameter("Preconditioner_reuse", "none", !required, preconditioner_reuse);
+  set_parameter("Preconditioner_reuse_max_iteration_ratio", 2.0, !required, preconditioner_reuse_max_iteration_ratio);
+  set_parameter("Preconditioner_reuse_max_solves", 10, !required, preconditioner_reuse_max_solves);
+
   auto assemble_type = LinearAlgebra::type_to_name.at(consts::LinearAlgebraType::none);
   set_parameter("Assembly", assemble_type, !required, assembly);
 }
@@ -2487,6 +2513,15 @@ void LinearAlgebraParameters::set_values(tinyxml2::XMLElement* xml_elem)
         "' given in the XML <Linear_algebra> <Preconditioner> element.\nValid types are: " + valid_types);
   }     
 
+  // Check preconditioner reuse type.
+  if (consts::preconditioner_reuse_name_to_type.count(preconditioner_reuse.value()) == 0) {
+    std::string valid_types = "";
+    std::for_each(consts::preconditioner_reuse_name_to_type.begin(), consts::preconditioner_reuse_name_to_type.end(),
+        [&valid_types](std::pair<const std::string, const consts::PreconditionerReuseType> p) {valid_types += p.first+" ";});
+    throw std::runtime_error("Unknown TYPE '" + preconditioner_reuse() + 
+        "' given in the XML <Linear_algebra> <Preconditioner_reuse> element.\nValid types are: " + valid_types);
+  }     
+
   check_input_parameters();
 
   values_set_ = true;
@@ -2523,14 +2558,31 @@ LinearSolverParameters::LinearSolverParameters()
 
   set_parameter("Absolute_tolerance", 1.0e-10, !required, absolute_tolerance);
 
+  set_parameter("AMG_coarse_size", 500, !required, amg_coarse_size);
+  set_parameter("AMG_max_levels", 10, !required, amg_max_levels);
+  set_parameter("AMG_smoother", "Chebyshev", !required, amg_smoother);
+  set_parameter("AMG_smoother_sweeps", 2, !required, amg_smoother_sweeps);
+  set_parameter("AMG_strength_threshold", 0.0, !required, amg_strength_threshold);
+
+  set_parameter("Forcing_term", "none", !required, forcing_term);
+  set_parameter("Forcing_term_initial", 0.1, !required, forcing_term_initial);
+  set_parameter("Forcing_term_max", 0.9, !required, forcing_term_max);
+
+  set_parameter("ILU_fill_level", 0, !required, ilu_fill_level);
+  set_parameter("Initial_guess_basis_size", 0, !required, initial_guess_basis_size);
+
   set_parameter("Krylov_space_dimension", 50, !required, krylov_space_dimension);
 
+  set_parameter("Matrix_free", false, !required, matrix_free);
   set_parameter("Max_iterations", 1000, !required, max_iterations);
 
   set_parameter("NS_CG_max_iterations", 1000, !required, ns_cg_max_iterations);
   set_parameter("NS_CG_tolerance", 1.0e-2, !required, ns_cg_tolerance);
   set_parameter("NS_GM_max_iterations", 1000, !required, ns_gm_max_iterations);
   set_parameter("NS_GM_tolerance", 1.0e-2, !required, ns_gm_tolerance);
+  set_parameter("NS_GM_pipelined", false, !required, ns_gm_pipelined);
+
+  set_parameter("Recycle_space_size", 0, !required, recycle_space_size);
 
   //set_parameter("Preconditioner", "", !required, preconditioner);
 
@@ -943,6 +943,9 @@ class LinearAlgebraParameters : public ParameterLists
     Parameter<std::string> assembly;
     Parameter<std::string> configuration_file;
     Parameter<std::string> preconditioner;
+    Parameter<std::string> preconditioner_reuse;
+    Parameter<double> preconditioner_reuse_max_iteration_ratio;
+    Parameter<int> preconditioner_reuse_max_solves;
 };
 
 /// @brief The LinearSolverParameters class stores parameters for
@@ -960,13 +963,31 @@ class LinearSolverParameters : public ParameterLists
     Parameter<std::string> type;
 
     Parameter<double> absolute_tolerance;
+
+    Parameter<int> amg_coarse_size;
+    Parameter<int> amg_max_levels;
+    Parameter<std::string> amg_smoother;
+    Parameter<int> amg_smoother_sweeps;
+    Parameter<double> amg_strength_threshold;
+
+    Parameter<std::string> forcing_term;
+    Parameter<double> forcing_term_initial;
+    Parameter<double> forcing_term_max;
+
+    Parameter<int> ilu_fill_level;
+    Parameter<int> initial_guess_basis_size;
+
     Parameter<int> krylov_space_dimension;
 
+    Parameter<bool> matrix_free;
     Parameter<int> max_iterations;
     Parameter<int> ns_cg_max_iterations;
     Parameter<double> ns_cg_tolerance;
     Parameter<int> ns_gm_max_iterations; 
     Parameter<double> ns_gm_tolerance;
+    Parameter<bool> ns_gm_pipelined;
+
+    Parameter<int> recycle_space_size;
 
     //Parameter<std::string> preconditioner;
 
@@ -1207,6 +1228,7 @@ class ContactParameters : public ParameterLists
 /// \code {.xml}
 /// <Add_equation type="FSI" >
 ///   <Coupled> true </Coupled>
+///   <Partition_cost> 1.0 </Partition_cost>
 ///   <Min_iterations> 1 </Min_iterations>
 ///   <Max_iterations> 1 </Max_iterations>
 ///   .
@@ -1242,11 +1264,16 @@ class EquationParameters : public ParameterLists
     Parameter<int> min_iterations;
     Parameter<double> momentum_stabilization_coefficient;
 
+    Parameter<double> partition_cost;
     Parameter<double> penalty_parameter;
     Parameter<double> poisson_ratio;
     Parameter<bool> prestress;
 
     Parameter<double> source_term;
+
+    Parameter<int> tangent_update_iterations;
+    Parameter<double> tangent_update_residual_ratio;
+    Parameter<int> tangent_update_time_steps;
     Parameter<double> tolerance;
 
     Parameter<std::string> type;
@@ -1296,14 +1323,26 @@ class EquationParameters : public ParameterLists
 ///   <Spectral_radius_of_infinite_time_step> 0.50 </Spectral_radius_of_infinite_time_step>
 ///   <Searched_file_name_to_trigger_stop> STOP_SIM </Searched_file_name_to_trigger_stop>
 ///   <Save_results_to_VTK_format> true </Save_results_to_VTK_format>
+///   <Save_results_to_partitioned_VTK_format> false </Save_results_to_partitioned_VTK_format>
+///   <Asynchronous_output> true </Asynchronous_output>
+///   <Asynchronous_output_queue_size> 2 </Asynchronous_output_queue_size>
 ///   <Name_prefix_of_saved_VTK_files> result </Name_prefix_of_saved_VTK_files>
+///   <Partition_cache_folder> partitions </Partition_cache_folder>
+///   <Partition_with_cost_model> true </Partition_with_cost_model>
+///   <Partition_cost_file> partition_cost.txt </Partition_cost_file>
+///   <Partition_balance_solver> true </Partition_balance_solver>
 ///   <Increment_in_saving_VTK_files> 1 </Increment_in_saving_VTK_files>
 ///   <Start_saving_after_time_step> 1 </Start_saving_after_time_step>
 ///   <Increment_in_saving_restart_files> 1 </Increment_in_saving_restart_files>
+///   <Save_restart_file_in_global_node_order> false </Save_restart_file_in_global_node_order>
+///   <Compress_restart_file> true </Compress_restart_file>
+///   <Increment_in_saving_full_restart_files> 100 </Increment_in_saving_full_restart_files>
 ///   <Convert_BIN_to_VTK_format> 0 </Convert_BIN_to_VTK_format>
 ///   <Verbose> 1 </Verbose>
 ///   <Warning> 0 </Warning>
 ///   <Debug> 0 </Debug>
+///   <Profile> true </Profile>
+///   <Profile_file_name> profile.csv </Profile_file_name>
 ///   <Simulation_requires_remeshing> true </Simulation_requires_remeshing>
 /// </GeneralSimulationParameters>
 /// \endcode
@@ -1317,12 +1356,19 @@ class GeneralSimulationParameters : public ParameterLists
 
     std::string xml_element_name;
 
+    Parameter<bool> asynchronous_output;
     Parameter<bool> check_ien_order;
+    Parameter<bool> compress_restart_file;
     Parameter<bool> continue_previous_simulation;
     Parameter<bool> convert_bin_to_vtk_format;
     Parameter<bool> debug;
     Parameter<bool> overwrite_restart_file;
+    Parameter<bool> partition_balance_solver;
+    Parameter<bool> partition_with_cost_model;
+    Parameter<bool> profile;
     Parameter<bool> save_averaged_results;
+    Parameter<bool> save_restart_file_in_global_node_order;
+    Parameter<bool> save_results_to_partitioned_vtk_format;
     Parameter<bool> save_results_to_vtk_format;
     Parameter<bool> simulation_requires_remeshing;
     Parameter<bool> start_averaging_from_zero;
@@ -1332,6 +1378,8 @@ class GeneralSimulationParameters : public ParameterLists
     Parameter<double> spectral_radius_of_infinite_time_step;
     Parameter<double> time_step_size;
 
+    Parameter<int> asynchronous_output_queue_size;
+    Parameter<int> increment_in_saving_full_restart_files;
     Parameter<int> increment_in_saving_restart_files;
     Parameter<int> increment_in_saving_vtk_files;
     Parameter<int> number_of_spatial_dimensions;
@@ -1341,6 +1389,9 @@ class GeneralSimulationParameters : public ParameterLists
     Parameter<int> number_of_time_steps;
 
     Parameter<std::string> name_prefix_of_saved_vtk_files;
+    Parameter<std::string> partition_cache_folder;
+    Parameter<std::string> partition_cost_file;
+    Parameter<std::string> profile_file_name; 
     Parameter<std::string> restart_file_name; 
     Parameter<std::string> searched_file_name_to_trigger_stop; 
     Parameter<std::string> save_results_in_folder; 
@@ -1411,6 +1462,9 @@ class MeshParameters : public ParameterLists
     Parameter<int> domain_id;
     Parameter<std::string> domain_file_path;
 
+    Parameter<bool> cache_element_geometry;
+    Parameter<double> element_geometry_cache_size;
+
     VectorParameter<std::string> fiber_direction_file_paths;
     //Parameter<std::string> fiber_direction_file_path;
     std::vector<VectorParameter<double>> fiber_directions;
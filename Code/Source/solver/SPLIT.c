@@ -32,6 +32,9 @@
 //
 // Interface to Metis for partitioning the mesh.
 //
+// If ncon > 0, elmWgt holds ncon weights for each element that are 
+// balanced across the partitions.
+//
 //--------------------------------------------------------------------
 
 #ifndef SEQ
@@ -39,19 +42,22 @@
 #include"parmetislib.h"
 
 int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN,
-   int *nPartsPtr, idx_t *iElmdist, float *iWgt, idx_t *part)
+   int *nPartsPtr, idx_t *iElmdist, float *iWgt, idx_t *part,
+   int *nconPtr, idx_t *elmWgt)
 {
 
-   int i, e, a, nEl=*nElptr, eNoN=*eNoNptr, eNoNb=*eNoNbptr,
+   int i, j, e, a, nEl=*nElptr, eNoN=*eNoNptr, eNoNb=*eNoNbptr,
       nparts, nTasks=*nPartsPtr, wgtflag, numflag, ncon, task,
       ncommonnodes, options[10], *exRanks, nExRanks, *map, edgecut;
 
    float ubvec[MAXNCON], *wgt;
    idx_t *eptr, *eind, *elmdist;
 
+   ncon = (*nconPtr > 0) ? *nconPtr : 1;
+
    map     = (int *)malloc(nTasks*sizeof(int));
    exRanks = (int *)malloc(nTasks*sizeof(int));
-   wgt     = (float *)malloc(nTasks*sizeof(float));
+   wgt     = (float *)malloc(nTasks*ncon*sizeof(float));
    elmdist = (idx_t *)malloc((nTasks+1)*sizeof(idx_t));
    MPI_Group newGrp, tmpGrp;
    MPI_Comm comm;
@@ -69,7 +75,7 @@ int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN,
          nExRanks++;
       } else {
          map[nparts] = i;
-         wgt[nparts] = iWgt[i];
+         for (j=0; j<ncon; j++) wgt[nparts*ncon+j] = iWgt[i];
          elmdist[nparts+1] = iElmdist[i+1];
          nparts++;
       }
@@ -100,9 +106,8 @@ int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN,
    for (a=0; a<nEl*eNoN; a++) {
       eind[a] = IEN[a] - 1;
    }
-   wgtflag = 0;
+   wgtflag = (*nconPtr > 0) ? 2 : 0;
    numflag = 0;
-   ncon = 1;
    ncommonnodes = eNoNb;
 
    for (i=0; i<ncon; i++) ubvec[i] = UNBALANCE_FRACTION;
@@ -111,7 +116,7 @@ int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN,
    options[PMV3_OPTION_DBGLVL] = 0;
    options[PMV3_OPTION_SEED] = 10;
 
-   ParMETIS_V3_PartMeshKway(elmdist, eptr, eind, NULL, &wgtflag,
+   ParMETIS_V3_PartMeshKway(elmdist, eptr, eind, (wgtflag ? elmWgt : NULL), &wgtflag,
       &numflag, &ncon, &ncommonnodes, &nparts, wgt, ubvec,
       options, &edgecut, part, &comm);
 
@@ -143,7 +148,8 @@ int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN,
 }
 #else
 int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN,
-   int *nPartsptr, int *iElmdist, float *iWgt, int *part)  {
+   int *nPartsptr, int *iElmdist, float *iWgt, int *part,
+   int *nconPtr, int *elmWgt)  {
    return 0;
 }
 #endif
@@ -89,6 +89,9 @@ void Simulation::set_module_parameters()
   com_mod.stopTrigName = general.searched_file_name_to_trigger_stop.value();
   com_mod.ichckIEN = general.check_ien_order.value();
   com_mod.saveVTK = general.save_results_to_vtk_format.value();
+  com_mod.savePVTU = general.save_results_to_partitioned_vtk_format.value();
+  com_mod.asyncOutput = general.asynchronous_output.value();
+  com_mod.asyncOutputQueueSize = general.asynchronous_output_queue_size.value();
   com_mod.saveName = general.name_prefix_of_saved_vtk_files.value();
   com_mod.saveName = chnl_mod.appPath + com_mod.saveName;
   com_mod.saveIncr = general.increment_in_saving_vtk_files.value();
@@ -98,8 +101,32 @@ void Simulation::set_module_parameters()
   com_mod.stFileRepl = general.overwrite_restart_file.value();
   com_mod.stFileName = chnl_mod.appPath + general.restart_file_name.value();
   com_mod.stFileIncr = general.increment_in_saving_restart_files.value();
+  com_mod.stFileGlobal = general.save_restart_file_in_global_node_order.value();
+  com_mod.stFileCompress = general.compress_restart_file.value();
+  com_mod.stFileFullIncr = general.increment_in_saving_full_restart_files.value();
+
+  if (com_mod.stFileGlobal && com_mod.stFileCompress) {
+    throw std::runtime_error("[svFSIplus] The 'Compress_restart_file' and 'Save_restart_file_in_global_node_order' " 
+        "parameters can not both be true.");
+  }
+
   com_mod.rmsh.isReqd = general.simulation_requires_remeshing.value();
 
+  if (general.partition_cache_folder.value() != "") {
+    com_mod.partCacheDir = chnl_mod.appPath + general.partition_cache_folder.value();
+  }
+
+  com_mod.partCost = general.partition_with_cost_model.value();
+  com_mod.partBalanceSolver = general.partition_balance_solver.value();
+  if (general.partition_cost_file.value() != "") {
+    com_mod.partCostFile = chnl_mod.appPath + general.partition_cost_file.value();
+  }
+
+  com_mod.profile = general.profile.value();
+  if (general.profile_file_name.value() != "") {
+    com_mod.profileFileName = chnl_mod.appPath + general.profile_file_name.value();
+  }
+
   auto& precomp_sol = parameters.precomputed_solution_parameters;
   com_mod.usePrecomp = precomp_sol.use_precomputed_solution.value();
   com_mod.precompFileName = precomp_sol.file_path.value();
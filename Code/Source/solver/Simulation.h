@@ -31,6 +31,8 @@
 #ifndef SIMULATION_H 
 #define SIMULATION_H 
 
+#include "AsyncWriter.h"
+#include "Checkpoint.h"
 #include "ComMod.h"
 #include "Parameters.h"
 #include "SimulationLogger.h"
@@ -71,6 +73,12 @@ class Simulation {
     // Log solution information.
     SimulationLogger logger;
 
+    // Write restart and VTK files in the background.
+    AsyncWriter output_writer;
+
+    // Write compressed restart files.
+    Checkpoint checkpoint;
+
     // Number of time steps
     int nTs;
 
@@ -47,6 +47,8 @@ class TrilinosLinearAlgebra::TrilinosImpl {
         const Array3<double>& lK, const Array<double>& lR){};
     void initialize(ComMod& com_mod) {};
     void set_preconditioner(consts::PreconditionerType prec_type) {};
+    void set_preconditioner_reuse(const consts::PreconditionerReuseType reuse, const int max_solves, 
+        const double max_ratio) {};
     void solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res) {};
     void solve_assembled(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res) {};
 };
@@ -80,6 +82,10 @@ TrilinosLinearAlgebra::~TrilinosLinearAlgebra()
   if (fsils_solver != nullptr) { 
     delete fsils_solver;
   }
+
+  if (impl != nullptr) { 
+    delete impl;
+  }
 }
 
 /// @brief Allocate data arrays.
@@ -108,6 +114,18 @@ void TrilinosLinearAlgebra::assemble(ComMod& com_mod, const int num_elem_nodes,
   }
 }
 
+/// @brief Assemble the local arrays of element 'e' of mesh 'lM'.
+//
+void TrilinosLinearAlgebra::assemble(ComMod& com_mod, const mshType& lM, const int e, const Vector<int>& eqN,
+        const Array3<double>& lK, const Array<double>& lR)
+{
+  if (use_fsils_assembly) {
+    fsils_solver->assemble(com_mod, lM, e, eqN, lK, lR);
+  } else {
+    impl->assemble(com_mod, lM.eNoN, eqN, lK, lR);
+  }
+}
+
 /// @brief Check the validity of the precondition and assembly options. 
 /// 
 /// Trilinos can use fsils or trilinos for assembly.
@@ -192,6 +210,13 @@ void TrilinosLinearAlgebra::set_preconditioner(consts::PreconditionerType prec_t
   impl->set_preconditioner(prec_type);
 }
 
+/// @brief Set the reuse of the ML and Ifpack preconditioners between solves.
+void TrilinosLinearAlgebra::set_preconditioner_reuse(const consts::PreconditionerReuseType reuse, 
+    const int max_solves, const double max_ratio)
+{
+  impl->set_preconditioner_reuse(reuse, max_solves, max_ratio);
+}
+
 /// @brief Solve a system of linear equations.
 void TrilinosLinearAlgebra::solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res)
 {
@@ -35,16 +35,16 @@ template<>
 bool Vector<double>::show_index_check_message = true;
 
 template<>
-double Vector<double>::memory_in_use = 0;
+std::atomic<long long> Vector<double>::memory_in_use{0};
 
 template<>
-double Vector<double>::memory_returned = 0;
+std::atomic<long long> Vector<double>::memory_returned{0};
 
 template<>
-int Vector<double>::num_allocated = 0;
+std::atomic<int> Vector<double>::num_allocated{0};
 
 template<>
-int Vector<double>::active = 0;
+std::atomic<int> Vector<double>::active{0};
 
 template<>
 bool Vector<double>::write_enabled = false;
@@ -69,16 +69,16 @@ template<>
 bool Vector<int>::show_index_check_message = true;
 
 template<>
-double Vector<int>::memory_in_use = 0;
+std::atomic<long long> Vector<int>::memory_in_use{0};
 
 template<>
-double Vector<int>::memory_returned = 0;
+std::atomic<long long> Vector<int>::memory_returned{0};
 
 template<>
-int Vector<int>::num_allocated = 0;
+std::atomic<int> Vector<int>::num_allocated{0};
 
 template<>
-int Vector<int>::active = 0;
+std::atomic<int> Vector<int>::active{0};
 
 template<>
 bool Vector<int>::write_enabled = false;
@@ -101,16 +101,16 @@ template<>
 bool Vector<Vector<double>>::show_index_check_message = true;
 
 template<>
-double Vector<Vector<double>>::memory_in_use = 0;
+std::atomic<long long> Vector<Vector<double>>::memory_in_use{0};
 
 template<>
-double Vector<Vector<double>>::memory_returned = 0;
+std::atomic<long long> Vector<Vector<double>>::memory_returned{0};
 
 template<>
-int Vector<Vector<double>>::num_allocated = 0;
+std::atomic<int> Vector<Vector<double>>::num_allocated{0};
 
 template<>
-int Vector<Vector<double>>::active = 0;
+std::atomic<int> Vector<Vector<double>>::active{0};
 
 template<>
 bool Vector<Vector<double>>::write_enabled = false;
@@ -120,16 +120,16 @@ template<>
 bool Vector<float>::show_index_check_message = true;
 
 template<>
-double Vector<float>::memory_in_use = 0;
+std::atomic<long long> Vector<float>::memory_in_use{0};
 
 template<>
-double Vector<float>::memory_returned = 0;
+std::atomic<long long> Vector<float>::memory_returned{0};
 
 template<>
-int Vector<float>::num_allocated = 0;
+std::atomic<int> Vector<float>::num_allocated{0};
 
 template<>
-int Vector<float>::active = 0;
+std::atomic<int> Vector<float>::active{0};
 
 template<>
 bool Vector<float>::write_enabled = false;
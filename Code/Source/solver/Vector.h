@@ -32,6 +32,7 @@
 #define VECTOR_H 
 
 #include <algorithm>
+#include <atomic>
 #include <float.h>
 #include <iostream>
 #include <string>
@@ -50,10 +51,10 @@ class Vector
 {
   public:
 
-    static int num_allocated;
-    static int active;
-    static double memory_in_use;
-    static double memory_returned;
+    static std::atomic<int> num_allocated;
+    static std::atomic<int> active;
+    static std::atomic<long long> memory_in_use;
+    static std::atomic<long long> memory_returned;
     static bool write_enabled;
     static bool show_index_check_message;
     static void memory(const std::string& prefix="");
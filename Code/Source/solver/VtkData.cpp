@@ -34,6 +34,7 @@
 #include <vtkDoubleArray.h>
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include <vtkDataSetAttributes.h>
 #include <vtkGenericCell.h>
 #include <vtkIntArray.h>
 #include <vtkPointData.h>
@@ -253,6 +254,7 @@ class VtkVtuData::VtkVtuDataImpl {
     void set_point_data(const std::string& data_name, const Array<int>& data);
     void set_point_data(const std::string& data_name, const Vector<int>& data);
 
+    void set_ghost_points(const Vector<int>& ghosts);
     void set_points(const Array<double>& points);
     void write(const std::string& file_name);
 
@@ -486,6 +488,25 @@ void VtkVtuData::VtkVtuDataImpl::set_point_data(const std::string& data_name, co
   throw std::runtime_error("[VtkVtuData] set_point_data for Vector<int> not implemented.");
 }
 
+/// @brief Mark the points with a non-zero 'ghosts' value as duplicates of 
+/// points owned by another piece of a partitioned unstructured grid.
+//
+void VtkVtuData::VtkVtuDataImpl::set_ghost_points(const Vector<int>& ghosts)
+{
+  int num_vals = ghosts.size();
+
+  auto data_array = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  data_array->SetNumberOfComponents(1);
+  data_array->SetNumberOfTuples(num_vals);
+  data_array->SetName("vtkGhostType");
+
+  for (int i = 0; i < num_vals; i++) {
+    data_array->SetValue(i, (ghosts(i) != 0) ? vtkDataSetAttributes::DUPLICATEPOINT : 0);
+  }
+
+  vtk_ugrid->GetPointData()->AddArray(data_array);
+}
+
 /// @brief Set the 3D points (coordinates) data for the unstructured grid.
 //
 void VtkVtuData::VtkVtuDataImpl::set_points(const Array<double>& points)
@@ -804,6 +825,11 @@ void VtkVtpData::set_point_data(const std::string& data_name, const Vector<int>&
   impl->set_point_data(data_name, data);
 }
 
+void VtkVtpData::set_ghost_points(const Vector<int>& ghosts)
+{
+  throw std::runtime_error("[VtkVtpData] set_ghost_points not implemented.");
+}
+
 void VtkVtpData::set_points(const Array<double>& points)
 {
   impl->set_points(points);
@@ -1076,6 +1102,11 @@ void VtkVtuData::set_point_data(const std::string& data_name, const Vector<int>&
   impl->set_point_data(data_name, data);
 }
 
+void VtkVtuData::set_ghost_points(const Vector<int>& ghosts)
+{
+  impl->set_ghost_points(ghosts);
+}
+
 void VtkVtuData::set_points(const Array<double>& points)
 {
   impl->set_points(points);
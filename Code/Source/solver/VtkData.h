@@ -56,6 +56,7 @@ class VtkData {
     virtual void set_point_data(const std::string& data_name, const Array<int>& data) = 0;
     virtual void set_point_data(const std::string& data_name, const Vector<int>& data) = 0;
 
+    virtual void set_ghost_points(const Vector<int>& ghosts) = 0;
     virtual void set_points(const Array<double>& points) = 0;
     virtual void set_connectivity(const int nsd, const Array<int>& conn, const int pid = 0) = 0;
 
@@ -102,6 +103,7 @@ class VtkVtpData : public VtkData {
     virtual void set_point_data(const std::string& data_name, const Array<int>& data);
     virtual void set_point_data(const std::string& data_name, const Vector<int>& data);
 
+    virtual void set_ghost_points(const Vector<int>& ghosts);
     virtual void set_points(const Array<double>& points);
     virtual void write();
 
@@ -141,6 +143,7 @@ class VtkVtuData : public VtkData {
     virtual void set_point_data(const std::string& data_name, const Array<int>& data);
     virtual void set_point_data(const std::string& data_name, const Vector<int>& data);
 
+    virtual void set_ghost_points(const Vector<int>& ghosts);
     virtual void set_points(const Array<double>& points);
     virtual void write();
 
@@ -30,6 +30,7 @@
 
 #include "all_fun.h"
 
+#include "Profiler.h"
 #include "fsils_api.hpp"
 #include "mat_fun.h"
 #include "nn.h"
@@ -226,6 +227,8 @@ double aspect_ratio(ComMod& com_mod, const int nDim, const int eNoN, const Array
 //
 void commu(const ComMod& com_mod, Vector<double>& U)
 {
+  SV_PROFILE_REGION("commu");
+
   if (com_mod.cm.seq()) {
     return;
   }
@@ -249,6 +252,8 @@ void commu(const ComMod& com_mod, Vector<double>& U)
 //
 void commu(const ComMod& com_mod, Array<double>& U)
 {
+  SV_PROFILE_REGION("commu");
+
   if (com_mod.cm.seq()) {
     return;
   }
@@ -910,7 +910,7 @@ void construct_cmm(ComMod& com_mod, const mshType& lM, const Array<double>& Ag,
         cmm_3d(com_mod, eNoN, w, N, Nx, al, yl, bfl, ksix, lR, lK);
       }
 
-      eq.linear_algebra->assemble(com_mod, eNoN, ptr, lK, lR);
+      eq.linear_algebra->assemble(com_mod, lM, e, ptr, lK, lR);
     }
   }
 }
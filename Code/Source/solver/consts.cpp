@@ -285,6 +285,8 @@ const std::set<PreconditionerType> trilinos_preconditioners = {
 /// @brief The list of FSILS preconditioners. 
 const std::set<PreconditionerType> fsils_preconditioners = {
   PreconditionerType::PREC_FSILS,
+  PreconditionerType::PREC_FSILS_AMG,
+  PreconditionerType::PREC_FSILS_ILU,
   PreconditionerType::PREC_RCS
 };
 
@@ -301,6 +303,8 @@ const std::map<std::string,PreconditionerType> preconditioner_name_to_type =
   {"none", PreconditionerType::PREC_NONE},
 
   {"fsils", PreconditionerType::PREC_FSILS},
+  {"fsils-amg", PreconditionerType::PREC_FSILS_AMG},
+  {"fsils-ilu", PreconditionerType::PREC_FSILS_ILU},
   {"rcs", PreconditionerType::PREC_RCS},
   {"row-column-scaling", PreconditionerType::PREC_RCS},
 
@@ -320,6 +324,8 @@ const std::map<std::string,PreconditionerType> preconditioner_name_to_type =
 //
 const std::map<PreconditionerType, std::string> preconditioner_type_to_name {
   {PreconditionerType::PREC_FSILS, "fsils"}, 
+  {PreconditionerType::PREC_FSILS_AMG, "fsils-amg"}, 
+  {PreconditionerType::PREC_FSILS_ILU, "fsils-ilu"}, 
   {PreconditionerType::PREC_NONE, "none"}, 
   {PreconditionerType::PREC_RCS, "row-column-scaling"}, 
   {PreconditionerType::PREC_TRILINOS_DIAGONAL, "trilinos-diagonal"}, 
@@ -333,6 +339,15 @@ const std::map<PreconditionerType, std::string> preconditioner_type_to_name {
   {PreconditionerType::PREC_PETSC_RCS, "petsc-rcs"}
 };
 
+/// @brief Map for preconditioner reuse string to PreconditionerReuseType enum.
+//
+const std::map<std::string,PreconditionerReuseType> preconditioner_reuse_name_to_type =
+{
+  {"none", PreconditionerReuseType::PREC_REUSE_NONE},
+  {"structure", PreconditionerReuseType::PREC_REUSE_STRUCTURE},
+  {"full", PreconditionerReuseType::PREC_REUSE_FULL}
+};
+
 /// @brief Map solver type string to SolverType enum. 
 //
 const std::map<std::string,SolverType> solver_name_to_type 
@@ -344,6 +359,9 @@ const std::map<std::string,SolverType> solver_name_to_type
 
   {"gmres", SolverType::lSolver_GMRES},
 
+  {"pipelined-gmres", SolverType::lSolver_PGMRES},
+  {"pgmres", SolverType::lSolver_PGMRES},
+
   {"conjugate-gradient", SolverType::lSolver_CG},
   {"cg", SolverType::lSolver_CG},
 
@@ -438,7 +438,9 @@ enum class PreconditionerType
   PREC_TRILINOS_ML = 708,
   PREC_RCS = 709,
   PREC_PETSC_JACOBI = 710,
-  PREC_PETSC_RCS = 711
+  PREC_PETSC_RCS = 711,
+  PREC_FSILS_AMG = 712,
+  PREC_FSILS_ILU = 713
 };
 
 extern const std::set<PreconditionerType> fsils_preconditioners;
@@ -449,13 +451,31 @@ extern const std::map<PreconditionerType, std::string> preconditioner_type_to_na
 /// Map for preconditioner type string to PreconditionerType enum.
 extern const std::map<std::string,PreconditionerType> preconditioner_name_to_type;
 
+/// @brief Reuse of a preconditioner between linear solves.
+///
+///   PREC_REUSE_NONE - rebuild the preconditioner for each solve
+///   PREC_REUSE_STRUCTURE - keep the structure (e.g. multigrid aggregates,
+///     symbolic factorization) and recompute the numeric values 
+///   PREC_REUSE_FULL - keep the whole preconditioner 
+//
+enum class PreconditionerReuseType
+{
+  PREC_REUSE_NONE = 0,
+  PREC_REUSE_STRUCTURE = 1,
+  PREC_REUSE_FULL = 2
+};
+
+/// Map for preconditioner reuse string to PreconditionerReuseType enum.
+extern const std::map<std::string,PreconditionerReuseType> preconditioner_reuse_name_to_type;
+
 enum class SolverType
 {
   lSolver_NA = 799,
   lSolver_CG = 798, 
   lSolver_GMRES = 797, 
   lSolver_NS = 796,
-  lSolver_BICGS = 795
+  lSolver_BICGS = 795,
+  lSolver_PGMRES = 794
 };
 
 /// Map for solver type string to SolverType enum. 
@@ -35,18 +35,28 @@
 #include "all_fun.h"
 #include "consts.h"
 #include "nn.h"
+#include "partition_cost.h"
 #include "utils.h"
 
 #include "CmMod.h"
+#include "Profiler.h"
 
 #include "mpi.h"
 
+#include <array>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <math.h>
+#include <vector>
+
+// Identifies a partition cache file.
+const int partition_cache_magic = 0x73764650;
 
 extern "C" {
 
-int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN, int *nPartsPtr, int *iElmdist, float *iWgt, int *part);
+int split_(int *nElptr, int *eNoNptr, int *eNoNbptr, int *IEN, int *nPartsPtr, int *iElmdist, float *iWgt, int *part,
+    int *nconPtr, int *elmWgt);
 
 };
  
@@ -84,6 +94,10 @@ void distribute(Simulation* simulation)
     cm.bcast(cm_mod, &com_mod.nMsh);
     cm.bcast(cm_mod, &com_mod.nsd);
     cm.bcast(cm_mod, &com_mod.rmsh.isReqd);
+    cm.bcast(cm_mod, com_mod.partCacheDir);
+    cm.bcast(cm_mod, &com_mod.partCost);
+    cm.bcast(cm_mod, &com_mod.partBalanceSolver);
+    cm.bcast(cm_mod, com_mod.partCostFile);
   } 
 
   cm.bcast(cm_mod, &com_mod.gtnNo);
@@ -296,11 +310,41 @@ void distribute(Simulation* simulation)
     cm.bcast(cm_mod, &com_mod.stFileFlag);
     cm.bcast(cm_mod, &com_mod.stFileIncr);
     cm.bcast(cm_mod, &com_mod.stFileRepl);
+    cm.bcast(cm_mod, &com_mod.stFileGlobal);
+    cm.bcast(cm_mod, &com_mod.stFileCompress);
+    cm.bcast(cm_mod, &com_mod.stFileFullIncr);
     cm.bcast(cm_mod, &com_mod.saveIncr);
 
+    cm.bcast(cm_mod, &com_mod.profile);
+    cm.bcast(cm_mod, com_mod.profileFileName);
+    if (com_mod.profile) {
+      Profiler::enable(cm.com(), com_mod.profileFileName);
+    }
+
     cm.bcast(cm_mod, &com_mod.saveATS);
     cm.bcast(cm_mod, &com_mod.saveAve);
     cm.bcast(cm_mod, &com_mod.saveVTK);
+    cm.bcast(cm_mod, &com_mod.savePVTU);
+
+    cm.bcast(cm_mod, &com_mod.asyncOutput);
+    cm.bcast(cm_mod, &com_mod.asyncOutputQueueSize);
+
+    // A background output thread needs at least MPI_THREAD_FUNNELED support.
+    //
+    if (com_mod.asyncOutput) {
+      int mpi_thread_level;
+      MPI_Query_thread(&mpi_thread_level);
+      if (mpi_thread_level < MPI_THREAD_FUNNELED) {
+        if (cm.mas(cm_mod)) {
+          std::cout << "WARNING: The MPI library does not support MPI_THREAD_FUNNELED; Asynchronous output is disabled." << std::endl;
+        }
+        com_mod.asyncOutput = false;
+      }
+    }
+
+    if (com_mod.asyncOutput) {
+      simulation->output_writer.start(com_mod.asyncOutputQueueSize);
+    }
     cm.bcast(cm_mod, &com_mod.bin2VTK);
 
     cm.bcast(cm_mod, &com_mod.mvMsh);
@@ -960,6 +1004,9 @@ void dist_eq(ComMod& com_mod, const CmMod& cm_mod, const cmType& cm, const std::
   cm.bcast(cm_mod, &lEq.nBc);
   cm.bcast(cm_mod, &lEq.nBf);
   cm.bcast(cm_mod, &lEq.tol);
+  cm.bcast(cm_mod, &lEq.tangent.iterations);
+  cm.bcast(cm_mod, &lEq.tangent.time_steps);
+  cm.bcast(cm_mod, &lEq.tangent.residual_ratio);
   cm.bcast(cm_mod, &lEq.useTLS);
   cm.bcast(cm_mod, &lEq.assmTLS);
 
@@ -990,12 +1037,28 @@ void dist_eq(ComMod& com_mod, const CmMod& cm_mod, const cmType& cm, const std::
   cm.bcast(cm_mod, &lEq.FSILS.RI.sD);
   cm.bcast(cm_mod, &lEq.FSILS.GM.sD);
   cm.bcast(cm_mod, &lEq.FSILS.CG.sD);
+  cm.bcast(cm_mod, &lEq.FSILS.GM.pipelined);
+  cm.bcast_enum(cm_mod, &lEq.FSILS.amg.smoother);
+  cm.bcast(cm_mod, &lEq.FSILS.amg.sweeps);
+  cm.bcast(cm_mod, &lEq.FSILS.amg.max_levels);
+  cm.bcast(cm_mod, &lEq.FSILS.amg.coarse_size);
+  cm.bcast(cm_mod, &lEq.FSILS.amg.theta);
+  cm.bcast(cm_mod, &lEq.FSILS.ilu_fill);
+  cm.bcast(cm_mod, &lEq.FSILS.proj_size);
+  cm.bcast(cm_mod, &lEq.FSILS.recycle_size);
+  cm.bcast_enum(cm_mod, &lEq.FSILS.forcing.type);
+  cm.bcast(cm_mod, &lEq.FSILS.forcing.eta0);
+  cm.bcast(cm_mod, &lEq.FSILS.forcing.eta_max);
 
   cm.bcast_enum(cm_mod, &lEq.ls.LS_type);
 
   cm.bcast_enum(cm_mod, &lEq.linear_algebra_type);
   cm.bcast_enum(cm_mod, &lEq.linear_algebra_preconditioner);
   cm.bcast_enum(cm_mod, &lEq.linear_algebra_assembly_type);
+  cm.bcast_enum(cm_mod, &lEq.linear_algebra_preconditioner_reuse);
+  cm.bcast(cm_mod, &lEq.linear_algebra_preconditioner_reuse_max_solves);
+  cm.bcast(cm_mod, &lEq.linear_algebra_preconditioner_reuse_max_ratio);
+  cm.bcast(cm_mod, &lEq.matrixFree);
 
   cm.bcast(cm_mod, &lEq.ls.relTol);
   cm.bcast(cm_mod, &lEq.ls.absTol);
@@ -1461,6 +1524,169 @@ void part_face(Simulation* simulation, mshType& lM, faceType& lFa, faceType& gFa
 }
 
 
+/// @brief Send the 'num_values' values of each element in the slice of this
+/// processor to the processor 'part(e)' it is partitioned to.
+///
+/// The received values are stored in 'new_values' ordered by the sending 
+/// processor and then by element.
+//
+template <typename T>
+void migrate_elements(const cmType& cm, MPI_Datatype data_type, const int num_values, const T* values, 
+    const Vector<int>& part, const Vector<int>& send_count, const Vector<int>& recv_count, T* new_values)
+{
+  int num_proc = cm.np();
+  Vector<int> send_disp(num_proc);
+  Vector<int> recv_disp(num_proc);
+  Vector<int> send_size(num_proc);
+  Vector<int> recv_size(num_proc);
+
+  for (int i = 0; i < num_proc; i++) { 
+    send_size[i] = send_count[i] * num_values;
+    recv_size[i] = recv_count[i] * num_values;
+    if (i > 0) {
+      send_disp[i] = send_disp[i-1] + send_size[i-1];
+      recv_disp[i] = recv_disp[i-1] + recv_size[i-1];
+    }
+  }
+
+  std::vector<T> send_values(part.size() * num_values);
+  Vector<int> next_value(send_disp);
+
+  for (int e = 0; e < part.size(); e++) {
+    int& pos = next_value[part[e]];
+    for (int i = 0; i < num_values; i++, pos++) {
+      send_values[pos] = values[e*num_values + i];
+    }
+  }
+
+  MPI_Alltoallv(send_values.data(), send_size.data(), send_disp.data(), data_type, 
+      new_values, recv_size.data(), recv_disp.data(), data_type, cm.com());
+}
+
+/// @brief Compute a hash of the connectivity of the mesh 'lM', the 
+/// processor weights 'wgt' and the element weights 'elem_wgt' on the master. 
+///
+/// The hash identifies the mesh a cached partition was computed for.
+//
+uint64_t partition_hash(const mshType& lM, const Vector<float>& wgt, const Array<int>& elem_wgt)
+{
+  // FNV-1a hash.
+  uint64_t hash = 14695981039346656037ULL;
+
+  auto add = [&hash](const void* data, const size_t size) {
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+  };
+
+  add(&lM.gnNo, sizeof(lM.gnNo));
+  add(&lM.gnEl, sizeof(lM.gnEl));
+  add(&lM.eNoN, sizeof(lM.eNoN));
+  add(lM.gIEN.data(), lM.gIEN.size() * sizeof(int));
+  add(wgt.data(), wgt.size() * sizeof(float));
+  add(elem_wgt.data(), elem_wgt.size() * sizeof(int));
+
+  return hash;
+}
+
+/// @brief Read the processor of each element in the slice of this processor 
+/// from the partition cache file 'file_name'.
+///
+/// Returns false if the file does not exist, was written for a different
+/// mesh or number of processors, or contains an invalid processor ID.
+///
+/// File layout
+///
+///   int magic, int number of processors, int gnEl, int eNoN, uint64 hash
+///   int part[gnEl]
+//
+bool read_partition_cache(Simulation* simulation, const mshType& lM, const std::string& file_name, 
+    const uint64_t hash, Vector<int>& part)
+{
+  auto& cm_mod = simulation->cm_mod;
+  auto& cm = simulation->com_mod.cm;
+  const std::array<int,4> header{partition_cache_magic, cm.np(), lM.gnEl, lM.eNoN};
+  int found = 0;
+
+  if (cm.mas(cm_mod)) {
+    std::ifstream file(file_name, std::ios::in | std::ios::binary);
+    std::array<int,4> file_header{};
+    uint64_t file_hash = 0;
+    file.read((char*)file_header.data(), sizeof(file_header));
+    file.read((char*)&file_hash, sizeof(file_hash));
+    found = file && (file_header == header) && (file_hash == hash);
+  }
+
+  cm.bcast(cm_mod, &found);
+
+  if (!found) {
+    return false;
+  }
+
+  MPI_File file;
+  if (MPI_File_open(cm.com(), file_name.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+    throw std::runtime_error("[part_msh] Unable to open the partition cache file '" + file_name + "'.");
+  }
+
+  MPI_Offset offset = sizeof(header) + sizeof(hash) + static_cast<MPI_Offset>(lM.eDist(cm.id())) * sizeof(int);
+  MPI_File_read_at_all(file, offset, part.data(), part.size(), cm_mod::mpint, MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+
+  // A truncated or damaged file is ignored and the mesh is partitioned again.
+  //
+  int valid = 1;
+  for (int e = 0; e < part.size(); e++) {
+    if (part(e) < 0 || part(e) >= cm.np()) {
+      valid = 0;
+      break;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &valid, 1, cm_mod::mpint, MPI_MIN, cm.com());
+
+  return valid == 1;
+}
+
+/// @brief Write the processor of each element in the slice of this processor 
+/// to the partition cache file 'file_name'.
+///
+/// The file is written under a temporary name and renamed when complete so
+/// that an interrupted run does not leave a partial cache file.
+//
+void write_partition_cache(Simulation* simulation, const mshType& lM, const std::string& file_name, 
+    const uint64_t hash, const Vector<int>& part)
+{
+  auto& cm_mod = simulation->cm_mod;
+  auto& cm = simulation->com_mod.cm;
+  const std::array<int,4> header{partition_cache_magic, cm.np(), lM.gnEl, lM.eNoN};
+  const std::string tmp_name = file_name + ".tmp";
+
+  if (cm.mas(cm_mod)) {
+    auto folder = std::filesystem::path(file_name).parent_path();
+    if (!folder.empty()) {
+      std::filesystem::create_directories(folder);
+    }
+    std::ofstream file(tmp_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write((char*)header.data(), sizeof(header));
+    file.write((char*)&hash, sizeof(hash));
+  }
+
+  MPI_Barrier(cm.com());
+
+  MPI_File file;
+  if (MPI_File_open(cm.com(), tmp_name.c_str(), MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+    throw std::runtime_error("[part_msh] Unable to open the partition cache file '" + tmp_name + "'.");
+  }
+
+  MPI_Offset offset = sizeof(header) + sizeof(hash) + static_cast<MPI_Offset>(lM.eDist(cm.id())) * sizeof(int);
+  MPI_File_write_at_all(file, offset, part.data(), part.size(), cm_mod::mpint, MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+
+  if (cm.mas(cm_mod)) {
+    std::filesystem::rename(tmp_name, file_name);
+  }
+}
+
 /// @brief Reproduces the Fortran 'PARTMSH' subroutine.
 /// Parameters for the part_msh function:
 /// @param[in] simulation A pointer to the simulation object.
@@ -1527,6 +1753,8 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
   cm.bcast(cm_mod, &lM.nFn);
   cm.bcast(cm_mod, &lM.scF);
   cm.bcast(cm_mod, &lM.qmTET4);
+  cm.bcast(cm_mod, &lM.cacheGeo);
+  cm.bcast(cm_mod, &lM.cacheGeoSize);
 
   // Number of fibers.
   int nFn = lM.nFn;
@@ -1652,6 +1880,48 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
   if (fp) fclose(fp);
   #endif
 
+  // Element weights balancing the assembly cost of the elements, and 
+  // optionally their number, are computed by the master and scattered 
+  // with the elements.
+  //
+  int ncon = 0;
+  Array<int> gElemWgt;
+  Array<int> elemWgt;
+
+  if (com_mod.partCost) {
+    ncon = com_mod.partBalanceSolver ? 2 : 1;
+    if (cm.mas(cm_mod)) {
+      gElemWgt = partition_cost::element_weights(simulation, lM, ncon);
+    }
+
+    Vector<int> wgt_count(num_proc);
+    Vector<int> wgt_disp(num_proc);
+    for (int i = 0; i < num_proc; i++) { 
+      wgt_disp[i] = lM.eDist[i] * ncon;
+      wgt_count[i] = lM.eDist[i+1] * ncon - wgt_disp[i];
+    }
+
+    elemWgt.resize(ncon, nEl);
+    MPI_Scatterv(gElemWgt.data(), wgt_count.data(), wgt_disp.data(), cm_mod::mpint, elemWgt.data(), 
+        nEl*ncon, cm_mod::mpint, cm_mod.master, cm.com());
+  }
+
+  // Partitions cached by a previous run with the same mesh and number of 
+  // processors are used instead of calling ParMETIS. Only the processor of 
+  // each element is cached, the distributed mesh data is rebuilt below.
+  //
+  std::string cache_file;
+  uint64_t cache_hash = 0;
+
+  if (com_mod.partCacheDir != "") {
+    cache_file = com_mod.partCacheDir + "/" + lM.name + "_" + std::to_string(num_proc) + ".bin";
+    if (cm.mas(cm_mod)) {
+      cache_hash = partition_hash(lM, wgt, gElemWgt);
+    }
+  }
+
+  gElemWgt.clear();
+
   if (lM.eType == consts::ElementType::NRB) {
     part = cm.id();
 
@@ -1677,6 +1947,11 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
     dmsg << "---------- " << "---------- ";
     #endif
 
+  } else if (cache_file != "" && read_partition_cache(simulation, lM, cache_file, cache_hash, part)) {
+    #ifdef dbg_part_msh
+    dmsg << "Read partition data from cache file " << cache_file;
+    #endif
+
   // Scattering the lM.gIEN array to all processors.
   //
   } else { 
@@ -1708,7 +1983,8 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
     // which processor element "i" belongs to
     // Doing partitioning, using ParMetis
     //
-    auto edgecut = split_(&nEl, &eNoN, &eNoNb, lM.IEN.data(), &num_proc, lM.eDist.data(),  wgt.data(), part.data());
+    auto edgecut = split_(&nEl, &eNoN, &eNoNb, lM.IEN.data(), &num_proc, lM.eDist.data(),  wgt.data(), part.data(),
+        &ncon, elemWgt.data());
     #ifdef dbg_part_msh
     dmsg << "edgecut: " << edgecut;
     #endif
@@ -1724,7 +2000,9 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
       #endif
     } 
 
-    lM.IEN.clear();
+    if (cache_file != "") {
+      write_partition_cache(simulation, lM, cache_file, cache_hash, part);
+    }
 
     if (com_mod.rmsh.isReqd) {
       #ifdef dbg_part_msh
@@ -1746,9 +2024,31 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
     }
   }
 
+  // The elements of the slice of this processor are needed for migrating
+  // them to the processors they are partitioned to.
+  //
+  if (lM.IEN.ncols() != nEl) {
+    lM.IEN.resize(eNoN, nEl);
+    MPI_Scatterv(lM.gIEN.data(), sCount.data(), disp.data(), cm_mod::mpint, lM.IEN.data(), 
+        nEl*eNoN, cm_mod::mpint, cm_mod.master, cm.com());
+  }
+
+  // Count the elements sent to and received from each processor.
+  //
+  Vector<int> send_count(num_proc);
+  Vector<int> recv_count(num_proc);
+
+  for (int e = 0; e < nEl; e++) {
+    send_count[part[e]] += 1;
+  }
+
+  MPI_Alltoall(send_count.data(), 1, cm_mod::mpint, recv_count.data(), 1, cm_mod::mpint, cm.com());
+
+  Vector<int> slice_dist(lM.eDist);
+
   for (int i = 0; i < num_proc; i++) { 
-    disp[i] = lM.eDist[i];
-    sCount[i] = lM.eDist[i+1] - disp[i];
+    disp[i] = slice_dist[i];
+    sCount[i] = slice_dist[i+1] - disp[i];
   }
 
   // Gathering the parts inside master, part(e) is equal to the
@@ -1767,83 +2067,75 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
   MPI_Gatherv(part.data(), nEl, cm_mod::mpint, gPart.data(), sCount.data(), disp.data(), 
       cm_mod::mpint, cm_mod.master, cm.com());
 
-  part.clear();
+  // The elements of each processor are contiguous and in their original 
+  // order in the new element distribution.
+  //
+  int new_nEl = 0;
+  for (int i = 0; i < num_proc; i++) { 
+    new_nEl += recv_count[i];
+  }
 
-  Array<int> tempIEN;
-  Array<double> tmpFn;
-  flag = false;
-  bool fnFlag = false;
+  Vector<int> new_count(num_proc);
+  MPI_Allgather(&new_nEl, 1, cm_mod::mpint, new_count.data(), 1, cm_mod::mpint, cm.com());
+
+  lM.eDist[0] = 0;
+  for (int i = 0; i < num_proc; i++) { 
+    lM.eDist[i+1] = lM.eDist[i] + new_count[i];
+  }
 
   #ifdef dbg_part_msh
-  dmsg << "sCount: " << sCount;
-  dmsg << "disp: " << disp;
-  //dmsg << "gPart: " << gPart;
   dmsg << " " << " ";
   dmsg << "Making the lM%IEN array " << " ...";
+  dmsg << "lM.eDist: " << lM.eDist;
   #endif
- 
-  if (cm.mas(cm_mod)) {
-    sCount = 0;
-    for (int e = 0; e < lM.gnEl; e++) {
-      sCount[gPart[e]] = sCount[gPart[e]] + 1;
-    }
-
-    for (int i = 0; i < num_proc; i++) { 
-      lM.eDist[i+1] = lM.eDist[i] + sCount[i];
-    }
 
-    #ifdef dbg_part_msh
-    dmsg << "lM.eDist: " << lM.eDist;
-    dmsg << "sCount: " << sCount;
-    #endif
+  flag = false;
+  bool fnFlag = false;
 
-    tempIEN.resize(eNoN,lM.gnEl); 
-    lM.otnIEN.resize(lM.gnEl);
+  if (cm.mas(cm_mod)) {
 
-    // Making the lM%IEN array in order, based on the cm%id() number in
-    // master. lM%otnIEN maps old IEN order to new IEN order.
+    // lM%otnIEN maps old IEN order to new IEN order.
     //
-    disp = 0;
+    Vector<int> next_elem(num_proc);
+    lM.otnIEN.resize(lM.gnEl);
 
-    for (int e = 0; e < lM.gnEl; e++) { 
-      int Ec = lM.eDist[gPart[e]];
-      lM.eDist[gPart[e]] = Ec + 1;
-      tempIEN.set_col(Ec, lM.gIEN.col(e));
-      lM.otnIEN[e] = Ec;
+    for (int i = 0; i < num_proc; i++) { 
+      next_elem[i] = lM.eDist[i];
     }
 
-    lM.gIEN = tempIEN;
-    lM.eDist[0] = 0;
-    for (int i = 0; i < num_proc; i++) { 
-      lM.eDist[i+1] = lM.eDist[i] + sCount[i];
+    for (int e = 0; e < lM.gnEl; e++) { 
+      lM.otnIEN[e] = next_elem[gPart[e]];
+      next_elem[gPart[e]] += 1;
     }
-    #ifdef dbg_part_msh
-    dmsg << "2 lM.eDist: " << lM.eDist;
-    #endif
 
-    // This it to distribute eId, if allocated
+    // Reorder lM%gIEN in place by following the cycles of the 
+    // permutation so no second copy of the global mesh is needed.
     //
-    if (lM.eId.size() != 0) {
-      flag = true;
-      part.resize(lM.gnEl);
-      for (int e = 0; e < lM.gnEl; e++) {
-        int Ec = lM.otnIEN[e];
-        part[Ec] = lM.eId[e];
+    std::vector<bool> moved(lM.gnEl, false);
+    Vector<int> column(eNoN);
+
+    for (int e = 0; e < lM.gnEl; e++) { 
+      if (moved[e]) {
+        continue;
       }
-      lM.eId.clear();
-    }
 
-    // This it to distribute fN, if allocated
-    if (lM.fN.size() != 0) {
-      fnFlag = true;
-      tmpFn.resize(nFn*nsd, lM.gnEl);
-      for (int e = 0; e < lM.gnEl; e++) {
-        int Ec = lM.otnIEN[e];
-        tmpFn.set_col(Ec, lM.fN.col(e));
+      for (int a = 0; a < eNoN; a++) {
+        column[a] = lM.gIEN(a,e);
+      }
+
+      int Ec = lM.otnIEN[e];
+
+      while (!moved[Ec]) { 
+        for (int a = 0; a < eNoN; a++) {
+          std::swap(column[a], lM.gIEN(a,Ec));
+        }
+        moved[Ec] = true;
+        Ec = lM.otnIEN[Ec];
       }
-      lM.fN.clear();
     }
 
+    flag = (lM.eId.size() != 0);
+    fnFlag = (lM.fN.size() != 0);
   } else { 
     lM.otnIEN.clear();
   }
@@ -1852,33 +2144,15 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
 
   cm.bcast(cm_mod, &flag);
   cm.bcast(cm_mod, &fnFlag);
-  cm.bcast(cm_mod, lM.eDist);
-
-  nEl = lM.eDist[cm.id()+1] - lM.eDist[cm.id()];
-  #ifdef dbg_part_msh
-  dmsg << "flag: " << flag;
-  dmsg << "fnFlag: " << fnFlag;
-  dmsg << "3 lM.eDist: " << lM.eDist;
-  #endif
-  lM.nEl = nEl;
-  lM.IEN.resize(eNoN,nEl); 
-  lM.iGC.resize(nEl);
 
   // Communicating eId, if neccessary.
   //
   if (flag) {
-    lM.eId.resize(nEl);
-    // [NOTE] Not sure what's going on here.
-    if (part.size() == 0) {
-      part.clear();
-    }
-    for (int i = 0; i < num_proc; i++) { 
-      disp[i] = lM.eDist[i];
-      sCount[i] = lM.eDist[i+1] - disp[i];
-    }
-    MPI_Scatterv(part.data(), sCount.data(), disp.data(), cm_mod::mpint, lM.eId.data(), nEl, 
+    Vector<int> eId(nEl);
+    MPI_Scatterv(lM.eId.data(), sCount.data(), disp.data(), cm_mod::mpint, eId.data(), nEl, 
         cm_mod::mpint, cm_mod.master, cm.com());
-    part.clear();
+    lM.eId.resize(new_nEl);
+    migrate_elements(cm, cm_mod::mpint, 1, eId.data(), part, send_count, recv_count, lM.eId.data());
   }
 
   // Communicating fN, if neccessary
@@ -1889,39 +2163,33 @@ void part_msh(Simulation* simulation, int iM, mshType& lM, Vector<int>& gmtl, in
     dmsg << "nFn: " << nFn;
     dmsg << "nsd: " << nsd;
     dmsg << "nEl: " << nEl;
-    dmsg << "tmpFn.size(): " << tmpFn.size();
     #endif
-    lM.fN.resize(nFn*nsd,nEl);
-    if (tmpFn.size() == 0) {
-      // ALLOCATE(tmpFn(0,0))
-    }
     for (int i = 0; i < num_proc; i++) { 
-      disp[i] = lM.eDist[i] * nFn * nsd;
-      sCount[i] = lM.eDist[i+1] * nFn * nsd - disp[i];
+      disp[i] = slice_dist[i] * nFn * nsd;
+      sCount[i] = slice_dist[i+1] * nFn * nsd - disp[i];
     }
-    MPI_Scatterv(tmpFn.data(), sCount.data(), disp.data(), cm_mod::mpreal, lM.fN.data(), nEl*nFn*nsd, 
+    Array<double> fN(nFn*nsd, nEl);
+    MPI_Scatterv(lM.fN.data(), sCount.data(), disp.data(), cm_mod::mpreal, fN.data(), nEl*nFn*nsd, 
         cm_mod::mpreal, cm_mod.master, cm.com());
-    tmpFn.clear();
+    lM.fN.resize(nFn*nsd, new_nEl);
+    migrate_elements(cm, cm_mod::mpreal, nFn*nsd, fN.data(), part, send_count, recv_count, lM.fN.data());
   }
 
-  // Now scattering the sorted lM%IEN to all processors.
+  // Now sending the elements of the slice of this processor directly 
+  // to the processors they are partitioned to.
   //
   #ifdef dbg_part_msh
   dmsg << " " << " ";
-  dmsg << "Now scattering the sorted lM%IEN to all processors " << " ...";
+  dmsg << "Now migrating the lM%IEN elements to all processors " << " ...";
   #endif
-  if (tempIEN.size() == 0) {
-    tempIEN.clear();
-  }
-  for (int i = 0; i < num_proc; i++) {
-    disp[i] = lM.eDist[i] * eNoN;
-    sCount[i] = lM.eDist[i+1]*eNoN - disp[i];
-  }
-
-  MPI_Scatterv(tempIEN.data(), sCount.data(), disp.data(), cm_mod::mpint, lM.IEN.data(), 
-      nEl*eNoN, cm_mod::mpint, cm_mod.master, cm.com());
+  Array<int> sliceIEN(lM.IEN);
+  lM.IEN.resize(eNoN, new_nEl); 
+  migrate_elements(cm, cm_mod::mpint, eNoN, sliceIEN.data(), part, send_count, recv_count, lM.IEN.data());
+  sliceIEN.clear();
 
-  tempIEN.clear();
+  nEl = new_nEl;
+  lM.nEl = nEl;
+  lM.iGC.resize(nEl);
 
   // Constructing the initial global to local pointer
   // lM%IEN: eNoN,nEl --> gnNo
@@ -0,0 +1,271 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "elem_color.h"
+
+#include "LinearAlgebra.h"
+#include "all_fun.h"
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+
+namespace elem_color {
+
+/// @brief Color the elements of a mesh using a greedy algorithm.
+///
+/// Two elements conflict if they share a node or if one of their nodes is
+/// mapped (idMap) onto a node of the other, since in both cases they add
+/// to the same rows of R and Val. Each element gets the smallest color not
+/// used by a conflicting element colored before it. Elements keep their
+/// original order within a color.
+///
+/// Must be called after lhsa() has set com_mod.idMap.
+///
+/// Modifies:
+///   lM.nColor
+///   lM.eColPtr
+///   lM.eColList
+//
+void color_msh(const ComMod& com_mod, mshType& lM)
+{
+  #define n_debug_color_msh
+  #ifdef debug_color_msh
+  DebugMsg dmsg(__func__, com_mod.cm.idcm());
+  dmsg.banner();
+  #endif
+
+  const int tnNo = com_mod.tnNo;
+  const int eNoN = lM.eNoN;
+  const int nEl = lM.nEl;
+  const auto& idMap = com_mod.idMap;
+  const bool mapped = (idMap.size() == tnNo);
+
+  lM.nColor = 0;
+  lM.eColPtr.clear();
+  lM.eColList.clear();
+
+  if (nEl == 0) {
+    return;
+  }
+
+  // Build the node to element map. A mapped node also points back to
+  // the elements containing its slave nodes.
+  //
+  Vector<int> nePtr(tnNo+1);
+
+  for (int e = 0; e < nEl; e++) {
+    for (int a = 0; a < eNoN; a++) {
+      int Ac = lM.IEN(a,e);
+      nePtr(Ac+1) += 1;
+      if (mapped && idMap(Ac) != Ac) {
+        nePtr(idMap(Ac)+1) += 1;
+      }
+    }
+  }
+
+  for (int i = 0; i < tnNo; i++) {
+    nePtr(i+1) += nePtr(i);
+  }
+
+  Vector<int> neList(nePtr(tnNo));
+  Vector<int> neFill(tnNo);
+
+  for (int e = 0; e < nEl; e++) {
+    for (int a = 0; a < eNoN; a++) {
+      int Ac = lM.IEN(a,e);
+      neList(nePtr(Ac) + neFill(Ac)) = e;
+      neFill(Ac) += 1;
+      if (mapped && idMap(Ac) != Ac) {
+        int Bc = idMap(Ac);
+        neList(nePtr(Bc) + neFill(Bc)) = e;
+        neFill(Bc) += 1;
+      }
+    }
+  }
+
+  // Greedy coloring; 'used[c] == e' marks color c as taken by a
+  // neighbor of element e.
+  //
+  Vector<int> eColor(nEl);
+  eColor = -1;
+  std::vector<int> used;
+
+  auto mark_neighbors = [&](const int node, const int e) {
+    for (int i = nePtr(node); i < nePtr(node+1); i++) {
+      int c = eColor(neList(i));
+      if (c != -1) {
+        used[c] = e;
+      }
+    }
+  };
+
+  for (int e = 0; e < nEl; e++) {
+    for (int a = 0; a < eNoN; a++) {
+      int Ac = lM.IEN(a,e);
+      mark_neighbors(Ac, e);
+      if (mapped && idMap(Ac) != Ac) {
+        mark_neighbors(idMap(Ac), e);
+      }
+    }
+
+    int c = 0;
+    while (c < static_cast<int>(used.size()) && used[c] == e) {
+      c += 1;
+    }
+
+    if (c == static_cast<int>(used.size())) {
+      used.push_back(-1);
+    }
+
+    eColor(e) = c;
+  }
+
+  // Sort elements by color.
+  //
+  lM.nColor = used.size();
+  lM.eColPtr.resize(lM.nColor+1);
+
+  for (int e = 0; e < nEl; e++) {
+    lM.eColPtr(eColor(e)+1) += 1;
+  }
+
+  for (int c = 0; c < lM.nColor; c++) {
+    lM.eColPtr(c+1) += lM.eColPtr(c);
+  }
+
+  lM.eColList.resize(nEl);
+  Vector<int> cFill(lM.nColor);
+
+  for (int e = 0; e < nEl; e++) {
+    int c = eColor(e);
+    lM.eColList(lM.eColPtr(c) + cFill(c)) = e;
+    cFill(c) += 1;
+  }
+
+  #ifdef debug_color_msh
+  dmsg << "lM.name: " << lM.name;
+  dmsg << "lM.nEl: " << nEl;
+  dmsg << "lM.nColor: " << lM.nColor;
+  #endif
+}
+
+/// @brief Get the order elements are integrated in and split it into
+/// batches of elements that belong to the same domain.
+///
+/// If 'threaded' is true the elements are ordered by color and grouped
+/// by domain within each color, so the elements in a batch can be
+/// assembled concurrently. Otherwise the elements are kept in their
+/// original order and consecutive elements of the same domain form a
+/// batch.
+//
+void get_batches(const ComMod& com_mod, const mshType& lM, const int iEq, const bool threaded,
+    Vector<int>& elems, std::vector<ElemBatch>& batches)
+{
+  const int nEl = lM.nEl;
+  const int nDmn = com_mod.eq[iEq].nDmn;
+
+  elems.resize(nEl);
+  batches.clear();
+
+  Vector<int> eDmn(nEl);
+  for (int e = 0; e < nEl; e++) {
+    eDmn(e) = all_fun::domain(com_mod, lM, iEq, e);
+  }
+
+  if (!threaded) {
+    for (int e = 0; e < nEl; e++) {
+      elems(e) = e;
+      if (batches.empty() || batches.back().dmn != eDmn(e)) {
+        batches.push_back(ElemBatch{eDmn(e), e, e});
+      }
+      batches.back().end = e + 1;
+    }
+    return;
+  }
+
+  int n = 0;
+
+  for (int c = 0; c < lM.nColor; c++) {
+    for (int iDmn = 0; iDmn < nDmn; iDmn++) {
+      int start = n;
+
+      for (int i = lM.eColPtr(c); i < lM.eColPtr(c+1); i++) {
+        int e = lM.eColList(i);
+        if (eDmn(e) == iDmn) {
+          elems(n) = e;
+          n += 1;
+        }
+      }
+
+      if (n != start) {
+        batches.push_back(ElemBatch{iDmn, start, n});
+      }
+    }
+  }
+
+  if (n != nEl) {
+    throw std::runtime_error("[get_batches] Elements of mesh '" + lM.name + "' are not all assigned to a domain.");
+  }
+}
+
+/// @brief Return the number of threads used for element assembly.
+//
+int num_threads()
+{
+  #ifdef WITH_OPENMP
+  return omp_get_max_threads();
+  #else
+  return 1;
+  #endif
+}
+
+/// @brief Check if the elements of a mesh can be assembled by several threads.
+///
+/// This requires the mesh to be colored and the linear algebra package
+/// to assemble into com_mod.R and com_mod.Val.
+//
+bool use_threads(const ComMod& com_mod, const mshType& lM, const eqType& lEq)
+{
+  if (num_threads() == 1 || lM.nColor == 0) {
+    return false;
+  }
+
+  if (lEq.linear_algebra == nullptr) {
+    return false;
+  }
+
+  return lEq.linear_algebra->thread_safe_assembly();
+}
+
+};
+
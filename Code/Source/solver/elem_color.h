@@ -0,0 +1,66 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ELEM_COLOR_H 
+#define ELEM_COLOR_H 
+
+#include "ComMod.h"
+
+#include <vector>
+
+/// @brief The functions defined here partition mesh elements into colors
+/// such that no two elements of the same color assemble into the same
+/// global row. Elements of a color can then be integrated and assembled
+/// concurrently by several threads without locking.
+//
+namespace elem_color {
+
+  /// @brief A contiguous range [start,end) of an element list whose
+  /// elements all belong to the same equation domain.
+  //
+  struct ElemBatch {
+    int dmn = -1;
+    int start = 0;
+    int end = 0;
+  };
+
+  void color_msh(const ComMod& com_mod, mshType& lM);
+
+  void get_batches(const ComMod& com_mod, const mshType& lM, const int iEq, const bool threaded,
+      Vector<int>& elems, std::vector<ElemBatch>& batches);
+
+  int num_threads();
+
+  bool use_threads(const ComMod& com_mod, const mshType& lM, const eqType& lEq);
+
+};
+
+#endif
+
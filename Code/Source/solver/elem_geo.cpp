@@ -0,0 +1,330 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "elem_geo.h"
+
+#include "fs.h"
+#include "nn.h"
+#include "utils.h"
+
+#include <iostream>
+
+namespace elem_geo {
+
+/// @brief Free the element geometry caches of a mesh.
+//
+void clear_geo(mshType& lM)
+{
+  lM.geo = elemGeoType();
+
+  for (auto& geo_opt : lM.thGeo) {
+    for (auto& geo : geo_opt) {
+      geo = elemGeoType();
+    }
+  }
+}
+
+/// @brief Copy the cached geometry of element e at integration point g.
+//
+void get_geo(const elemGeoType& geo, const int e, const int g, Array<double>& Nx, double& Jac, Array<double>& ksix)
+{
+  const int k = e*geo.nG + g;
+  const int nsd = Nx.nrows();
+  const int eNoN = Nx.ncols();
+
+  for (int a = 0; a < eNoN; a++) {
+    for (int i = 0; i < nsd; i++) {
+      Nx(i,a) = geo.Nx(i,a,k);
+    }
+  }
+
+  for (int j = 0; j < nsd; j++) {
+    for (int i = 0; i < nsd; i++) {
+      ksix(i,j) = geo.ksix(i,j,k);
+    }
+  }
+
+  Jac = geo.Jac(k);
+}
+
+/// @brief Copy the cached geometry, including shape function second 
+/// derivatives, of element e at integration point g.
+//
+void get_geo(const elemGeoType& geo, const int e, const int g, Array<double>& Nx, Array<double>& Nxx, 
+    double& Jac, Array<double>& ksix)
+{
+  get_geo(geo, e, g, Nx, Jac, ksix);
+
+  const int k = e*geo.nG + g;
+  const int l = Nxx.nrows();
+  const int eNoN = Nxx.ncols();
+
+  for (int a = 0; a < eNoN; a++) {
+    for (int i = 0; i < l; i++) {
+      Nxx(i,a) = geo.Nxx(i,a,k);
+    }
+  }
+}
+
+/// @brief Allocate the storage of a cache for 'nG' integration points.
+//
+void alloc_geo(elemGeoType& geo, const int nsd, const int l, const int eNoN, const int nEl, const int nG)
+{
+  geo.nG = nG;
+  geo.Nx.resize(nsd, eNoN, nEl*nG);
+  geo.ksix.resize(nsd, nsd, nEl*nG);
+  geo.Jac.resize(nEl*nG);
+
+  if (l > 0) {
+    geo.Nxx.resize(l, eNoN, nEl*nG);
+  }
+}
+
+/// @brief Store the geometry of element e at integration point g.
+//
+void store_geo(elemGeoType& geo, const int e, const int g, const Array<double>& Nx, const double Jac, 
+    const Array<double>& ksix)
+{
+  const int k = e*geo.nG + g;
+  const int nsd = Nx.nrows();
+  const int eNoN = Nx.ncols();
+
+  for (int a = 0; a < eNoN; a++) {
+    for (int i = 0; i < nsd; i++) {
+      geo.Nx(i,a,k) = Nx(i,a);
+    }
+  }
+
+  for (int j = 0; j < nsd; j++) {
+    for (int i = 0; i < nsd; i++) {
+      geo.ksix(i,j,k) = ksix(i,j);
+    }
+  }
+
+  geo.Jac(k) = Jac;
+}
+
+/// @brief Compute and cache the element geometry of a mesh.
+///
+/// The cache is only set for meshes with 'Cache_element_geometry' set 
+/// to true that are integrated by equations using the reference 
+/// coordinates: the mesh function space for heatF, heatS, lElas and 
+/// struct equations and the Taylor-Hood function spaces for fluid 
+/// equations. 
+///
+/// If the cache of the mesh would need more than its 'Element_geometry_cache_size' 
+/// MB on a process the geometry is recomputed during assembly. The limit is 
+/// per mesh, a run with several cached meshes can use the sum of their limits.
+///
+/// Must be called after the function spaces are initialized. The cache
+/// is rebuilt each time the mesh is initialized (e.g. after remeshing).
+///
+/// Modifies:
+///   lM.geo
+///   lM.thGeo
+//
+void set_geo(ComMod& com_mod, mshType& lM)
+{
+  using namespace consts;
+
+  #define n_debug_set_geo
+  #ifdef debug_set_geo
+  DebugMsg dmsg(__func__, com_mod.cm.idcm());
+  dmsg.banner();
+  dmsg << "lM.name: " << lM.name;
+  dmsg << "lM.cacheGeo: " << lM.cacheGeo;
+  #endif
+
+  clear_geo(lM);
+
+  if (!lM.cacheGeo || (lM.nEl == 0) || lM.lShl || lM.lFib || (lM.eType == ElementType::NRB)) {
+    return;
+  }
+
+  const int nsd = com_mod.nsd;
+  const int nsymd = com_mod.nsymd;
+  const int nEl = lM.nEl;
+  const int eNoN = lM.eNoN;
+
+  // Find the function spaces the mesh is integrated with.
+  //
+  bool msh_fs = false;
+  bool thood_fs = false;
+
+  for (const auto& eq : com_mod.eq) {
+    switch (eq.phys) {
+      case EquationType::phys_fluid:
+        thood_fs = true;
+      break;
+
+      case EquationType::phys_heatF:
+      case EquationType::phys_heatS:
+      case EquationType::phys_lElas:
+      case EquationType::phys_struct:
+        msh_fs = true;
+      break;
+
+      default:
+      break;
+    }
+  }
+
+  bool vmsStab = (lM.nFs == 1);
+  std::array<std::array<fsType,2>,2> fs;
+
+  if (thood_fs) {
+    if (lM.fs.size() == 0) {
+      thood_fs = false;
+    } else {
+      fs::get_thood_fs(com_mod, fs[0], lM, vmsStab, 1);
+      fs::get_thood_fs(com_mod, fs[1], lM, vmsStab, 2);
+    }
+  }
+
+  // Check the cache size. 
+  //
+  double size = 0.0;
+
+  if (msh_fs) {
+    int nG = lM.lShpF ? 1 : lM.nG;
+    size += nG * (nsd*eNoN + nsd*nsd + 1);
+  }
+
+  if (thood_fs) {
+    for (int iOpt = 0; iOpt < 2; iOpt++) {
+      for (int i = 0; i < 2; i++) {
+        int nG = fs[iOpt][i].lShpF ? 1 : fs[iOpt][iOpt].nG;
+        int l = (iOpt == 0 && i == 0) ? nsymd : 0;
+        size += nG * ((nsd+l)*fs[iOpt][i].eNoN + nsd*nsd + 1);
+      }
+    }
+  }
+
+  size *= static_cast<double>(nEl) * sizeof(double) / (1024.0*1024.0);
+
+  #ifdef debug_set_geo
+  dmsg << "msh_fs: " << msh_fs;
+  dmsg << "thood_fs: " << thood_fs;
+  dmsg << "size: " << size;
+  #endif
+
+  if (size == 0.0) {
+    return;
+  }
+
+  if (size > lM.cacheGeoSize) {
+    std::cout << "WARNING: The element geometry cache of mesh '" << lM.name << "' needs " << size 
+        << " MB which is larger than the 'Element_geometry_cache_size' of " << lM.cacheGeoSize 
+        << " MB; the geometry will be recomputed during assembly." << std::endl;
+    return;
+  }
+
+  // Element coordinates in the reference configuration.
+  Array<double> xl(nsd,eNoN);
+  Array<double> ksix(nsd,nsd);
+  double Jac{0.0};
+
+  auto check_jac = [&lM](const double Jac, const int e) {
+    if (utils::is_zero(Jac)) {
+      throw std::runtime_error("[set_geo] Jacobian for element " + std::to_string(e) + " of mesh '" + 
+          lM.name + "' is < 0.");
+    }
+  };
+
+  // Mesh function space.
+  //
+  if (msh_fs) {
+    auto& geo = lM.geo;
+    alloc_geo(geo, nsd, 0, eNoN, nEl, lM.lShpF ? 1 : lM.nG);
+    Array<double> Nx(nsd,eNoN);
+
+    for (int e = 0; e < nEl; e++) {
+      for (int a = 0; a < eNoN; a++) {
+        int Ac = lM.IEN(a,e);
+        for (int i = 0; i < nsd; i++) {
+          xl(i,a) = com_mod.x(i,Ac);
+        }
+      }
+
+      for (int g = 0; g < geo.nG; g++) {
+        auto Nx_g = lM.Nx.rslice(g);
+        nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
+        check_jac(Jac, e);
+        store_geo(geo, e, g, Nx, Jac, ksix);
+      }
+    }
+  }
+
+  // Taylor-Hood function spaces. The integration points of pass iOpt are
+  // those of fs[iOpt].
+  //
+  if (thood_fs) {
+    for (int iOpt = 0; iOpt < 2; iOpt++) {
+      for (int i = 0; i < 2; i++) {
+        auto& lfs = fs[iOpt][i];
+        auto& geo = lM.thGeo[iOpt][i];
+        int l = (iOpt == 0 && i == 0) ? nsymd : 0;
+        alloc_geo(geo, nsd, l, lfs.eNoN, nEl, lfs.lShpF ? 1 : fs[iOpt][iOpt].nG);
+
+        Array<double> xfl(nsd,lfs.eNoN), Nx(nsd,lfs.eNoN), Nxx(nsymd,lfs.eNoN);
+
+        for (int e = 0; e < nEl; e++) {
+          for (int a = 0; a < lfs.eNoN; a++) {
+            int Ac = lM.IEN(a,e);
+            for (int j = 0; j < nsd; j++) {
+              xfl(j,a) = com_mod.x(j,Ac);
+            }
+          }
+
+          for (int g = 0; g < geo.nG; g++) {
+            auto Nx_g = lfs.Nx.rslice(g);
+            nn::gnn(lfs.eNoN, nsd, nsd, Nx_g, xfl, Nx, Jac, ksix);
+            check_jac(Jac, e);
+            store_geo(geo, e, g, Nx, Jac, ksix);
+
+            if (l > 0) {
+              auto Nxx_g = lfs.Nxx.rslice(g);
+              nn::gn_nxx(l, lfs.eNoN, nsd, nsd, Nx_g, Nxx_g, xfl, Nx, Nxx);
+              int k = e*geo.nG + g;
+              for (int a = 0; a < lfs.eNoN; a++) {
+                for (int j = 0; j < l; j++) {
+                  geo.Nxx(j,a,k) = Nxx(j,a);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+};
+
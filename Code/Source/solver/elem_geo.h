@@ -0,0 +1,59 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ELEM_GEO_H 
+#define ELEM_GEO_H 
+
+#include "ComMod.h"
+
+/// @brief The functions defined here cache the element geometry (shape 
+/// function gradients, Jacobians and inverse mapping gradients) of meshes 
+/// whose reference coordinates do not change during a simulation. 
+///
+/// Assembly routines that integrate over the reference coordinates 
+/// (com_mod.x) use the cached values instead of calling nn::gnn() for 
+/// each element, integration point and nonlinear iteration. If a cache 
+/// is not valid they recompute the values.
+//
+namespace elem_geo {
+
+  void clear_geo(mshType& lM);
+
+  void get_geo(const elemGeoType& geo, const int e, const int g, Array<double>& Nx, double& Jac, Array<double>& ksix);
+
+  void get_geo(const elemGeoType& geo, const int e, const int g, Array<double>& Nx, Array<double>& Nxx, 
+      double& Jac, Array<double>& ksix);
+
+  void set_geo(ComMod& com_mod, mshType& lM);
+
+};
+
+#endif
+
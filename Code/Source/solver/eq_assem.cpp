@@ -30,6 +30,7 @@
 
 #include "eq_assem.h"
 
+#include "Profiler.h"
 #include "all_fun.h"
 #include "consts.h"
 #include "lhsa.h"
@@ -389,6 +390,8 @@ void fsi_ls_upd(ComMod& com_mod, const bcType& lBc, const faceType& lFa)
 void global_eq_assem(ComMod& com_mod, CepMod& cep_mod, const mshType& lM, const Array<double>& Ag, 
     const Array<double>& Yg, const Array<double>& Dg)
 {
+  SV_PROFILE_REGION("global_eq_assem");
+
   #define n_debug_global_eq_assem
   #ifdef debug_global_eq_assem
   DebugMsg dmsg(__func__, com_mod.cm.idcm());
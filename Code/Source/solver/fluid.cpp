@@ -32,12 +32,16 @@
 
 #include "all_fun.h"
 #include "consts.h"
+#include "elem_color.h"
+#include "elem_geo.h"
 #include "fs.h"
 #include "lhsa.h"
+#include "NodeArray.h"
 #include "nn.h"
 #include "utils.h"
 
 #include <array>
+#include <exception>
 #include <iomanip>
 #include <math.h>
 
@@ -544,203 +548,256 @@ void construct_fluid(ComMod& com_mod, const mshType& lM, const Array<double>& Ag
   dmsg << "nsd: " <<  nsd;
   #endif
 
-  // FLUID: dof = nsd+1
-  Vector<int> ptr(eNoN); 
-  Array<double> xl(nsd,eNoN); 
-  
-  // local acceleration vector (for a single element)
-  Array<double> al(tDof,eNoN);
-  
-  // local velocity vector (for a single element)
-  Array<double> yl(tDof,eNoN);
-  Array<double> bfl(nsd,eNoN);
-  
-  // local (weak form) residual vector (for a single element) 
-  Array<double> lR(dof,eNoN);
-  
-  // local tangent matrix (for a single element)
-  Array3<double> lK(dof*dof,eNoN,eNoN);
-
-  // Loop over all elements of mesh
+  // Get the order elements are integrated in. When using threads elements
+  // are ordered by color so that the elements assembled concurrently never
+  // share a global row.
   //
-  int num_c = lM.nEl / 10;
-
-  for (int e = 0; e < lM.nEl; e++) {
-    #ifdef debug_construct_fluid
-    dmsg << "---------- e: " << e+1;
-    #endif
-    cDmn = all_fun::domain(com_mod, lM, cEq, e);
-    auto cPhys = eq.dmn[cDmn].phys;
-
-    if (cPhys != EquationType::phys_fluid) {
-      continue;
-    }
-    
-    double K_inverse_darcy_permeability = eq.dmn[cDmn].prop.at(PhysicalProperyType::inverse_darcy_permeability);
-
-    //  Update shape functions for NURBS
-    if (lM.eType == ElementType::NRB) {
-      //CALL NRBNNX(lM, e)
-    }
-
-    // Create local copies
-    for (int a = 0; a < eNoN; a++) {
-      int Ac = lM.IEN(a,e);
-      ptr(a) = Ac;
-
-      for (int i = 0; i < xl.nrows(); i++) {
-        xl(i,a) = com_mod.x(i,Ac);
-        bfl(i,a) = com_mod.Bf(i,Ac);
-     }
-      for (int i = 0; i < al.nrows(); i++) {
-        al(i,a) = Ag(i,Ac);
-        yl(i,a) = Yg(i,Ac);
-      }
-    }
-
-    // Initialize residual and tangents
-    lR = 0.0;
-    lK = 0.0;
-    std::array<fsType,2> fs;
-
-    // Set function spaces for velocity and pressure.
-    fs::get_thood_fs(com_mod, fs, lM, vmsStab, 1);
-
-    // Define element coordinates appropriate for function spaces
-    Array<double> xwl(nsd,fs[0].eNoN); 
-    Array<double> Nwx(nsd,fs[0].eNoN); 
-    Array<double> Nwxx(l,fs[0].eNoN);
-
-    Array<double> xql(nsd,fs[1].eNoN); 
-    Array<double> Nqx(nsd,fs[1].eNoN);
-
-    #ifdef debug_construct_fluid
-    dmsg;
-    dmsg << "l: " << l;
-    dmsg << "fs[0].eNoN: " << fs[0].eNoN;
-    dmsg << "fs[1].eNoN: " << fs[1].eNoN;
-    #endif
+  const bool threaded = elem_color::use_threads(com_mod, lM, eq);
+  Vector<int> elems;
+  std::vector<elem_color::ElemBatch> batches;
+  elem_color::get_batches(com_mod, lM, cEq, threaded, elems, batches);
+  std::exception_ptr error;
 
-    xwl = xl;
-
-    for (int i = 0; i < xql.nrows(); i++) { 
-      for (int j = 0; j < fs[1].eNoN; j++) { 
-        xql(i,j) = xl(i,j);
-      }
-    }
-
-    // Gauss integration 1
-    //
-    #ifdef debug_construct_fluid
-    dmsg;
-    dmsg << "Gauss integration 1 ... " << "";
-    dmsg << "fs[1].nG: " << fs[0].nG;
-    dmsg << "fs[1].lShpF: " << fs[0].lShpF;
-    dmsg << "fs[2].nG: " << fs[1].nG;
-    dmsg << "fs[2].lShpF: " << fs[1].lShpF;
-    #endif
-
-    double Jac{0.0};
-    Array<double> ksix(nsd,nsd);
-
-    for (int g = 0; g < fs[0].nG; g++) {
-      #ifdef debug_construct_fluid
-      dmsg << "===== g: " << g+1;
-      #endif
-      if (g == 0 || !fs[1].lShpF) {
-        auto Nx = fs[1].Nx.rslice(g);
-        nn::gnn(fs[1].eNoN, nsd, nsd, Nx, xql, Nqx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
-        }
-      }
-
-      if (g == 0 || !fs[0].lShpF) {
-        auto Nx = fs[0].Nx.rslice(g);
-        nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
-        }
-
-        auto Nxx = fs[0].Nxx.rslice(g);
-        nn::gn_nxx(l, fs[0].eNoN, nsd, nsd, Nx, Nxx, xwl, Nwx, Nwxx); 
-      }
+  // Select element kernels specialized for the mesh element type.
+  //
+  Fluid3dKernel kernel_c, kernel_m;
+  fluid_3d_kernels(lM, vmsStab, kernel_c, kernel_m);
 
-      double w = fs[0].w(g) * Jac;
-      #ifdef debug_construct_fluid
-      dmsg << "Jac: " << Jac;
-      dmsg << "w: " << w;
-      #endif
-
-      // Compute momentum residual and tangent matrix.
-      //
-      if (nsd == 3) {
-        auto N0 = fs[0].N.rcol(g); 
-        auto N1 = fs[1].N.rcol(g); 
-        fluid_3d_m(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, 
-            Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
-
-      } else if (nsd == 2) {
-        auto N0 = fs[0].N.rcol(g); 
-        auto N1 = fs[1].N.rcol(g); 
-        fluid_2d_m(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, 
-            Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
-      }
-    } // g: loop
+  // Use the cached element geometry if it has been computed.
+  const bool geo_cached = lM.thGeo[0][0].valid();
 
-    // Set function spaces for velocity and pressure.
-    //
-    fs::get_thood_fs(com_mod, fs, lM, vmsStab, 2);
+  #pragma omp parallel if(threaded)
+  {
+    // FLUID: dof = nsd+1
+    Vector<int> ptr(eNoN); 
+    Array<double> xl(nsd,eNoN); 
+  
+    // local acceleration vector (for a single element)
+    Array<double> al(tDof,eNoN);
+  
+    // local velocity vector (for a single element)
+    Array<double> yl(tDof,eNoN);
+    Array<double> bfl(nsd,eNoN);
+  
+    // local (weak form) residual vector (for a single element) 
+    Array<double> lR(dof,eNoN);
+  
+    // local tangent matrix (for a single element)
+    Array3<double> lK(dof*dof,eNoN,eNoN);
 
-    // Gauss integration 2
+    // Loop over all elements of mesh
     //
-    #ifdef debug_construct_fluid
-    dmsg;
-    dmsg << "Gauss integration 2 ... " << "";
-    dmsg << "fs[1].nG: " << fs[0].nG;
-    dmsg << "fs[1].lShpF: " << fs[0].lShpF;
-    dmsg << "fs[2].nG: " << fs[1].nG;
-    dmsg << "fs[2].lShpF: " << fs[1].lShpF;
-    #endif
-
-    for (int g = 0; g < fs[1].nG; g++) {
-      if (g == 0 || !fs[0].lShpF) {
-        auto Nx = fs[0].Nx.rslice(g);
-        nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
-
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
-        }
+    for (const auto& batch : batches) {
+      if (eq.dmn[batch.dmn].phys != EquationType::phys_fluid) {
+        continue;
       }
 
-      if (g == 0 || !fs[1].lShpF) {
-        auto Nx = fs[1].Nx.rslice(g);
-        nn::gnn(fs[1].eNoN, nsd, nsd, Nx, xql, Nqx, Jac, ksix);
-
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
+      #pragma omp single
+      cDmn = batch.dmn;
+
+      double K_inverse_darcy_permeability = eq.dmn[batch.dmn].prop.at(PhysicalProperyType::inverse_darcy_permeability);
+
+      #pragma omp for schedule(dynamic,64)
+      for (int ie = batch.start; ie < batch.end; ie++) {
+        int e = elems(ie);
+
+        try {
+          #ifdef debug_construct_fluid
+          dmsg << "---------- e: " << e+1;
+          #endif
+          //  Update shape functions for NURBS
+          if (lM.eType == ElementType::NRB) {
+            //CALL NRBNNX(lM, e)
+          }
+
+          // Create local copies
+          for (int a = 0; a < eNoN; a++) {
+            int Ac = lM.IEN(a,e);
+            ptr(a) = Ac;
+
+            for (int i = 0; i < xl.nrows(); i++) {
+              xl(i,a) = com_mod.x(i,Ac);
+              bfl(i,a) = com_mod.Bf(i,Ac);
+           }
+            for (int i = 0; i < al.nrows(); i++) {
+              al(i,a) = Ag(i,Ac);
+              yl(i,a) = Yg(i,Ac);
+            }
+          }
+
+          // Initialize residual and tangents
+          lR = 0.0;
+          lK = 0.0;
+          std::array<fsType,2> fs;
+
+          // Set function spaces for velocity and pressure.
+          fs::get_thood_fs(com_mod, fs, lM, vmsStab, 1);
+
+          // Define element coordinates appropriate for function spaces
+          Array<double> xwl(nsd,fs[0].eNoN); 
+          Array<double> Nwx(nsd,fs[0].eNoN); 
+          Array<double> Nwxx(l,fs[0].eNoN);
+
+          Array<double> xql(nsd,fs[1].eNoN); 
+          Array<double> Nqx(nsd,fs[1].eNoN);
+
+          #ifdef debug_construct_fluid
+          dmsg;
+          dmsg << "l: " << l;
+          dmsg << "fs[0].eNoN: " << fs[0].eNoN;
+          dmsg << "fs[1].eNoN: " << fs[1].eNoN;
+          #endif
+
+          xwl = xl;
+
+          for (int i = 0; i < xql.nrows(); i++) { 
+            for (int j = 0; j < fs[1].eNoN; j++) { 
+              xql(i,j) = xl(i,j);
+            }
+          }
+
+          // Gauss integration 1
+          //
+          #ifdef debug_construct_fluid
+          dmsg;
+          dmsg << "Gauss integration 1 ... " << "";
+          dmsg << "fs[1].nG: " << fs[0].nG;
+          dmsg << "fs[1].lShpF: " << fs[0].lShpF;
+          dmsg << "fs[2].nG: " << fs[1].nG;
+          dmsg << "fs[2].lShpF: " << fs[1].lShpF;
+          #endif
+
+          double Jac{0.0};
+          Array<double> ksix(nsd,nsd);
+
+          for (int g = 0; g < fs[0].nG; g++) {
+            #ifdef debug_construct_fluid
+            dmsg << "===== g: " << g+1;
+            #endif
+            if (g == 0 || !fs[1].lShpF) {
+              if (geo_cached) {
+                elem_geo::get_geo(lM.thGeo[0][1], e, g, Nqx, Jac, ksix);
+              } else {
+                auto Nx = fs[1].Nx.rslice(g);
+                nn::gnn(fs[1].eNoN, nsd, nsd, Nx, xql, Nqx, Jac, ksix);
+                if (utils::is_zero(Jac)) {
+                   throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
+                }
+              }
+            }
+
+            if (g == 0 || !fs[0].lShpF) {
+              if (geo_cached) {
+                elem_geo::get_geo(lM.thGeo[0][0], e, g, Nwx, Nwxx, Jac, ksix);
+              } else {
+                auto Nx = fs[0].Nx.rslice(g);
+                nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
+                if (utils::is_zero(Jac)) {
+                   throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
+                }
+
+                auto Nxx = fs[0].Nxx.rslice(g);
+                nn::gn_nxx(l, fs[0].eNoN, nsd, nsd, Nx, Nxx, xwl, Nwx, Nwxx); 
+              }
+            }
+
+            double w = fs[0].w(g) * Jac;
+            #ifdef debug_construct_fluid
+            dmsg << "Jac: " << Jac;
+            dmsg << "w: " << w;
+            #endif
+
+            // Compute momentum residual and tangent matrix.
+            //
+            if (nsd == 3) {
+              auto N0 = fs[0].N.rcol(g); 
+              auto N1 = fs[1].N.rcol(g); 
+              kernel_m(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, 
+                  Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
+
+            } else if (nsd == 2) {
+              auto N0 = fs[0].N.rcol(g); 
+              auto N1 = fs[1].N.rcol(g); 
+              fluid_2d_m(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, 
+                  Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
+            }
+          } // g: loop
+
+          // Set function spaces for velocity and pressure.
+          //
+          fs::get_thood_fs(com_mod, fs, lM, vmsStab, 2);
+
+          // Gauss integration 2
+          //
+          #ifdef debug_construct_fluid
+          dmsg;
+          dmsg << "Gauss integration 2 ... " << "";
+          dmsg << "fs[1].nG: " << fs[0].nG;
+          dmsg << "fs[1].lShpF: " << fs[0].lShpF;
+          dmsg << "fs[2].nG: " << fs[1].nG;
+          dmsg << "fs[2].lShpF: " << fs[1].lShpF;
+          #endif
+
+          for (int g = 0; g < fs[1].nG; g++) {
+            if (g == 0 || !fs[0].lShpF) {
+              if (geo_cached) {
+                elem_geo::get_geo(lM.thGeo[1][0], e, g, Nwx, Jac, ksix);
+              } else {
+                auto Nx = fs[0].Nx.rslice(g);
+                nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
+
+                if (utils::is_zero(Jac)) {
+                   throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
+                }
+              }
+            }
+
+            if (g == 0 || !fs[1].lShpF) {
+              if (geo_cached) {
+                elem_geo::get_geo(lM.thGeo[1][1], e, g, Nqx, Jac, ksix);
+              } else {
+                auto Nx = fs[1].Nx.rslice(g);
+                nn::gnn(fs[1].eNoN, nsd, nsd, Nx, xql, Nqx, Jac, ksix);
+
+                if (utils::is_zero(Jac)) {
+                   throw std::runtime_error("[construct_fluid] Jacobian for element " + std::to_string(e) + " is < 0.");
+                }
+              }
+            }
+            double w = fs[1].w(g) * Jac;
+
+            // Compute continuity residual and tangent matrix.
+            //
+            if (nsd == 3) {
+              auto N0 = fs[0].N.rcol(g); 
+              auto N1 = fs[1].N.rcol(g); 
+              kernel_c(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
+
+            } else if (nsd == 2) {
+              auto N0 = fs[0].N.rcol(g); 
+              auto N1 = fs[1].N.rcol(g); 
+              fluid_2d_c(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
+            }
+
+          } // g: loop
+
+          eq.linear_algebra->assemble(com_mod, lM, e, ptr, lK, lR);
+
+        } catch (...) {
+          #pragma omp critical
+          {
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
         }
-      }
-      double w = fs[1].w(g) * Jac;
-
-      // Compute continuity residual and tangent matrix.
-      //
-      if (nsd == 3) {
-        auto N0 = fs[0].N.rcol(g); 
-        auto N1 = fs[1].N.rcol(g); 
-        fluid_3d_c(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
-
-      } else if (nsd == 2) {
-        auto N0 = fs[0].N.rcol(g); 
-        auto N1 = fs[1].N.rcol(g); 
-        fluid_2d_c(com_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, ksix, N0, N1, Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, K_inverse_darcy_permeability);
-      }
-
-    } // g: loop
-
-    eq.linear_algebra->assemble(com_mod, eNoN, ptr, lK, lR);
+      } // e: loop
+    } // batch: loop
+  } // omp parallel
 
-  } // e: loop
+  if (error) {
+    std::rethrow_exception(error);
+  }
 
   #ifdef debug_construct_fluid
   double end_time = utils::cput();
@@ -1426,12 +1483,19 @@ void fluid_2d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
 
 
 /// @brief Element continuity residual.
+///
+/// The template parameters are the number of velocity and pressure nodes of 
+/// a specialized element type, or 0 to use the 'eNoNw_in' and 'eNoNq_in' values.
 //
-void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int eNoNq, const double w, 
+template <int eNoNw_t, int eNoNq_t>
+void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw_in, const int eNoNq_in, const double w, 
     const Array<double>& Kxi, const Vector<double>& Nw, const Vector<double>& Nq, const Array<double>& Nwx, 
     const Array<double>& Nqx, const Array<double>& Nwxx, const Array<double>& al, const Array<double>& yl, 
     const Array<double>& bfl, Array<double>& lR, Array3<double>& lK, double K_inverse_darcy_permeability)
 {
+  const int eNoNw = (eNoNw_t > 0) ? eNoNw_t : eNoNw_in;
+  const int eNoNq = (eNoNq_t > 0) ? eNoNq_t : eNoNq_in;
+
   #define n_debug_fluid3d_c
   #ifdef debug_fluid3d_c
   DebugMsg dmsg(__func__, com_mod.cm.idcm());
@@ -1442,9 +1506,6 @@ void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   double start_time = utils::cput();
   #endif
   
-  // Maximum size of arrays sized by (3,eNoNw) -> (3,MAX_SIZE).
-  const int MAX_SIZE = 27;
-
   using namespace consts;
 
   int cEq = com_mod.cEq;
@@ -1569,7 +1630,7 @@ void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   es[1][2] = es[2][1];
   es[2][0] = es[0][2];
 
-  double esNx[3][MAX_SIZE];
+  NodeArray<eNoNw_t,3> esNx(eNoNw);
 
   for (int a = 0; a < eNoNw; a++) {
     esNx[0][a] = es[0][0]*Nwx(0,a) + es[1][0]*Nwx(1,a) + es[2][0]*Nwx(2,a);
@@ -1633,7 +1694,7 @@ void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   // Stabilization parameters
   //
   double up[3] = {};
-  double updu[3][3][MAX_SIZE] = {};
+  NodeArray<eNoNw_t,3,3> updu(eNoNw);
   double tauM = 0.0;
 
   if (vmsFlag) {
@@ -1688,7 +1749,6 @@ void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   } else {
     tauM = 0.0;
     std::memset(up, 0, sizeof up);
-    std::memset(updu, 0, sizeof updu);
   }
 
   //  Local residual
@@ -1734,12 +1794,19 @@ void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
 ///  Modifies:
 ///    lR(dof,eNoN)  - Residual
 ///    lK(dof*dof,eNoN,eNoN) - Stiffness matrix
+///
+/// The template parameters are the number of velocity and pressure nodes of 
+/// a specialized element type, or 0 to use the 'eNoNw_in' and 'eNoNq_in' values.
 //
-void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int eNoNq, const double w,
+template <int eNoNw_t, int eNoNq_t>
+void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw_in, const int eNoNq_in, const double w,
     const Array<double>& Kxi, const Vector<double>& Nw, const Vector<double>& Nq, const Array<double>& Nwx,
     const Array<double>& Nqx, const Array<double>& Nwxx, const Array<double>& al, const Array<double>& yl,
     const Array<double>& bfl, Array<double>& lR, Array3<double>& lK, double K_inverse_darcy_permeability)
 {
+  const int eNoNw = (eNoNw_t > 0) ? eNoNw_t : eNoNw_in;
+  const int eNoNq = (eNoNq_t > 0) ? eNoNq_t : eNoNq_in;
+
   #define n_debug_fluid_3d_m
   #ifdef debug_fluid_3d_m
   DebugMsg dmsg(__func__, com_mod.cm.idcm());
@@ -1751,9 +1818,6 @@ void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   double start_time = utils::cput();
   #endif
 
-  // Maximum size of arrays sized by (3,eNoNw) -> (3,MAX_SIZE).
-  const int MAX_SIZE = 27;
-
   using namespace consts;
 
   int cEq = com_mod.cEq;
@@ -1896,7 +1960,7 @@ void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   es[1][2] = es[2][1];
   es[2][0] = es[0][2];
 
-  double esNx[3][MAX_SIZE];
+  NodeArray<eNoNw_t,3> esNx(eNoNw);
 
   for (int a = 0; a < eNoNw; a++) {
     esNx[0][a] = es[0][0]*Nwx(0,a) + es[1][0]*Nwx(1,a) + es[2][0]*Nwx(2,a);
@@ -2058,10 +2122,10 @@ void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
 
   //  Local residual
   //
-  double updu[3][3][MAX_SIZE] = {};
-  double uNx[MAX_SIZE] = {};
-  double upNx[MAX_SIZE] = {}; 
-  double uaNx[MAX_SIZE] = {}; 
+  NodeArray<eNoNw_t,3,3> updu(eNoNw);
+  NodeArray<eNoNw_t> uNx(eNoNw);
+  NodeArray<eNoNw_t> upNx(eNoNw);
+  NodeArray<eNoNw_t> uaNx(eNoNw);
 
   for (int a = 0; a < eNoNw; a++) {
     lR(0,a) = lR(0,a) + wr*Nw(a)*rV[0] + w*(Nwx(0,a)*rM[0][0] + Nwx(1,a)*rM[1][0] + Nwx(2,a)*rM[2][0]);
@@ -2179,6 +2243,72 @@ void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
   }
 }
 
+/// @brief Element continuity residual for any element type.
+//
+void fluid_3d_c(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int eNoNq, const double w, 
+    const Array<double>& Kxi, const Vector<double>& Nw, const Vector<double>& Nq, const Array<double>& Nwx, 
+    const Array<double>& Nqx, const Array<double>& Nwxx, const Array<double>& al, const Array<double>& yl, 
+    const Array<double>& bfl, Array<double>& lR, Array3<double>& lK, double K_inverse_darcy_permeability)
+{
+  fluid_3d_c<0,0>(com_mod, vmsFlag, eNoNw, eNoNq, w, Kxi, Nw, Nq, Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, 
+      K_inverse_darcy_permeability);
+}
+
+/// @brief Element momentum residual for any element type.
+//
+void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int eNoNq, const double w,
+    const Array<double>& Kxi, const Vector<double>& Nw, const Vector<double>& Nq, const Array<double>& Nwx,
+    const Array<double>& Nqx, const Array<double>& Nwxx, const Array<double>& al, const Array<double>& yl,
+    const Array<double>& bfl, Array<double>& lR, Array3<double>& lK, double K_inverse_darcy_permeability)
+{
+  fluid_3d_m<0,0>(com_mod, vmsFlag, eNoNw, eNoNq, w, Kxi, Nw, Nq, Nwx, Nqx, Nwxx, al, yl, bfl, lR, lK, 
+      K_inverse_darcy_permeability);
+}
+
+/// @brief Select the 3D element kernels specialized for the element type 
+/// and function spaces of a mesh. 
+///
+/// Meshes with other element types use the generic fluid_3d_c() and 
+/// fluid_3d_m() kernels.
+//
+void fluid_3d_kernels(const mshType& lM, const bool vmsStab, Fluid3dKernel& kernel_c, Fluid3dKernel& kernel_m)
+{
+  using namespace consts;
+
+  kernel_c = fluid_3d_c;
+  kernel_m = fluid_3d_m;
+
+  if (lM.fs.size() == 0) {
+    return;
+  }
+
+  int eNoNw = lM.fs[0].eNoN;
+  int eNoNq = eNoNw;
+
+  if (!vmsStab) {
+    if (lM.fs.size() < 2) {
+      return;
+    }
+    eNoNq = lM.fs[1].eNoN;
+  }
+
+  if (lM.eType == ElementType::TET4 && eNoNw == 4 && eNoNq == 4) {
+    kernel_c = fluid_3d_c<4,4>;
+    kernel_m = fluid_3d_m<4,4>;
+
+  } else if (lM.eType == ElementType::TET10 && eNoNw == 10 && eNoNq == 10) {
+    kernel_c = fluid_3d_c<10,10>;
+    kernel_m = fluid_3d_m<10,10>;
+
+  } else if (lM.eType == ElementType::TET10 && eNoNw == 10 && eNoNq == 4) {
+    kernel_c = fluid_3d_c<10,4>;
+    kernel_m = fluid_3d_m<10,4>;
+
+  } else if (lM.eType == ElementType::HEX8 && eNoNw == 8 && eNoNq == 8) {
+    kernel_c = fluid_3d_c<8,8>;
+    kernel_m = fluid_3d_m<8,8>;
+  }
+}
 
 void get_viscosity(const ComMod& com_mod, const dmnType& lDmn, double& gamma, double& mu, double& mu_s, double& mu_x)
 {
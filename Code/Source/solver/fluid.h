@@ -70,6 +70,14 @@ void fluid_3d_m(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int e
     const Array<double>& Nwxx, const Array<double>& al, const Array<double>& yl, const Array<double>& bfl, 
     Array<double>& lR, Array3<double>& lK, double K_inverse_darcy_permeability);
 
+/// @brief Pointer to a 3D element kernel, fluid_3d_c() or fluid_3d_m().
+using Fluid3dKernel = void (*)(ComMod& com_mod, const int vmsFlag, const int eNoNw, const int eNoNq, const double w, 
+    const Array<double>& Kxi, const Vector<double>& Nw, const Vector<double>& Nq, const Array<double>& Nwx, 
+    const Array<double>& Nqx, const Array<double>& Nwxx, const Array<double>& al, const Array<double>& yl, 
+    const Array<double>& bfl, Array<double>& lR, Array3<double>& lK, double K_inverse_darcy_permeability);
+
+void fluid_3d_kernels(const mshType& lM, const bool vmsStab, Fluid3dKernel& kernel_c, Fluid3dKernel& kernel_m);
+
 void get_viscosity(const ComMod& com_mod, const dmnType& lDmn, double& gamma, double& mu, double& mu_s, double& mu_x);
 
 };
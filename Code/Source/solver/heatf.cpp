@@ -31,6 +31,7 @@
 #include "heatf.h"
 
 #include "all_fun.h"
+#include "elem_geo.h"
 #include "lhsa.h"
 #include "mat_fun.h"
 #include "nn.h"
@@ -135,10 +136,14 @@ void construct_heatf(ComMod& com_mod, const mshType& lM, const Array<double>& Ag
 
     for (int g = 0; g < lM.nG; g++) {
       if (g == 0 || !lM.lShpF) {
-        auto Nx_g = lM.Nx.slice(g);
-        nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-          throw std::runtime_error("[construct_heatf] Jacobian for element " + std::to_string(e) + " is < 0.");
+        if (lM.geo.valid()) {
+          elem_geo::get_geo(lM.geo, e, g, Nx, Jac, ksix);
+        } else {
+          auto Nx_g = lM.Nx.slice(g);
+          nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
+          if (utils::is_zero(Jac)) {
+            throw std::runtime_error("[construct_heatf] Jacobian for element " + std::to_string(e) + " is < 0.");
+          }
         }
       }
 
@@ -153,7 +158,7 @@ void construct_heatf(ComMod& com_mod, const mshType& lM, const Array<double>& Ag
       }
     } // for g = 0
 
-    eq.linear_algebra->assemble(com_mod, eNoN, ptr, lK, lR);
+    eq.linear_algebra->assemble(com_mod, lM, e, ptr, lK, lR);
 
   } // for e = 0
 }
@@ -237,6 +242,10 @@ void heatf_2d(ComMod& com_mod, const int eNoN, const double w, const Vector<doub
   for (int a = 0; a < eNoN; a++) {
     lR(0,a) = lR(0,a) + w*(N(a)*(Td + udTx) + (Nx(0,a)*Tx(0) + Nx(1,a)*Tx(1))*nu - udNx(a)*Tp);
 
+    if (eq.tangent.reuse) {
+      continue;
+    }
+
     for (int b = 0; b < eNoN; b++) {
       lK(0,a,b) = lK(0,a,b) + wl*(nu*(Nx(0,a)*Nx(0,b) + Nx(1,a)*Nx(1,b)) + (N(a) + tauM*udNx(a))*(N(b)*amd + udNx(b)));
     }
@@ -348,6 +357,10 @@ void heatf_3d(ComMod& com_mod, const int eNoN, const double w, const Vector<doub
   for (int a = 0; a < eNoN; a++) {
     lR(0,a) = lR(0,a) + w*(N(a)*(Td + udTx) + (Nx(0,a)*Tx(0) + Nx(1,a)*Tx(1) + Nx(2,a)*Tx(2))*nu - udNx(a)*Tp);
 
+    if (eq.tangent.reuse) {
+      continue;
+    }
+
     for (int b = 0; b < eNoN; b++) {
       lK(0,a,b) = lK(0,a,b) + wl*(nu*(Nx(0,a)*Nx(0,b) + Nx(1,a)*Nx(1,b) + Nx(2,a)*Nx(2,b)) + 
                   (N(a) + tauM*udNx(a))*(N(b)*amd + udNx(b)));
@@ -34,10 +34,13 @@
 
 #include "distribute.h"
 
+#include "Profiler.h"
 #include "all_fun.h"
 #include "baf_ini.h"
 #include "cep_ion.h"
 #include "consts.h"
+#include "elem_color.h"
+#include "elem_geo.h"
 #include "fs.h"
 #include "lhsa.h"
 #include "mat_fun.h"
@@ -59,9 +62,11 @@
 
 #include "mpi.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <math.h>
+#include <sstream>
 
 /// @brief This seems to deallocate a bunch of arrys.
 ///
@@ -71,6 +76,124 @@ void finalize(Simulation* simulation)
 {
 }
 
+/// @brief Using a restart file written in global node order for initialization.
+///
+/// The file is independent of the partitioning so it can be read with any 
+/// number of processors. Each processor reads the values of its own nodes 
+/// using a single collective MPI-IO read.
+//
+void init_from_global_bin(Simulation* simulation, const std::string& fName, std::array<double,3>& timeP)
+{
+  auto& com_mod = simulation->com_mod;
+  auto& cm = com_mod.cm;
+
+  com_mod.timeP[0] = timeP[0];
+  com_mod.timeP[1] = timeP[1];
+  com_mod.timeP[2] = timeP[2];
+
+  MPI_File file;
+  if (MPI_File_open(cm.com(), fName.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+    throw std::runtime_error("[init_from_global_bin] Unable to open the restart file '" + fName + "'.");
+  }
+
+  // Read the header.
+  //
+  std::array<int,3> prefix;
+  MPI_File_read_at_all(file, 0, prefix.data(), prefix.size(), MPI_INT, MPI_STATUS_IGNORE);
+  int header_length = prefix[2];
+
+  std::string header_data(header_length, '\0');
+  MPI_File_read_at_all(file, 0, header_data.data(), header_length, MPI_BYTE, MPI_STATUS_IGNORE);
+  std::istringstream header(header_data, std::ios::in | std::ios::binary);
+  header.seekg(sizeof(prefix));
+
+  std::array<int,7> tStamp;
+  int gtnNo, nodeDof;
+  output::read_restart_header(com_mod, tStamp, timeP[0], header);
+  header.read((char*)&gtnNo, sizeof(gtnNo));
+  header.read((char*)&nodeDof, sizeof(nodeDof));
+
+  // The number of processors and local nodes are allowed to change.
+  //
+  auto stamp = com_mod.stamp;
+  tStamp[0] = stamp[0];
+  tStamp[3] = stamp[3];
+
+  std::vector<std::string> error_msgs = {
+    "The number of processors ",
+    "The number of equations ",
+    "The number of meshes ",
+    "The number of nodes ",
+    "The number of ncplBC.x ",
+    "The number of dof ",
+    "The dFlag specification "
+  };
+
+  std::string error_msg;
+
+  for (int i = 0; i < stamp.size(); i++) {
+    if (tStamp[i] != stamp[i]) {
+      error_msg = error_msgs[i] + " " + std::to_string(tStamp[i]) + " ";
+      break;
+    }
+  }
+
+  if (error_msg == "" && gtnNo != com_mod.gtnNo) {
+    error_msg = error_msgs[3] + " " + std::to_string(gtnNo) + " ";
+  }
+
+  auto fields = output::restart_node_fields(simulation, com_mod.Yo, com_mod.Ao, com_mod.Do);
+  int num_values = 0;
+  for (auto& field : fields) {
+    num_values += field.second;
+  }
+
+  if (error_msg == "" && nodeDof != num_values) {
+    error_msg = "The number of values per node " + std::to_string(nodeDof) + " ";
+  }
+
+  if (error_msg != "") { 
+    MPI_File_close(&file);
+    throw std::runtime_error("[init_from_global_bin] " + error_msg + "read from '" + fName + "' don't match.");
+  }
+
+  header.read((char*)com_mod.cplBC.xo.data(), com_mod.cplBC.xo.msize());
+
+  // Read the values of the local nodes in increasing global node order.
+  //
+  std::vector<std::pair<int,int>> nodes;
+  for (int a = 0; a < com_mod.tnNo; a++) {
+    nodes.push_back({com_mod.ltg(a), a});
+  }
+  std::sort(nodes.begin(), nodes.end());
+
+  int num_nodes = nodes.size();
+  std::vector<MPI_Aint> offsets(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    offsets[i] = static_cast<MPI_Aint>(nodes[i].first) * nodeDof * sizeof(double);
+  }
+
+  MPI_Datatype file_type;
+  MPI_Type_create_hindexed_block(num_nodes, nodeDof, offsets.data(), MPI_DOUBLE, &file_type);
+  MPI_Type_commit(&file_type);
+
+  std::vector<double> values(num_nodes * nodeDof);
+  MPI_File_set_view(file, header_length, MPI_DOUBLE, file_type, "native", MPI_INFO_NULL);
+  MPI_File_read_all(file, values.data(), values.size(), MPI_DOUBLE, MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+  MPI_Type_free(&file_type);
+
+  int n = 0;
+  for (int i = 0; i < num_nodes; i++) {
+    int a = nodes[i].second;
+    for (auto& field : fields) {
+      for (int j = 0; j < field.second; j++, n++) {
+        field.first[j + a*field.second] = values[n];
+      }
+    }
+  }
+}
+
 /// @brief Using the svFSI specific format binary file for initialization
 ///
 /// Reprodices 'SUBROUTINE INITFROMBIN(fName, timeP)' defined in INITIALIZE.f.
@@ -96,6 +219,19 @@ void init_from_bin(Simulation* simulation, const std::string& fName, std::array<
   bool pstEq = com_mod.pstEq;
   bool cepEq = cep_mod.cepEq;
 
+  // Restart files written in global node order are identified by their 
+  // first value.
+  //
+  int magic = 0;
+  std::ifstream magic_file(fName, std::ios::binary | std::ios::in);
+  magic_file.read((char*)&magic, sizeof(magic));
+  magic_file.close();
+
+  if (magic == output::global_restart_magic) {
+    init_from_global_bin(simulation, fName, timeP);
+    return;
+  }
+
   com_mod.timeP[0] = timeP[0];
   com_mod.timeP[1] = timeP[1];
   com_mod.timeP[2] = timeP[2];
@@ -108,14 +244,23 @@ void init_from_bin(Simulation* simulation, const std::string& fName, std::array<
   dmsg << "cm.tF(): " << cm.tF(cm_mod); 
   #endif
 
-  // Open file and position at the location in the file
-  // for the current process.
+  // Read the record for the current process, compressed restart 
+  // files are decompressed.
   //
-  std::ifstream bin_file(fName, std::ios::binary | std::ios::in);
-  int process_id = cm.tF(cm_mod);
-  std::streampos write_pos = (process_id  - 1) * recLn;
-  bin_file.seekg(write_pos);
-  //OPEN(fid, FILE=fName, ACCESS='DIRECT', RECL=recLn)
+  std::string record;
+
+  if (!Checkpoint::read(simulation, fName, record)) {
+    std::ifstream record_file(fName, std::ios::binary | std::ios::in);
+    int process_id = cm.tF(cm_mod);
+    std::streampos write_pos = (process_id  - 1) * recLn;
+    record_file.seekg(write_pos);
+    record.resize(recLn);
+    record_file.read(record.data(), recLn);
+    record.resize(record_file.gcount());
+    //OPEN(fid, FILE=fName, ACCESS='DIRECT', RECL=recLn)
+  }
+
+  std::istringstream bin_file(record, std::ios::binary | std::ios::in);
 
   std::array<int,7> tStamp;
   auto& cplBC = com_mod.cplBC;
@@ -194,8 +339,6 @@ void init_from_bin(Simulation* simulation, const std::string& fName, std::array<
     */
   }
 
-  bin_file.close();
-
   // First checking all variables on master processor, since on the
   // other processor data will be shifted due to any change on the
   // sizes
@@ -312,6 +455,8 @@ void init_from_vtu(Simulation* simulation, const std::string& fName, std::array<
 //
 void initialize(Simulation* simulation, Vector<double>& timeP)
 {
+  SV_PROFILE_REGION("initialize");
+
   using namespace consts;
 
   auto& com_mod = simulation->com_mod;
@@ -553,6 +698,14 @@ void initialize(Simulation* simulation, Vector<double>& timeP)
   int nnz = 0;
   lhsa_ns::lhsa(simulation, nnz);
 
+  // Color mesh elements for threaded assembly.
+  //
+  if (elem_color::num_threads() > 1) {
+    for (auto& msh : com_mod.msh) {
+      elem_color::color_msh(com_mod, msh);
+    }
+  }
+
   int gnnz = nnz;
   MPI_Allreduce(&nnz, &gnnz, 1, cm_mod::mpint, MPI_SUM, cm.com());
 
@@ -740,6 +893,13 @@ void initialize(Simulation* simulation, Vector<double>& timeP)
     }
   }
 
+  // Cache the element geometry of meshes integrated in the reference
+  // configuration.
+  //
+  for (auto& mesh : com_mod.msh) {
+    elem_geo::set_geo(com_mod, mesh);
+  }
+
   // Initialize Immersed Boundary data structures
   // [TODO:DaveP] not implemented but still need to allocate iblank.
   //
@@ -35,6 +35,8 @@
 
 void finalize(Simulation* simulation);
 
+void init_from_global_bin(Simulation* simulation, const std::string& fName, std::array<double,3>& timeP);
+
 void init_from_bin(Simulation* simulation, const std::string& fName, std::array<double,3>& timeP);
 
 void init_from_vtu(Simulation* simulation, const std::string& fName, std::array<double,3>& timeP);
@@ -35,6 +35,7 @@
 #include "l_elas.h"
 
 #include "all_fun.h"
+#include "elem_geo.h"
 #include "lhsa.h"
 #include "nn.h"
 #include "utils.h"
@@ -135,10 +136,14 @@ void construct_l_elas(ComMod& com_mod, const mshType& lM, const Array<double>& A
 
     for (int g = 0; g < lM.nG; g++) {
       if (g == 0 || !lM.lShpF) {
-        auto Nx_g = lM.Nx.slice(g);
-        nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-          throw std::runtime_error("[construct_dsolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+        if (lM.geo.valid()) {
+          elem_geo::get_geo(lM.geo, e, g, Nx, Jac, ksix);
+        } else {
+          auto Nx_g = lM.Nx.slice(g);
+          nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
+          if (utils::is_zero(Jac)) {
+            throw std::runtime_error("[construct_dsolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+          }
         }
       }
 
@@ -164,7 +169,7 @@ void construct_l_elas(ComMod& com_mod, const mshType& lM, const Array<double>& A
       }
     }
 
-    eq.linear_algebra->assemble(com_mod, eNoN, ptr, lK, lR);
+    eq.linear_algebra->assemble(com_mod, lM, e, ptr, lK, lR);
   }
 }
 
@@ -252,6 +257,10 @@ void l_elas_2d(ComMod& com_mod, const int eNoN, const double w, const Vector<dou
     lR(0,a) = lR(0,a) + w*(rho*N(a)*ud(0) + Nx(0,a)*S(0) + Nx(1,a)*S(2)); 
     lR(1,a) = lR(1,a) + w*(rho*N(a)*ud(1) + Nx(0,a)*S(2) + Nx(1,a)*S(1));
 
+    if (eq.tangent.reuse) {
+      continue;
+    }
+
     for (int b = 0; b < eNoN; b++) {
       double NxdNx = Nx(0,a)*Nx(0,b) + Nx(1,a)*Nx(1,b);
       double T1 = amd*N(a)*N(b) / mu + NxdNx;
@@ -367,6 +376,10 @@ void l_elas_3d(ComMod& com_mod, const int eNoN, const double w, const Vector<dou
     lR(1,a) = lR(1,a) + w*(rho*N(a)*ud(1) + Nx(0,a)*S(3) + Nx(1,a)*S(1) + Nx(2,a)*S(4));
     lR(2,a) = lR(2,a) + w*(rho*N(a)*ud(2) + Nx(0,a)*S(5) + Nx(1,a)*S(4) + Nx(2,a)*S(2));
 
+    if (eq.tangent.reuse) {
+      continue;
+    }
+
     for (int b = 0; b < eNoN; b++) {
       double NxdNx = Nx(0,a)*Nx(0,b) + Nx(1,a)*Nx(1,b) + Nx(2,a)*Nx(2,b);
       double T1 = amd*N(a)*N(b) / mu + NxdNx;
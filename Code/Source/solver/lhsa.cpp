@@ -35,6 +35,8 @@
 #include "consts.h"
 #include "utils.h"
 
+#include <algorithm>
+
 namespace lhsa_ns {
 
 void add_col(const int tnNo, const int row, const int col, int& mnnzeic, Array<int>& uInd)
@@ -140,6 +142,52 @@ void do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array3
   }
 }
 
+/// @brief Assemble the element stiffness matrix and residual like do_assem() 
+/// but use the element scatter map 'valPtr' (a slice of mshType::eValPtr) to 
+/// locate the Val entries instead of searching colPtr.
+//
+void do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array<int>& valPtr, 
+    const Array3<double>& lK, const Array<double>& lR)
+{
+  auto& R = com_mod.R;
+  auto& Val = com_mod.Val;
+
+  for (int a = 0; a < d; a++) {
+    int rowN = eqN(a);
+
+    for (int i = 0; i < R.nrows(); i++) {
+      R(i,rowN) = R(i,rowN) + lR(i,a);
+    }
+
+    for (int b = 0; b < d; b++) {
+      int ptr = valPtr(a,b);
+
+      for (int i = 0; i < Val.nrows(); i++) {
+        Val(i,ptr) = Val(i,ptr) + lK(i,a,b);
+      }
+    }
+  }
+}
+
+/// @brief Assemble only the element residual, used when the tangent 
+/// matrix of a previous Newton iteration is reused.
+//
+void do_assem_residual(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array<double>& lR)
+{
+  auto& R = com_mod.R;
+
+  for (int a = 0; a < d; a++) {
+    int rowN = eqN(a);
+    if (rowN == -1) {
+      continue;
+    }
+
+    for (int i = 0; i < R.nrows(); i++) {
+      R(i,rowN) = R(i,rowN) + lR(i,a);
+    }
+  }
+}
+
 //------
 // lhsa
 //------
@@ -377,6 +425,8 @@ void lhsa(Simulation* simulation, int& nnz)
     }
     com_mod.rowPtr(rowN+1) = j;
   }
+
+  set_elem_val_ptr(com_mod);
 }
 
 //-------
@@ -406,6 +456,45 @@ void resiz(const int tnNo, int& mnnzeic, Array<int>& uInd)
   }
 }
 
+//------------------
+// set_elem_val_ptr
+//------------------
+// Set the element scatter map for each mesh from the element connectivity
+// and the rowPtr/colPtr sparse pattern. This replaces the search over colPtr 
+// done for each element entry in do_assem() by a table lookup.
+//
+// Modifies:
+//   com_mod.msh[iM].eValPtr
+//
+void set_elem_val_ptr(ComMod& com_mod)
+{
+  const auto& rowPtr = com_mod.rowPtr;
+  const auto& colPtr = com_mod.colPtr;
+
+  for (auto& msh : com_mod.msh) {
+    const int eNoN = msh.eNoN;
+    msh.eValPtr.resize(eNoN, eNoN, msh.nEl);
+
+    for (int e = 0; e < msh.nEl; e++) {
+      for (int a = 0; a < eNoN; a++) {
+        int rowN = msh.IEN(a,e);
+        const int* first = colPtr.data() + rowPtr(rowN);
+        const int* last = colPtr.data() + rowPtr(rowN+1);
+
+        for (int b = 0; b < eNoN; b++) {
+          int colN = msh.IEN(b,e);
+          auto it = std::lower_bound(first, last, colN);
+          if (it == last || *it != colN) {
+            throw std::runtime_error("[set_elem_val_ptr] No sparse matrix entry for row " + std::to_string(rowN) + 
+                " and column " + std::to_string(colN) + " of mesh '" + msh.name + "'.");
+          }
+          msh.eValPtr(a,b,e) = it - colPtr.data();
+        }
+      }
+    }
+  }
+}
+
 };
 
 
@@ -40,10 +40,17 @@ namespace lhsa_ns {
 
   void do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array3<double>& lK, const Array<double>& lR);
 
+  void do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array<int>& valPtr, 
+      const Array3<double>& lK, const Array<double>& lR);
+
+  void do_assem_residual(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array<double>& lR);
+
   void lhsa(Simulation* simulation, int& nnz);
 
   void resiz(const int tnNo, int& mnnzeic, Array<int>& uInd);
 
+  void set_elem_val_ptr(ComMod& com_mod);
+
 };
 
 #endif
@@ -33,9 +33,11 @@
 
 #include "ls.h"
 
+#include "Profiler.h"
 #include "fsils_api.hpp"
 #include "consts.h"
 
+#include <algorithm>
 #include <math.h>
 
 namespace ls_ns {
@@ -68,6 +70,8 @@ void ls_alloc(ComMod& com_mod, eqType& lEq)
 //
 void ls_solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res) 
 {
+  SV_PROFILE_REGION("ls_solve");
+
   #define n_debug_ls_solve
   #ifdef debug_ls_solve 
   DebugMsg dmsg(__func__, com_mod.cm.idcm());
@@ -77,7 +81,81 @@ void ls_solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vecto
   dmsg << "lEq.assmTLS: " << lEq.assmTLS;
   #endif
 
+  // Pass the state of the Newton iterations used to set the relative
+  // tolerance of an inexact Newton solve. The iterations are converged 
+  // when the residual norm is reduced by 'tol' relative to the initial 
+  // norm or to the norm of the first iteration of the time step.
+  //
+  auto& forcing = lEq.FSILS.forcing;
+
+  if (forcing.type != fsi_linear_solver::ForcingTermType::FORCING_NONE) {
+    forcing.itr = lEq.itr;
+    forcing.nl_tol = lEq.tol * lEq.iNorm;
+
+    if (lEq.itr > 1) {
+      forcing.nl_tol *= std::max(1.0, lEq.pNorm);
+    }
+  }
+
+  // Solve with the tangent matrix kept from a previous Newton iteration 
+  // or keep the assembled tangent matrix, the linear solver may modify Val.
+  //
+  auto& tangent = lEq.tangent;
+
+  if (tangent.enabled()) {
+    if (tangent.reuse) {
+      com_mod.Val = tangent.Val;
+    } else {
+      tangent.Val = com_mod.Val;
+    }
+  }
+
   lEq.linear_algebra->solve(com_mod, lEq, incL, res);
+
+  if (tangent.enabled()) {
+    tangent.age += 1;
+    tangent.rNormO = (lEq.itr == 1) ? 0.0 : tangent.rNorm;
+    tangent.rNorm = lEq.FSILS.RI.iNorm;
+  }
+}
+
+/// @brief Set if the current Newton iteration of equation 'lEq' reuses the 
+/// kept tangent matrix (modified Newton) or assembles a new one.
+///
+/// Modifies: lEq.tangent
+//
+void ls_set_tangent_reuse(ComMod& com_mod, eqType& lEq)
+{
+  auto& tangent = lEq.tangent;
+  tangent.reuse = false;
+
+  if (!tangent.enabled()) {
+    return;
+  }
+
+  const int cTS = com_mod.cTS;
+  bool reuse = (tangent.cTS != -1) && (tangent.Val.size() == com_mod.dof*com_mod.dof*com_mod.lhs.nnz);
+
+  if (reuse) {
+    if (lEq.itr == 1) {
+      reuse = (cTS - tangent.cTS) < tangent.time_steps;
+    } else if (tangent.iterations > 0) {
+      reuse = tangent.age < tangent.iterations;
+    }
+  }
+
+  // Assemble when the Newton iterations converge slowly.
+  //
+  if (reuse && (tangent.residual_ratio > 0.0) && (tangent.rNormO > 0.0)) {
+    reuse = (tangent.rNorm / tangent.rNormO) <= tangent.residual_ratio;
+  }
+
+  if (!reuse) {
+    tangent.age = 0;
+    tangent.cTS = cTS;
+  }
+
+  tangent.reuse = reuse;
 }
 
 };
@@ -34,6 +34,7 @@
 //
 //   svFSIplus XML_FILE_NAME
 //
+#include "Profiler.h"
 #include "Simulation.h"
 
 #include "all_fun.h"
@@ -45,6 +46,7 @@
 #include "initialize.h"
 #include "ls.h"
 #include "output.h"
+#include "partition_cost.h"
 #include "pic.h"
 #include "read_files.h"
 #include "read_msh.h"
@@ -69,6 +71,8 @@ void add_eq_linear_algebra(ComMod& com_mod, eqType& lEq)
 {
   lEq.linear_algebra = LinearAlgebraFactory::create_interface(lEq.linear_algebra_type);
   lEq.linear_algebra->set_preconditioner(lEq.linear_algebra_preconditioner);
+  lEq.linear_algebra->set_preconditioner_reuse(lEq.linear_algebra_preconditioner_reuse, 
+      lEq.linear_algebra_preconditioner_reuse_max_solves, lEq.linear_algebra_preconditioner_reuse_max_ratio);
   lEq.linear_algebra->initialize(com_mod, lEq);
 
   if (lEq.linear_algebra_assembly_type != consts::LinearAlgebraType::none) {
@@ -231,6 +235,8 @@ void iterate_solution(Simulation* simulation)
   dmsg << "cmmInit: " << com_mod.cmmInit;
   #endif
 
+  SV_PROFILE_REGION("iterate_solution");
+
   Array<double> Ag(tDof,tnNo); 
   Array<double> Yg(tDof,tnNo); 
   Array<double> Dg(tDof,tnNo); 
@@ -296,6 +302,8 @@ void iterate_solution(Simulation* simulation)
     dmsg << "========================================= " << std::endl;
     #endif
 
+    ProfileRegion time_step_region("time_step");
+
     // Adjusting the time step size once initialization stage is over
     //
     if (cTS == nITs) {
@@ -369,6 +377,8 @@ void iterate_solution(Simulation* simulation)
 
     // Looping over Newton iterations
     while (true) { 
+      SV_PROFILE_REGION("newton_iteration");
+
       #ifdef debug_iterate_solution
       dmsg << "---------- Inner Loop " + std::to_string(inner_count) << " -----------" << std::endl;
       dmsg << "cEq: " << cEq;
@@ -428,6 +438,11 @@ void iterate_solution(Simulation* simulation)
       ls_ns::ls_alloc(com_mod, eq);
       com_mod.Val.write("Val_alloc"+ istr);
 
+      // Set if only the residual is assembled and the tangent matrix of a 
+      // previous Newton iteration is reused.
+      //
+      ls_ns::ls_set_tangent_reuse(com_mod, eq);
+
       // Compute body forces. If phys is shells or CMM (init), apply
       // contribution from body forces (pressure) to residual
       //
@@ -447,7 +462,11 @@ void iterate_solution(Simulation* simulation)
       #endif
 
       for (int iM = 0; iM < com_mod.nMsh; iM++) {
+        double assembly_time = utils::cput();
         eq_assem::global_eq_assem(com_mod, cep_mod, com_mod.msh[iM], Ag, Yg, Dg);
+        if (com_mod.partCostFile != "" && !eq.tangent.reuse) {
+          partition_cost::add_assembly_time(com_mod, iM, utils::cput() - assembly_time);
+        }
       }
       com_mod.R.write("R_as"+ istr);
       com_mod.Val.write("Val_as"+ istr);
@@ -585,6 +604,19 @@ void iterate_solution(Simulation* simulation)
       dmsg << "Solving equation: " << eq.sym; 
       #endif
 
+      // The matrix-free linear solver applies the tangent matrix by
+      // reassembling the equation's element and boundary terms.
+      //
+      if (eq.matrixFree) {
+        eq.linear_algebra->set_assembly_function([&]() {
+          for (int iM = 0; iM < com_mod.nMsh; iM++) {
+            eq_assem::global_eq_assem(com_mod, cep_mod, com_mod.msh[iM], Ag, Yg, Dg);
+          }
+          set_bc::set_bc_neu(com_mod, cm_mod, Yg, Dg);
+          set_bc::set_bc_dir_w(com_mod, Yg, Dg);
+        });
+      }
+
       ls_ns::ls_solve(com_mod, eq, incL, res);
 
       com_mod.Val.write("Val_solve"+ istr);
@@ -744,6 +776,10 @@ void iterate_solution(Simulation* simulation)
       //CALL IB_OUTCPUT()
     }
 
+    // Write the profile of the time step.
+    time_step_region.stop();
+    Profiler::write_time_step(cTS);
+
     // Exiting outer loop if l1
     if (l1) {
       break;
@@ -765,6 +801,9 @@ void iterate_solution(Simulation* simulation)
   dmsg << "End of outer loop" << std::endl;
   #endif
 
+  // Wait for the restart and VTK files still being written in the background.
+  simulation->output_writer.flush();
+
   //#ifdef debug_iterate_solution
   //dmsg << "=======  Simulation Finished   ========== " << std::endl;
   //#endif
@@ -791,8 +830,11 @@ int main(int argc, char *argv[])
 
   // Initialize MPI.
   //
-  int mpi_rank, mpi_size;
-  MPI_Init(&argc, &argv);
+  // Only the main thread makes MPI calls, OpenMP threads and the 
+  // background output thread do not.
+  //
+  int mpi_rank, mpi_size, mpi_thread_level;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &mpi_thread_level);
   MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
   MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
   //std::cout << "[svFSI] MPI rank: " << mpi_rank << std::endl;
@@ -880,6 +922,14 @@ int main(int argc, char *argv[])
 
   }
 
+  // Save the measured assembly times for partitioning later runs.
+  if (simulation->com_mod.partCostFile != "") {
+    partition_cost::write_costs(simulation);
+  }
+
+  // Print the min/avg/max time spent in the profiled code regions.
+  simulation->logger << Profiler::report();
+
   MPI_Finalize();
 }
 
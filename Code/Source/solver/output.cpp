@@ -32,9 +32,13 @@
 // desined to interface with user.
 
 #include "output.h"
+#include "Profiler.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <math.h>
+#include <sstream>
 
 namespace output {
 
@@ -46,6 +50,8 @@ namespace output {
 //
 void output_result(Simulation* simulation,  std::array<double,3>& timeP, const int co, const int iEq)
 {
+  SV_PROFILE_REGION("output_result");
+
   #ifdef debug_output_result
   DebugMsg dmsg(__func__, com_mod.cm.idcm());
   dmsg.banner();
@@ -162,6 +168,16 @@ void output_result(Simulation* simulation,  std::array<double,3>& timeP, const i
   auto db_str = std::to_string(static_cast<int>(round(eq.FSILS.RI.dB)));
   auto calld_str = std::to_string(static_cast<int>(round(tmp)));
   sOut += "  " + c1 + std::to_string(eq.FSILS.RI.itr) + " " + db_str + " " + calld_str + c2;
+
+  // Relative tolerance of the linear solve set by the forcing term of an 
+  // inexact Newton iteration.
+  //
+  if (eq.FSILS.forcing.type != fsi_linear_solver::ForcingTermType::FORCING_NONE) {
+    char eta_str[20];
+    sprintf(eta_str, "%4.3e", eq.FSILS.forcing.eta);
+    sOut += "  eta " + std::string(eta_str);
+  }
+
   sOut += convergence_msg; 
 
   if (com_mod.nEq > 1) {
@@ -182,7 +198,7 @@ void output_result(Simulation* simulation,  std::array<double,3>& timeP, const i
   }
 }
 
-void read_restart_header(ComMod& com_mod, std::array<int,7>& tStamp, double& timeP, std::ifstream& restart_file)
+void read_restart_header(ComMod& com_mod, std::array<int,7>& tStamp, double& timeP, std::istream& restart_file)
 {
   auto& cTS = com_mod.cTS;
   auto& time = com_mod.time;
@@ -201,6 +217,8 @@ void read_restart_header(ComMod& com_mod, std::array<int,7>& tStamp, double& tim
 //
 void write_restart(Simulation* simulation, std::array<double,3>& timeP)
 {
+  SV_PROFILE_REGION("write_restart");
+
   auto& com_mod = simulation->com_mod;
   #define n_debug_write_restart
   #ifdef debug_write_restart
@@ -273,9 +291,27 @@ void write_restart(Simulation* simulation, std::array<double,3>& timeP)
     fName = stFileName + "_" + fName_num + ".bin";
   }
 
+  if (com_mod.stFileGlobal) {
+    write_restart_global(simulation, timeP, fName);
+
+    if (!com_mod.stFileRepl && cm.mas(cm_mod)) {
+      std::filesystem::remove(tmpS);
+      std::filesystem::create_hard_link(fName, tmpS);
+    }
+    return;
+  }
+
   // Create the file.
   //
-  if (cm.mas(cm_mod)) {
+  // A restart file that is overwritten may still be written by the background 
+  // output of the previous save on some processors.
+  //
+  if (com_mod.asyncOutput && com_mod.stFileRepl) {
+    simulation->output_writer.flush();
+    MPI_Barrier(cm.com());
+  }
+
+  if (cm.mas(cm_mod) && !com_mod.stFileCompress) {
     int np = cm.np();
     std::ofstream restart_file(fName, std::ios::out | std::ios::binary);
     char data{0};
@@ -288,9 +324,10 @@ void write_restart(Simulation* simulation, std::array<double,3>& timeP)
   // This call is to block all processors
   cm.bcast(cm_mod, &fid);
 
-  std::ofstream restart_file(fName, std::ios::out | std::ios::binary | std::ios::in);
-  std::streampos write_pos = (myID - 1) * recLn;
-  restart_file.seekp(write_pos);
+  // Copy the record of this processor into memory, it is written to the file
+  // by the output writer so the solution arrays can change meanwhile.
+  //
+  std::ostringstream restart_file(std::ios::out | std::ios::binary);
 
   write_restart_header(com_mod, timeP, restart_file);
   restart_file.write((char*)cplBC.xn.data(), cplBC.xn.msize());
@@ -348,17 +385,163 @@ void write_restart(Simulation* simulation, std::array<double,3>& timeP)
     }
   }
 
-  restart_file.close();
+  if (com_mod.stFileCompress) {
+    simulation->checkpoint.write(simulation, fName, tmpS, restart_file.str());
+    return;
+  }
+
+  std::streampos write_pos = (myID - 1) * recLn;
+  bool link_last = !com_mod.stFileRepl && cm.mas(cm_mod);
+
+  simulation->output_writer.submit([fName, tmpS, write_pos, link_last, record = restart_file.str()]() {
+    std::ofstream restart_file(fName, std::ios::out | std::ios::binary | std::ios::in);
+    restart_file.seekp(write_pos);
+    restart_file.write(record.data(), record.size());
+    restart_file.close();
+
+    // Create a hard link to the bin file for the last time step.
+    //
+    if (link_last) {
+      std::filesystem::remove(tmpS);
+      std::filesystem::create_hard_link(fName, tmpS);
+    }
+  });
+}
+
+/// @brief Returns the nodal arrays saved in a global node order restart file 
+/// as (data, rows) pairs, where column 'a' of each array holds the values 
+/// for node 'a'. 
+///
+/// The same arrays are used for writing (Yn, An, Dn) and reading (Yo, Ao, Do).
+//
+std::vector<std::pair<double*,int>> 
+restart_node_fields(Simulation* simulation, Array<double>& Y, Array<double>& A, Array<double>& D)
+{
+  auto& com_mod = simulation->com_mod;
+  auto& cep_mod = simulation->cep_mod;
+  std::vector<std::pair<double*,int>> fields;
+
+  fields.push_back({Y.data(), Y.nrows()});
+  fields.push_back({A.data(), A.nrows()});
+
+  if (com_mod.dFlag) {
+    fields.push_back({D.data(), D.nrows()});
+
+    if (com_mod.pstEq) {
+      fields.push_back({com_mod.pS0.data(), com_mod.pS0.nrows()});
+    }
 
-  // Create a soft link to the bin file for the last time step.
+    if (com_mod.sstEq) {
+      fields.push_back({com_mod.Ad.data(), com_mod.Ad.nrows()});
+    }
+  }
+
+  if (cep_mod.cepEq) {
+    fields.push_back({cep_mod.Xion.data(), cep_mod.Xion.nrows()});
+
+    if (com_mod.dFlag && cep_mod.cem.Ya.size() != 0) {
+      fields.push_back({cep_mod.cem.Ya.data(), 1});
+    }
+  }
+
+  return fields;
+}
+
+/// @brief Write a restart file with the nodal values stored in global node 
+/// order so it can be read with any number of processors and partitioning.
+///
+/// File layout
+///
+///   int magic, int version, int header length
+///   restart header (stamp, cTS, time, cpu time, eq.iNorm)
+///   int gtnNo, int number of values per node, cplBC.xn
+///   double values[gtnNo][number of values per node]
+///
+/// Each processor writes the nodes it owns in the linear solver using a 
+/// single collective MPI-IO write.
+//
+void write_restart_global(Simulation* simulation, std::array<double,3>& timeP, const std::string& fName)
+{
+  auto& com_mod = simulation->com_mod;
+  auto& cm_mod = simulation->cm_mod;
+  auto& cm = com_mod.cm;
+  auto& cplBC = com_mod.cplBC;
+  auto& lhs = com_mod.lhs;
+
+  auto fields = restart_node_fields(simulation, com_mod.Yn, com_mod.An, com_mod.Dn);
+  int nodeDof = 0;
+  for (auto& field : fields) {
+    nodeDof += field.second;
+  }
+
+  // Every processor builds the header to get its length but only the 
+  // master writes it.
   //
-  if (!com_mod.stFileRepl && cm.mas(cm_mod)) {
-    std::string cmd = "ln -f " + fName + " " + tmpS;
-    std::system(cmd.c_str());
+  std::ostringstream header(std::ios::out | std::ios::binary);
+  write_restart_header(com_mod, timeP, header);
+  header.write((char*)&com_mod.gtnNo, sizeof(int));
+  header.write((char*)&nodeDof, sizeof(int));
+  header.write((char*)cplBC.xn.data(), cplBC.xn.msize());
+
+  const int version = 1;
+  int header_length = 3*sizeof(int) + header.str().size();
+  std::string header_data;
+  header_data.append((char*)&global_restart_magic, sizeof(int));
+  header_data.append((char*)&version, sizeof(int));
+  header_data.append((char*)&header_length, sizeof(int));
+  header_data.append(header.str());
+
+  // Pack the owned nodes in increasing global node order, the order 
+  // required for an MPI file view.
+  //
+  std::vector<std::pair<int,int>> nodes;
+  for (int a = 0; a < com_mod.tnNo; a++) {
+    if (lhs.map(a) < lhs.mynNo) {
+      nodes.push_back({com_mod.ltg(a), a});
+    }
   }
+  std::sort(nodes.begin(), nodes.end());
+
+  int num_nodes = nodes.size();
+  std::vector<double> values(num_nodes * nodeDof);
+  std::vector<MPI_Aint> offsets(num_nodes);
+  int n = 0;
+
+  for (int i = 0; i < num_nodes; i++) {
+    int Ac = nodes[i].first;
+    int a = nodes[i].second;
+    offsets[i] = static_cast<MPI_Aint>(Ac) * nodeDof * sizeof(double);
+    for (auto& field : fields) {
+      for (int j = 0; j < field.second; j++, n++) {
+        values[n] = field.first[j + a*field.second];
+      }
+    }
+  }
+
+  MPI_Datatype file_type;
+  MPI_Type_create_hindexed_block(num_nodes, nodeDof, offsets.data(), MPI_DOUBLE, &file_type);
+  MPI_Type_commit(&file_type);
+
+  MPI_File file;
+  if (MPI_File_open(cm.com(), fName.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+    throw std::runtime_error("[write_restart] Unable to open the restart file '" + fName + "' for writing.");
+  }
+
+  MPI_Offset file_size = header_length + static_cast<MPI_Offset>(com_mod.gtnNo) * nodeDof * sizeof(double);
+  MPI_File_set_size(file, file_size);
+
+  if (cm.mas(cm_mod)) {
+    MPI_File_write_at(file, 0, header_data.data(), header_data.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+
+  MPI_File_set_view(file, header_length, MPI_DOUBLE, file_type, "native", MPI_INFO_NULL);
+  MPI_File_write_all(file, values.data(), values.size(), MPI_DOUBLE, MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+
+  MPI_Type_free(&file_type);
 }
 
-void write_restart_header(ComMod& com_mod, std::array<double,3>& timeP, std::ofstream& restart_file)
+void write_restart_header(ComMod& com_mod, std::array<double,3>& timeP, std::ostream& restart_file)
 {
   auto const cTS = com_mod.cTS;
   auto const time = com_mod.time;
@@ -40,11 +40,18 @@ namespace output {
 
 void output_result(Simulation* simulation,  std::array<double,3>& timeP, const int co, const int iEq);
 
-void read_restart_header(ComMod& com_mod, std::array<int,7>& tStamp, double& timeP, std::ifstream& restart_file);
+/// @brief Identifies a restart file written in global node order.
+const int global_restart_magic = 0x73764753;
+
+void read_restart_header(ComMod& com_mod, std::array<int,7>& tStamp, double& timeP, std::istream& restart_file);
+
+std::vector<std::pair<double*,int>> restart_node_fields(Simulation* simulation, Array<double>& Y, Array<double>& A, Array<double>& D);
 
 void write_restart(Simulation* simulation, std::array<double,3>& timeP);
 
-void write_restart_header(ComMod& com_mod, std::array<double,3>& timeP, std::ofstream& restart_file);
+void write_restart_global(Simulation* simulation, std::array<double,3>& timeP, const std::string& fName);
+
+void write_restart_header(ComMod& com_mod, std::array<double,3>& timeP, std::ostream& restart_file);
 
 void write_results(ComMod& com_mod, const std::array<double,3>& timeP, const std::string& fName, const bool sstEq);
 
@@ -0,0 +1,295 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// The functions here compute the element weights used by ParMETIS to
+// balance the assembly cost of meshes with several physics and element 
+// types across processors.
+
+#include "partition_cost.h"
+
+#include "consts.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace partition_cost {
+
+using namespace consts;
+
+/// @brief Assembly cost of one element quadrature point and node for each 
+/// physics relative to the fluid equation.
+//
+const std::map<EquationType, double> physics_cost = {
+  {EquationType::phys_CEP, 0.3},
+  {EquationType::phys_CMM, 1.0},
+  {EquationType::phys_FSI, 1.0},
+  {EquationType::phys_fluid, 1.0},
+  {EquationType::phys_heatF, 0.4},
+  {EquationType::phys_heatS, 0.3},
+  {EquationType::phys_lElas, 0.5},
+  {EquationType::phys_mesh, 0.5},
+  {EquationType::phys_shell, 1.5},
+  {EquationType::phys_stokes, 0.6},
+  {EquationType::phys_struct, 1.5},
+  {EquationType::phys_ustruct, 2.0}
+};
+
+/// @brief Return the domain of equation 'eq' containing element 'e' of 
+/// mesh 'lM', or nullptr if the equation is not solved on the element.
+//
+const dmnType* element_domain(const eqType& eq, const mshType& lM, const int e)
+{
+  if (eq.nDmn == 1 || lM.eId.size() == 0) {
+    return &eq.dmn[0];
+  }
+
+  for (int iDmn = 0; iDmn < eq.nDmn; iDmn++) {
+    if (utils::btest(lM.eId(e), eq.dmn[iDmn].Id)) {
+      return &eq.dmn[iDmn];
+    }
+  }
+
+  return nullptr;
+}
+
+/// @brief Model cost of assembling element 'e' of mesh 'lM' for equation 
+/// 'eq': the product of the equation's <Partition_cost>, the cost of the 
+/// domain physics and the number of element nodes and quadrature points.
+///
+/// The physics of the element is returned in 'phys'.
+//
+double model_cost(const eqType& eq, const mshType& lM, const int e, EquationType& phys)
+{
+  auto dmn = element_domain(eq, lM, e);
+
+  if (dmn == nullptr || physics_cost.count(dmn->phys) == 0) {
+    return 0.0;
+  }
+
+  phys = dmn->phys;
+  return eq.partitionCost * physics_cost.at(phys) * lM.eNoN * lM.nG;
+}
+
+/// @brief Accumulate the time 'time' spent assembling the current equation 
+/// on mesh 'iM', used to calibrate the cost model.
+///
+/// Only assemblies of the tangent matrix and residual are timed, not the 
+/// residual only assemblies when the tangent matrix is reused.
+//
+void add_assembly_time(ComMod& com_mod, const int iM, const double time)
+{
+  if (com_mod.asmTime.size() == 0) {
+    com_mod.asmTime.resize(com_mod.nEq, com_mod.nMsh);
+    com_mod.asmCount.resize(com_mod.nEq, com_mod.nMsh);
+  }
+
+  com_mod.asmTime(com_mod.cEq, iM) += time;
+  com_mod.asmCount(com_mod.cEq, iM) += 1.0;
+}
+
+/// @brief Read the calibration of the cost model measured by a previous run.
+///
+/// Each line of the file is: physics name, seconds per unit of model cost.
+//
+std::map<EquationType, double> read_costs(const std::string& file_name)
+{
+  std::map<EquationType, double> costs;
+  std::ifstream file(file_name);
+  std::string line;
+
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream line_stream(line);
+    std::string phys_name;
+    double cost;
+
+    if ((line_stream >> phys_name >> cost) && equation_name_to_type.count(phys_name) != 0 && cost > 0.0) {
+      costs[equation_name_to_type.at(phys_name)] = cost;
+    }
+  }
+
+  return costs;
+}
+
+/// @brief Compute the 'ncon' ParMETIS weights of the elements of mesh 'lM' 
+/// on the master, in the order the elements were read.
+///
+/// The first weight is the assembly cost of the element summed over the 
+/// equations, given by model_cost(). If a previous run measured the 
+/// assembly time per unit of model cost of a physics, the model cost of 
+/// its elements is scaled by it; physics that were not measured use the 
+/// mean of the measured scale factors.
+///
+/// A second weight of one per element balances the number of elements, 
+/// used as an estimate of the linear solver cost.
+//
+Array<int> element_weights(Simulation* simulation, const mshType& lM, const int ncon)
+{
+  auto& com_mod = simulation->com_mod;
+  const int gnEl = lM.gnEl;
+
+  std::map<EquationType, double> measured_costs;
+  if (com_mod.partCostFile != "") {
+    measured_costs = read_costs(com_mod.partCostFile);
+  }
+
+  double mean_scale = 1.0;
+  if (measured_costs.size() != 0) {
+    mean_scale = 0.0;
+    for (auto& [phys, value] : measured_costs) {
+      mean_scale += value / measured_costs.size();
+    }
+  }
+
+  std::vector<double> cost(gnEl, 0.0);
+
+  for (int iEq = 0; iEq < com_mod.nEq; iEq++) {
+    auto& eq = com_mod.eq[iEq];
+
+    for (int e = 0; e < gnEl; e++) {
+      EquationType phys = EquationType::phys_NA;
+      double value = model_cost(eq, lM, e, phys);
+
+      if (value > 0.0) {
+        auto it = measured_costs.find(phys);
+        cost[e] += value * (it != measured_costs.end() ? it->second : mean_scale);
+      }
+    }
+  }
+
+  // Scale the costs to integers with a mean of about 10, limiting the sum
+  // of the weights to the range of a ParMETIS index.
+  //
+  double mean = 0.0;
+  for (auto value : cost) {
+    mean += value / gnEl;
+  }
+
+  double scale = std::min(10.0, 1.0e9 / gnEl);
+  Array<int> weights(ncon, gnEl);
+
+  for (int e = 0; e < gnEl; e++) {
+    int weight = 1;
+    if (mean > 0.0) {
+      weight = std::max(1, static_cast<int>(std::round(scale * cost[e] / mean)));
+    }
+    weights(0,e) = weight;
+
+    for (int i = 1; i < ncon; i++) {
+      weights(i,e) = 1;
+    }
+  }
+
+  return weights;
+}
+
+/// @brief Write the assembly time per unit of model cost of each physics 
+/// measured over all processors, read by element_weights() in later runs.
+///
+/// The time of each equation and mesh is split between the physics of the
+/// assembled elements in proportion to their model cost.
+//
+void write_costs(Simulation* simulation)
+{
+  auto& com_mod = simulation->com_mod;
+  auto& cm_mod = simulation->cm_mod;
+  auto& cm = com_mod.cm;
+
+  const int num_phys = physics_cost.size();
+  std::map<EquationType, int> phys_index;
+  int num_index = 0;
+  for (auto& [phys, value] : physics_cost) {
+    phys_index[phys] = num_index++;
+  }
+
+  Vector<double> phys_time(num_phys);
+  Vector<double> phys_units(num_phys);
+
+  for (int iEq = 0; iEq < com_mod.asmTime.nrows(); iEq++) {
+    auto& eq = com_mod.eq[iEq];
+
+    for (int iM = 0; iM < com_mod.nMsh; iM++) {
+      if (com_mod.asmCount(iEq,iM) == 0.0) {
+        continue;
+      }
+
+      auto& lM = com_mod.msh[iM];
+      Vector<double> units(num_phys);
+      double total_units = 0.0;
+
+      for (int e = 0; e < lM.nEl; e++) {
+        EquationType phys = EquationType::phys_NA;
+        double value = model_cost(eq, lM, e, phys);
+        if (value > 0.0) {
+          units(phys_index[phys]) += value;
+          total_units += value;
+        }
+      }
+
+      if (total_units == 0.0) {
+        continue;
+      }
+
+      for (int i = 0; i < num_phys; i++) {
+        phys_time(i) += com_mod.asmTime(iEq,iM) * units(i) / total_units;
+        phys_units(i) += com_mod.asmCount(iEq,iM) * units(i);
+      }
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, phys_time.data(), num_phys, cm_mod::mpreal, MPI_SUM, cm.com());
+  MPI_Allreduce(MPI_IN_PLACE, phys_units.data(), num_phys, cm_mod::mpreal, MPI_SUM, cm.com());
+
+  if (!cm.mas(cm_mod)) {
+    return;
+  }
+
+  std::ofstream file(com_mod.partCostFile);
+  file << "# physics seconds_per_model_cost" << std::endl;
+  file << std::scientific;
+
+  for (auto& [name, phys] : equation_name_to_type) {
+    auto it = phys_index.find(phys);
+    if (it == phys_index.end() || phys_units(it->second) == 0.0) {
+      continue;
+    }
+    file << name << " " << phys_time(it->second) / phys_units(it->second) << std::endl;
+    phys_index.erase(it);
+  }
+}
+
+};
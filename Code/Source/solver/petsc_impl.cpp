@@ -197,6 +197,9 @@ void petsc_create_linearsolver(const consts::SolverType lsType, const consts::Pr
             KSPSetType(psol[cEq].ksp, KSPGMRES);
 //            KSPGMRESSetRestart(psol[cEq].ksp, *kSpace);
             break;
+        case SolverType::lSolver_PGMRES:
+            KSPSetType(psol[cEq].ksp, KSPPGMRES);
+            break;
         case SolverType::lSolver_BICGS:
             KSPSetType(psol[cEq].ksp, KSPBCGS);
             break;
@@ -268,8 +271,8 @@ void petsc_set_values(const PetscInt dof, const PetscInt iEq, const PetscReal *R
     /* Set values in A &b, apply Dir and Lumped parameter BC */
     PetscLogStagePush(stages[3]);
     petsc_set_vec(dof, cEq, R);
-    petsc_set_mat(dof, cEq, Val);
-    petsc_set_bc(cEq, svFSI_DirBC, svFSI_lpBC);
+    petsc_set_mat(dof, cEq, Val, svFSI_lpBC);
+    petsc_set_bc(cEq, svFSI_DirBC);
     PetscLogStagePop();
 
     /* Scale A and b if RCS preconditioner is activated. */
@@ -292,7 +295,7 @@ void petsc_solve(PetscReal *resNorm,  PetscReal *initNorm,  PetscReal *dB,
     PetscInt   i, j, na;
     // PetscInt   cEq = *iEq - 1;
     PetscInt   cEq = iEq;   // in Fortran, cEq = 1; in C++, cEq = 0;
-    PetscBool  usepreonly;
+    PetscBool  usepreonly, matset, pmatset;
     KSPType    ksptype;
     Vec        lx, res;
     KSPConvergedReason reason;
@@ -302,7 +305,16 @@ void petsc_solve(PetscReal *resNorm,  PetscReal *initNorm,  PetscReal *dB,
     na = maxIter;
     PetscMalloc1(na, &a);
     PetscTime(&ts);
-    KSPSetOperators(psol[cEq].ksp, psol[cEq].A, psol[cEq].A);
+
+    /* 
+        The operators are only attached once. A keeps its nonzero pattern 
+        between assemblies, so KSPSetUp() only redoes the numeric part of 
+        the preconditioner setup (SAME_NONZERO_PATTERN).
+    */
+    KSPGetOperatorsSet(psol[cEq].ksp, &matset, &pmatset);
+    if (!matset || !pmatset) {
+        KSPSetOperators(psol[cEq].ksp, psol[cEq].A, psol[cEq].A);
+    }
 
     /* Calculate residual for direct solver. KSP uses preconditioned norm. */
     PetscObjectTypeCompare((PetscObject)psol[cEq].ksp, KSPPREONLY, &usepreonly);
@@ -376,6 +388,7 @@ void petsc_destroy_all(const PetscInt nEq)
 
         plhs.nNo     = 0;
         plhs.mynNo   = 0;
+        plhs.nnz     = 0;
         plhs.created = PETSC_FALSE;
 
         PetscFree (plhs.map);
@@ -399,6 +412,9 @@ void petsc_destroy_all(const PetscInt nEq)
             psol[cEq].DirPts = 0;
             PetscFree (psol[cEq].DirBC);
 
+            psol[cEq].ncoo = 0;
+            PetscFree(psol[cEq].cooVal);
+
             VecDestroy(&psol[cEq].b);
             MatDestroy(&psol[cEq].A);
             KSPDestroy(&psol[cEq].ksp);
@@ -446,6 +462,7 @@ PetscErrorCode petsc_create_lhs(const PetscInt nNo, const PetscInt mynNo, const
 
     plhs.nNo     = nNo;
     plhs.mynNo   = mynNo;
+    plhs.nnz     = nnz;
     plhs.created = PETSC_TRUE;
 
     /* Fortran index to C index (NOT apply for svFSIplus) */ 
@@ -585,12 +602,19 @@ PetscErrorCode petsc_create_bc(const PetscInt dof, const PetscInt cEq, \
 
 /*
     Create and preallocate parallel PETSC vector and matrix data structure.
+
+    The nonzero pattern of A is handed to PETSc once in COO format. The 
+    entries are ordered like the svFSI Val array, i.e. block j = rowPtr(i) 
+    ... of row i followed by its dof*dof row-major entries, so that Val can
+    be passed to MatSetValuesCOO() without any reordering. The entries of 
+    the lumped parameter BC are appended at the end. Entries of rows owned
+    by another process are summed by PETSc.
 */
 PetscErrorCode petsc_create_vecmat(const PetscInt dof, const PetscInt cEq, const PetscInt nEq)
 {   
-    PetscInt   i, j, is, ie, row, col;
-    Mat        preallocator;
-    PetscReal *value;
+    PetscInt   i, j, r, c, is, ie, row, col, nsd;
+    PetscCount k, nblk;
+    PetscInt  *coo_i, *coo_j;
     PC         pc;
     PetscBool  usefieldsplit, useamg;
 
@@ -601,38 +625,43 @@ PetscErrorCode petsc_create_vecmat(const PetscInt dof, const PetscInt cEq, const
     if (nEq > 1) PetscCall(VecSetOptionsPrefix(psol[cEq].b, psol[cEq].pre));
     PetscCall(VecSetFromOptions(psol[cEq].b));
 
-
-    /*
-        Preallocate psol.A with the help of MATPREALLOCATOR.
-        Internally MatPreallocatorPreallocate() will call MatSetOption(A, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_TRUE);
-    */
-    PetscCall(MatCreate(MPI_COMM_WORLD, &preallocator));
-    PetscCall(MatSetType(preallocator, MATPREALLOCATOR));
-    PetscCall(MatSetSizes(preallocator, plhs.mynNo*dof, plhs.mynNo*dof, PETSC_DECIDE, PETSC_DECIDE));
-    PetscCall(MatSetBlockSize(preallocator, dof));
-    PetscCall(MatSetUp(preallocator));
-    PetscCall(PetscMalloc1(dof*dof, &value));
-    for (i = 0; i < dof*dof; i++) value[i] = 0.0;
+    /* Build the COO index set of A from the svFSI adjacency info. */
+    nsd  = dof*dof;
+    nblk = (PetscCount)plhs.nnz*nsd;
+    psol[cEq].ncoo = nblk + (PetscCount)psol[cEq].lpPts*psol[cEq].lpPts;
+    PetscCall(PetscMalloc2(psol[cEq].ncoo, &coo_i, psol[cEq].ncoo, &coo_j));
     /* Internal points */
     for (i = 0; i < plhs.nNo; i++) {
         is  = plhs.rowPtr[i*2];
         ie  = plhs.rowPtr[i*2+1];
-        row = plhs.ltg[i];
+        row = plhs.ltg[i]*dof;
         for (j = is; j < ie; j++) {
-            col = plhs.colPtr[j];
-            PetscCall(MatSetValuesBlocked(preallocator, 1, &row, 1, &col, value, INSERT_VALUES));
+            col = plhs.colPtr[j]*dof;
+            k   = (PetscCount)j*nsd;
+            for (r = 0; r < dof; r++) {
+                for (c = 0; c < dof; c++) {
+                    coo_i[k] = row + r;
+                    coo_j[k] = col + c;
+                    k++;
+                }
+            }
         }
     }
     /* Points with lumped parameter BC */
+    k = nblk;
     for (i = 0; i < psol[cEq].lpPts; i++){
-        row = psol[cEq].lpBC_g[i];
         for (j = 0; j < psol[cEq].lpPts; j++){
-            col = psol[cEq].lpBC_g[j];
-            PetscCall(MatSetValue(preallocator, row, col, 0.0, INSERT_VALUES));
+            coo_i[k] = psol[cEq].lpBC_g[i];
+            coo_j[k] = psol[cEq].lpBC_g[j];
+            k++;
         }
     }
-    PetscCall(MatAssemblyBegin(preallocator, MAT_FINAL_ASSEMBLY));
-    PetscCall(MatAssemblyEnd(preallocator, MAT_FINAL_ASSEMBLY));
+
+    /* Values are only staged when the lumped parameter BC entries have to be appended to Val. */
+    psol[cEq].cooVal = NULL;
+    if (psol[cEq].lpPts > 0) {
+        PetscCall(PetscMalloc1(psol[cEq].ncoo, &psol[cEq].cooVal));
+    }
 
     /* Create and preallocate matrix structure */
     KSPGetPC(psol[cEq].ksp, &pc);
@@ -649,7 +678,14 @@ PetscErrorCode petsc_create_vecmat(const PetscInt dof, const PetscInt cEq, const
     PetscCall(MatSetFromOptions(psol[cEq].A));
     PetscCall(MatSetSizes(psol[cEq].A, plhs.mynNo*dof, plhs.mynNo*dof, PETSC_DECIDE, PETSC_DECIDE));
     PetscCall(MatSetBlockSize(psol[cEq].A, dof));
-    PetscCall(MatPreallocatorPreallocate(preallocator, PETSC_TRUE, psol[cEq].A));
+    PetscCall(MatSetPreallocationCOO(psol[cEq].A, psol[cEq].ncoo, coo_i, coo_j));
+
+    /* 
+        Dirichlet BC zero rows and columns of A in place. Keep the pattern so 
+        that the COO map stays valid and the preconditioner setup can reuse 
+        its symbolic phase.
+    */
+    PetscCall(MatSetOption(psol[cEq].A, MAT_KEEP_NONZERO_PATTERN, PETSC_TRUE));
     PetscCall(MatSetOption(psol[cEq].A, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE));
     PetscCall(MatSetOption(psol[cEq].A, MAT_NEW_NONZERO_LOCATIONS, PETSC_FALSE));
 
@@ -659,8 +695,7 @@ PetscErrorCode petsc_create_vecmat(const PetscInt dof, const PetscInt cEq, const
         PetscCall(VecDuplicate(psol[cEq].b, &psol[cEq].Dc));
     }
 
-    PetscCall(PetscFree(value));
-    PetscCall(MatDestroy(&preallocator));
+    PetscCall(PetscFree2(coo_i, coo_j));
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
@@ -698,58 +733,48 @@ PetscErrorCode petsc_set_vec(const PetscInt dof, const PetscInt cEq, const Petsc
 
 /*
     Set values to the matrix.
+
+    Val is copied into A in a single MatSetValuesCOO() call. INSERT_VALUES 
+    replaces all values of A, so there is no need to zero A beforehand.
+    The lumped parameter BC augments A with the entries lpBC[i]*lpBC[j].
 */
-PetscErrorCode petsc_set_mat(const PetscInt dof, const PetscInt cEq, const PetscReal *Val)
+PetscErrorCode petsc_set_mat(const PetscInt dof, const PetscInt cEq, const PetscReal *Val, 
+                             const PetscReal *lpBC)
 {   
-    PetscInt   i, j, is, ie; 
-    PetscInt  *col, *row;
-    const PetscScalar *value;
+    PetscInt   i, j, ii, jj;
+    PetscCount k, nblk;
 
     PetscFunctionBeginUser;
 
-    PetscCall(MatZeroEntries(psol[cEq].A));
-    for (i = 0; i < plhs.nNo; i++) {
-        is    = plhs.rowPtr[i*2];
-        ie    = plhs.rowPtr[i*2+1];
-        row   = plhs.ltg+i;
-        for (j = is; j < ie; j++){
-            value = Val + j*dof*dof;
-            col   = plhs.colPtr + j;
-            PetscCall(MatSetValuesBlocked(psol[cEq].A, 1, row, 1, col, value, ADD_VALUES));  
+    if (psol[cEq].lpPts == 0) {
+        PetscCall(MatSetValuesCOO(psol[cEq].A, Val, INSERT_VALUES));
+        PetscFunctionReturn(PETSC_SUCCESS);
+    }
+
+    nblk = (PetscCount)plhs.nnz*dof*dof;
+    PetscCall(PetscArraycpy(psol[cEq].cooVal, Val, nblk));
+    k = nblk;
+    for (i = 0; i < psol[cEq].lpPts; i++){
+        ii = psol[cEq].lpBC_l[i];
+        for (j = 0; j < psol[cEq].lpPts; j++){
+            jj = psol[cEq].lpBC_l[j];
+            psol[cEq].cooVal[k++] = lpBC[ii] * lpBC[jj];
         }
-        
     }
-    PetscCall(MatAssemblyBegin(psol[cEq].A, MAT_FLUSH_ASSEMBLY));
-    PetscCall(MatAssemblyEnd(psol[cEq].A, MAT_FLUSH_ASSEMBLY));
+    PetscCall(MatSetValuesCOO(psol[cEq].A, psol[cEq].cooVal, INSERT_VALUES));
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
 
 /*
-    Set up Dirichlet BC and resistance BC.
+    Set up Dirichlet BC.
 */
-PetscErrorCode petsc_set_bc(const PetscInt cEq, const PetscReal *DirBC, const PetscReal *lpBC)
+PetscErrorCode petsc_set_bc(const PetscInt cEq, const PetscReal *DirBC)
 {   
     Vec x;
-    PetscInt  i, j, ii, jj, row, col;
-    PetscReal value;
 
     PetscFunctionBeginUser;
 
-    /* Apply lumped parameter BC by augmenting the matrix A. */
-    for (i = 0; i < psol[cEq].lpPts; i++){
-        ii  = psol[cEq].lpBC_l[i];
-        row = psol[cEq].lpBC_g[i];
-        for (j = 0; j < psol[cEq].lpPts; j++){
-            jj  = psol[cEq].lpBC_l[j];
-            col = psol[cEq].lpBC_g[j];
-            value = lpBC[ii] * lpBC[jj];
-            PetscCall(MatSetValue(psol[cEq].A, row, col, value, ADD_VALUES));
-        }
-    }
-    PetscCall(MatAssemblyBegin(psol[cEq].A, MAT_FINAL_ASSEMBLY));
-    PetscCall(MatAssemblyEnd(psol[cEq].A, MAT_FINAL_ASSEMBLY));
-
     /*
         Apply Dirichlet BC by resetting matrix A and rhs b.
         Since the BC remains the same, the matrix will retain the same nonzero structure
@@ -50,6 +50,7 @@ typedef struct {
 
     PetscInt  nNo;      /* local number of vertices */
     PetscInt  mynNo;    /* number of owned vertices */
+    PetscInt  nnz;      /* number of nonzero blocks */
 
     PetscInt *map;      /* local to local mapping, map[O2] = O1 */
     PetscInt *ltg;      /* local to global in PETSc ordering */
@@ -74,6 +75,9 @@ typedef struct {
     PetscInt  DirPts;   /* number of dofs with Dirichlet BC */
     PetscInt *DirBC;    /* PETSc index for dofs with Dirichlet BC */
 
+    PetscCount ncoo;    /* number of COO entries of A (blocks + lumped parameter BC) */
+    PetscScalar *cooVal;/* COO values when lumped parameter BC entries are appended */
+
     Vec       b;        /* rhs/solution vector of owned vertices */
     Mat       A;        /* stiffness matrix */
     KSP       ksp;      /* linear solver context */
@@ -117,9 +121,9 @@ PetscErrorCode petsc_create_vecmat(const PetscInt, const PetscInt, const PetscIn
 
 PetscErrorCode petsc_set_vec(const PetscInt, const PetscInt, const PetscReal *);
 
-PetscErrorCode petsc_set_mat(const PetscInt, const PetscInt, const PetscReal *);
+PetscErrorCode petsc_set_mat(const PetscInt, const PetscInt, const PetscReal *, const PetscReal *);
 
-PetscErrorCode petsc_set_bc(const PetscInt, const PetscReal *, const PetscReal *);
+PetscErrorCode petsc_set_bc(const PetscInt, const PetscReal *);
 
 PetscErrorCode petsc_set_pcfieldsplit(const PetscInt, const PetscInt);
 
@@ -40,6 +40,7 @@
 
 #include "pic.h"
 
+#include "Profiler.h"
 #include "Simulation.h"
 #include "all_fun.h"
 #include "cep_ion.h"
@@ -73,6 +74,8 @@ namespace pic {
 //
 void picc(Simulation* simulation)
 {
+  SV_PROFILE_REGION("picc");
+
   using namespace consts;
 
   auto& com_mod = simulation->com_mod;
@@ -485,6 +488,8 @@ void pic_eth(Simulation* simulation)
 //
 void pici(Simulation* simulation, Array<double>& Ag, Array<double>& Yg, Array<double>& Dg)
 {
+  SV_PROFILE_REGION("pici");
+
   using namespace consts;
 
   auto& com_mod = simulation->com_mod;
@@ -590,6 +595,8 @@ void pici(Simulation* simulation, Array<double>& Ag, Array<double>& Yg, Array<do
 //
 void picp(Simulation* simulation)
 {
+  SV_PROFILE_REGION("picp");
+
   using namespace consts;
 
   auto& com_mod = simulation->com_mod;
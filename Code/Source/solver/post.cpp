@@ -1195,6 +1195,9 @@ void ppbin2vtk(Simulation* simulation)
     }
   }
 
+  // Wait for the VTK files still being written in the background.
+  simulation->output_writer.flush();
+
   finalize(simulation);
   
   MPI_Finalize();
@@ -1362,6 +1362,22 @@ void read_eq(Simulation* simulation, EquationParameters* eq_params, eqType& lEq)
   lEq.minItr = eq_params->min_iterations.value();
   lEq.maxItr = eq_params->max_iterations.value();
   lEq.tol = eq_params->tolerance.value();
+  lEq.partitionCost = eq_params->partition_cost.value();
+
+  if (lEq.partitionCost < 0.0) {
+    throw std::runtime_error("[svFSIplus] <Partition_cost> must be zero or greater.");
+  }
+
+  // Set the reuse of the tangent matrix between Newton iterations.
+  //
+  lEq.tangent.iterations = eq_params->tangent_update_iterations.value();
+  lEq.tangent.time_steps = eq_params->tangent_update_time_steps.value();
+  lEq.tangent.residual_ratio = eq_params->tangent_update_residual_ratio.value();
+
+  if ((lEq.tangent.iterations < 0) || (lEq.tangent.time_steps < 1) || (lEq.tangent.residual_ratio < 0.0)) {
+    throw std::runtime_error("[svFSIplus] <Tangent_update_iterations> must be zero or greater, <Tangent_update_time_steps> " 
+        "greater than zero and <Tangent_update_residual_ratio> zero or greater.");
+  }
 
   // Initialize coupled BC.
   //
@@ -1990,6 +2006,7 @@ void read_ls(Simulation* simulation, EquationParameters* eq_params, consts::Solv
   static std::map<SolverType,LinearSolverType> solver_to_ls_map = {
     {SolverType::lSolver_NS, LinearSolverType::LS_TYPE_NS},
     {SolverType::lSolver_GMRES, LinearSolverType::LS_TYPE_GMRES},
+    {SolverType::lSolver_PGMRES, LinearSolverType::LS_TYPE_PGMRES},
     {SolverType::lSolver_CG, LinearSolverType::LS_TYPE_CG},
     {SolverType::lSolver_BICGS, LinearSolverType::LS_TYPE_BICGS},
   };
@@ -2049,11 +2066,181 @@ void read_ls(Simulation* simulation, EquationParameters* eq_params, consts::Solv
   lEq.linear_algebra_preconditioner = consts::preconditioner_name_to_type.at(linear_algebra.preconditioner());
   lEq.linear_algebra_assembly_type = LinearAlgebra::name_to_type.at(linear_algebra.assembly()); 
 
+  // Set the preconditioner reuse policy, only supported by Trilinos. 
+  //
+  lEq.linear_algebra_preconditioner_reuse = consts::preconditioner_reuse_name_to_type.at(linear_algebra.preconditioner_reuse());
+  lEq.linear_algebra_preconditioner_reuse_max_solves = linear_algebra.preconditioner_reuse_max_solves();
+  lEq.linear_algebra_preconditioner_reuse_max_ratio = linear_algebra.preconditioner_reuse_max_iteration_ratio();
+
+  if (lEq.linear_algebra_preconditioner_reuse != consts::PreconditionerReuseType::PREC_REUSE_NONE) {
+    if (lEq.linear_algebra_type != LinearAlgebraType::trilinos) {
+      throw std::runtime_error("[svFSIplus] The <Preconditioner_reuse> option is only supported for trilinos linear algebra.");
+    }
+
+    if (lEq.linear_algebra_preconditioner_reuse_max_solves < 1) {
+      throw std::runtime_error("[svFSIplus] <Preconditioner_reuse_max_solves> must be greater than zero.");
+    }
+
+    if (lEq.linear_algebra_preconditioner_reuse_max_ratio < 1.0) {
+      throw std::runtime_error("[svFSIplus] <Preconditioner_reuse_max_iteration_ratio> must be one or greater.");
+    }
+  }
+
   // Check that equation physics is compatible with the LinearAlgebra type. 
   for (auto& domain : lEq.dmn) {
     LinearAlgebra::check_equation_compatibility(domain.phys,  lEq.linear_algebra_type, lEq.linear_algebra_assembly_type);
   }
 
+  // Check that the matrix-free option is supported. The tangent matrix is 
+  // applied by reassembling the equation so only fluid and Stokes equations
+  // solved with fsils GMRES and its diagonal preconditioner are supported.
+  //
+  lEq.matrixFree = eq_params->linear_solver.matrix_free.value();
+
+  if (lEq.matrixFree) {
+    if ((lEq.phys != EquationType::phys_fluid) && (lEq.phys != EquationType::phys_stokes)) {
+      throw std::runtime_error("[svFSIplus] The <Matrix_free> linear solver option is only supported for fluid and stokes equations.");
+    }
+
+    if (lEq.linear_algebra_type != LinearAlgebraType::fsils) {
+      throw std::runtime_error("[svFSIplus] The <Matrix_free> linear solver option requires fsils linear algebra.");
+    }
+
+    if ((solver_type != SolverType::lSolver_GMRES) && (solver_type != SolverType::lSolver_PGMRES)) {
+      throw std::runtime_error("[svFSIplus] The <Matrix_free> linear solver option requires a GMRES linear solver.");
+    }
+
+    if (lEq.linear_algebra_preconditioner != PreconditionerType::PREC_FSILS) {
+      throw std::runtime_error("[svFSIplus] The <Matrix_free> linear solver option requires the fsils preconditioner.");
+    }
+  }
+
+  // The kept tangent matrix is the fsils assembled Val so the tangent matrix 
+  // can't be reused with Trilinos assembly or the matrix-free solver. The 
+  // ustruct equation keeps its own tangent blocks between iterations.
+  //
+  if (lEq.tangent.enabled()) {
+    if (lEq.linear_algebra_assembly_type == LinearAlgebraType::trilinos) {
+      throw std::runtime_error("[svFSIplus] The tangent matrix can't be reused with trilinos assembly.");
+    }
+
+    if (lEq.matrixFree) {
+      throw std::runtime_error("[svFSIplus] The tangent matrix can't be reused with the <Matrix_free> linear solver option.");
+    }
+
+    if ((lEq.phys == EquationType::phys_ustruct) || (lEq.phys == EquationType::phys_FSI)) {
+      throw std::runtime_error("[svFSIplus] The tangent matrix can't be reused for ustruct and FSI equations.");
+    }
+  }
+
+  if ((solver_type == SolverType::lSolver_PGMRES) && (lEq.linear_algebra_type == LinearAlgebraType::trilinos)) {
+    throw std::runtime_error("[svFSIplus] The pipelined GMRES linear solver is not supported for Trilinos linear algebra.");
+  }
+
+  // Set the fsils AMG preconditioner options.
+  //
+  if (lEq.linear_algebra_preconditioner == PreconditionerType::PREC_FSILS_AMG) {
+    if ((solver_type != SolverType::lSolver_CG) && (solver_type != SolverType::lSolver_GMRES) && 
+        (solver_type != SolverType::lSolver_NS)) {
+      throw std::runtime_error("[svFSIplus] The fsils-amg preconditioner can only be used with the CG, GMRES and NS linear solvers.");
+    }
+
+    auto& ls_params = eq_params->linear_solver;
+    auto smoother = ls_params.amg_smoother.value();
+    std::transform(smoother.begin(), smoother.end(), smoother.begin(), ::tolower);
+
+    if (smoother == "jacobi") {
+      lEq.FSILS.amg.smoother = fsi_linear_solver::AmgSmootherType::AMG_SMOOTHER_JACOBI;
+    } else if (smoother == "chebyshev") {
+      lEq.FSILS.amg.smoother = fsi_linear_solver::AmgSmootherType::AMG_SMOOTHER_CHEBYSHEV;
+    } else {
+      throw std::runtime_error("[svFSIplus] Unknown <AMG_smoother> '" + ls_params.amg_smoother.value() + 
+          "', must be 'Jacobi' or 'Chebyshev'.");
+    }
+
+    lEq.FSILS.amg.sweeps = ls_params.amg_smoother_sweeps.value();
+    lEq.FSILS.amg.max_levels = ls_params.amg_max_levels.value();
+    lEq.FSILS.amg.coarse_size = ls_params.amg_coarse_size.value();
+    lEq.FSILS.amg.theta = ls_params.amg_strength_threshold.value();
+
+    if ((lEq.FSILS.amg.sweeps < 1) || (lEq.FSILS.amg.max_levels < 1)) {
+      throw std::runtime_error("[svFSIplus] <AMG_smoother_sweeps> and <AMG_max_levels> must be greater than zero.");
+    }
+  }
+
+  // Set the fsils ILU preconditioner options.
+  //
+  if (lEq.linear_algebra_preconditioner == PreconditionerType::PREC_FSILS_ILU) {
+    if (solver_type != SolverType::lSolver_GMRES) {
+      throw std::runtime_error("[svFSIplus] The fsils-ilu preconditioner can only be used with the GMRES linear solver.");
+    }
+
+    lEq.FSILS.ilu_fill = eq_params->linear_solver.ilu_fill_level.value();
+
+    if (lEq.FSILS.ilu_fill < 0) {
+      throw std::runtime_error("[svFSIplus] <ILU_fill_level> must be zero or greater.");
+    }
+  }
+
+  // Set the options for reusing previous solves: the projection of the 
+  // initial guess onto previous solutions and Krylov subspace recycling.
+  //
+  lEq.FSILS.proj_size = eq_params->linear_solver.initial_guess_basis_size.value();
+  lEq.FSILS.recycle_size = eq_params->linear_solver.recycle_space_size.value();
+
+  if ((lEq.FSILS.proj_size < 0) || (lEq.FSILS.recycle_size < 0)) {
+    throw std::runtime_error("[svFSIplus] <Initial_guess_basis_size> and <Recycle_space_size> must be zero or greater.");
+  }
+
+  if ((lEq.FSILS.proj_size > 0) || (lEq.FSILS.recycle_size > 0)) {
+    if (lEq.linear_algebra_type != LinearAlgebraType::fsils) {
+      throw std::runtime_error("[svFSIplus] <Initial_guess_basis_size> and <Recycle_space_size> require fsils linear algebra.");
+    }
+  }
+
+  if (lEq.FSILS.recycle_size > 0) {
+    if (solver_type != SolverType::lSolver_GMRES) {
+      throw std::runtime_error("[svFSIplus] <Recycle_space_size> can only be used with the GMRES linear solver.");
+    }
+
+    if ((lEq.linear_algebra_preconditioner != PreconditionerType::PREC_FSILS) && 
+        (lEq.linear_algebra_preconditioner != PreconditionerType::PREC_RCS)) {
+      throw std::runtime_error("[svFSIplus] <Recycle_space_size> can only be used with the fsils or rcs preconditioners.");
+    }
+  }
+
+  // Set the forcing term used to choose the relative tolerance of the 
+  // linear solve of each Newton iteration (inexact Newton).
+  //
+  auto forcing_type = eq_params->linear_solver.forcing_term.value();
+  std::transform(forcing_type.begin(), forcing_type.end(), forcing_type.begin(), ::tolower);
+
+  if (forcing_type == "none") {
+    lEq.FSILS.forcing.type = fsi_linear_solver::ForcingTermType::FORCING_NONE;
+  } else if ((forcing_type == "ew1") || (forcing_type == "eisenstat_walker_1")) {
+    lEq.FSILS.forcing.type = fsi_linear_solver::ForcingTermType::FORCING_EW1;
+  } else if ((forcing_type == "ew2") || (forcing_type == "eisenstat_walker_2")) {
+    lEq.FSILS.forcing.type = fsi_linear_solver::ForcingTermType::FORCING_EW2;
+  } else {
+    throw std::runtime_error("[svFSIplus] Unknown <Forcing_term> '" + eq_params->linear_solver.forcing_term.value() + 
+        "', must be 'none', 'EW1' or 'EW2'.");
+  }
+
+  lEq.FSILS.forcing.eta0 = eq_params->linear_solver.forcing_term_initial.value();
+  lEq.FSILS.forcing.eta_max = eq_params->linear_solver.forcing_term_max.value();
+
+  if (lEq.FSILS.forcing.type != fsi_linear_solver::ForcingTermType::FORCING_NONE) {
+    if (lEq.linear_algebra_type != LinearAlgebraType::fsils) {
+      throw std::runtime_error("[svFSIplus] <Forcing_term> requires fsils linear algebra.");
+    }
+
+    auto& forcing = lEq.FSILS.forcing;
+
+    if ((forcing.eta0 <= 0.0) || (forcing.eta0 >= 1.0) || (forcing.eta_max <= 0.0) || (forcing.eta_max >= 1.0)) {
+      throw std::runtime_error("[svFSIplus] <Forcing_term_initial> and <Forcing_term_max> must be between 0 and 1.");
+    }
+  }
+
   if (!solver_type_defined) {
     return;
   } 
@@ -2088,6 +2275,7 @@ void read_ls(Simulation* simulation, EquationParameters* eq_params, consts::Solv
     lEq.FSILS.CG.absTol = lEq.FSILS.RI.absTol;
 
     lEq.FSILS.GM.sD = lEq.FSILS.RI.sD;
+    lEq.FSILS.GM.pipelined = linear_solver.ns_gm_pipelined.value();
   } 
 
   #ifdef debug_read_ls
@@ -1123,6 +1123,8 @@ void read_msh(Simulation* simulation)
       mesh.lShl = param->set_mesh_as_shell();
       mesh.lFib = param->set_mesh_as_fibers();
       mesh.scF = param->mesh_scale_factor();
+      mesh.cacheGeo = param->cache_element_geometry();
+      mesh.cacheGeoSize = param->element_geometry_cache_size();
       #ifdef debug_read_msh 
       dmsg << "Mesh name: " << mesh.name;
       dmsg << "  mesh.lShl: " << mesh.lShl;
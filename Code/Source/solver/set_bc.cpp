@@ -30,6 +30,7 @@
 
 #include "set_bc.h"
 
+#include "Profiler.h"
 #include "all_fun.h"
 #include "cmm.h"
 #include "consts.h"
@@ -588,6 +589,8 @@ void rcr_init(ComMod& com_mod, const CmMod& cm_mod)
 //
 void set_bc_cmm(ComMod& com_mod, const CmMod& cm_mod, const Array<double>& Ag, const Array<double>& Dg ) 
 {
+  SV_PROFILE_REGION("set_bc_cmm");
+
   using namespace consts;
 
   int cEq = com_mod.cEq;
@@ -673,6 +676,8 @@ void set_bc_cmm_l(ComMod& com_mod, const CmMod& cm_mod, const faceType& lFa, con
 //
 void set_bc_cpl(ComMod& com_mod, CmMod& cm_mod)
 {
+  SV_PROFILE_REGION("set_bc_cpl");
+
   static double absTol = 1.E-8, relTol = 1.E-5;
 
   using namespace consts;
@@ -791,6 +796,8 @@ void set_bc_cpl(ComMod& com_mod, CmMod& cm_mod)
 //
 void set_bc_dir(ComMod& com_mod, Array<double>& lA, Array<double>& lY, Array<double>& lD)
 {
+  SV_PROFILE_REGION("set_bc_dir");
+
   using namespace consts;
 
   #define n_set_bc_dir
@@ -1064,6 +1071,8 @@ void set_bc_dir_l(ComMod& com_mod, const bcType& lBc, const faceType& lFa, Array
 //
 void set_bc_dir_w(ComMod& com_mod, const Array<double>& Yg, const Array<double>& Dg)
 {
+  SV_PROFILE_REGION("set_bc_dir_w");
+
   using namespace consts;
 
   const int cEq = com_mod.cEq;
@@ -1313,6 +1322,8 @@ void set_bc_dir_wl(ComMod& com_mod, const bcType& lBc, const mshType& lM, const
 //
 void set_bc_neu(ComMod& com_mod, const CmMod& cm_mod, const Array<double>& Yg, const Array<double>& Dg)
 {
+  SV_PROFILE_REGION("set_bc_neu");
+
   using namespace consts;
 
   #define n_debug_set_bc_neu
@@ -1800,6 +1811,8 @@ void set_bc_trac_l(ComMod& com_mod, const CmMod& cm_mod, const bcType& lBc, cons
 //
 void set_bc_undef_neu(ComMod& com_mod)
 {
+  SV_PROFILE_REGION("set_bc_undef_neu");
+
   using namespace consts;
 
   const int cEq = com_mod.cEq;
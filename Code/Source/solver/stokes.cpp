@@ -226,7 +226,7 @@ void construct_stokes(ComMod& com_mod, const mshType& lM, const Array<double>& A
 
     } // g: loop
 
-    eq.linear_algebra->assemble(com_mod, eNoN, ptr, lK, lR);
+    eq.linear_algebra->assemble(com_mod, lM, e, ptr, lK, lR);
 
   } // e: loop
 
@@ -330,6 +330,10 @@ void stokes_2d_c(ComMod& com_mod, const int lStab, const int eNoNw, const int eN
     lR(2,a) = lR(2,a) + w*(Nq(a)*div + tauM*rM);
   }
 
+  if (eq.tangent.reuse) {
+    return;
+  }
+
   // Tangent (stiffness) matrices
   //
   wm = wm * tauM;
@@ -442,6 +446,10 @@ void stokes_2d_m(ComMod& com_mod, const int eNoNw, const int eNoNq, const double
     lR(1,a) = lR(1,a) + w*(Nw(a)*vd(1) + rM);
   }
 
+  if (eq.tangent.reuse) {
+    return;
+  }
+
   // Tangent (stiffness) matrices
   for (int b = 0; b < eNoNw; b++) {
     for (int a = 0; a < eNoNw; a++) {
@@ -552,6 +560,10 @@ void stokes_3d_c(ComMod& com_mod, const int lStab, const int eNoNw, const int eN
     lR(3,a) = lR(3,a) + w*(Nq(a)*div + tauM*rM);
   }
 
+  if (eq.tangent.reuse) {
+    return;
+  }
+
   // Tangent (stiffness) matrices
   //
   wm = wm * tauM;
@@ -689,6 +701,10 @@ void stokes_3d_m(ComMod& com_mod, const int eNoNw, const int eNoNq, const double
     lR(2,a) = lR(2,a) + w*(Nw(a)*vd(2) + rM);
   }
 
+  if (eq.tangent.reuse) {
+    return;
+  }
+
   // Tangent (stiffness) matrices
   //
   for (int b = 0; b < eNoNw; b++) {
@@ -37,7 +37,10 @@
 
 #include "all_fun.h"
 #include "consts.h"
+#include "elem_color.h"
+#include "elem_geo.h"
 #include "lhsa.h"
+#include "NodeArray.h"
 #include "mat_fun.h"
 #include "mat_models.h"
 #include "nn.h"
@@ -224,7 +227,7 @@ void construct_dsolid(ComMod& com_mod, CepMod& cep_mod, const mshType& lM, const
   const int dof = com_mod.dof;
   const int cEq = com_mod.cEq;
   const auto& eq = com_mod.eq[cEq];
-  auto cDmn = com_mod.cDmn;
+  auto& cDmn = com_mod.cDmn;
   const int nsymd = com_mod.nsymd;
   auto& pS0 = com_mod.pS0;
   auto& pSn = com_mod.pSn;
@@ -245,117 +248,156 @@ void construct_dsolid(ComMod& com_mod, CepMod& cep_mod, const mshType& lM, const
   dmsg << "lM.nG: " << lM.nG;
   #endif
 
-  // STRUCT: dof = nsd
-
-  Vector<int> ptr(eNoN);
-  Vector<double> pSl(nsymd), ya_l(eNoN), N(eNoN);
-  Array<double> xl(nsd,eNoN), al(tDof,eNoN), yl(tDof,eNoN), dl(tDof,eNoN), 
-                bfl(nsd,eNoN), fN(nsd,nFn), pS0l(nsymd,eNoN), Nx(nsd,eNoN), lR(dof,eNoN);
-  Array3<double> lK(dof*dof,eNoN,eNoN);
-
-  // Loop over all elements of mesh
-
-  for (int e = 0; e < lM.nEl; e++) {
-    // Update domain and proceed if domain phys and eqn phys match
-    cDmn = all_fun::domain(com_mod, lM, cEq, e);
-    auto cPhys = eq.dmn[cDmn].phys;
-    if (cPhys != EquationType::phys_struct) {
-      continue; 
-    }
-
-    // Update shape functions for NURBS
-    if (lM.eType == ElementType::NRB) {
-      //CALL NRBNNX(lM, e)
-    }
-
-    // Create local copies
-    fN  = 0.0;
-    pS0l = 0.0;
-    ya_l = 0.0;
-
-    for (int a = 0; a < eNoN; a++) {
-      int Ac = lM.IEN(a,e);
-      ptr(a) = Ac;
-
-      for (int i = 0; i < nsd; i++) {
-        xl(i,a) = com_mod.x(i,Ac);
-        bfl(i,a) = com_mod.Bf(i,Ac);
-      }
-
-      for (int i = 0; i < tDof; i++) {
-        al(i,a) = Ag(i,Ac);
-        dl(i,a) = Dg(i,Ac);
-        yl(i,a) = Yg(i,Ac);
+  // Get the order elements are integrated in. When using threads elements
+  // are ordered by color so that the elements assembled concurrently never
+  // share a global row.
+  //
+  const bool threaded = elem_color::use_threads(com_mod, lM, eq);
+  Vector<int> elems;
+  std::vector<elem_color::ElemBatch> batches;
+  elem_color::get_batches(com_mod, lM, cEq, threaded, elems, batches);
+  std::exception_ptr error;
+
+  // Select the element kernel specialized for the mesh element type.
+  auto kernel = struct_3d_kernel(lM);
+
+  #pragma omp parallel if(threaded)
+  {
+    // STRUCT: dof = nsd
+
+    Vector<int> ptr(eNoN);
+    Vector<double> pSl(nsymd), ya_l(eNoN), N(eNoN);
+    Array<double> xl(nsd,eNoN), al(tDof,eNoN), yl(tDof,eNoN), dl(tDof,eNoN), 
+                  bfl(nsd,eNoN), fN(nsd,nFn), pS0l(nsymd,eNoN), Nx(nsd,eNoN), lR(dof,eNoN);
+    Array3<double> lK(dof*dof,eNoN,eNoN);
+
+    // Loop over all elements of mesh
+    //
+    for (const auto& batch : batches) {
+      // Proceed if domain phys and eqn phys match
+      if (eq.dmn[batch.dmn].phys != EquationType::phys_struct) {
+        continue;
       }
 
-      if (lM.fN.size() != 0) {
-        for (int iFn = 0; iFn < nFn; iFn++) {
-          for (int i = 0; i < nsd; i++) {
-            fN(i,iFn) = lM.fN(i+nsd*iFn,e);
-          }
-        }
-      }
+      #pragma omp single
+      cDmn = batch.dmn;
 
-      if (pS0.size() != 0) { 
-        pS0l.set_col(a, pS0.col(Ac));
-      }
+      #pragma omp for schedule(dynamic,64)
+      for (int ie = batch.start; ie < batch.end; ie++) {
+        int e = elems(ie);
 
-      if (cem.cpld) {
-        ya_l(a) = cem.Ya(Ac);
-      }
-    }
+        try {
+          // Update shape functions for NURBS
+          if (lM.eType == ElementType::NRB) {
+            //CALL NRBNNX(lM, e)
+          }
 
-    // Gauss integration
-    //
-    lR = 0.0;
-    lK = 0.0;
-
-    double Jac{0.0};
-    Array<double> ksix(nsd,nsd);
-
-    for (int g = 0; g < lM.nG; g++) {
-      if (g == 0 || !lM.lShpF) {
-        auto Nx_g = lM.Nx.slice(g);
-        nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-          throw std::runtime_error("[construct_dsolid] Jacobian for element " + std::to_string(e) + " is < 0.");
-        }
-      }
-      double w = lM.w(g) * Jac;
-      N = lM.N.col(g);
-      pSl = 0.0;
+          // Create local copies
+          fN  = 0.0;
+          pS0l = 0.0;
+          ya_l = 0.0;
+
+          for (int a = 0; a < eNoN; a++) {
+            int Ac = lM.IEN(a,e);
+            ptr(a) = Ac;
+
+            for (int i = 0; i < nsd; i++) {
+              xl(i,a) = com_mod.x(i,Ac);
+              bfl(i,a) = com_mod.Bf(i,Ac);
+            }
+
+            for (int i = 0; i < tDof; i++) {
+              al(i,a) = Ag(i,Ac);
+              dl(i,a) = Dg(i,Ac);
+              yl(i,a) = Yg(i,Ac);
+            }
+
+            if (lM.fN.size() != 0) {
+              for (int iFn = 0; iFn < nFn; iFn++) {
+                for (int i = 0; i < nsd; i++) {
+                  fN(i,iFn) = lM.fN(i+nsd*iFn,e);
+                }
+              }
+            }
+
+            if (pS0.size() != 0) { 
+              pS0l.set_col(a, pS0.col(Ac));
+            }
+
+            if (cem.cpld) {
+              ya_l(a) = cem.Ya(Ac);
+            }
+          }
 
-      if (nsd == 3) {
-        struct_3d(com_mod, cep_mod, eNoN, nFn, w, N, Nx, al, yl, dl, bfl, fN, pS0l, pSl, ya_l, lR, lK);
+          // Gauss integration
+          //
+          lR = 0.0;
+          lK = 0.0;
+
+          double Jac{0.0};
+          Array<double> ksix(nsd,nsd);
+
+          for (int g = 0; g < lM.nG; g++) {
+            if (g == 0 || !lM.lShpF) {
+              if (lM.geo.valid()) {
+                elem_geo::get_geo(lM.geo, e, g, Nx, Jac, ksix);
+              } else {
+                auto Nx_g = lM.Nx.slice(g);
+                nn::gnn(eNoN, nsd, nsd, Nx_g, xl, Nx, Jac, ksix);
+                if (utils::is_zero(Jac)) {
+                  throw std::runtime_error("[construct_dsolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+                }
+              }
+            }
+            double w = lM.w(g) * Jac;
+            N = lM.N.col(g);
+            pSl = 0.0;
+
+            if (nsd == 3) {
+              kernel(com_mod, cep_mod, eNoN, nFn, w, N, Nx, al, yl, dl, bfl, fN, pS0l, pSl, ya_l, lR, lK);
 
 #if 0
-        if (e == 0 && g == 0) {
-          Array3<double>::write_enabled = true;
-          Array<double>::write_enabled = true;
-          lR.write("lR");
-          lK.write("lK");
-          exit(0);
-        }
+              if (e == 0 && g == 0) {
+                Array3<double>::write_enabled = true;
+                Array<double>::write_enabled = true;
+                lR.write("lR");
+                lK.write("lK");
+                exit(0);
+              }
 #endif
 
-      } else if (nsd == 2) {
-        struct_2d(com_mod, cep_mod, eNoN, nFn, w, N, Nx, al, yl, dl, bfl, fN, pS0l, pSl, ya_l, lR, lK);
-      }
-
-      // Prestress
-      if (pstEq) {
-        for (int a = 0; a < eNoN; a++) {
-          int Ac = ptr(a);
-          pSa(Ac) = pSa(Ac) + w*N(a);
-          for (int i = 0; i < pSn.nrows(); i++) {
-            pSn(i,Ac) = pSn(i,Ac) + w*N(a)*pSl(i);
+            } else if (nsd == 2) {
+              struct_2d(com_mod, cep_mod, eNoN, nFn, w, N, Nx, al, yl, dl, bfl, fN, pS0l, pSl, ya_l, lR, lK);
+            }
+
+            // Prestress
+            if (pstEq) {
+              for (int a = 0; a < eNoN; a++) {
+                int Ac = ptr(a);
+                pSa(Ac) = pSa(Ac) + w*N(a);
+                for (int i = 0; i < pSn.nrows(); i++) {
+                  pSn(i,Ac) = pSn(i,Ac) + w*N(a)*pSl(i);
+                }
+              }
+            }
+          } 
+
+          eq.linear_algebra->assemble(com_mod, lM, e, ptr, lK, lR);
+        } catch (...) {
+          #pragma omp critical
+          {
+            if (!error) {
+              error = std::current_exception();
+            }
           }
         }
-      }
-    } 
+      } // e: loop
+    } // batch: loop
+  } // omp parallel
 
-    eq.linear_algebra->assemble(com_mod, eNoN, ptr, lK, lR);
-  } 
+  if (error) {
+    std::rethrow_exception(error);
+  }
 }
 
 /// @brief Reproduces Fortran 'STRUCT2D' subroutine.
@@ -546,11 +588,18 @@ void struct_2d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
 }
 
 /// @brief Reproduces Fortran 'STRUCT3D' subroutine.
-void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn, const double w, 
+///
+/// The template parameter is the number of nodes of a specialized element 
+/// type, or 0 to use the 'eNoN_in' value.
+//
+template <int eNoN_t>
+void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN_in, const int nFn, const double w, 
     const Vector<double>& N, const Array<double>& Nx, const Array<double>& al, const Array<double>& yl, 
     const Array<double>& dl, const Array<double>& bfl, const Array<double>& fN, const Array<double>& pS0l, 
     Vector<double>& pSl, const Vector<double>& ya_l, Array<double>& lR, Array3<double>& lK) 
 {
+  const int eNoN = (eNoN_t > 0) ? eNoN_t : eNoN_in;
+
   using namespace consts;
   using namespace mat_fun;
   // std::cout << "\n==================== struct_3d ===============" << std::endl;
@@ -574,9 +623,9 @@ void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
   //
   double rho = dmn.prop.at(PhysicalProperyType::solid_density);
   double dmp = dmn.prop.at(PhysicalProperyType::damping);
-  Vector<double> fb({dmn.prop.at(PhysicalProperyType::f_x), 
-                     dmn.prop.at(PhysicalProperyType::f_y), 
-                     dmn.prop.at(PhysicalProperyType::f_z)});
+  const double fb[3] = {dmn.prop.at(PhysicalProperyType::f_x), 
+                        dmn.prop.at(PhysicalProperyType::f_y), 
+                        dmn.prop.at(PhysicalProperyType::f_z)};
 
   double afu = eq.af * eq.beta*dt*dt;
   double afv = eq.af * eq.gam*dt;
@@ -597,14 +646,16 @@ void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
   // Inertia, body force and deformation tensor (F)
   //
   Array<double> F(3,3), S0(3,3), vx(3,3);
-  Vector<double> ud(3);
+  double ud[3];
 
   double F_f[3][3]={}; 
   F_f[0][0] = 1.0;
   F_f[1][1] = 1.0;
   F_f[2][2] = 1.0;
 
-  ud = -rho*fb;
+  ud[0] = -rho*fb[0];
+  ud[1] = -rho*fb[1];
+  ud[2] = -rho*fb[2];
   F = 0.0;
   F(0,0) = 1.0;
   F(1,1) = 1.0;
@@ -613,9 +664,9 @@ void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
   double ya_g = 0.0;
 
   for (int a = 0; a < eNoN; a++) {
-    ud(0) = ud(0) + N(a)*(rho*(al(i,a)-bfl(0,a)) + dmp*yl(i,a));
-    ud(1) = ud(1) + N(a)*(rho*(al(j,a)-bfl(1,a)) + dmp*yl(j,a));
-    ud(2) = ud(2) + N(a)*(rho*(al(k,a)-bfl(2,a)) + dmp*yl(k,a));
+    ud[0] = ud[0] + N(a)*(rho*(al(i,a)-bfl(0,a)) + dmp*yl(i,a));
+    ud[1] = ud[1] + N(a)*(rho*(al(j,a)-bfl(1,a)) + dmp*yl(j,a));
+    ud[2] = ud[2] + N(a)*(rho*(al(k,a)-bfl(2,a)) + dmp*yl(k,a));
 
     vx(0,0) = vx(0,0) + Nx(0,a)*yl(i,a);
     vx(0,1) = vx(0,1) + Nx(1,a)*yl(i,a);
@@ -690,51 +741,62 @@ void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
   // 1st Piola-Kirchhoff tensor (P)
   //
   Array<double> P(3,3);
-  Array3<double> Bm(6,3,eNoN); 
+  NodeArray<eNoN_t,6,3> Bm(eNoN);
   mat_fun::mat_mul(F, S, P);
 
   // Local residual
   for (int a = 0; a < eNoN; a++) {
-    lR(0,a) = lR(0,a) + w*(N(a)*ud(0) + Nx(0,a)*P(0,0) + Nx(1,a)*P(0,1) + Nx(2,a)*P(0,2));
-    lR(1,a) = lR(1,a) + w*(N(a)*ud(1) + Nx(0,a)*P(1,0) + Nx(1,a)*P(1,1) + Nx(2,a)*P(1,2));
-    lR(2,a) = lR(2,a) + w*(N(a)*ud(2) + Nx(0,a)*P(2,0) + Nx(1,a)*P(2,1) + Nx(2,a)*P(2,2));
+    lR(0,a) = lR(0,a) + w*(N(a)*ud[0] + Nx(0,a)*P(0,0) + Nx(1,a)*P(0,1) + Nx(2,a)*P(0,2));
+    lR(1,a) = lR(1,a) + w*(N(a)*ud[1] + Nx(0,a)*P(1,0) + Nx(1,a)*P(1,1) + Nx(2,a)*P(1,2));
+    lR(2,a) = lR(2,a) + w*(N(a)*ud[2] + Nx(0,a)*P(2,0) + Nx(1,a)*P(2,1) + Nx(2,a)*P(2,2));
   }
 
   // Auxilary quantities for computing stiffness tensor
   //
   for (int a = 0; a < eNoN; a++) {
-    Bm(0,0,a) = Nx(0,a)*F(0,0);
-    Bm(0,1,a) = Nx(0,a)*F(1,0);
-    Bm(0,2,a) = Nx(0,a)*F(2,0);
+    Bm[0][0][a] = Nx(0,a)*F(0,0);
+    Bm[0][1][a] = Nx(0,a)*F(1,0);
+    Bm[0][2][a] = Nx(0,a)*F(2,0);
 
-    Bm(1,0,a) = Nx(1,a)*F(0,1);
-    Bm(1,1,a) = Nx(1,a)*F(1,1);
-    Bm(1,2,a) = Nx(1,a)*F(2,1);
+    Bm[1][0][a] = Nx(1,a)*F(0,1);
+    Bm[1][1][a] = Nx(1,a)*F(1,1);
+    Bm[1][2][a] = Nx(1,a)*F(2,1);
 
-    Bm(2,0,a) = Nx(2,a)*F(0,2);
-    Bm(2,1,a) = Nx(2,a)*F(1,2);
-    Bm(2,2,a) = Nx(2,a)*F(2,2);
+    Bm[2][0][a] = Nx(2,a)*F(0,2);
+    Bm[2][1][a] = Nx(2,a)*F(1,2);
+    Bm[2][2][a] = Nx(2,a)*F(2,2);
 
-    Bm(3,0,a) = (Nx(0,a)*F(0,1) + F(0,0)*Nx(1,a));
-    Bm(3,1,a) = (Nx(0,a)*F(1,1) + F(1,0)*Nx(1,a));
-    Bm(3,2,a) = (Nx(0,a)*F(2,1) + F(2,0)*Nx(1,a));
+    Bm[3][0][a] = (Nx(0,a)*F(0,1) + F(0,0)*Nx(1,a));
+    Bm[3][1][a] = (Nx(0,a)*F(1,1) + F(1,0)*Nx(1,a));
+    Bm[3][2][a] = (Nx(0,a)*F(2,1) + F(2,0)*Nx(1,a));
 
-    Bm(4,0,a) = (Nx(1,a)*F(0,2) + F(0,1)*Nx(2,a));
-    Bm(4,1,a) = (Nx(1,a)*F(1,2) + F(1,1)*Nx(2,a));
-    Bm(4,2,a) = (Nx(1,a)*F(2,2) + F(2,1)*Nx(2,a));
+    Bm[4][0][a] = (Nx(1,a)*F(0,2) + F(0,1)*Nx(2,a));
+    Bm[4][1][a] = (Nx(1,a)*F(1,2) + F(1,1)*Nx(2,a));
+    Bm[4][2][a] = (Nx(1,a)*F(2,2) + F(2,1)*Nx(2,a));
 
-    Bm(5,0,a) = (Nx(2,a)*F(0,0) + F(0,2)*Nx(0,a));
-    Bm(5,1,a) = (Nx(2,a)*F(1,0) + F(1,2)*Nx(0,a));
-    Bm(5,2,a) = (Nx(2,a)*F(2,0) + F(2,2)*Nx(0,a));
+    Bm[5][0][a] = (Nx(2,a)*F(0,0) + F(0,2)*Nx(0,a));
+    Bm[5][1][a] = (Nx(2,a)*F(1,0) + F(1,2)*Nx(0,a));
+    Bm[5][2][a] = (Nx(2,a)*F(2,0) + F(2,2)*Nx(0,a));
   }
 
   // Local stiffness tensor
   double NxSNx, T1, NxNx, BmDBm, Tv;
 
-  Array<double> DBm(6,3);
+  double DBm[6][3];
 
   for (int b = 0; b < eNoN; b++) {
 
+    // Material Stiffness (D*B) for node b
+    for (int ii = 0; ii < 6; ii++) {
+      for (int jj = 0; jj < 3; jj++) {
+        double sum = 0.0;
+        for (int kk = 0; kk < 6; kk++) {
+          sum += Dm(ii,kk) * Bm[kk][jj][b];
+        }
+        DBm[ii][jj] = sum;
+      }
+    }
+
     for (int a = 0; a < eNoN; a++) {
 
       // Geometric stiffness
@@ -746,84 +808,110 @@ void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
 
       T1 = amd*N(a)*N(b) + afu*NxSNx;
 
-      // Material Stiffness (Bt*D*B)
-      mat_mul(Dm, Bm.rslice(b), DBm);
-
       // dM1/du1
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,0,a)*DBm(0,0) + Bm(1,0,a)*DBm(1,0) +
-              Bm(2,0,a)*DBm(2,0) + Bm(3,0,a)*DBm(3,0) +
-              Bm(4,0,a)*DBm(4,0) + Bm(5,0,a)*DBm(5,0);
+      BmDBm = Bm[0][0][a]*DBm[0][0] + Bm[1][0][a]*DBm[1][0] +
+              Bm[2][0][a]*DBm[2][0] + Bm[3][0][a]*DBm[3][0] +
+              Bm[4][0][a]*DBm[4][0] + Bm[5][0][a]*DBm[5][0];
 
       lK(0,a,b) = lK(0,a,b) + w*( T1 + afu*(BmDBm + Kvis_u(0,a,b)) + afv*Kvis_v(0,a,b) );
 
       // dM1/du2
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,0,a)*DBm(0,1) + Bm(1,0,a)*DBm(1,1) +
-              Bm(2,0,a)*DBm(2,1) + Bm(3,0,a)*DBm(3,1) +
-              Bm(4,0,a)*DBm(4,1) + Bm(5,0,a)*DBm(5,1);
+      BmDBm = Bm[0][0][a]*DBm[0][1] + Bm[1][0][a]*DBm[1][1] +
+              Bm[2][0][a]*DBm[2][1] + Bm[3][0][a]*DBm[3][1] +
+              Bm[4][0][a]*DBm[4][1] + Bm[5][0][a]*DBm[5][1];
 
 
       lK(1,a,b) = lK(1,a,b) + w*( afu*(BmDBm + Kvis_u(1,a,b)) + afv*(Kvis_v(1,a,b)) );
 
       // dM1/du3
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,0,a)*DBm(0,2) + Bm(1,0,a)*DBm(1,2) +
-              Bm(2,0,a)*DBm(2,2) + Bm(3,0,a)*DBm(3,2) +
-              Bm(4,0,a)*DBm(4,2) + Bm(5,0,a)*DBm(5,2);
+      BmDBm = Bm[0][0][a]*DBm[0][2] + Bm[1][0][a]*DBm[1][2] +
+              Bm[2][0][a]*DBm[2][2] + Bm[3][0][a]*DBm[3][2] +
+              Bm[4][0][a]*DBm[4][2] + Bm[5][0][a]*DBm[5][2];
 
       lK(2,a,b) = lK(2,a,b) + w*( afu*(BmDBm + Kvis_u(2,a,b)) + afv*Kvis_v(2,a,b) );
 
       // dM2/du1
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,1,a)*DBm(0,0) + Bm(1,1,a)*DBm(1,0) +
-              Bm(2,1,a)*DBm(2,0) + Bm(3,1,a)*DBm(3,0) +
-              Bm(4,1,a)*DBm(4,0) + Bm(5,1,a)*DBm(5,0);
+      BmDBm = Bm[0][1][a]*DBm[0][0] + Bm[1][1][a]*DBm[1][0] +
+              Bm[2][1][a]*DBm[2][0] + Bm[3][1][a]*DBm[3][0] +
+              Bm[4][1][a]*DBm[4][0] + Bm[5][1][a]*DBm[5][0];
 
       lK(dof+0,a,b) = lK(dof+0,a,b) + w*( afu*(BmDBm + Kvis_u(3,a,b)) + afv*Kvis_v(3,a,b) );
 
       // dM2/du2
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,1,a)*DBm(0,1) + Bm(1,1,a)*DBm(1,1) +
-              Bm(2,1,a)*DBm(2,1) + Bm(3,1,a)*DBm(3,1) +
-              Bm(4,1,a)*DBm(4,1) + Bm(5,1,a)*DBm(5,1);
+      BmDBm = Bm[0][1][a]*DBm[0][1] + Bm[1][1][a]*DBm[1][1] +
+              Bm[2][1][a]*DBm[2][1] + Bm[3][1][a]*DBm[3][1] +
+              Bm[4][1][a]*DBm[4][1] + Bm[5][1][a]*DBm[5][1];
 
       lK(dof+1,a,b) = lK(dof+1,a,b) + w*(T1 + afu*(BmDBm + Kvis_u(4,a,b)) + afv*Kvis_v(4,a,b) );
 
       // dM2/du3
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,1,a)*DBm(0,2) + Bm(1,1,a)*DBm(1,2) +
-              Bm(2,1,a)*DBm(2,2) + Bm(3,1,a)*DBm(3,2) +
-              Bm(4,1,a)*DBm(4,2) + Bm(5,1,a)*DBm(5,2);
+      BmDBm = Bm[0][1][a]*DBm[0][2] + Bm[1][1][a]*DBm[1][2] +
+              Bm[2][1][a]*DBm[2][2] + Bm[3][1][a]*DBm[3][2] +
+              Bm[4][1][a]*DBm[4][2] + Bm[5][1][a]*DBm[5][2];
 
       lK(dof+2,a,b) = lK(dof+2,a,b) + w*( afu*(BmDBm + Kvis_u(5,a,b)) + afv*Kvis_v(5,a,b) );
 
       // dM3/du1
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,2,a)*DBm(0,0) + Bm(1,2,a)*DBm(1,0) +
-              Bm(2,2,a)*DBm(2,0) + Bm(3,2,a)*DBm(3,0) +
-              Bm(4,2,a)*DBm(4,0) + Bm(5,2,a)*DBm(5,0);
+      BmDBm = Bm[0][2][a]*DBm[0][0] + Bm[1][2][a]*DBm[1][0] +
+              Bm[2][2][a]*DBm[2][0] + Bm[3][2][a]*DBm[3][0] +
+              Bm[4][2][a]*DBm[4][0] + Bm[5][2][a]*DBm[5][0];
 
       lK(2*dof+0,a,b) = lK(2*dof+0,a,b) + w*( afu*(BmDBm + Kvis_u(6,a,b)) + afv*Kvis_v(6,a,b) );
 
       // dM3/du2
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,2,a)*DBm(0,1) + Bm(1,2,a)*DBm(1,1) +
-              Bm(2,2,a)*DBm(2,1) + Bm(3,2,a)*DBm(3,1) +
-              Bm(4,2,a)*DBm(4,1) + Bm(5,2,a)*DBm(5,1);
+      BmDBm = Bm[0][2][a]*DBm[0][1] + Bm[1][2][a]*DBm[1][1] +
+              Bm[2][2][a]*DBm[2][1] + Bm[3][2][a]*DBm[3][1] +
+              Bm[4][2][a]*DBm[4][1] + Bm[5][2][a]*DBm[5][1];
 
      lK(2*dof+1,a,b) = lK(2*dof+1,a,b) + w*( afu*(BmDBm + Kvis_u(7,a,b)) + afv*Kvis_v(7,a,b) );
 
       // dM3/du3
       // Material stiffness: Bt*D*B
-      BmDBm = Bm(0,2,a)*DBm(0,2) + Bm(1,2,a)*DBm(1,2) +
-              Bm(2,2,a)*DBm(2,2) + Bm(3,2,a)*DBm(3,2) +
-              Bm(4,2,a)*DBm(4,2) + Bm(5,2,a)*DBm(5,2);
+      BmDBm = Bm[0][2][a]*DBm[0][2] + Bm[1][2][a]*DBm[1][2] +
+              Bm[2][2][a]*DBm[2][2] + Bm[3][2][a]*DBm[3][2] +
+              Bm[4][2][a]*DBm[4][2] + Bm[5][2][a]*DBm[5][2];
 
       lK(2*dof+2,a,b) = lK(2*dof+2,a,b) + w*( T1 + afu*(BmDBm + Kvis_u(8,a,b)) + afv*Kvis_v(8,a,b) );
     }
   }
 }
 
+/// @brief Reproduces Fortran 'STRUCT3D' subroutine for any element type.
+//
+void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn, const double w, 
+    const Vector<double>& N, const Array<double>& Nx, const Array<double>& al, const Array<double>& yl, 
+    const Array<double>& dl, const Array<double>& bfl, const Array<double>& fN, const Array<double>& pS0l, 
+    Vector<double>& pSl, const Vector<double>& ya_l, Array<double>& lR, Array3<double>& lK) 
+{
+  struct_3d<0>(com_mod, cep_mod, eNoN, nFn, w, N, Nx, al, yl, dl, bfl, fN, pS0l, pSl, ya_l, lR, lK);
+}
+
+/// @brief Select the 3D element kernel specialized for the element type of 
+/// a mesh. Meshes with other element types use the generic struct_3d().
+//
+Struct3dKernel struct_3d_kernel(const mshType& lM)
+{
+  using namespace consts;
+
+  switch (lM.eType) {
+    case ElementType::TET4:
+      return struct_3d<4>;
+    case ElementType::TET10:
+      return struct_3d<10>;
+    case ElementType::HEX8:
+      return struct_3d<8>;
+    default:
+      return struct_3d;
+  }
+}
+
 };
 
@@ -56,6 +56,14 @@ void struct_3d(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn,
     const Array<double>& dl, const Array<double>& bfl, const Array<double>& fN, const Array<double>& pS0l, 
     Vector<double>& pSl, const Vector<double>& ya_l, Array<double>& lR, Array3<double>& lK);
 
+/// @brief Pointer to a 3D element kernel, struct_3d().
+using Struct3dKernel = void (*)(ComMod& com_mod, CepMod& cep_mod, const int eNoN, const int nFn, const double w, 
+    const Vector<double>& N, const Array<double>& Nx, const Array<double>& al, const Array<double>& yl, 
+    const Array<double>& dl, const Array<double>& bfl, const Array<double>& fN, const Array<double>& pS0l, 
+    Vector<double>& pSl, const Vector<double>& ya_l, Array<double>& lR, Array3<double>& lK);
+
+Struct3dKernel struct_3d_kernel(const mshType& lM);
+
 };
 
 #endif
@@ -44,6 +44,9 @@
 #define NOOUTPUT
 
 // --- Define global Trilinos variables to be used in below functions ---------
+//
+// These hold the data of the equation being assembled or solved, see 
+// swapTrilinosState().
 
 /// Unique block map consisting of nodes owned by each processor
 Epetra_BlockMap *Trilinos::blockMap;
@@ -94,10 +97,26 @@ std::vector<int> nnzPerRow;
 
 std::vector<int> localToGlobalSorted;
 
-int timecount = 0;
-
 bool coupledBC;
 
+// --- Define variables used to reuse the ML and Ifpack preconditioners -------
+
+/// Reuse policy, TRILINOS_PREC_REUSE_NONE/STRUCTURE/FULL
+int precReuseType = TRILINOS_PREC_REUSE_NONE;
+
+/// Maximum number of solves using the same preconditioner
+int precReuseMaxSolves = 1;
+
+/// Maximum ratio of the iterations of a solve to the iterations of the
+/// first solve using the same preconditioner
+double precReuseMaxIterRatio = 2.0;
+
+/// Number of solves using the current preconditioner
+int precNumSolves = 0;
+
+/// Number of iterations of the first solve using the current preconditioner
+int precFirstIters = 0;
+
 // ----------------------------------------------------------------------------
 /**
  * Define the matrix vector multiplication operation to do at each iteration
@@ -673,15 +692,9 @@ void trilinos_solve_(double *x, const double *dirW, double &resNorm,
   if (coupledBC) Trilinos::bdryVec->PutScalar(0.0);
   //0 out initial guess for iteration
   Trilinos::X->PutScalar(0.0);
-  // Free memory if MLPrec is invoked
-  if (ifpackPrec) {
-      delete ifpackPrec;
-      ifpackPrec = NULL;
-  }
-  if (MLPrec) {
-      delete MLPrec;
-      MLPrec = NULL;
-  }
+
+  // Keep the ML and Ifpack preconditioners for the next solve or free them
+  updatePrecReuse(numIters);
 } // trilinos_solve_
 
 // ----------------------------------------------------------------------------
@@ -749,6 +762,18 @@ void setPreconditioner(int precondType, AztecOO &Solver)
  */
 void setMLPrec(AztecOO &Solver)
 {
+  // Reuse the hierarchy kept from a previous solve. With structure reuse 
+  // the aggregates and prolongators are kept and the coarse matrices and 
+  // smoothers are recomputed for the current matrix.
+  //
+  if (MLPrec != NULL) {
+    if (precReuseType == TRILINOS_PREC_REUSE_STRUCTURE) {
+      MLPrec->ReComputePreconditioner();
+    }
+    Solver.SetPrecOperator(MLPrec);
+    return;
+  }
+
   //break up into initializer
   Teuchos::ParameterList MLList;
   int *options = new int[AZ_OPTIONS_SIZE];
@@ -800,21 +825,15 @@ void setMLPrec(AztecOO &Solver)
   MLList.set("repartition: partitioner","Zoltan");
   MLList.set("repartition: Zoltan dimensions",2);
 
+  // keep the aggregates and prolongators so the hierarchy can be recomputed
+  if (precReuseType == TRILINOS_PREC_REUSE_STRUCTURE)
+    MLList.set("reuse: enable", true);
+
   // create the preconditioner object based on options in MLList and compute hierarchy
-  if (MLPrec == NULL)
-    MLPrec = new ML_Epetra::MultiLevelPreconditioner(*Trilinos::K, MLList, false);
-
-  timecount = 0;
-  if (timecount == 0)
-    MLPrec->ComputePreconditioner();
-  else {//switch to recompute
-    MLPrec->ReComputePreconditioner();
-  }
+  MLPrec = new ML_Epetra::MultiLevelPreconditioner(*Trilinos::K, MLList, false);
+  MLPrec->ComputePreconditioner();
   Solver.SetPrecOperator(MLPrec);
 
-  //solver to separte function only recompute at separate time iter
-  timecount += 1;
-
   delete[] options;
   delete[] params;
 }// setMLPrec
@@ -838,6 +857,18 @@ void setIFPACKPrec(AztecOO &Solver)
   //ifpackPrec->Compute();
   //Solver.SetPrecOperator(&*ifpackPrec);
 
+  // Reuse the preconditioner kept from a previous solve. With structure 
+  // reuse the symbolic factorization is kept and the numeric factorization 
+  // is recomputed for the current matrix.
+  //
+  if (ifpackPrec != NULL) {
+    if (precReuseType == TRILINOS_PREC_REUSE_STRUCTURE) {
+      ifpackPrec->Compute();
+    }
+    Solver.SetPrecOperator(&*ifpackPrec);
+    return;
+  }
+
   Teuchos::ParameterList List;
   int OverlapLevel = 0;
   ifpackPrec = new Ifpack_AdditiveSchwarz<Ifpack_ILUT> (Trilinos::K, OverlapLevel);
@@ -850,6 +881,76 @@ void setIFPACKPrec(AztecOO &Solver)
 
 } // setIFPACKPrec
 
+// ----------------------------------------------------------------------------
+/**
+ * Set the policy used to reuse the ML and Ifpack preconditioners between 
+ * solves, the stored preconditioners are freed if the policy changes
+ *
+ * \param reuseType     TRILINOS_PREC_REUSE_NONE/STRUCTURE/FULL
+ * \param maxSolves     maximum number of solves using the same preconditioner
+ * \param maxIterRatio  rebuild the preconditioner when the iterations exceed
+ *                      this ratio times the iterations of its first solve
+ */
+void setPrecReuse(int reuseType, int maxSolves, double maxIterRatio)
+{
+  if (reuseType == TRILINOS_PREC_REUSE_NONE) {
+    maxSolves = 1;
+  }
+
+  if ((reuseType != precReuseType) || (maxSolves != precReuseMaxSolves) ||
+      (maxIterRatio != precReuseMaxIterRatio)) {
+    freePreconditioners();
+  }
+
+  precReuseType = reuseType;
+  precReuseMaxSolves = maxSolves;
+  precReuseMaxIterRatio = maxIterRatio;
+} // setPrecReuse
+
+// ----------------------------------------------------------------------------
+/**
+ * Count a solve using the current preconditioner and free it if it has 
+ * reached the maximum number of solves or the number of iterations has 
+ * grown past the allowed ratio, it is then rebuilt by the next solve
+ *
+ * \param numIters  number of iterations of the solve
+ */
+void updatePrecReuse(int numIters)
+{
+  precNumSolves += 1;
+
+  if (precNumSolves == 1) {
+    precFirstIters = std::max(numIters, 1);
+  }
+
+  bool keep = (precReuseType != TRILINOS_PREC_REUSE_NONE) && (precNumSolves < precReuseMaxSolves) &&
+              (numIters <= precReuseMaxIterRatio * precFirstIters);
+
+  if (!keep) {
+    freePreconditioners();
+  }
+} // updatePrecReuse
+
+// ----------------------------------------------------------------------------
+/**
+ * Free the ML and Ifpack preconditioners
+ */
+void freePreconditioners()
+{
+  if (ifpackPrec) {
+      delete ifpackPrec;
+      ifpackPrec = NULL;
+  }
+  if (MLPrec) {
+      MLPrec->DestroyPreconditioner();
+      delete MLPrec;
+      MLPrec = NULL;
+  }
+
+  precNumSolves = 0;
+  precFirstIters = 0;
+} // freePreconditioners
+
 // ----------------------------------------------------------------------------
 /**
  * This routine is to be used with preconditioners such as ILUT which require
@@ -962,11 +1063,9 @@ void trilinos_bc_create_(const double *v, bool &isCoupledBC)
  */
 void trilinos_lhs_free_()
 {
-  if (MLPrec) {
-      MLPrec->DestroyPreconditioner();
-      delete MLPrec;
-      MLPrec = NULL;
-  }
+  // The preconditioners reference the matrix K
+  freePreconditioners();
+
   if (Trilinos::blockMap) {
       delete Trilinos::blockMap;
       Trilinos::blockMap = NULL;
@@ -1002,6 +1101,43 @@ void trilinos_lhs_free_()
 
 }
 
+// ----------------------------------------------------------------------------
+/**
+ * exchange the global data structures and preconditioners with the ones 
+ * stored in state, used to switch between the linear systems of equations
+ *
+ * \param state   data structures of a linear system
+ */
+void swapTrilinosState(TrilinosState &state)
+{
+  std::swap(Trilinos::blockMap, state.blockMap);
+  std::swap(Trilinos::F, state.F);
+  std::swap(Trilinos::K, state.K);
+  std::swap(Trilinos::X, state.X);
+  std::swap(Trilinos::ghostX, state.ghostX);
+  std::swap(Trilinos::Importer, state.Importer);
+  std::swap(Trilinos::bdryVec, state.bdryVec);
+  std::swap(Trilinos::K_graph, state.K_graph);
+
+  std::swap(MLPrec, state.MLPrec);
+  std::swap(ifpackPrec, state.ifpackPrec);
+
+  std::swap(dof, state.dof);
+  std::swap(ghostAndLocalNodes, state.ghostAndLocalNodes);
+  std::swap(localNodes, state.localNodes);
+  std::swap(globalColInd, state.globalColInd);
+  std::swap(localToGlobalUnsorted, state.localToGlobalUnsorted);
+  std::swap(nnzPerRow, state.nnzPerRow);
+  std::swap(localToGlobalSorted, state.localToGlobalSorted);
+  std::swap(coupledBC, state.coupledBC);
+
+  std::swap(precReuseType, state.precReuseType);
+  std::swap(precReuseMaxSolves, state.precReuseMaxSolves);
+  std::swap(precReuseMaxIterRatio, state.precReuseMaxIterRatio);
+  std::swap(precNumSolves, state.precNumSolves);
+  std::swap(precFirstIters, state.precFirstIters);
+} // swapTrilinosState
+
 // ----------------------------------------------------------------------------
 /**
  * for debugging purposes here are routines to print the matrix and RHS vector
@@ -1079,6 +1215,19 @@ void printSolutionToFile()
 //                  T r i l i n o s I m p l                    //
 /////////////////////////////////////////////////////////////////
 
+//--------------
+// The TrilinosStateGuard class swaps the data structures of a linear
+// system into the global Trilinos variables while it is in scope.
+//
+class TrilinosStateGuard {
+  public:
+    TrilinosStateGuard(TrilinosState& state) : state_(state) { swapTrilinosState(state_); }
+    ~TrilinosStateGuard() { swapTrilinosState(state_); }
+
+  private:
+    TrilinosState& state_;
+};
+
 //--------------
 // TrilinosImpl 
 //--------------
@@ -1088,6 +1237,7 @@ void printSolutionToFile()
 class TrilinosLinearAlgebra::TrilinosImpl {
   public:
     TrilinosImpl();
+    ~TrilinosImpl();
     void alloc(ComMod& com_mod, eqType& lEq);
     void assemble(ComMod& com_mod, const int num_elem_nodes, const Vector<int>& eqN,
         const Array3<double>& lK, const Array<double>& lR);
@@ -1096,9 +1246,20 @@ class TrilinosLinearAlgebra::TrilinosImpl {
     void solve_assembled(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, const Vector<double>& res);
     void init_dir_and_coup_neu(ComMod& com_mod, const Vector<int>& incL, const Vector<double>& res);
     void set_preconditioner(consts::PreconditionerType preconditioner);
+    void set_preconditioner_reuse(const consts::PreconditionerReuseType reuse, const int max_solves, 
+        const double max_ratio);
+    bool same_lhs(ComMod& com_mod);
 
     consts::PreconditionerType preconditioner_;
 
+    /// @brief Preconditioner reuse policy
+    consts::PreconditionerReuseType prec_reuse_ = consts::PreconditionerReuseType::PREC_REUSE_NONE;
+    int prec_reuse_max_solves_ = 1;
+    double prec_reuse_max_ratio_ = 2.0;
+
+    /// @brief Trilinos matrix, vectors and preconditioners of the equation
+    TrilinosState state_;
+
     /// @brief Local to global mapping
     Vector<int> ltg_;
 
@@ -1113,6 +1274,12 @@ TrilinosLinearAlgebra::TrilinosImpl::TrilinosImpl()
 {
 }
 
+TrilinosLinearAlgebra::TrilinosImpl::~TrilinosImpl()
+{
+  TrilinosStateGuard guard(state_);
+  trilinos_lhs_free_();
+}
+
 /// @brief Allocate Trilinos arrays.
 void TrilinosLinearAlgebra::TrilinosImpl::alloc(ComMod& com_mod, eqType& lEq) 
 {
@@ -1127,12 +1294,22 @@ void TrilinosLinearAlgebra::TrilinosImpl::alloc(ComMod& com_mod, eqType& lEq)
   std::cout << "[TrilinosImpl.alloc] ltg_.size(): " << ltg_.size() << std::endl;
   #endif
 
+  TrilinosStateGuard guard(state_);
+
+  // A reused preconditioner references the Trilinos matrix so the matrix 
+  // is kept while the sparsity pattern does not change.
+  //
+  if ((prec_reuse_ != consts::PreconditionerReuseType::PREC_REUSE_NONE) && (W_.size() != 0) && same_lhs(com_mod)) {
+    return;
+  }
+
   if (W_.size() != 0) {
     W_.clear();
     R_.clear();
-    trilinos_lhs_free_();
   }
 
+  trilinos_lhs_free_();
+
   W_.resize(dof,tnNo); 
   R_.resize(dof,tnNo);
 
@@ -1141,13 +1318,42 @@ void TrilinosLinearAlgebra::TrilinosImpl::alloc(ComMod& com_mod, eqType& lEq)
 
   trilinos_lhs_create_(gtnNo, lhs.mynNo, tnNo, lhs.nnz, ltg_.data(), com_mod.ltg.data(), com_mod.rowPtr.data(), 
       com_mod.colPtr.data(), dof, cpp_index, task_id);
+}
+
+/// @brief Check if the Trilinos data structures of this object were created
+/// for the current dof and sparsity pattern.
+bool TrilinosLinearAlgebra::TrilinosImpl::same_lhs(ComMod& com_mod)
+{
+  int tnNo = com_mod.tnNo;
+  int nnz = com_mod.lhs.nnz;
+
+  if ((Trilinos::K == NULL) || (::dof != com_mod.dof) || 
+      (ghostAndLocalNodes != tnNo) || (localNodes != com_mod.lhs.mynNo) || 
+      (localToGlobalUnsorted.size() != tnNo) || (globalColInd.size() != nnz)) {
+    return false;
+  }
+
+  for (int a = 0; a < tnNo; a++) {
+    if ((localToGlobalUnsorted[a] != com_mod.ltg(a)) || 
+        (nnzPerRow[a] != com_mod.rowPtr(a+1) - com_mod.rowPtr(a))) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < nnz; i++) {
+    if (globalColInd[i] != com_mod.ltg(com_mod.colPtr(i))) {
+      return false;
+    }
+  }
 
+  return true;
 }
 
 /// @brief Assemble local element arrays.
 void TrilinosLinearAlgebra::TrilinosImpl::assemble(ComMod& com_mod, const int num_elem_nodes, const Vector<int>& eqN,
         const Array3<double>& lK, const Array<double>& lR)
 {
+  TrilinosStateGuard guard(state_);
   trilinos_doassem_(const_cast<int&>(num_elem_nodes), eqN.data(), lK.data(), lR.data());
 }
 
@@ -1249,10 +1455,21 @@ void TrilinosLinearAlgebra::TrilinosImpl::set_preconditioner(consts::Preconditio
   preconditioner_ = prec_type;
 }
 
+/// @brief Set the reuse of the ML and Ifpack preconditioners.
+void TrilinosLinearAlgebra::TrilinosImpl::set_preconditioner_reuse(const consts::PreconditionerReuseType reuse, 
+    const int max_solves, const double max_ratio)
+{
+  prec_reuse_ = reuse;
+  prec_reuse_max_solves_ = max_solves;
+  prec_reuse_max_ratio_ = max_ratio;
+}
+
 /// @brief Solve a system of linear equations assembled by fsils.
 void TrilinosLinearAlgebra::TrilinosImpl::solve(ComMod& com_mod, eqType& lEq, const Vector<int>& incL, 
     const Vector<double>& res)
 {
+  TrilinosStateGuard guard(state_);
+
   init_dir_and_coup_neu(com_mod, incL, res);
 
   auto& Val = com_mod.Val;
@@ -1276,6 +1493,8 @@ void TrilinosLinearAlgebra::TrilinosImpl::solve(ComMod& com_mod, eqType& lEq, co
     throw std::runtime_error("[TrilinosLinearAlgebra::solve] ERROR: '" + prec_name + "' is not a valid Trilinos preconditioner.");
   }
 
+  setPrecReuse(static_cast<int>(prec_reuse_), prec_reuse_max_solves_, prec_reuse_max_ratio_);
+
   trilinos_global_solve_(Val.data(), R.data(), R_.data(), W_.data(), lEq.FSILS.RI.fNorm,
       lEq.FSILS.RI.iNorm, lEq.FSILS.RI.itr, lEq.FSILS.RI.callD, lEq.FSILS.RI.dB, lEq.FSILS.RI.suc,
       solver_type, lEq.FSILS.RI.relTol, lEq.FSILS.RI.mItr, lEq.FSILS.RI.sD, prec_type);
@@ -1284,6 +1503,13 @@ void TrilinosLinearAlgebra::TrilinosImpl::solve(ComMod& com_mod, eqType& lEq, co
     for (int i = 0; i < com_mod.R.nrows(); i++) {
       com_mod.R(i,a) = R_(i,com_mod.lhs.map(a));
     }
+  }
+
+  // Without reuse the data structures are recreated by the next alloc(),
+  // free them so that only one equation holds a matrix at a time.
+  //
+  if (prec_reuse_ == consts::PreconditionerReuseType::PREC_REUSE_NONE) {
+    trilinos_lhs_free_();
   } 
 }
 
@@ -1310,8 +1536,12 @@ void TrilinosLinearAlgebra::TrilinosImpl::solve_assembled(ComMod& com_mod, eqTyp
     throw std::runtime_error("[TrilinosLinearAlgebra::solve_assembled] ERROR: '" + prec_name + "' is not a valid Trilinos preconditioner.");
   }
 
+  TrilinosStateGuard guard(state_);
+
   init_dir_and_coup_neu(com_mod, incL, res);
 
+  setPrecReuse(static_cast<int>(prec_reuse_), prec_reuse_max_solves_, prec_reuse_max_ratio_);
+
   trilinos_solve_(R_.data(), W_.data(), lEq.FSILS.RI.fNorm, lEq.FSILS.RI.iNorm, 
       lEq.FSILS.RI.itr, lEq.FSILS.RI.callD, lEq.FSILS.RI.dB, lEq.FSILS.RI.suc, 
       solver_type, lEq.FSILS.RI.relTol, lEq.FSILS.RI.mItr, lEq.FSILS.RI.sD, 
@@ -1323,5 +1553,12 @@ void TrilinosLinearAlgebra::TrilinosImpl::solve_assembled(ComMod& com_mod, eqTyp
     }
   }
 
+  // Without reuse the data structures are recreated by the next alloc(),
+  // free them so that only one equation holds a matrix at a time.
+  //
+  if (prec_reuse_ == consts::PreconditionerReuseType::PREC_REUSE_NONE) {
+    trilinos_lhs_free_();
+  }
+
 }
 
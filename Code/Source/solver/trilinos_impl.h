@@ -90,6 +90,11 @@
 #define TRILINOS_ICT_PRECONDITIONER 707
 #define TRILINOS_ML_PRECONDITIONER 708
 
+// Define preconditioner reuse as following consts::PreconditionerReuseType
+#define TRILINOS_PREC_REUSE_NONE 0
+#define TRILINOS_PREC_REUSE_STRUCTURE 1
+#define TRILINOS_PREC_REUSE_FULL 2
+
 /// @brief Initialize all Epetra types we need separate from Fortran
 struct Trilinos
 {
@@ -104,6 +109,41 @@ struct Trilinos
   static Epetra_FECrsGraph *K_graph;
 };
 
+/// @brief Trilinos data structures and preconditioners of one linear system
+///
+/// Each TrilinosLinearAlgebra object stores its own state, which is swapped
+/// into the global variables used by the functions below while the object
+/// assembles or solves its equation.
+struct TrilinosState
+{
+  Epetra_BlockMap *blockMap = NULL;
+  Epetra_FEVector *F = NULL;
+  Epetra_FEVbrMatrix *K = NULL;
+  Epetra_Vector *X = NULL;
+  Epetra_Vector *ghostX = NULL;
+  Epetra_Import *Importer = NULL;
+  Epetra_FEVector *bdryVec = NULL;
+  Epetra_FECrsGraph *K_graph = NULL;
+
+  ML_Epetra::MultiLevelPreconditioner *MLPrec = NULL;
+  Ifpack_Preconditioner *ifpackPrec = NULL;
+
+  int dof = 0;
+  int ghostAndLocalNodes = 0;
+  int localNodes = 0;
+  std::vector<int> globalColInd;
+  std::vector<int> localToGlobalUnsorted;
+  std::vector<int> nnzPerRow;
+  std::vector<int> localToGlobalSorted;
+  bool coupledBC = false;
+
+  int precReuseType = TRILINOS_PREC_REUSE_NONE;
+  int precReuseMaxSolves = 1;
+  double precReuseMaxIterRatio = 2.0;
+  int precNumSolves = 0;
+  int precFirstIters = 0;
+};
+
 /**
  * \class TrilinosMatVec
  * \brief This class implements the pure virtual class Epetra_Operator for the
@@ -230,6 +270,14 @@ void setMLPrec(AztecOO &Solver);
 
 void setIFPACKPrec(AztecOO &Solver);
 
+void setPrecReuse(int reuseType, int maxSolves, double maxIterRatio);
+
+void updatePrecReuse(int numIters);
+
+void freePreconditioners();
+
+void swapTrilinosState(TrilinosState &state);
+
 void checkDiagonalIsZero();
 
 void constructJacobiScaling(const double *dirW,
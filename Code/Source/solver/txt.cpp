@@ -33,6 +33,7 @@
 
 #include "txt.h"
 
+#include "Profiler.h"
 #include "all_fun.h"
 #include "consts.h"
 #include "post.h"
@@ -169,6 +170,8 @@ void create_volume_integral_file(const ComMod& com_mod, CmMod& cm_mod, const eqT
 //
 void txt(Simulation* simulation, const bool init_write) 
 {
+  SV_PROFILE_REGION("txt");
+
   using namespace consts;
   using namespace utils;
 
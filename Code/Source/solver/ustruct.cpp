@@ -49,12 +49,15 @@
 #include "ustruct.h"
 
 #include "all_fun.h"
+#include "elem_color.h"
 #include "fs.h"
 #include "mat_fun.h"
 #include "mat_models.h"
+#include "NodeArray.h"
 #include "nn.h"
 #include "utils.h"
 
+#include <exception>
 #include <math.h>
 
 namespace ustruct {
@@ -272,147 +275,188 @@ void construct_usolid(ComMod& com_mod, CepMod& cep_mod, const mshType& lM, const
   dmsg << "vmsStab: " << vmsStab;
   #endif
 
-  // USTRUCT: dof = nsd+1
-  Vector<int> ptr(eNoN);
-  Vector<double> pSl(nsymd), ya_l(eNoN), N(eNoN);
-  Array<double> xl(nsd,eNoN), al(tDof,eNoN), yl(tDof,eNoN), dl(tDof,eNoN),
-                bfl(nsd,eNoN), fN(nsd,nFn), pS0l(nsymd,eNoN), Nx(nsd,eNoN), lR(dof,eNoN);
-  Array3<double> lK(dof*dof,eNoN,eNoN), lKd(dof*nsd,eNoN,eNoN);
-
-  for (int e = 0; e < lM.nEl; e++) {
-    // Update domain and proceed if domain phys and eqn phys match
-    cDmn = all_fun::domain(com_mod, lM, cEq, e);
-    auto cPhys = eq.dmn[cDmn].phys;
-    if (cPhys != EquationType::phys_ustruct) {
-      continue;
-    }
-
-    // Create local copies
-    fN  = 0.0;
-    ya_l = 0.0;
-
-    for (int a = 0; a < eNoN; a++) {
-      int Ac = lM.IEN(a,e);
-      ptr(a) = Ac;
-
-      for (int i = 0; i < nsd; i++) {
-        xl(i,a) = com_mod.x(i,Ac);
-        bfl(i,a) = com_mod.Bf(i,Ac);
-      }
-
-      for (int i = 0; i < tDof; i++) {
-        al(i,a) = Ag(i,Ac);
-        dl(i,a) = Dg(i,Ac);
-        yl(i,a) = Yg(i,Ac);
+  // Get the order elements are integrated in. When using threads elements
+  // are ordered by color so that the elements assembled concurrently never
+  // share a global row.
+  //
+  const bool threaded = elem_color::use_threads(com_mod, lM, eq);
+  Vector<int> elems;
+  std::vector<elem_color::ElemBatch> batches;
+  elem_color::get_batches(com_mod, lM, cEq, threaded, elems, batches);
+  std::exception_ptr error;
+
+  // Select the element kernel specialized for the mesh element type.
+  auto kernel_m = ustruct_3d_m_kernel(lM, vmsStab);
+
+  #pragma omp parallel if(threaded)
+  {
+    // USTRUCT: dof = nsd+1
+    Vector<int> ptr(eNoN);
+    Vector<double> pSl(nsymd), ya_l(eNoN), N(eNoN);
+    Array<double> xl(nsd,eNoN), al(tDof,eNoN), yl(tDof,eNoN), dl(tDof,eNoN),
+                  bfl(nsd,eNoN), fN(nsd,nFn), pS0l(nsymd,eNoN), Nx(nsd,eNoN), lR(dof,eNoN);
+    Array3<double> lK(dof*dof,eNoN,eNoN), lKd(dof*nsd,eNoN,eNoN);
+
+    // Loop over all elements of mesh
+    //
+    for (const auto& batch : batches) {
+      // Proceed if domain phys and eqn phys match
+      if (eq.dmn[batch.dmn].phys != EquationType::phys_ustruct) {
+        continue;
       }
 
-      if (lM.fN.size() != 0) {
-        for (int iFn = 0; iFn < nFn; iFn++) {
-          for (int i = 0; i < nsd; i++) {
-            fN(i,iFn) = lM.fN(i+nsd*iFn,e);
+      #pragma omp single
+      cDmn = batch.dmn;
+
+      #pragma omp for schedule(dynamic,64)
+      for (int ie = batch.start; ie < batch.end; ie++) {
+        int e = elems(ie);
+
+        try {
+          // Create local copies
+          fN  = 0.0;
+          ya_l = 0.0;
+
+          for (int a = 0; a < eNoN; a++) {
+            int Ac = lM.IEN(a,e);
+            ptr(a) = Ac;
+
+            for (int i = 0; i < nsd; i++) {
+              xl(i,a) = com_mod.x(i,Ac);
+              bfl(i,a) = com_mod.Bf(i,Ac);
+            }
+
+            for (int i = 0; i < tDof; i++) {
+              al(i,a) = Ag(i,Ac);
+              dl(i,a) = Dg(i,Ac);
+              yl(i,a) = Yg(i,Ac);
+            }
+
+            if (lM.fN.size() != 0) {
+              for (int iFn = 0; iFn < nFn; iFn++) {
+                for (int i = 0; i < nsd; i++) {
+                  fN(i,iFn) = lM.fN(i+nsd*iFn,e);
+                }
+              }
+            }
+
+            if (cem.cpld) {
+              ya_l(a) = cem.Ya(Ac);
+            }
           }
-        }
-      }
 
-      if (cem.cpld) {
-        ya_l(a) = cem.Ya(Ac);
-      }
-    }
-
-    // Initialize residual and tangents
-    lR = 0.0;
-    lK = 0.0;
-    lKd = 0.0;
-    std::array<fsType,2> fs;
+          // Initialize residual and tangents
+          lR = 0.0;
+          lK = 0.0;
+          lKd = 0.0;
+          std::array<fsType,2> fs;
 
-    // Set function spaces for velocity and pressure.
-    fs::get_thood_fs(com_mod, fs, lM, vmsStab, 1);
+          // Set function spaces for velocity and pressure.
+          fs::get_thood_fs(com_mod, fs, lM, vmsStab, 1);
 
-    // Define element coordinates appropriate for function spaces
-    Array<double> xwl(nsd,fs[0].eNoN);
-    Array<double> Nwx(nsd,fs[0].eNoN);
-    Array<double> xql(nsd,fs[1].eNoN);
-    Array<double> Nqx(nsd,fs[1].eNoN);
+          // Define element coordinates appropriate for function spaces
+          Array<double> xwl(nsd,fs[0].eNoN);
+          Array<double> Nwx(nsd,fs[0].eNoN);
+          Array<double> xql(nsd,fs[1].eNoN);
+          Array<double> Nqx(nsd,fs[1].eNoN);
 
-    xwl = xl;
+          xwl = xl;
 
-    for (int i = 0; i < nsd; i++) {
-      for (int j = 0; j < fs[1].eNoN; j++) {
-        xql(i,j) = xl(i,j);
-      }
-    }
-
-    // Gauss integration 1
-    //
-    double Jac{0.0};
-    Array<double> ksix(nsd,nsd);
-
-    for (int g = 0; g < fs[0].nG; g++) {
-      if (g == 0 || !fs[0].lShpF) {
-        auto Nx = fs[0].Nx.slice(g);
-        nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_usolid] Jacobian for element " + std::to_string(e) + " is < 0.");
-        }
-      }
-
-      double w = fs[0].w(g) * Jac;
-
-      if (nsd == 3) {
-        auto N0 = fs[0].N.col(g);
-        auto N1 = fs[1].N.col(g);
-        ustruct_3d_m(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, nFn, w, Jac, N0, N1, Nwx, al, yl, dl, bfl, fN, ya_l, lR, lK, lKd);
-
-      } else if (nsd == 2) {
-        auto N0 = fs[0].N.col(g);
-        auto N1 = fs[1].N.col(g);
-        ustruct_2d_m(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, nFn, w, Jac, N0, N1, Nwx, al, yl, dl, bfl, fN, ya_l, lR, lK, lKd);
-      }
-
-    } // for g = 0 to fs[0].nG
-
-    // Set function spaces for velocity/displacement and pressure.
-    fs::get_thood_fs(com_mod, fs, lM, vmsStab, 2);
+          for (int i = 0; i < nsd; i++) {
+            for (int j = 0; j < fs[1].eNoN; j++) {
+              xql(i,j) = xl(i,j);
+            }
+          }
 
-    // Gauss integration 2
-    //
-    for (int g = 0; g < fs[1].nG; g++) {
-      if (g == 0 || !fs[0].lShpF) {
-        auto Nx = fs[0].Nx.slice(g);
-        nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_usolid] Jacobian for element " + std::to_string(e) + " is < 0.");
-        }
-      }
+          // Gauss integration 1
+          //
+          double Jac{0.0};
+          Array<double> ksix(nsd,nsd);
+
+          for (int g = 0; g < fs[0].nG; g++) {
+            if (g == 0 || !fs[0].lShpF) {
+              auto Nx = fs[0].Nx.slice(g);
+              nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
+              if (utils::is_zero(Jac)) {
+                 throw std::runtime_error("[construct_usolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+              }
+            }
+
+            double w = fs[0].w(g) * Jac;
+
+            if (nsd == 3) {
+              auto N0 = fs[0].N.col(g);
+              auto N1 = fs[1].N.col(g);
+              kernel_m(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, nFn, w, Jac, N0, N1, Nwx, al, yl, dl, bfl, fN, ya_l, lR, lK, lKd);
+
+            } else if (nsd == 2) {
+              auto N0 = fs[0].N.col(g);
+              auto N1 = fs[1].N.col(g);
+              ustruct_2d_m(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, nFn, w, Jac, N0, N1, Nwx, al, yl, dl, bfl, fN, ya_l, lR, lK, lKd);
+            }
+
+          } // for g = 0 to fs[0].nG
+
+          // Set function spaces for velocity/displacement and pressure.
+          fs::get_thood_fs(com_mod, fs, lM, vmsStab, 2);
+
+          // Gauss integration 2
+          //
+          for (int g = 0; g < fs[1].nG; g++) {
+            if (g == 0 || !fs[0].lShpF) {
+              auto Nx = fs[0].Nx.slice(g);
+              nn::gnn(fs[0].eNoN, nsd, nsd, Nx, xwl, Nwx, Jac, ksix);
+              if (utils::is_zero(Jac)) {
+                 throw std::runtime_error("[construct_usolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+              }
+            }
+
+            if (g == 0 || !fs[1].lShpF) {
+              auto Nx = fs[1].Nx.slice(g);
+              nn::gnn(fs[1].eNoN, nsd, nsd, Nx, xql, Nqx, Jac, ksix);
+              if (utils::is_zero(Jac)) {
+                 throw std::runtime_error("[construct_usolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+              }
+            }
+
+            double w = fs[1].w(g) * Jac;
+
+            if (nsd == 3) {
+              auto N0 = fs[0].N.col(g);
+              auto N1 = fs[1].N.col(g);
+              ustruct_3d_c(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, Jac, N0, N1, Nwx, 
+                  Nqx, al, yl, dl, bfl, lR, lK, lKd);
+
+            } else if (nsd == 2) {
+              auto N0 = fs[0].N.col(g);
+              auto N1 = fs[1].N.col(g);
+              ustruct_2d_c(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, Jac, N0, N1, Nwx, 
+                  Nqx, al, yl, dl, bfl, lR, lK, lKd);
+            }
+
+          } // for g = 0 to fs[1].nG
+
+          if (lM.eValPtr.nslices() == lM.nEl) {
+            ustruct_do_assem(com_mod, eNoN, ptr, lM.eValPtr.rslice(e), lKd, lK, lR);
+          } else {
+            ustruct_do_assem(com_mod, eNoN, ptr, lKd, lK, lR);
+          }
 
-      if (g == 0 || !fs[1].lShpF) {
-        auto Nx = fs[1].Nx.slice(g);
-        nn::gnn(fs[1].eNoN, nsd, nsd, Nx, xql, Nqx, Jac, ksix);
-        if (utils::is_zero(Jac)) {
-           throw std::runtime_error("[construct_usolid] Jacobian for element " + std::to_string(e) + " is < 0.");
+        } catch (...) {
+          #pragma omp critical
+          {
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
         }
-      }
-
-      double w = fs[1].w(g) * Jac;
-
-      if (nsd == 3) {
-        auto N0 = fs[0].N.col(g);
-        auto N1 = fs[1].N.col(g);
-        ustruct_3d_c(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, Jac, N0, N1, Nwx, 
-            Nqx, al, yl, dl, bfl, lR, lK, lKd);
-
-      } else if (nsd == 2) {
-        auto N0 = fs[0].N.col(g);
-        auto N1 = fs[1].N.col(g);
-        ustruct_2d_c(com_mod, cep_mod, vmsStab, fs[0].eNoN, fs[1].eNoN, w, Jac, N0, N1, Nwx, 
-            Nqx, al, yl, dl, bfl, lR, lK, lKd);
-      }
-
-    } // for g = 0 to fs[1].nG
+      } // e: loop
+    } // batch: loop
+  } // omp parallel
 
-    ustruct_do_assem(com_mod, eNoN, ptr, lKd, lK, lR);
-
-  } // for e = 0 to lM.nEl
+  if (error) {
+    std::rethrow_exception(error);
+  }
 
 }
 
@@ -1168,8 +1212,12 @@ void ustruct_2d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
 }
 
 /// @brief Reproduces Fortran USTRUCT3D_M.
+///
+/// The template parameters are the number of velocity and pressure nodes of 
+/// a specialized element type, or 0 to use the 'eNoNw_in' and 'eNoNq_in' values.
 //
-void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const int eNoNw, const int eNoNq, 
+template <int eNoNw_t, int eNoNq_t>
+void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const int eNoNw_in, const int eNoNq_in, 
     const int nFn, const double w, const double Je, const Vector<double>& Nw,  const Vector<double>& Nq, 
     const Array<double>& Nwx, const Array<double>& al, const Array<double>& yl, const Array<double>& dl, 
     const Array<double>& bfl, const Array<double>& fN, const Vector<double>& ya_l, Array<double>& lR, 
@@ -1178,6 +1226,9 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
   using namespace consts;
   using namespace mat_fun;
 
+  const int eNoNw = (eNoNw_t > 0) ? eNoNw_t : eNoNw_in;
+  const int eNoNq = (eNoNq_t > 0) ? eNoNq_t : eNoNq_in;
+
   #define n_debug_ustruct_3d_m
   #ifdef debug_ustruct_3d_m
   DebugMsg dmsg(__func__, com_mod.cm.idcm());
@@ -1321,12 +1372,12 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
 
   // Shape function gradients in the current configuration
   //
-  Array<double> NxFi(3,eNoNw);
+  NodeArray<eNoNw_t,3> NxFi(eNoNw);
 
   for (int a = 0; a < eNoNw; a++) {
-    NxFi(0,a) = Nwx(0,a)*Fi(0,0) + Nwx(1,a)*Fi(1,0) + Nwx(2,a)*Fi(2,0);
-    NxFi(1,a) = Nwx(0,a)*Fi(0,1) + Nwx(1,a)*Fi(1,1) + Nwx(2,a)*Fi(2,1);
-    NxFi(2,a) = Nwx(0,a)*Fi(0,2) + Nwx(1,a)*Fi(1,2) + Nwx(2,a)*Fi(2,2);
+    NxFi[0][a] = Nwx(0,a)*Fi(0,0) + Nwx(1,a)*Fi(1,0) + Nwx(2,a)*Fi(2,0);
+    NxFi[1][a] = Nwx(0,a)*Fi(0,1) + Nwx(1,a)*Fi(1,1) + Nwx(2,a)*Fi(2,1);
+    NxFi[2][a] = Nwx(0,a)*Fi(0,2) + Nwx(1,a)*Fi(1,2) + Nwx(2,a)*Fi(2,2);
   } 
 
   // Velocity gradient in current configuration
@@ -1341,56 +1392,56 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
   for (int a = 0; a < eNoNw; a++) {
     T1 = Jac*rho*vd(0)*Nw(a);
     T2 = Pdev(0,0)*Nwx(0,a) + Pdev(0,1)*Nwx(1,a) + Pdev(0,2)*Nwx(2,a);
-    T3 = Jac*rCl*NxFi(0,a);
+    T3 = Jac*rCl*NxFi[0][a];
     lR(0,a) = lR(0,a) + w*(T1 + T2 + T3);
 
     T1 = Jac*rho*vd(1)*Nw(a);
     T2 = Pdev(1,0)*Nwx(0,a) + Pdev(1,1)*Nwx(1,a) + Pdev(1,2)*Nwx(2,a);
-    T3 = Jac*rCl*NxFi(1,a);
+    T3 = Jac*rCl*NxFi[1][a];
     lR(1,a) = lR(1,a) + w*(T1 + T2 + T3);
 
     T1 = Jac*rho*vd(2)*Nw(a);
     T2 = Pdev(2,0)*Nwx(0,a) + Pdev(2,1)*Nwx(1,a) + Pdev(2,2)*Nwx(2,a);
-    T3 = Jac*rCl*NxFi(2,a);
+    T3 = Jac*rCl*NxFi[2][a];
     lR(2,a) = lR(2,a) + w*(T1 + T2 + T3);
   }
 
   // Auxilary quantities for computing stiffness tensors
   //
-  Array3<double> Bm(6,3,eNoNw);
+  NodeArray<eNoNw_t,6,3> Bm(eNoNw);
 
   for (int a = 0; a < eNoNw; a++) {
-    Bm(0,0,a) = Nwx(0,a)*F(0,0);
-    Bm(0,1,a) = Nwx(0,a)*F(1,0);
-    Bm(0,2,a) = Nwx(0,a)*F(2,0);
+    Bm[0][0][a] = Nwx(0,a)*F(0,0);
+    Bm[0][1][a] = Nwx(0,a)*F(1,0);
+    Bm[0][2][a] = Nwx(0,a)*F(2,0);
 
-    Bm(1,0,a) = Nwx(1,a)*F(0,1);
-    Bm(1,1,a) = Nwx(1,a)*F(1,1);
-    Bm(1,2,a) = Nwx(1,a)*F(2,1);
+    Bm[1][0][a] = Nwx(1,a)*F(0,1);
+    Bm[1][1][a] = Nwx(1,a)*F(1,1);
+    Bm[1][2][a] = Nwx(1,a)*F(2,1);
 
-    Bm(2,0,a) = Nwx(2,a)*F(0,2);
-    Bm(2,1,a) = Nwx(2,a)*F(1,2);
-    Bm(2,2,a) = Nwx(2,a)*F(2,2);
+    Bm[2][0][a] = Nwx(2,a)*F(0,2);
+    Bm[2][1][a] = Nwx(2,a)*F(1,2);
+    Bm[2][2][a] = Nwx(2,a)*F(2,2);
 
-    Bm(3,0,a) = (Nwx(0,a)*F(0,1) + F(0,0)*Nwx(1,a));
-    Bm(3,1,a) = (Nwx(0,a)*F(1,1) + F(1,0)*Nwx(1,a));
-    Bm(3,2,a) = (Nwx(0,a)*F(2,1) + F(2,0)*Nwx(1,a));
+    Bm[3][0][a] = (Nwx(0,a)*F(0,1) + F(0,0)*Nwx(1,a));
+    Bm[3][1][a] = (Nwx(0,a)*F(1,1) + F(1,0)*Nwx(1,a));
+    Bm[3][2][a] = (Nwx(0,a)*F(2,1) + F(2,0)*Nwx(1,a));
 
-    Bm(4,0,a) = (Nwx(1,a)*F(0,2) + F(0,1)*Nwx(2,a));
-    Bm(4,1,a) = (Nwx(1,a)*F(1,2) + F(1,1)*Nwx(2,a));
-    Bm(4,2,a) = (Nwx(1,a)*F(2,2) + F(2,1)*Nwx(2,a));
+    Bm[4][0][a] = (Nwx(1,a)*F(0,2) + F(0,1)*Nwx(2,a));
+    Bm[4][1][a] = (Nwx(1,a)*F(1,2) + F(1,1)*Nwx(2,a));
+    Bm[4][2][a] = (Nwx(1,a)*F(2,2) + F(2,1)*Nwx(2,a));
 
-    Bm(5,0,a) = (Nwx(2,a)*F(0,0) + F(0,2)*Nwx(0,a));
-    Bm(5,1,a) = (Nwx(2,a)*F(1,0) + F(1,2)*Nwx(0,a));
-    Bm(5,2,a) = (Nwx(2,a)*F(2,0) + F(2,2)*Nwx(0,a));
+    Bm[5][0][a] = (Nwx(2,a)*F(0,0) + F(0,2)*Nwx(0,a));
+    Bm[5][1][a] = (Nwx(2,a)*F(1,0) + F(1,2)*Nwx(0,a));
+    Bm[5][2][a] = (Nwx(2,a)*F(2,0) + F(2,2)*Nwx(0,a));
   }
 
-  Array<double> VxNx(3,eNoNw);
+  NodeArray<eNoNw_t,3> VxNx(eNoNw);
 
   for (int a = 0; a < eNoNw; a++) {
-    VxNx(0,a) = VxFi(0,0)*NxFi(0,a) + VxFi(1,0)*NxFi(1,a) + VxFi(2,0)*NxFi(2,a);
-    VxNx(1,a) = VxFi(0,1)*NxFi(0,a) + VxFi(1,1)*NxFi(1,a) + VxFi(2,1)*NxFi(2,a);
-    VxNx(2,a) = VxFi(0,2)*NxFi(0,a) + VxFi(1,2)*NxFi(1,a) + VxFi(2,2)*NxFi(2,a);
+    VxNx[0][a] = VxFi(0,0)*NxFi[0][a] + VxFi(1,0)*NxFi[1][a] + VxFi(2,0)*NxFi[2][a];
+    VxNx[1][a] = VxFi(0,1)*NxFi[0][a] + VxFi(1,1)*NxFi[1][a] + VxFi(2,1)*NxFi[2][a];
+    VxNx[2][a] = VxFi(0,2)*NxFi[0][a] + VxFi(1,2)*NxFi[1][a] + VxFi(2,2)*NxFi[2][a];
   }
 
   // Tangent (stiffness) matrices
@@ -1399,8 +1450,21 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
   double r23 = 2.0 / 3.0;
   double NxSNx{0.0}, BtDB{0.0};
   double Tv{0.0}, Ku{0.0};
+  double DBm[6][3];
 
   for (int b = 0; b < eNoNw; b++) {
+
+    // Material stiffness (D*B) for node b
+    for (int ii = 0; ii < 6; ii++) {
+      for (int jj = 0; jj < 3; jj++) {
+        double sum = 0.0;
+        for (int kk = 0; kk < 6; kk++) {
+          sum += Dm(ii,kk) * Bm[kk][jj][b];
+        }
+        DBm[ii][jj] = sum;
+      }
+    }
+
     for (int a = 0; a < eNoNw; a++) {
       NxSNx = Nwx(0,a)*Siso(0,0)*Nwx(0,b)
        + Nwx(0,a)*Siso(0,1)*Nwx(1,b) + Nwx(0,a)*Siso(0,2)*Nwx(2,b)
@@ -1408,159 +1472,157 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
        + Nwx(1,a)*Siso(1,2)*Nwx(2,b) + Nwx(2,a)*Siso(2,0)*Nwx(0,b)
        + Nwx(2,a)*Siso(2,1)*Nwx(1,b) + Nwx(2,a)*Siso(2,2)*Nwx(2,b);
 
-      auto DBm = mat_mul(Dm, Bm.rslice(b));
-
       // dM1_dV1 + af/am *dM_1/dU_1
-      BtDB = Bm(0,0,a)*DBm(0,0) + Bm(1,0,a)*DBm(1,0) +
-             Bm(2,0,a)*DBm(2,0) + Bm(3,0,a)*DBm(3,0) +
-             Bm(4,0,a)*DBm(4,0) + Bm(5,0,a)*DBm(5,0);
-      T1   = Jac*rho*vd(0)*Nw(a)*NxFi(0,b);
-      T2   = -tauC*Jac*NxFi(0,a)*VxNx(0,b);
+      BtDB = Bm[0][0][a]*DBm[0][0] + Bm[1][0][a]*DBm[1][0] +
+             Bm[2][0][a]*DBm[2][0] + Bm[3][0][a]*DBm[3][0] +
+             Bm[4][0][a]*DBm[4][0] + Bm[5][0][a]*DBm[5][0];
+      T1   = Jac*rho*vd(0)*Nw(a)*NxFi[0][b];
+      T2   = -tauC*Jac*NxFi[0][a]*VxNx[0][b];
  
       Ku   = w*af*(T1 + T2 + BtDB + NxSNx + Kvis_u(0,a,b));
       lKd(0,a,b) = lKd(0,a,b) + Ku;
  
       T1   = am*Jac*rho*Nw(a)*Nw(b);
-      T2   = T1 + af*Jac*tauC*rho*NxFi(0,a)*NxFi(0,b);
+      T2   = T1 + af*Jac*tauC*rho*NxFi[0][a]*NxFi[0][b];
       Tv   = af*Kvis_v(0,a,b);
       lK(0,a,b)  = lK(0,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_1/dV_2 + af/am *dM_1/dU_2
-      BtDB = Bm(0,0,a)*DBm(0,1) + Bm(1,0,a)*DBm(1,1) +
-             Bm(2,0,a)*DBm(2,1) + Bm(3,0,a)*DBm(3,1) +
-             Bm(4,0,a)*DBm(4,1) + Bm(5,0,a)*DBm(5,1);
-      T1   = Jac*rho*vd(0)*Nw(a)*NxFi(1,b);
-      T2   = -tauC*Jac*NxFi(0,a)*VxNx(1,b);
-      T3   = Jac*rCl*(NxFi(0,a)*NxFi(1,b) - NxFi(1,a)*NxFi(0,b));
+      BtDB = Bm[0][0][a]*DBm[0][1] + Bm[1][0][a]*DBm[1][1] +
+             Bm[2][0][a]*DBm[2][1] + Bm[3][0][a]*DBm[3][1] +
+             Bm[4][0][a]*DBm[4][1] + Bm[5][0][a]*DBm[5][1];
+      T1   = Jac*rho*vd(0)*Nw(a)*NxFi[1][b];
+      T2   = -tauC*Jac*NxFi[0][a]*VxNx[1][b];
+      T3   = Jac*rCl*(NxFi[0][a]*NxFi[1][b] - NxFi[1][a]*NxFi[0][b]);
  
       Ku   = w*af*(T1 + T2 + T3 + BtDB + Kvis_u(1,a,b));
       lKd(1,a,b) = lKd(1,a,b) + Ku;
  
-      T2   = af*Jac*tauC*rho*NxFi(0,a)*NxFi(1,b);
+      T2   = af*Jac*tauC*rho*NxFi[0][a]*NxFi[1][b];
       Tv   = af*Kvis_v(1,a,b);
       lK(1,a,b) = lK(1,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_1/dV_3 + af/am *dM_1/dU_3
       //
-      BtDB = Bm(0,0,a)*DBm(0,2) + Bm(1,0,a)*DBm(1,2) +
-             Bm(2,0,a)*DBm(2,2) + Bm(3,0,a)*DBm(3,2) +
-             Bm(4,0,a)*DBm(4,2) + Bm(5,0,a)*DBm(5,2);
-      T1   = Jac*rho*vd(0)*Nw(a)*NxFi(2,b);
-      T2   = -tauC*Jac*NxFi(0,a)*VxNx(2,b);
-      T3   = Jac*rCl*(NxFi(0,a)*NxFi(2,b) - NxFi(2,a)*NxFi(0,b));
+      BtDB = Bm[0][0][a]*DBm[0][2] + Bm[1][0][a]*DBm[1][2] +
+             Bm[2][0][a]*DBm[2][2] + Bm[3][0][a]*DBm[3][2] +
+             Bm[4][0][a]*DBm[4][2] + Bm[5][0][a]*DBm[5][2];
+      T1   = Jac*rho*vd(0)*Nw(a)*NxFi[2][b];
+      T2   = -tauC*Jac*NxFi[0][a]*VxNx[2][b];
+      T3   = Jac*rCl*(NxFi[0][a]*NxFi[2][b] - NxFi[2][a]*NxFi[0][b]);
  
       Ku   = w*af*(T1 + T2 + T3 + BtDB + Kvis_u(2,a,b));
       lKd(2,a,b) = lKd(2,a,b) + Ku;
  
-      T2   = af*Jac*tauC*rho*NxFi(0,a)*NxFi(2,b);
+      T2   = af*Jac*tauC*rho*NxFi[0][a]*NxFi[2][b];
       Tv   = af*Kvis_v(2,a,b);
       lK(2,a,b) = lK(2,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_2/dV_1 + af/am *dM_2/dU_1
       //
-      BtDB = Bm(0,1,a)*DBm(0,0) + Bm(1,1,a)*DBm(1,0) +
-             Bm(2,1,a)*DBm(2,0) + Bm(3,1,a)*DBm(3,0) +
-             Bm(4,1,a)*DBm(4,0) + Bm(5,1,a)*DBm(5,0);
+      BtDB = Bm[0][1][a]*DBm[0][0] + Bm[1][1][a]*DBm[1][0] +
+             Bm[2][1][a]*DBm[2][0] + Bm[3][1][a]*DBm[3][0] +
+             Bm[4][1][a]*DBm[4][0] + Bm[5][1][a]*DBm[5][0];
 
-      T1   = Jac*rho*vd(1)*Nw(a)*NxFi(0,b);
-      T2   = -tauC*Jac*NxFi(1,a)*VxNx(0,b);
-      T3   = Jac*rCl*(NxFi(1,a)*NxFi(0,b) - NxFi(0,a)*NxFi(1,b));
+      T1   = Jac*rho*vd(1)*Nw(a)*NxFi[0][b];
+      T2   = -tauC*Jac*NxFi[1][a]*VxNx[0][b];
+      T3   = Jac*rCl*(NxFi[1][a]*NxFi[0][b] - NxFi[0][a]*NxFi[1][b]);
  
       Ku   = w*af*(T1 + T2 + T3 + BtDB + Kvis_u(3,a,b));
       lKd(3,a,b) = lKd(3,a,b) + Ku;
  
-      T2   = af*Jac*tauC*rho*NxFi(1,a)*NxFi(0,b);
+      T2   = af*Jac*tauC*rho*NxFi[1][a]*NxFi[0][b];
       Tv   = af*Kvis_v(3,a,b);
 
       lK(4,a,b) = lK(4,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_2/dV_2 + af/am *dM_2/dU_2
       //
-      BtDB = Bm(0,1,a)*DBm(0,1) + Bm(1,1,a)*DBm(1,1) +
-             Bm(2,1,a)*DBm(2,1) + Bm(3,1,a)*DBm(3,1) +
-             Bm(4,1,a)*DBm(4,1) + Bm(5,1,a)*DBm(5,1);
+      BtDB = Bm[0][1][a]*DBm[0][1] + Bm[1][1][a]*DBm[1][1] +
+             Bm[2][1][a]*DBm[2][1] + Bm[3][1][a]*DBm[3][1] +
+             Bm[4][1][a]*DBm[4][1] + Bm[5][1][a]*DBm[5][1];
 
-      T1   = Jac*rho*vd(1)*Nw(a)*NxFi(1,b);
+      T1   = Jac*rho*vd(1)*Nw(a)*NxFi[1][b];
 
-      T2   = -tauC*Jac*NxFi(1,a)*VxNx(1,b);
+      T2   = -tauC*Jac*NxFi[1][a]*VxNx[1][b];
 
  
       Ku   = w*af*(T1 + T2 + BtDB + NxSNx + Kvis_u(4,a,b));
       lKd(4,a,b) = lKd(4,a,b) + Ku;
  
       T1   = am*Jac*rho*Nw(a)*Nw(b);
-      T2   = T1 + af*Jac*tauC*rho*NxFi(1,a)*NxFi(1,b);
+      T2   = T1 + af*Jac*tauC*rho*NxFi[1][a]*NxFi[1][b];
       Tv   = af*Kvis_v(4,a,b);
       lK(5,a,b) = lK(5,a,b) + w*(T2 + Tv) + afm*Ku;
 
 
       // dM_2/dV_3 + af/am *dM_2/dU_3
       //
-      BtDB = Bm(0,1,a)*DBm(0,2) + Bm(1,1,a)*DBm(1,2) +
-             Bm(2,1,a)*DBm(2,2) + Bm(3,1,a)*DBm(3,2) +
-             Bm(4,1,a)*DBm(4,2) + Bm(5,1,a)*DBm(5,2);
+      BtDB = Bm[0][1][a]*DBm[0][2] + Bm[1][1][a]*DBm[1][2] +
+             Bm[2][1][a]*DBm[2][2] + Bm[3][1][a]*DBm[3][2] +
+             Bm[4][1][a]*DBm[4][2] + Bm[5][1][a]*DBm[5][2];
 
-      T1   = Jac*rho*vd(1)*Nw(a)*NxFi(2,b);
-      T2   = -tauC*Jac*NxFi(1,a)*VxNx(2,b);
-      T3   = Jac*rCl*(NxFi(1,a)*NxFi(2,b) - NxFi(2,a)*NxFi(1,b));
+      T1   = Jac*rho*vd(1)*Nw(a)*NxFi[2][b];
+      T2   = -tauC*Jac*NxFi[1][a]*VxNx[2][b];
+      T3   = Jac*rCl*(NxFi[1][a]*NxFi[2][b] - NxFi[2][a]*NxFi[1][b]);
 
  
       Ku   = w*af*(T1 + T2 + T3 + BtDB + Kvis_u(5,a,b));
       lKd(5,a,b) = lKd(5,a,b) + Ku;
  
-      T2   = af*Jac*tauC*rho*NxFi(1,a)*NxFi(2,b);
+      T2   = af*Jac*tauC*rho*NxFi[1][a]*NxFi[2][b];
       Tv   = af*Kvis_v(5,a,b);
       lK(6,a,b) = lK(6,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_3/dV_1 + af/am *dM_3/dU_1
       //
-      BtDB = Bm(0,2,a)*DBm(0,0) + Bm(1,2,a)*DBm(1,0) +
-             Bm(2,2,a)*DBm(2,0) + Bm(3,2,a)*DBm(3,0) +
-             Bm(4,2,a)*DBm(4,0) + Bm(5,2,a)*DBm(5,0);
+      BtDB = Bm[0][2][a]*DBm[0][0] + Bm[1][2][a]*DBm[1][0] +
+             Bm[2][2][a]*DBm[2][0] + Bm[3][2][a]*DBm[3][0] +
+             Bm[4][2][a]*DBm[4][0] + Bm[5][2][a]*DBm[5][0];
 
-      T1   = Jac*rho*vd(2)*Nw(a)*NxFi(0,b);
-      T2   = -tauC*Jac*NxFi(2,a)*VxNx(0,b);
-      T3   = Jac*rCl*(NxFi(2,a)*NxFi(0,b) - NxFi(0,a)*NxFi(2,b));
+      T1   = Jac*rho*vd(2)*Nw(a)*NxFi[0][b];
+      T2   = -tauC*Jac*NxFi[2][a]*VxNx[0][b];
+      T3   = Jac*rCl*(NxFi[2][a]*NxFi[0][b] - NxFi[0][a]*NxFi[2][b]);
  
       Ku   = w*af*(T1 + T2 + T3 + BtDB + Kvis_u(6,a,b));
       lKd(6,a,b) = lKd(6,a,b) + Ku;
  
-      T2   = af*Jac*tauC*rho*NxFi(2,a)*NxFi(0,b);
+      T2   = af*Jac*tauC*rho*NxFi[2][a]*NxFi[0][b];
       Tv   = af*Kvis_v(6,a,b);
       lK(8,a,b) = lK(8,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_3/dV_2 + af/am *dM_3/dU_2
       //
-      BtDB = Bm(0,2,a)*DBm(0,1) + Bm(1,2,a)*DBm(1,1) +
-             Bm(2,2,a)*DBm(2,1) + Bm(3,2,a)*DBm(3,1) +
-             Bm(4,2,a)*DBm(4,1) + Bm(5,2,a)*DBm(5,1);
+      BtDB = Bm[0][2][a]*DBm[0][1] + Bm[1][2][a]*DBm[1][1] +
+             Bm[2][2][a]*DBm[2][1] + Bm[3][2][a]*DBm[3][1] +
+             Bm[4][2][a]*DBm[4][1] + Bm[5][2][a]*DBm[5][1];
 
-      T1   = Jac*rho*vd(2)*Nw(a)*NxFi(1,b);
-      T2   = -tauC*Jac*NxFi(2,a)*VxNx(1,b);
-      T3   = Jac*rCl*(NxFi(2,a)*NxFi(1,b) - NxFi(1,a)*NxFi(2,b));
+      T1   = Jac*rho*vd(2)*Nw(a)*NxFi[1][b];
+      T2   = -tauC*Jac*NxFi[2][a]*VxNx[1][b];
+      T3   = Jac*rCl*(NxFi[2][a]*NxFi[1][b] - NxFi[1][a]*NxFi[2][b]);
  
       Ku   = w*af*(T1 + T2 + T3 + BtDB + Kvis_u(7,a,b));
       lKd(7,a,b) = lKd(7,a,b) + Ku;
  
-      T2   = af*Jac*tauC*rho*NxFi(2,a)*NxFi(1,b);
+      T2   = af*Jac*tauC*rho*NxFi[2][a]*NxFi[1][b];
       Tv   = af*Kvis_v(7,a,b);
 
       lK(9,a,b) = lK(9,a,b) + w*(T2 + Tv) + afm*Ku;
 
       // dM_3/dV_3 + af/am *dM_3/dU_3
       //
-      BtDB = Bm(0,2,a)*DBm(0,2) + Bm(1,2,a)*DBm(1,2) +
-             Bm(2,2,a)*DBm(2,2) + Bm(3,2,a)*DBm(3,2) +
-             Bm(4,2,a)*DBm(4,2) + Bm(5,2,a)*DBm(5,2);
+      BtDB = Bm[0][2][a]*DBm[0][2] + Bm[1][2][a]*DBm[1][2] +
+             Bm[2][2][a]*DBm[2][2] + Bm[3][2][a]*DBm[3][2] +
+             Bm[4][2][a]*DBm[4][2] + Bm[5][2][a]*DBm[5][2];
 
-      T1   = Jac*rho*vd(2)*Nw(a)*NxFi(2,b);
-      T2   = -tauC*Jac*NxFi(2,a)*VxNx(2,b);
+      T1   = Jac*rho*vd(2)*Nw(a)*NxFi[2][b];
+      T2   = -tauC*Jac*NxFi[2][a]*VxNx[2][b];
  
       Ku   = w*af*(T1 + T2 + BtDB + NxSNx + Kvis_u(8,a,b));
       lKd(8,a,b) = lKd(8,a,b) + Ku;
  
       T1   = am*Jac*rho*Nw(a)*Nw(b);
-      T2   = T1 + af*Jac*tauC*rho*NxFi(2,a)*NxFi(2,b);
+      T2   = T1 + af*Jac*tauC*rho*NxFi[2][a]*NxFi[2][b];
       Tv   = af*Kvis_v(8,a,b);
 
       lK(10,a,b) = lK(10,a,b) + w*(T2 + Tv) + afm*Ku;
@@ -1573,25 +1635,86 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
 
       // dM_0/dP
       T0 = am*tauC*beta + af*(tauC*dbeta*pd - 1.0);
-      T1 = T0*NxFi(0,a)*Nq(b) + af*drho*vd(0)*Nw(a)*Nq(b);
+      T1 = T0*NxFi[0][a]*Nq(b) + af*drho*vd(0)*Nw(a)*Nq(b);
       lK(3,a,b) = lK(3,a,b) + w*Jac*T1;
 
       // dM_1/dP
-      T1 = T0*NxFi(1,a)*Nq(b) + af*drho*vd(1)*Nw(a)*Nq(b);
+      T1 = T0*NxFi[1][a]*Nq(b) + af*drho*vd(1)*Nw(a)*Nq(b);
       lK(7,a,b) = lK(7,a,b) + w*Jac*T1;
 
       // dM_2/dP
-      T1 = T0*NxFi(2,a)*Nq(b) + af*drho*vd(2)*Nw(a)*Nq(b);
+      T1 = T0*NxFi[2][a]*Nq(b) + af*drho*vd(2)*Nw(a)*Nq(b);
       lK(11,a,b) = lK(11,a,b) + w*Jac*T1;
     }
   }
 
 }
 
+/// @brief Element momentum residual and tangents for any element type.
+//
+void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const int eNoNw, const int eNoNq, 
+    const int nFn, const double w, const double Je, const Vector<double>& Nw,  const Vector<double>& Nq, 
+    const Array<double>& Nwx, const Array<double>& al, const Array<double>& yl, const Array<double>& dl, 
+    const Array<double>& bfl, const Array<double>& fN, const Vector<double>& ya_l, Array<double>& lR, 
+    Array3<double>& lK, Array3<double>& lKd)
+{
+  ustruct_3d_m<0,0>(com_mod, cep_mod, vmsFlag, eNoNw, eNoNq, nFn, w, Je, Nw, Nq, Nwx, al, yl, dl, bfl, fN, 
+      ya_l, lR, lK, lKd);
+}
+
+/// @brief Select the 3D momentum kernel specialized for the element type 
+/// and function spaces of a mesh. 
+///
+/// Meshes with other element types use the generic ustruct_3d_m() kernel.
+//
+Ustruct3dKernel ustruct_3d_m_kernel(const mshType& lM, const bool vmsStab)
+{
+  using namespace consts;
+
+  if (lM.fs.size() == 0) {
+    return ustruct_3d_m;
+  }
+
+  int eNoNw = lM.fs[0].eNoN;
+  int eNoNq = eNoNw;
+
+  if (!vmsStab) {
+    if (lM.fs.size() < 2) {
+      return ustruct_3d_m;
+    }
+    eNoNq = lM.fs[1].eNoN;
+  }
+
+  if (lM.eType == ElementType::TET4 && eNoNw == 4 && eNoNq == 4) {
+    return ustruct_3d_m<4,4>;
+
+  } else if (lM.eType == ElementType::TET10 && eNoNw == 10 && eNoNq == 10) {
+    return ustruct_3d_m<10,10>;
+
+  } else if (lM.eType == ElementType::TET10 && eNoNw == 10 && eNoNq == 4) {
+    return ustruct_3d_m<10,4>;
+
+  } else if (lM.eType == ElementType::HEX8 && eNoNw == 8 && eNoNq == 8) {
+    return ustruct_3d_m<8,8>;
+  }
+
+  return ustruct_3d_m;
+}
+
 /// @brief Replicates 'SUBROUTINE USTRUCT_DOASSEM(d, eqN, lKd, lK, lR)'
 //
 void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array3<double>& lKd, 
     const Array3<double>& lK, const Array<double>& lR)
+{
+  ustruct_do_assem(com_mod, d, eqN, Array<int>(), lKd, lK, lR);
+}
+
+/// @brief Assemble using the element scatter map 'valPtr' (a slice of 
+/// mshType::eValPtr) for the entries whose row and column are not 
+/// remapped by idMap. If 'valPtr' is empty then colPtr is searched.
+//
+void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array<int>& valPtr,
+    const Array3<double>& lKd, const Array3<double>& lK, const Array<double>& lR)
 {
   const int nsd = com_mod.nsd;
   const auto& idMap = com_mod.idMap;
@@ -1599,6 +1722,13 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
   auto& Kd = com_mod.Kd;
   auto& Val = com_mod.Val;
 
+  auto col_ptr = [&](const int a, const int b, const int rowN, const int colN) {
+    if ((valPtr.size() != 0) && (rowN == eqN(a)) && (colN == eqN(b))) {
+      return valPtr(a,b);
+    }
+    return get_col_ptr(com_mod, rowN, colN);
+  };
+
   for (int a = 0; a < d; a++) {
     // Momentum equation residual is assembled at mapped rows
     int rowN = idMap(eqN(a));
@@ -1622,7 +1752,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // A - matrix
       for (int b = 0; b < d; b++) {
         int colN = idMap(eqN(b));
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
 
         for (int i = 0; i < 9; i++) {
           Kd (i,ptr) = Kd(i,ptr) + lKd(i,a,b);
@@ -1638,7 +1768,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // B - matrix
       for (int b = 0; b < d; b++) {
         int colN = eqN(b);
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
         Val(3 ,ptr) = Val(3 ,ptr) + lK(3 ,a,b);
         Val(7 ,ptr) = Val(7 ,ptr) + lK(7 ,a,b);
         Val(11,ptr) = Val(11,ptr) + lK(11,a,b);
@@ -1655,7 +1785,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // C - matrix
       for (int b = 0; b < d; b++) {
         int colN = idMap(eqN(b));
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
 
         for (int i = 0; i < 3; i++) {
           Kd(i+9,ptr) = Kd(i+9,ptr) + lKd(i+9,a,b);
@@ -1666,7 +1796,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // D - matrix
       for (int b = 0; b < d; b++) {
         int colN = eqN(b);
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
 
         Val(15,ptr) = Val(15,ptr) + lK(15,a,b);
       }
@@ -1684,7 +1814,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // A - matrix
       for (int b = 0; b < d; b++) {
         int colN = idMap(eqN(b));
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
 
         for (int i = 0; i < 4; i++) {
           Kd(i,ptr) = Kd(i,ptr) + lKd(i,a,b);
@@ -1699,7 +1829,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // B - matrix
       for (int b = 0; b < d; b++) {
         int colN = eqN(b);
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
 
         Val(2,ptr) = Val(2,ptr) + lK(2,a,b);
         Val(5,ptr) = Val(5,ptr) + lK(5,a,b);
@@ -1716,7 +1846,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // C - matrix
       for (int b = 0; b < d; b++) {
         int colN = idMap(eqN(b));
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
 
         for (int i = 0; i < 2; i++) {
           Kd (i+4,ptr) = Kd(i+4,ptr) + lKd(i+4,a,b);
@@ -1727,7 +1857,7 @@ void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, cons
       // D - matrix
       for (int b = 0; b < d; b++) {
         int colN = eqN(b);
-        int ptr = get_col_ptr(com_mod, rowN, colN);
+        int ptr = col_ptr(a, b, rowN, colN);
         Val(8,ptr) = Val(8,ptr) + lK(8,a,b);
       }
     }
@@ -74,9 +74,20 @@ void ustruct_3d_m(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const in
     const Array<double>& bfl, const Array<double>& fN, const Vector<double>& ya_l, Array<double>& lR, 
     Array3<double>& lK, Array3<double>& lKd);
 
+using Ustruct3dKernel = void (*)(ComMod& com_mod, CepMod& cep_mod, const bool vmsFlag, const int eNoNw, 
+    const int eNoNq, const int nFn, const double w, const double Je, const Vector<double>& Nw,  
+    const Vector<double>& Nq, const Array<double>& Nwx, const Array<double>& al, const Array<double>& yl, 
+    const Array<double>& dl, const Array<double>& bfl, const Array<double>& fN, const Vector<double>& ya_l, 
+    Array<double>& lR, Array3<double>& lK, Array3<double>& lKd);
+
+Ustruct3dKernel ustruct_3d_m_kernel(const mshType& lM, const bool vmsStab);
+
 void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array3<double>& lKd, 
     const Array3<double>& lK, const Array<double>& lR);
 
+void ustruct_do_assem(ComMod& com_mod, const int d, const Vector<int>& eqN, const Array<int>& valPtr,
+    const Array3<double>& lKd, const Array3<double>& lK, const Array<double>& lR);
+
 void ustruct_r(ComMod& com_mod, const Array<double>& Yg);
 
 };
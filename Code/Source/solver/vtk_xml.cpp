@@ -32,15 +32,20 @@
 
 #include "vtk_xml.h"
 #include "vtk_xml_parser.h"
+#include "Profiler.h"
 #include "VtkData.h"
 
 #include "all_fun.h"
 #include "consts.h"
 #include "post.h"
 
+#include <filesystem>
+#include <fstream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 #include <stdio.h>
+#include <tuple>
 
 #include <vtkUnstructuredGrid.h>
 #include <vtkSmartPointer.h>
@@ -906,6 +911,247 @@ void write_vtu_debug(ComMod& com_mod, mshType& lM, const std::string& fName)
   delete vtk_writer;
 }
 
+//-------------
+// write_pvtus
+//-------------
+/// @brief Write the output data 'd' prepared by write_vtus() for the local mesh
+/// nodes and elements of each processor to its own .vtu file (piece) and write 
+/// a .pvtu file on the master referencing the pieces. 
+///
+/// The pieces are written to the directory 'fName' and the .pvtu file to 'fName.pvtu'. 
+/// Nodes on a partition boundary are written to the pieces of all processors sharing 
+/// them, they are marked as ghost (duplicate) points on the processors not owning them.
+///
+/// This avoids gathering the meshes and all output data on the master processor.
+//
+void write_pvtus(Simulation* simulation, const std::vector<dataType>& d, const std::vector<std::string>& outNames,
+    const std::vector<int>& outS, const std::vector<std::string>& outNamesE, const int nOute, const bool lIbl, 
+    const std::string& fName)
+{
+  using namespace consts;
+
+  auto& com_mod = simulation->com_mod;
+  auto& cm = com_mod.cm;
+  auto& cm_mod = simulation->cm_mod;
+  const auto& lhs = com_mod.lhs;
+
+  const int nsd = com_mod.nsd;
+  const int nMsh = com_mod.nMsh;
+  const int nOut = outNames.size();
+  const auto& meshes = com_mod.msh;
+
+  // Name, type and number of components of the point and element data arrays. 
+  std::vector<std::tuple<std::string,std::string,int>> point_arrays;
+  std::vector<std::tuple<std::string,std::string,int>> elem_arrays;
+
+  auto base_name = fName.substr(fName.find_last_of('/') + 1);
+  auto piece_name = [&base_name](const int id) { 
+    return base_name + "/" + base_name + "_" + std::to_string(id) + ".vtu"; 
+  };
+
+  if (cm.mas(cm_mod)) {
+    std::filesystem::create_directories(fName);
+  }
+
+  MPI_Barrier(cm.com());
+
+  int nNo = 0;
+  int nEl = 0;
+
+  for (int iM = 0; iM < nMsh; iM++) {
+    nNo = nNo + meshes[iM].nNo;
+    nEl = nEl + meshes[iM].nEl;
+  }
+
+  auto file_name = fName.substr(0, fName.size() - base_name.size()) + piece_name(cm.id());
+  std::shared_ptr<VtkData> vtk_writer(VtkData::create_writer(file_name));
+
+  // Writing the position data and the ghost points, a node is owned by the
+  // processor if it is one of the first 'mynNo' nodes of the linear system.
+  //
+  Array<double> tmpV(consts::maxNSD, nNo);
+  Vector<int> ghosts(nNo);
+  int nSh = 0;
+
+  for (int iM = 0; iM < nMsh; iM++) {
+    auto& msh = meshes[iM];
+
+    for (int a = 0; a < msh.nNo; a++) {
+      for (int i = 0; i < nsd; i++) {
+        tmpV(i,a+nSh) = d[iM].x(i,a);
+      }
+
+      int Ac = msh.gN(a);
+      ghosts(a+nSh) = (lhs.map(Ac) >= lhs.mynNo);
+    }
+
+    nSh = nSh + msh.nNo;
+  }
+
+  vtk_writer->set_points(tmpV);
+  vtk_writer->set_ghost_points(ghosts);
+  point_arrays.push_back({"vtkGhostType", "UInt8", 1});
+
+  // Writing the connectivity data using the local mesh node IDs.
+  //
+  nSh = 0;
+
+  for (int iM = 0; iM < nMsh; iM++) {
+    auto& msh = meshes[iM];
+    Array<int> tmpI(msh.eNoN, msh.nEl);
+
+    for (int e = 0; e < msh.nEl; e++) {
+      for (int i = 0; i < msh.eNoN; i++) {
+        tmpI(i,e) = msh.lN(msh.IEN(i,e)) + nSh;
+      }
+    }
+
+    vtk_writer->set_connectivity(nsd, tmpI);
+    nSh = nSh + msh.nNo;
+  }
+
+  // Writing all solutions
+  //
+  for (int iOut = 1; iOut < nOut; iOut++) {
+    int s = outS[iOut];
+    int l = outS[iOut+1] - s;
+    Array<double> tmpV(l, nNo);
+    int nSh = 0;
+
+    for (int iM = 0; iM < nMsh; iM++) {
+      for (int a = 0; a < meshes[iM].nNo; a++) {
+        for (int i = 0; i < l; i++) {
+          tmpV(i,a+nSh) = d[iM].x(i+s,a);
+        }
+      }
+      nSh = nSh + meshes[iM].nNo;
+    }
+
+    vtk_writer->set_point_data(outNames[iOut], tmpV);
+    point_arrays.push_back({outNames[iOut], "Float64", l});
+  }
+
+  // Write element-based variables, the same variables as write_vtus().
+  //
+  if (!com_mod.savedOnce || nMsh > 1) {
+    Array<int> tmpI(1,nEl);
+
+    if (com_mod.dmnId.size() != 0) {
+      int Ec = 0;
+      for (int iM = 0; iM < nMsh; iM++) {
+        for (int e = 0; e < meshes[iM].nEl; e++) {
+          tmpI(0,Ec) = meshes[iM].eId(e);
+          Ec = Ec + 1;
+        }
+      }
+      vtk_writer->set_element_data("Domain_ID", tmpI);
+      elem_arrays.push_back({"Domain_ID", "Int32", 1});
+    }
+
+    if (!com_mod.savedOnce && !cm.seq()) {
+      tmpI = cm.id();
+      vtk_writer->set_element_data("Proc_ID", tmpI);
+      elem_arrays.push_back({"Proc_ID", "Int32", 1});
+    }
+
+    if (nMsh > 1) {
+      int Ec = 0;
+      for (int iM = 0; iM < nMsh; iM++) {
+        for (int e = 0; e < meshes[iM].nEl; e++) {
+          tmpI(0,Ec) = iM;
+          Ec = Ec + 1;
+        }
+      }
+      vtk_writer->set_element_data("Mesh_ID", tmpI);
+      elem_arrays.push_back({"Mesh_ID", "Int32", 1});
+    }
+  }
+
+  com_mod.savedOnce = true;
+
+  // Write element Jacobian and von Mises stress if necessary
+  //
+  for (int l = 0; l < nOute; l++) {
+    Array<double> tmpVe(1,nEl);
+    int Ec = 0;
+
+    for (int iM = 0; iM < nMsh; iM++) {
+      for (int e = 0; e < meshes[iM].nEl; e++) {
+        tmpVe(0,Ec) = (d[iM].xe.size() != 0) ? d[iM].xe(l,e) : 0.0;
+        Ec = Ec + 1;
+      }
+    }
+
+    vtk_writer->set_element_data(outNamesE[l], tmpVe);
+    elem_arrays.push_back({outNamesE[l], "Float64", 1});
+  }
+
+  // Write element ghost cells if necessary
+  //
+  if (lIbl) {
+    Array<int> tmpI(1,nEl);
+    int Ec = 0;
+
+    for (int iM = 0; iM < nMsh; iM++) {
+      for (int e = 0; e < meshes[iM].nEl; e++) {
+        tmpI(0,Ec) = (meshes[iM].iGC.size() != 0) ? meshes[iM].iGC(e) : 0;
+        Ec = Ec + 1;
+      }
+    }
+
+    vtk_writer->set_element_data("EGHOST", tmpI);
+    elem_arrays.push_back({"EGHOST", "Int32", 1});
+  }
+
+  // Write the piece in the background, the writer owns a copy of the data.
+  simulation->output_writer.submit([vtk_writer]() {
+    vtk_writer->write();
+  });
+
+  if (cm.slv(cm_mod)) {
+    return;
+  }
+
+  // Write the .pvtu file referencing the pieces of all processors.
+  //
+  std::ostringstream pvtu_file;
+
+  auto write_arrays = [&pvtu_file](const std::vector<std::tuple<std::string,std::string,int>>& arrays) {
+    for (auto& [name, type, num_comp] : arrays) {
+      pvtu_file << "      <PDataArray type=\"" << type << "\" Name=\"" << name << "\" NumberOfComponents=\"" 
+          << num_comp << "\"/>" << std::endl;
+    }
+  };
+
+  pvtu_file << "<?xml version=\"1.0\"?>" << std::endl;
+  pvtu_file << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+  pvtu_file << "  <PUnstructuredGrid GhostLevel=\"0\">" << std::endl;
+  pvtu_file << "    <PPointData>" << std::endl;
+  write_arrays(point_arrays);
+  pvtu_file << "    </PPointData>" << std::endl;
+  pvtu_file << "    <PCellData>" << std::endl;
+  write_arrays(elem_arrays);
+  pvtu_file << "    </PCellData>" << std::endl;
+  pvtu_file << "    <PPoints>" << std::endl;
+  pvtu_file << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>" << std::endl;
+  pvtu_file << "    </PPoints>" << std::endl;
+
+  for (int i = 0; i < cm.np(); i++) {
+    pvtu_file << "    <Piece Source=\"" << piece_name(i) << "\"/>" << std::endl;
+  }
+
+  pvtu_file << "  </PUnstructuredGrid>" << std::endl;
+  pvtu_file << "</VTKFile>" << std::endl;
+
+  simulation->output_writer.submit([file_name = fName + ".pvtu", contents = pvtu_file.str()]() {
+    std::ofstream pvtu_file(file_name);
+    if (pvtu_file.fail()) {
+      throw std::runtime_error("[write_pvtus] Unable to open the file '" + file_name + "' for writing.");
+    }
+    pvtu_file << contents;
+  });
+}
+
 //------------
 // write_vtus
 //------------
@@ -913,6 +1159,8 @@ void write_vtu_debug(ComMod& com_mod, mshType& lM, const std::string& fName)
 //
 void write_vtus(Simulation* simulation, const Array<double>& lA, const Array<double>& lY, const Array<double>& lD, const bool lAve)
 {
+  SV_PROFILE_REGION("write_vtus");
+
   #define n_debug_write_vtus
   #ifdef debug_write_vtus 
   DebugMsg dmsg(__func__, simulation->com_mod.cm.idcm());
@@ -1314,6 +1562,24 @@ void write_vtus(Simulation* simulation, const Array<double>& lA, const Array<dou
 
   } // iM for loop 
 
+  std::string fName;
+
+  if (com_mod.cTS > 1000 || lAve) {
+    fName = std::to_string(com_mod.cTS);
+  } else { 
+    std::ostringstream ss;
+    ss << std::setw(3) << std::setfill('0') << com_mod.cTS;
+    fName = ss.str();
+  }
+
+  fName = com_mod.saveName + "_" + fName;
+
+  // Each processor writes its local data.
+  //
+  if (com_mod.savePVTU) {
+    write_pvtus(simulation, d, outNames, outS, outNamesE, nOute, lIbl, fName);
+    return;
+  }
 
   // Integrate data from all processors
   //
@@ -1340,18 +1606,7 @@ void write_vtus(Simulation* simulation, const Array<double>& lA, const Array<dou
 
   // Writing to vtu file (master only)
   //
-  std::string fName;
-
-  if (com_mod.cTS > 1000 || lAve) {
-    fName = std::to_string(com_mod.cTS);
-  } else { 
-    std::ostringstream ss;
-    ss << std::setw(3) << std::setfill('0') << com_mod.cTS;
-    fName = ss.str();
-  }
-
-  fName = com_mod.saveName + "_" + fName + ".vtu";
-  auto vtk_writer = VtkData::create_writer(fName);
+  std::shared_ptr<VtkData> vtk_writer(VtkData::create_writer(fName + ".vtu"));
 
   // Writing the position data
   //
@@ -1503,8 +1758,10 @@ void write_vtus(Simulation* simulation, const Array<double>& lA, const Array<dou
      vtk_writer->set_element_data("EGHOST", tmpI);
   }
 
-  vtk_writer->write();
-  delete vtk_writer;
+  // The writer owns a copy of the data and is written by the output writer.
+  simulation->output_writer.submit([vtk_writer]() {
+    vtk_writer->write();
+  });
 }
 
 };
@@ -59,6 +59,10 @@ void write_vtu(ComMod& com_mod, mshType& lM, const std::string& fName);
 
 void write_vtu_debug(ComMod& com_mod, mshType& lM, const std::string& fName);
 
+void write_pvtus(Simulation* simulation, const std::vector<dataType>& d, const std::vector<std::string>& outNames,
+    const std::vector<int>& outS, const std::vector<std::string>& outNamesE, const int nOute, const bool lIbl, 
+    const std::string& fName);
+
 void write_vtus(Simulation* simulation, const Array<double>& lA, const Array<double>& lY, const Array<double>& lD, const bool lAve);
 
 };
@@ -0,0 +1,146 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// --------------------------------------------------------------
+// Tests for the compression of restart records in 
+// Code/Source/solver/Checkpoint.cpp.
+//
+// Run the tests with
+//
+//   ./run_all_unit_tests --gtest_filter='CheckpointTest.*'
+// --------------------------------------------------------------
+
+#include <cmath>
+#include <random>
+#include <string>
+#include "gtest/gtest.h"
+#include "Checkpoint.h"
+
+class CheckpointTest : public ::testing::Test {
+  protected:
+    // Create a record of 'num_doubles' slowly varying doubles followed 
+    // by 'num_extra' random bytes.
+    std::string create_record(const int64_t num_doubles, const int num_extra) {
+      std::mt19937 gen(num_doubles + num_extra);
+      std::uniform_int_distribution<int> byte(0, 255);
+
+      std::string record(num_doubles*sizeof(double) + num_extra, '\0');
+
+      for (int64_t i = 0; i < num_doubles; i++) {
+        double value = std::sin(1e-3 * i);
+        record.replace(i*sizeof(double), sizeof(double), (char*)&value, sizeof(double));
+      }
+
+      for (int i = 0; i < num_extra; i++) {
+        record[num_doubles*sizeof(double) + i] = static_cast<char>(byte(gen));
+      }
+
+      return record;
+    }
+
+    // Compress and decompress 'record' and check that it is unchanged.
+    void round_trip(const std::string& record) {
+      uint32_t checksum = Checkpoint::checksum(record);
+      auto data = Checkpoint::compress(record, checksum);
+
+      uint32_t read_checksum = 0;
+      auto result = Checkpoint::decompress(data, read_checksum);
+
+      EXPECT_EQ(read_checksum, checksum);
+      ASSERT_EQ(result.size(), record.size());
+      EXPECT_TRUE(result == record);
+      EXPECT_EQ(Checkpoint::checksum(result), checksum);
+    }
+};
+
+TEST_F(CheckpointTest, TestRoundTripEmpty) {
+  round_trip(std::string());
+}
+
+TEST_F(CheckpointTest, TestRoundTripPartialDouble) {
+  round_trip(create_record(0, 5));
+  round_trip(create_record(1000, 3));
+  round_trip(create_record(1000, 7));
+}
+
+// Records longer than the 1 MB compression block.
+TEST_F(CheckpointTest, TestRoundTripMultipleBlocks) {
+  round_trip(create_record((1 << 20) / sizeof(double), 0));
+  round_trip(create_record(300000, 0));
+  round_trip(create_record(300000, 5));
+}
+
+// A record changed before it is compressed, e.g. in memory, decompresses 
+// without error but does not match the checksum.
+TEST_F(CheckpointTest, TestChecksumDetectsCorruptRecord) {
+  auto record = create_record(300000, 5);
+  uint32_t checksum = Checkpoint::checksum(record);
+
+  auto corrupt_record = record;
+  corrupt_record[record.size() / 3] ^= 0x10;
+  auto data = Checkpoint::compress(corrupt_record, checksum);
+
+  uint32_t read_checksum = 0;
+  auto result = Checkpoint::decompress(data, read_checksum);
+
+  EXPECT_EQ(read_checksum, checksum);
+  EXPECT_NE(Checkpoint::checksum(result), read_checksum);
+}
+
+// A byte changed in the compressed data is detected when decompressing 
+// or by the checksum.
+TEST_F(CheckpointTest, TestCorruptCompressedData) {
+  auto record = create_record(300000, 5);
+  uint32_t checksum = Checkpoint::checksum(record);
+  auto data = Checkpoint::compress(record, checksum);
+
+  data[data.size() / 2] ^= 0x10;
+
+  bool detected = false;
+  try {
+    uint32_t read_checksum = 0;
+    auto result = Checkpoint::decompress(data, read_checksum);
+    detected = (result != record) && (Checkpoint::checksum(result) != read_checksum);
+  } catch (const std::runtime_error&) {
+    detected = true;
+  }
+
+  EXPECT_TRUE(detected);
+}
+
+// Truncated compressed data is rejected.
+TEST_F(CheckpointTest, TestTruncatedData) {
+  auto record = create_record(1000, 3);
+  auto data = Checkpoint::compress(record, Checkpoint::checksum(record));
+  data.resize(data.size() - 10);
+
+  uint32_t read_checksum = 0;
+  EXPECT_THROW(Checkpoint::decompress(data, read_checksum), std::runtime_error);
+}
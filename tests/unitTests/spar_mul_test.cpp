@@ -0,0 +1,162 @@
+/* Copyright (c) Stanford University, The Regents of the University of California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// --------------------------------------------------------------
+// Tests and micro-benchmark for the fsils block sparse matrix-vector 
+// kernels in Code/Source/liner_solver/spar_mul_block.cpp.
+//
+// The block kernels are compared with the Array index operator kernels
+// for a 27-point stencil node graph on a structured grid. The timing of 
+// both kernels is printed, run the benchmark with
+//
+//   ./run_all_unit_tests --gtest_filter='SparMulTest.*'
+// --------------------------------------------------------------
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "spar_mul_block.h"
+
+using namespace spar_mul;
+
+class SparMulTest : public ::testing::Test {
+  protected:
+    // Number of grid nodes in each direction.
+    int n = 24;
+
+    // Number of products timed.
+    int num_repeats = 20;
+
+    int nNo = 0;
+    Array<int> rowPtr;
+    Vector<int> colPtr;
+
+    // Create the node graph of a 27-point stencil on an n x n x n grid. 
+    void SetUp() override {
+      nNo = n*n*n;
+      rowPtr.resize(2,nNo);
+      std::vector<int> cols;
+
+      for (int z = 0; z < n; z++) {
+        for (int y = 0; y < n; y++) {
+          for (int x = 0; x < n; x++) {
+            int i = x + n*(y + n*z);
+            rowPtr(0,i) = cols.size();
+            for (int dz = -1; dz <= 1; dz++) {
+              for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                  int xn = x+dx, yn = y+dy, zn = z+dz;
+                  if ((xn < 0) || (yn < 0) || (zn < 0) || (xn >= n) || (yn >= n) || (zn >= n)) {
+                    continue;
+                  }
+                  cols.push_back(xn + n*(yn + n*zn));
+                }
+              }
+            }
+            rowPtr(1,i) = cols.size() - 1;
+          }
+        }
+      }
+
+      colPtr.resize(cols.size());
+      for (size_t j = 0; j < cols.size(); j++) {
+        colPtr(j) = cols[j];
+      }
+    }
+
+    // Compare the block and csr kernels for a block size and print their timings.
+    void compare_kernels(const int dof) {
+      std::mt19937 gen(dof);
+      std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+      Array<double> K(dof*dof, colPtr.size()), U(dof,nNo);
+      Array<double> KU_csr(dof,nNo), KU_block(dof,nNo);
+
+      for (int i = 0; i < K.size(); i++) {
+        K(i) = dist(gen);
+      }
+      for (int i = 0; i < U.size(); i++) {
+        U(i) = dist(gen);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      for (int r = 0; r < num_repeats; r++) {
+        spar_mul_vv_csr(0, nNo, rowPtr, colPtr, dof, K, U, KU_csr);
+      }
+      std::chrono::duration<double> csr_time = std::chrono::steady_clock::now() - start;
+
+      start = std::chrono::steady_clock::now();
+      for (int r = 0; r < num_repeats; r++) {
+        spar_mul_vv_block(0, nNo, rowPtr, colPtr, dof, K, U, KU_block);
+      }
+      std::chrono::duration<double> block_time = std::chrono::steady_clock::now() - start;
+
+      for (int i = 0; i < KU_csr.size(); i++) {
+        EXPECT_NEAR(KU_block(i), KU_csr(i), 1e-12 * (1.0 + std::abs(KU_csr(i))));
+      }
+
+      std::cout << "[SparMulTest] dof " << dof << "  nnz " << colPtr.size() 
+                << "  csr " << csr_time.count() / num_repeats << " s" 
+                << "  block " << block_time.count() / num_repeats << " s" 
+                << "  speedup " << csr_time.count() / block_time.count() << std::endl;
+    }
+};
+
+TEST_F(SparMulTest, TestBlockSize2) {
+  compare_kernels(2);
+}
+
+TEST_F(SparMulTest, TestBlockSize3) {
+  compare_kernels(3);
+}
+
+TEST_F(SparMulTest, TestBlockSize4) {
+  compare_kernels(4);
+}
+
+TEST_F(SparMulTest, TestBlockSize7) {
+  compare_kernels(7);
+}
+
+TEST_F(SparMulTest, TestBlockSizeSupported) {
+  EXPECT_TRUE(block_size_supported(3));
+  EXPECT_FALSE(block_size_supported(1));
+  EXPECT_FALSE(block_size_supported(5));
+
+  for (int dof = 1; dof <= 8; dof++) {
+    if (block_size_vectorized(dof)) {
+      EXPECT_TRUE(block_size_supported(dof));
+    }
+  }
+  EXPECT_FALSE(block_size_vectorized(1));
+  EXPECT_FALSE(block_size_vectorized(5));
+}